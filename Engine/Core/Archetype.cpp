@@ -0,0 +1,171 @@
+/*****************************************************************//**
+ * \file   Archetype.cpp
+ * \brief  Chunked structure-of-arrays storage for one component combination
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "Archetype.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    //chunks and component arrays start on cache line boundaries, or stricter if a component asks
+    constexpr size_t CHUNK_ALIGNMENT = 64;
+
+    size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+/**
+ * @brief Archetype Constructor. Works out the chunk layout for mask.
+ *
+ * @param archetypeMask The set of components stored here.
+ */
+Archetype::Archetype(ComponentMask archetypeMask)
+    : mask(archetypeMask),
+    chunkCapacity(0),
+    chunkAlignment(CHUNK_ALIGNMENT),
+    entityCount(0)
+{
+    componentOffsets.fill(NO_COLUMN);
+
+    size_t bytesPerEntity = sizeof(Entity);
+    for (ComponentTypeId id = 0; id < MAX_COMPONENT_TYPES; id++)
+    {
+        if (mask & (ComponentMask(1) << id))
+        {
+            componentTypes.push_back(id);
+            const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+            bytesPerEntity += info.size;
+            chunkAlignment = std::max(chunkAlignment, info.alignment);
+        }
+    }
+
+    // Largest capacity whose aligned arrays still fit into one chunk
+    uint32_t capacity = static_cast<uint32_t>(CHUNK_SIZE / bytesPerEntity);
+    while (capacity > 0)
+    {
+        size_t offset = sizeof(Entity) * capacity;
+        for (ComponentTypeId id : componentTypes)
+        {
+            const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+            offset = AlignUp(offset, std::max(info.alignment, CHUNK_ALIGNMENT));
+            componentOffsets[id] = static_cast<uint32_t>(offset);
+            offset += info.size * capacity;
+        }
+        if (offset <= CHUNK_SIZE)
+        {
+            break;
+        }
+        capacity--;
+    }
+
+    if (capacity == 0)
+    {
+        throw std::runtime_error("Components are too large to fit an entity into one chunk!");
+    }
+    chunkCapacity = capacity;
+}
+
+/**
+ * @brief Archetype Destructor. Destroys remaining components and frees the chunks.
+ *
+ */
+Archetype::~Archetype()
+{
+    for (Chunk& chunk : chunks)
+    {
+        for (ComponentTypeId id : componentTypes)
+        {
+            const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+            if (!info.destroy)
+            {
+                continue;
+            }
+            std::byte* array = static_cast<std::byte*>(GetComponentArray(chunk, id));
+            for (uint32_t row = 0; row < chunk.count; row++)
+            {
+                info.destroy(array + row * info.size);
+            }
+        }
+        ::operator delete(chunk.memory, std::align_val_t(chunkAlignment));
+    }
+}
+
+/**
+ * @brief Appends an entity to the last chunk, allocating a new chunk if it is full.
+ *
+ * @param entity The entity stored alongside the components.
+ * @return Location Where the entity now lives.
+ */
+Archetype::Location Archetype::AllocateRow(Entity entity)
+{
+    if (chunks.empty() || chunks.back().count == chunkCapacity)
+    {
+        Chunk chunk;
+        chunk.memory = static_cast<std::byte*>(::operator new(CHUNK_SIZE, std::align_val_t(chunkAlignment)));
+        chunks.push_back(chunk);
+    }
+
+    Chunk& chunk = chunks.back();
+    Location location{ static_cast<uint32_t>(chunks.size() - 1), chunk.count };
+    GetEntities(chunk)[chunk.count] = entity;
+    chunk.count++;
+    entityCount++;
+    return location;
+}
+
+/**
+ * @brief Removes a row, keeping chunks densely packed.
+ *
+ * @param location Row to remove.
+ * @param destroyComponents False if the caller already destroyed or moved them out.
+ * @return Entity The entity that moved into location, invalid if none moved.
+ */
+Entity Archetype::RemoveRow(Location location, bool destroyComponents)
+{
+    Chunk& chunk = chunks[location.chunk];
+    Chunk& last = chunks.back();
+    const uint32_t lastRow = last.count - 1;
+    const bool isLast = (&chunk == &last) && location.row == lastRow;
+
+    for (ComponentTypeId id : componentTypes)
+    {
+        const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+        std::byte* hole = static_cast<std::byte*>(GetComponentArray(chunk, id)) + location.row * info.size;
+        if (destroyComponents && info.destroy)
+        {
+            info.destroy(hole);
+        }
+        if (!isLast)
+        {
+            // Fill the hole with the archetype's last entity
+            std::byte* source = static_cast<std::byte*>(GetComponentArray(last, id)) + lastRow * info.size;
+            info.moveConstruct(hole, source);
+            if (info.destroy)
+            {
+                info.destroy(source);
+            }
+        }
+    }
+
+    Entity moved;
+    if (!isLast)
+    {
+        moved = GetEntities(last)[lastRow];
+        GetEntities(chunk)[location.row] = moved;
+    }
+
+    last.count--;
+    entityCount--;
+    if (last.count == 0)
+    {
+        ::operator delete(last.memory, std::align_val_t(chunkAlignment));
+        chunks.pop_back();
+    }
+    return moved;
+}
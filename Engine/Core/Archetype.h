@@ -0,0 +1,112 @@
+/*****************************************************************//**
+ * \file   Archetype.h
+ * \brief  Chunked structure-of-arrays storage for one component combination
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <array>
+#include <vector>
+#include "Entity.h"
+
+/**
+ * @brief Every entity with exactly the same set of components lives in the same
+ * archetype. Entities are packed into fixed size chunks; inside a chunk each
+ * component has its own contiguous array, so iterating a component touches
+ * nothing but that component's memory.
+ */
+class Archetype
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr uint32_t NO_COLUMN = UINT32_MAX;
+
+    struct Chunk
+    {
+        std::byte* memory = nullptr;
+        uint32_t count = 0;
+    };
+
+    //where an entity lives inside an archetype
+    struct Location
+    {
+        uint32_t chunk;
+        uint32_t row;
+    };
+
+    explicit Archetype(ComponentMask mask);
+    ~Archetype();
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    ComponentMask GetMask() const { return mask; }
+
+    bool HasComponent(ComponentTypeId id) const { return componentOffsets[id] != NO_COLUMN; }
+
+    const std::vector<ComponentTypeId>& GetComponentTypes() const { return componentTypes; }
+
+    uint32_t GetChunkCapacity() const { return chunkCapacity; }
+
+    size_t GetChunkCount() const { return chunks.size(); }
+
+    Chunk& GetChunk(size_t index) { return chunks[index]; }
+
+    uint32_t GetEntityCount() const { return entityCount; }
+
+    Entity* GetEntities(const Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.memory); }
+
+    /**
+     * @brief Start of the array holding component id in chunk.
+     */
+    void* GetComponentArray(const Chunk& chunk, ComponentTypeId id) const
+    {
+        return chunk.memory + componentOffsets[id];
+    }
+
+    template <typename T>
+    T* GetComponents(const Chunk& chunk) const
+    {
+        return static_cast<T*>(GetComponentArray(chunk, ComponentRegistry::GetId<std::remove_const_t<T>>()));
+    }
+
+    void* GetComponent(Location location, ComponentTypeId id) const
+    {
+        const Chunk& chunk = chunks[location.chunk];
+        return chunk.memory + componentOffsets[id] + static_cast<size_t>(location.row) * ComponentRegistry::GetInfo(id).size;
+    }
+
+    /**
+     * @brief Appends an entity. Its components are left uninitialized for the
+     * caller to construct.
+     *
+     * @param entity The entity stored alongside the components.
+     * @return Location Where the entity now lives.
+     */
+    Location AllocateRow(Entity entity);
+
+    /**
+     * @brief Removes a row by moving the archetype's last entity into the hole.
+     *
+     * @param location Row to remove.
+     * @param destroyComponents False if the caller already destroyed or moved them out.
+     * @return Entity The entity that moved into location, invalid if none moved.
+     */
+    Entity RemoveRow(Location location, bool destroyComponents);
+
+    //cached archetype graph edges for adding/removing one component
+    std::array<Archetype*, MAX_COMPONENT_TYPES> addEdges{};
+    std::array<Archetype*, MAX_COMPONENT_TYPES> removeEdges{};
+
+private:
+    ComponentMask mask;
+    std::vector<ComponentTypeId> componentTypes;
+    //byte offset of each component array inside a chunk, NO_COLUMN if absent
+    std::array<uint32_t, MAX_COMPONENT_TYPES> componentOffsets;
+    uint32_t chunkCapacity;
+    //chunks are allocated at the largest column alignment, at least a cache line
+    size_t chunkAlignment;
+    uint32_t entityCount;
+    std::vector<Chunk> chunks;
+};
@@ -0,0 +1,603 @@
+/*****************************************************************//**
+ * \file   Benchmarks.cpp
+ * \brief  Engine microbenchmarks
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "Benchmarks.h"
+#include "EntityCommandBuffer.h"
+#include "FrameAllocator.h"
+#include "JobSystem.h"
+#include "LinearArena.h"
+#include "Profiler.h"
+#include "VulkanRenderAPI.h"
+#include "World.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    //keeps the optimizer from deleting benchmark work
+    std::atomic<uint64_t> benchmarkSink{ 0 };
+
+    double SecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    struct BenchPosition { float x, y, z; };
+    struct BenchVelocity { float x, y, z; };
+    struct BenchAcceleration { float x, y, z; };
+    struct BenchMass { float value; };
+}
+
+/**
+ * @brief Runs the named benchmark.
+ *
+ * @param name Benchmark name, "all" runs every benchmark.
+ * @return int Process exit code.
+ */
+int RunBenchmark(const std::string& name)
+{
+    bool ran = false;
+    if (name == "jobs" || name == "all")
+    {
+        BenchmarkJobSystem();
+        ran = true;
+    }
+
+    if (name == "ecs" || name == "all")
+    {
+        BenchmarkEcs();
+        ran = true;
+    }
+
+    if (name == "alloc" || name == "all")
+    {
+        BenchmarkAllocators();
+        ran = true;
+    }
+
+    if (name == "record" || name == "all")
+    {
+        BenchmarkCommandRecording();
+        ran = true;
+    }
+
+    if (name == "indirect" || name == "all")
+    {
+        BenchmarkGpuDriven();
+        ran = true;
+    }
+
+    if (name == "profiler" || name == "all")
+    {
+        BenchmarkProfiler();
+        ran = true;
+    }
+
+    if (!ran)
+    {
+        std::cerr << "Unknown benchmark: " << name << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Measures job throughput with 1 to N threads.
+ *
+ * Schedules waves of small jobs (a few hundred cycles each) from the main
+ * thread and waits on them by helping, which is the pattern the frame loop uses.
+ */
+void BenchmarkJobSystem()
+{
+    constexpr uint32_t JOBS_PER_WAVE = 2048;
+    constexpr uint32_t WAVES = 512;
+    constexpr uint32_t WORK_PER_JOB = 256;
+
+    const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    double singleThreadRate = 0.0;
+
+    std::printf("Job system: %u jobs x %u waves, %u iterations per job\n", JOBS_PER_WAVE, WAVES, WORK_PER_JOB);
+    std::printf("%8s %16s %10s %12s\n", "threads", "jobs/sec", "speedup", "efficiency");
+
+    // Powers of two, always ending at the full core count
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for (uint32_t threads : threadCounts)
+    {
+        JobSystem jobSystem(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t wave = 0; wave < WAVES; wave++)
+        {
+            JobCounter counter;
+            for (uint32_t i = 0; i < JOBS_PER_WAVE; i++)
+            {
+                uint32_t seed = wave * JOBS_PER_WAVE + i + 1;
+                jobSystem.Schedule([seed]()
+                {
+                    uint32_t state = seed;
+                    for (uint32_t n = 0; n < WORK_PER_JOB; n++)
+                    {
+                        state ^= state << 13;
+                        state ^= state >> 17;
+                        state ^= state << 5;
+                    }
+                    benchmarkSink.fetch_add(state & 1, std::memory_order_relaxed);
+                }, &counter);
+            }
+            jobSystem.Wait(counter);
+        }
+        double seconds = SecondsSince(start);
+
+        double rate = static_cast<double>(JOBS_PER_WAVE) * WAVES / seconds;
+        if (threads == 1)
+        {
+            singleThreadRate = rate;
+        }
+        double speedup = rate / singleThreadRate;
+        std::printf("%8u %16.0f %9.2fx %11.0f%%\n", threads, rate, speedup, 100.0 * speedup / threads);
+    }
+}
+
+/**
+ * @brief Measures query iteration cost over 1M entities with 2 to 4 components,
+ * plus the cost of structural changes made directly and through command buffers.
+ */
+void BenchmarkEcs()
+{
+    constexpr uint32_t ENTITY_COUNT = 1000000;
+    constexpr uint32_t ITERATIONS = 20;
+    constexpr float DT = 1.0f / 60.0f;
+
+    World world;
+    std::vector<Entity> entities;
+    entities.reserve(ENTITY_COUNT);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < ENTITY_COUNT; i++)
+    {
+        float f = static_cast<float>(i);
+        entities.push_back(world.CreateEntity(BenchPosition{ f, 0.0f, 0.0f }, BenchVelocity{ 1.0f, f, 0.0f },
+            BenchAcceleration{ 0.0f, -9.8f, 0.0f }, BenchMass{ 1.0f + f }));
+    }
+    double createSeconds = SecondsSince(start);
+
+    std::printf("ECS: %u entities, %zu byte chunks\n", ENTITY_COUNT, Archetype::CHUNK_SIZE);
+    std::printf("%-36s %10.2f ns/entity\n", "create (4 components)", createSeconds * 1e9 / ENTITY_COUNT);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t it = 0; it < ITERATIONS; it++)
+    {
+        world.Each<BenchPosition, const BenchVelocity>([](BenchPosition& p, const BenchVelocity& v)
+        {
+            p.x += v.x * DT;
+            p.y += v.y * DT;
+            p.z += v.z * DT;
+        });
+    }
+    std::printf("%-36s %10.2f ns/entity\n", "query 2 components", SecondsSince(start) * 1e9 / (double(ENTITY_COUNT) * ITERATIONS));
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t it = 0; it < ITERATIONS; it++)
+    {
+        world.Each<BenchPosition, BenchVelocity, const BenchAcceleration>([](BenchPosition& p, BenchVelocity& v, const BenchAcceleration& a)
+        {
+            v.x += a.x * DT;
+            v.y += a.y * DT;
+            v.z += a.z * DT;
+            p.x += v.x * DT;
+            p.y += v.y * DT;
+            p.z += v.z * DT;
+        });
+    }
+    std::printf("%-36s %10.2f ns/entity\n", "query 3 components", SecondsSince(start) * 1e9 / (double(ENTITY_COUNT) * ITERATIONS));
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t it = 0; it < ITERATIONS; it++)
+    {
+        world.Each<BenchPosition, BenchVelocity, const BenchAcceleration, const BenchMass>(
+            [](BenchPosition& p, BenchVelocity& v, const BenchAcceleration& a, const BenchMass& m)
+        {
+            float inverseMass = 1.0f / m.value;
+            v.x += a.x * inverseMass * DT;
+            v.y += a.y * inverseMass * DT;
+            v.z += a.z * inverseMass * DT;
+            p.x += v.x * DT;
+            p.y += v.y * DT;
+            p.z += v.z * DT;
+        });
+    }
+    std::printf("%-36s %10.2f ns/entity\n", "query 4 components", SecondsSince(start) * 1e9 / (double(ENTITY_COUNT) * ITERATIONS));
+
+    // Structural changes move entities between archetypes
+    constexpr uint32_t MOVE_COUNT = ENTITY_COUNT / 10;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < MOVE_COUNT; i++)
+    {
+        world.RemoveComponent<BenchMass>(entities[i]);
+    }
+    std::printf("%-36s %10.2f ns/entity\n", "remove component (archetype move)", SecondsSince(start) * 1e9 / MOVE_COUNT);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < MOVE_COUNT; i++)
+    {
+        world.DestroyEntity(entities[i]);
+    }
+    std::printf("%-36s %10.2f ns/entity\n", "destroy", SecondsSince(start) * 1e9 / MOVE_COUNT);
+
+    // The same kinds of changes recorded by parallel jobs and applied at a sync point,
+    // in frame sized batches. The first batch warms up arenas and playback scratch
+    constexpr uint32_t COMMAND_FRAMES = 50;
+    constexpr uint32_t COMMANDS_PER_FRAME = 2000;
+    JobSystem jobSystem;
+    EntityCommandQueue commands(jobSystem);
+    double recordSeconds = 0.0;
+    double playbackSeconds = 0.0;
+    for (uint32_t frame = 0; frame < COMMAND_FRAMES; frame++)
+    {
+        const uint32_t first = MOVE_COUNT + frame * COMMANDS_PER_FRAME;
+        JobCounter counter;
+        start = std::chrono::steady_clock::now();
+        auto record = [&commands, &entities, first](uint32_t begin, uint32_t end)
+        {
+            EntityCommandBuffer& buffer = commands.GetBuffer();
+            for (uint32_t i = begin; i < end; i++)
+            {
+                float f = static_cast<float>(i);
+                buffer.Spawn(BenchPosition{ f, 0.0f, 0.0f }, BenchVelocity{ 1.0f, f, 0.0f });
+                buffer.RemoveComponent<BenchMass>(entities[first + i]);
+            }
+        };
+        jobSystem.ParallelFor(COMMANDS_PER_FRAME, 256, record, &counter);
+        jobSystem.Wait(counter);
+        double recordTime = SecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        commands.Playback(world);
+        double playbackTime = SecondsSince(start);
+
+        if (frame > 0)
+        {
+            recordSeconds += recordTime;
+            playbackSeconds += playbackTime;
+        }
+    }
+    const double commandEntities = double(COMMAND_FRAMES - 1) * COMMANDS_PER_FRAME;
+    std::printf("%-36s %10.2f ns/entity\n", "record spawn + remove (parallel)", recordSeconds * 1e9 / commandEntities);
+    std::printf("%-36s %10.2f ns/entity\n", "playback spawn + remove", playbackSeconds * 1e9 / commandEntities);
+
+    float checksum = 0.0f;
+    world.Each<const BenchPosition>([&checksum](const BenchPosition& p) { checksum += p.x; });
+    benchmarkSink.fetch_add(static_cast<uint64_t>(checksum) & 1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Compares the frame and scratch allocators against malloc for typical
+ * per-frame patterns: many small short-lived objects, growing containers, and
+ * temporaries inside parallel jobs.
+ */
+void BenchmarkAllocators()
+{
+    constexpr uint32_t FRAMES = 200;
+    constexpr uint32_t SMALL_PER_FRAME = 10000;
+    constexpr uint32_t VECTORS_PER_FRAME = 256;
+    constexpr uint32_t VECTOR_LENGTH = 64;
+    constexpr uint32_t JOBS_PER_FRAME = 1024;
+    constexpr size_t JOB_SCRATCH_BYTES = 4096;
+
+    // Same pseudo random sizes for every allocator, 16 to 256 bytes
+    std::vector<uint32_t> sizes(SMALL_PER_FRAME);
+    uint32_t state = 12345;
+    for (uint32_t& size : sizes)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        size = 16 + state % 241;
+    }
+
+    FrameAllocator frameAllocator(4 * 1024 * 1024, 3);
+    std::vector<void*> pointers(SMALL_PER_FRAME);
+
+    std::printf("Allocators: %u frames\n", FRAMES);
+    std::printf("%-28s %12s %12s %9s\n", "pattern", "malloc ns", "arena ns", "speedup");
+
+    // Small objects that all die at the end of the frame
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        for (uint32_t i = 0; i < SMALL_PER_FRAME; i++)
+        {
+            pointers[i] = std::malloc(sizes[i]);
+            static_cast<unsigned char*>(pointers[i])[0] = static_cast<unsigned char>(i);
+        }
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < SMALL_PER_FRAME; i++)
+        {
+            sum += static_cast<unsigned char*>(pointers[i])[0];
+            std::free(pointers[i]);
+        }
+        benchmarkSink.fetch_add(sum, std::memory_order_relaxed);
+    }
+    double mallocSmall = SecondsSince(start) * 1e9 / (double(FRAMES) * SMALL_PER_FRAME);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        frameAllocator.BeginFrame();
+        for (uint32_t i = 0; i < SMALL_PER_FRAME; i++)
+        {
+            pointers[i] = frameAllocator.Allocate(sizes[i], 16);
+            static_cast<unsigned char*>(pointers[i])[0] = static_cast<unsigned char>(i);
+        }
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < SMALL_PER_FRAME; i++)
+        {
+            sum += static_cast<unsigned char*>(pointers[i])[0];
+        }
+        benchmarkSink.fetch_add(sum, std::memory_order_relaxed);
+    }
+    double arenaSmall = SecondsSince(start) * 1e9 / (double(FRAMES) * SMALL_PER_FRAME);
+    std::printf("%-28s %12.2f %12.2f %8.2fx\n", "small objects (16-256 B)", mallocSmall, arenaSmall, mallocSmall / arenaSmall);
+
+    // Containers built up during the frame, reallocating as they grow
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        for (uint32_t v = 0; v < VECTORS_PER_FRAME; v++)
+        {
+            std::vector<uint32_t> values;
+            for (uint32_t i = 0; i < VECTOR_LENGTH; i++)
+            {
+                values.push_back(i ^ v);
+            }
+            benchmarkSink.fetch_add(values.back() & 1, std::memory_order_relaxed);
+        }
+    }
+    double mallocVector = SecondsSince(start) * 1e9 / (double(FRAMES) * VECTORS_PER_FRAME);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        frameAllocator.BeginFrame();
+        for (uint32_t v = 0; v < VECTORS_PER_FRAME; v++)
+        {
+            std::pmr::vector<uint32_t> values(frameAllocator.GetResource());
+            for (uint32_t i = 0; i < VECTOR_LENGTH; i++)
+            {
+                values.push_back(i ^ v);
+            }
+            benchmarkSink.fetch_add(values.back() & 1, std::memory_order_relaxed);
+        }
+    }
+    double arenaVector = SecondsSince(start) * 1e9 / (double(FRAMES) * VECTORS_PER_FRAME);
+    std::printf("%-28s %12.2f %12.2f %8.2fx\n", "vector growth (per vector)", mallocVector, arenaVector, mallocVector / arenaVector);
+
+    // Temporaries inside jobs running on every thread, where malloc contends
+    JobSystem jobSystem;
+    auto mallocJob = [](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            auto* scratch = static_cast<unsigned char*>(std::malloc(JOB_SCRATCH_BYTES));
+            scratch[0] = static_cast<unsigned char>(i);
+            scratch[JOB_SCRATCH_BYTES - 1] = scratch[0];
+            benchmarkSink.fetch_add(scratch[JOB_SCRATCH_BYTES - 1] & 1, std::memory_order_relaxed);
+            std::free(scratch);
+        }
+    };
+    auto scratchJob = [](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            ScratchScope scope;
+            auto* scratch = scope.AllocateArray<unsigned char>(JOB_SCRATCH_BYTES);
+            scratch[0] = static_cast<unsigned char>(i);
+            scratch[JOB_SCRATCH_BYTES - 1] = scratch[0];
+            benchmarkSink.fetch_add(scratch[JOB_SCRATCH_BYTES - 1] & 1, std::memory_order_relaxed);
+        }
+    };
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        JobCounter counter;
+        jobSystem.ParallelFor(JOBS_PER_FRAME, 16, mallocJob, &counter);
+        jobSystem.Wait(counter);
+    }
+    double mallocJobs = SecondsSince(start) * 1e9 / (double(FRAMES) * JOBS_PER_FRAME);
+
+    start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < FRAMES; frame++)
+    {
+        JobCounter counter;
+        jobSystem.ParallelFor(JOBS_PER_FRAME, 16, scratchJob, &counter);
+        jobSystem.Wait(counter);
+    }
+    double arenaJobs = SecondsSince(start) * 1e9 / (double(FRAMES) * JOBS_PER_FRAME);
+    std::printf("%-28s %12.2f %12.2f %8.2fx\n", "job scratch (4 KB, parallel)", mallocJobs, arenaJobs, mallocJobs / arenaJobs);
+}
+
+/**
+ * @brief Measures how recording 50k draws scales with the number of threads the
+ * draws are split across, then the same objects merged into instanced draws.
+ * Needs a Vulkan device but no display, setup is headless and nothing is
+ * submitted, so only CPU batching and recording cost is measured.
+ */
+void BenchmarkCommandRecording()
+{
+    constexpr uint32_t DRAWS = 50000;
+    constexpr uint32_t FRAMES = 100;
+
+    const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    RenderData data;
+    data.settings.headless = true;
+    // Only sizes the render pools during setup, the measured runs bring their own
+    JobSystem setupJobs(1);
+    data.jobSystem = &setupJobs;
+
+    try
+    {
+        VulkanSetup(data);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Command recording benchmark skipped: " << e.what() << std::endl;
+        return;
+    }
+
+    std::printf("Command recording: %u draws x %u frames\n", DRAWS, FRAMES);
+    std::printf("%8s %12s %14s %10s %12s\n", "threads", "ms/frame", "ns/draw", "speedup", "efficiency");
+
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double singleThreadSeconds = 0.0;
+    for (uint32_t threads : threadCounts)
+    {
+        JobSystem jobSystem(threads);
+        double seconds = VulkanBenchmarkRecording(data, jobSystem, DRAWS, FRAMES, false);
+        if (threads == 1)
+        {
+            singleThreadSeconds = seconds;
+        }
+        double speedup = singleThreadSeconds / seconds;
+        std::printf("%8u %12.3f %14.2f %9.2fx %11.0f%%\n", threads, seconds * 1e3, seconds * 1e9 / DRAWS, speedup, 100.0 * speedup / threads);
+    }
+
+    // Same objects, identical mesh and material pairs merged into one draw each
+    {
+        JobSystem jobSystem(1);
+        double seconds = VulkanBenchmarkRecording(data, jobSystem, DRAWS, FRAMES, true);
+        std::printf("instanced: %u objects in %u draws, %.3f ms/frame, %.2fx vs 1 thread\n", DRAWS, data.batcher.GetStats().draws,
+            seconds * 1e3, singleThreadSeconds / seconds);
+    }
+
+    VulkanCleanup(data);
+}
+
+/**
+ * @brief Measures the CPU cost of a GPU-driven frame for 100 to 100k instances:
+ * writing the instance buffer, and recording the culling dispatch plus the one
+ * indirect draw. Recording should stay flat, only the instance upload grows.
+ */
+void BenchmarkGpuDriven()
+{
+    constexpr uint32_t FRAMES = 100;
+    constexpr uint32_t INSTANCE_COUNTS[] = { 100, 1000, 10000, 100000 };
+
+    RenderData data;
+    data.settings.headless = true;
+    data.settings.gpuDriven = true;
+    JobSystem setupJobs(1);
+    data.jobSystem = &setupJobs;
+
+    try
+    {
+        VulkanSetup(data);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "GPU-driven benchmark skipped: " << e.what() << std::endl;
+        return;
+    }
+
+    // Setup falls back to CPU draws when the device lacks the indirect features
+    if (data.settings.gpuDriven)
+    {
+        std::printf("GPU-driven frame: %u frames\n", FRAMES);
+        std::printf("%10s %16s %16s\n", "instances", "instances us", "record us");
+        for (uint32_t instances : INSTANCE_COUNTS)
+        {
+            GpuDrivenTimings timings = VulkanBenchmarkGpuDriven(data, instances, FRAMES);
+            std::printf("%10u %16.2f %16.2f\n", instances, timings.instanceSeconds * 1e6, timings.recordSeconds * 1e6);
+        }
+    }
+    else
+    {
+        std::cerr << "GPU-driven benchmark skipped: device lacks indirect count features" << std::endl;
+    }
+
+    VulkanCleanup(data);
+}
+
+/**
+ * @brief Measures the cost of one CPU profiler zone: disabled, enabled on one
+ * thread, and enabled on several threads at once, which should cost the same
+ * since every thread writes its own buffer. Enabled zones should stay under 50 ns.
+ */
+void BenchmarkProfiler()
+{
+    constexpr uint32_t DISABLED_ZONES = 1000000;
+    constexpr uint32_t ENABLED_ZONES = 500000;
+    constexpr uint32_t ZONES_PER_THREAD = 200000;
+
+    auto recordZones = [](uint32_t count)
+    {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            PROFILE_ZONE("BenchmarkZone");
+            sum += i;
+        }
+        benchmarkSink.fetch_add(sum, std::memory_order_relaxed);
+    };
+
+    std::printf("CPU profiler zones\n");
+    std::printf("%-28s %12s\n", "case", "ns per zone");
+
+    CpuProfiler::SetEnabled(false);
+    auto start = std::chrono::steady_clock::now();
+    recordZones(DISABLED_ZONES);
+    std::printf("%-28s %12.2f\n", "disabled", SecondsSince(start) * 1e9 / DISABLED_ZONES);
+
+    CpuProfiler::SetEnabled(true);
+    start = std::chrono::steady_clock::now();
+    recordZones(ENABLED_ZONES);
+    std::printf("%-28s %12.2f\n", "enabled, 1 thread", SecondsSince(start) * 1e9 / ENABLED_ZONES);
+
+    // Time each thread on its own so thread startup isn't counted
+    const uint32_t threadCount = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+    std::vector<double> threadSeconds(threadCount);
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount);
+    for (uint32_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            auto threadStart = std::chrono::steady_clock::now();
+            recordZones(ZONES_PER_THREAD);
+            threadSeconds[t] = SecondsSince(threadStart);
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    CpuProfiler::SetEnabled(false);
+
+    double worst = *std::max_element(threadSeconds.begin(), threadSeconds.end());
+    char label[64];
+    std::snprintf(label, sizeof(label), "enabled, %u threads (worst)", threadCount);
+    std::printf("%-28s %12.2f\n", label, worst * 1e9 / ZONES_PER_THREAD);
+}
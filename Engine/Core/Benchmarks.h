@@ -0,0 +1,29 @@
+/*****************************************************************//**
+ * \file   Benchmarks.h
+ * \brief  Engine microbenchmarks, run with `FridayEngine --bench <name>`
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <string>
+
+/**
+ * @brief Runs the named benchmark and prints its results to stdout.
+ *
+ * @param name Benchmark name, "all" runs every benchmark.
+ * @return int Process exit code.
+ */
+int RunBenchmark(const std::string& name);
+
+void BenchmarkJobSystem();
+
+void BenchmarkEcs();
+
+void BenchmarkAllocators();
+
+void BenchmarkCommandRecording();
+
+void BenchmarkGpuDriven();
+
+void BenchmarkProfiler();
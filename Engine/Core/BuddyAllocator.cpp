@@ -0,0 +1,139 @@
+/*****************************************************************//**
+ * \file   BuddyAllocator.cpp
+ * \brief  Power of two range allocator for sub-allocating large memory blocks
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "BuddyAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+/**
+ * @brief BuddyAllocator Constructor.
+ *
+ * @param size Range to manage, a power of two.
+ * @param minSize Smallest range handed out, a power of two no larger than size.
+ */
+BuddyAllocator::BuddyAllocator(uint64_t size, uint64_t minSize)
+    : size(size),
+    minSize(minSize),
+    minShift(static_cast<uint32_t>(std::countr_zero(minSize))),
+    levelCount(0),
+    used(0),
+    allocationCount(0)
+{
+    if (!std::has_single_bit(size) || !std::has_single_bit(minSize) || minSize > size)
+    {
+        throw std::runtime_error("Buddy allocator sizes must be powers of two!");
+    }
+    levelCount = static_cast<uint32_t>(std::countr_zero(size >> minShift)) + 1;
+
+    // Node 1 is the root, the children of node n are 2n and 2n + 1
+    freeOrder.resize(size_t(2) << (levelCount - 1));
+    for (uint32_t level = 0; level < levelCount; level++)
+    {
+        std::fill(freeOrder.begin() + (size_t(1) << level), freeOrder.begin() + (size_t(2) << level), FullOrder(level));
+    }
+}
+
+/**
+ * @brief Reserves a range, preferring the tightest free subtree so large ranges
+ * stay available.
+ *
+ * @param request Bytes needed.
+ * @param alignment Power of two alignment of the returned offset.
+ * @return uint64_t Offset of the range, or INVALID_OFFSET if nothing fits.
+ */
+uint64_t BuddyAllocator::Allocate(uint64_t request, uint64_t alignment)
+{
+    uint64_t rounded = std::bit_ceil(std::max({ request, alignment, minSize }));
+    if (rounded > size)
+    {
+        return INVALID_OFFSET;
+    }
+    uint8_t order = static_cast<uint8_t>(std::countr_zero(rounded >> minShift) + 1);
+    if (freeOrder[1] < order)
+    {
+        return INVALID_OFFSET;
+    }
+
+    uint32_t targetLevel = levelCount - order;
+    size_t node = 1;
+    for (uint32_t level = 0; level < targetLevel; level++)
+    {
+        size_t left = node * 2;
+        uint8_t leftOrder = freeOrder[left];
+        uint8_t rightOrder = freeOrder[left + 1];
+        if (leftOrder >= order && (rightOrder < order || leftOrder <= rightOrder))
+        {
+            node = left;
+        }
+        else
+        {
+            node = left + 1;
+        }
+    }
+    freeOrder[node] = 0;
+    uint64_t offset = (node - (size_t(1) << targetLevel)) * rounded;
+
+    for (uint32_t level = targetLevel; level > 0; level--)
+    {
+        node /= 2;
+        freeOrder[node] = std::max(freeOrder[node * 2], freeOrder[node * 2 + 1]);
+    }
+
+    used += rounded;
+    allocationCount++;
+    return offset;
+}
+
+/**
+ * @brief Releases a range and merges it with its buddy as far up as possible.
+ *
+ * @param offset Offset returned by Allocate.
+ * @return uint64_t Size of the range that was released.
+ */
+uint64_t BuddyAllocator::Free(uint64_t offset)
+{
+    if (offset >= size)
+    {
+        throw std::runtime_error("Freeing an offset outside of the buddy allocator!");
+    }
+
+    // The allocated node is the first one on the way up that is marked full,
+    // nodes below an allocation keep their free state
+    uint32_t level = levelCount - 1;
+    size_t node = (size_t(1) << level) + (offset >> minShift);
+    while (freeOrder[node] != 0)
+    {
+        if (node == 1)
+        {
+            throw std::runtime_error("Freeing an offset that was never allocated!");
+        }
+        node /= 2;
+        level--;
+    }
+
+    uint64_t released = size >> level;
+    freeOrder[node] = FullOrder(level);
+    while (node > 1)
+    {
+        node /= 2;
+        level--;
+        uint8_t left = freeOrder[node * 2];
+        uint8_t right = freeOrder[node * 2 + 1];
+        uint8_t childFull = FullOrder(level + 1);
+        freeOrder[node] = (left == childFull && right == childFull) ? FullOrder(level) : std::max(left, right);
+    }
+
+    used -= released;
+    allocationCount--;
+    return released;
+}
+
+uint64_t BuddyAllocator::GetLargestFree() const
+{
+    return freeOrder[1] ? minSize << (freeOrder[1] - 1) : 0;
+}
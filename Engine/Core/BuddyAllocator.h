@@ -0,0 +1,73 @@
+/*****************************************************************//**
+ * \file   BuddyAllocator.h
+ * \brief  Power of two range allocator for sub-allocating large memory blocks
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Hands out offsets inside a range of size bytes. Requests are rounded up
+ * to a power of two and placed at a multiple of that size, so any power of two
+ * alignment up to the rounded size comes for free. Freed ranges merge with their
+ * buddy right away, there is never free space that can't be reused.
+ *
+ * The allocator only does the bookkeeping, it never touches the memory itself,
+ * which makes it usable for GPU memory the CPU can't see.
+ */
+class BuddyAllocator
+{
+public:
+    static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+    /**
+     * @param size Range to manage, a power of two.
+     * @param minSize Smallest range handed out, a power of two no larger than size.
+     */
+    BuddyAllocator(uint64_t size, uint64_t minSize);
+
+    /**
+     * @brief Reserves a range.
+     *
+     * @param size Bytes needed.
+     * @param alignment Power of two alignment of the returned offset.
+     * @return uint64_t Offset of the range, or INVALID_OFFSET if nothing fits.
+     */
+    uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+    /**
+     * @brief Releases a range returned by Allocate.
+     *
+     * @param offset The range's offset.
+     * @return uint64_t Size of the range that was released.
+     */
+    uint64_t Free(uint64_t offset);
+
+    uint64_t GetSize() const { return size; }
+
+    //bytes in use, including the rounding up to powers of two
+    uint64_t GetUsed() const { return used; }
+
+    //largest single allocation that would still succeed
+    uint64_t GetLargestFree() const;
+
+    uint32_t GetAllocationCount() const { return allocationCount; }
+
+    bool IsEmpty() const { return allocationCount == 0; }
+
+private:
+    //order of a node is log2 of its size in units of minSize, stored +1 so 0 means full
+    uint8_t FullOrder(uint32_t level) const { return static_cast<uint8_t>(levelCount - level); }
+
+    uint64_t size;
+    uint64_t minSize;
+    uint32_t minShift;
+    uint32_t levelCount;
+    //implicit binary tree, largest free order in each node's subtree
+    std::vector<uint8_t> freeOrder;
+    uint64_t used;
+    uint32_t allocationCount;
+};
@@ -6,40 +6,208 @@
  * @date   April 2024
  *********************************************************************/
 #include "Engine.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
 
 /**
  * @brief Engine Constructor.
  * 
+ * @param renderSettings Renderer options, e.g. from the command line.
  */
-Engine::Engine()
+Engine::Engine(const RenderSettings& renderSettings)
     : prevTime(std::chrono::steady_clock::now()),
+    fixedDeltaTime(1.0 / 60.0),
+    accumulator(0.0),
+    jobSystem(std::make_unique<JobSystem>()),
+    commands(*jobSystem),
+    frameAllocator(FRAME_ARENA_SIZE, FRAME_ARENA_COUNT),
+    tickScheduler("Tick"),
+    frameScheduler("Frame"),
+    framePacket(nullptr),
     renderInstance(nullptr)
 {
-    renderInstance = std::make_unique<RenderSystem>();
-    window = &renderInstance.get()->GetWindow();
+    renderInstance = std::make_unique<RenderSystem>(*jobSystem, renderSettings);
+    window = renderInstance->GetWindow();
+    RegisterFrameSystems();
+
+    // Placeholder scene until there is content: the quad at the origin
+    world.CreateEntity(Transform{}, Renderable{});
 }
 
 /**
  * @brief Engine's main run loop.
  * 
+ * Each frame runs the frame scheduler: simulation advances in fixed ticks fed by an
+ * accumulator, rendering gets the last two ticks and interpolates between them.
  */
 void Engine::Run()
 {
-    while (!glfwWindowShouldClose(window))
+    for (uint64_t frame = 0; frameLimit == 0 || frame < frameLimit; frame++)
     {
-        glfwPollEvents();
+        if (window && glfwWindowShouldClose(window))
+        {
+            break;
+        }
+        PROFILE_FRAME(frame);
+        PROFILE_ZONE("Frame");
+
         auto currentTime = std::chrono::steady_clock::now();
-        std::chrono::duration<float> deltaTime = currentTime - prevTime;
-        float dt = deltaTime.count();
-        renderInstance->render();
+        std::chrono::duration<double> deltaTime = currentTime - prevTime;
         prevTime = currentTime;
+        frameAllocator.BeginFrame();
+        frameScheduler.Run(*jobSystem, static_cast<float>(deltaTime.count()));
+    }
+}
+
+/**
+ * @brief Declares the per-frame sequence as systems. Event polling and the
+ * simulation touch disjoint data and overlap, the frame packet waits for both.
+ * SubmitFrame blocks until the render thread takes the previous packet, so it
+ * stays on the main thread, where render errors are rethrown too.
+ *
+ */
+void Engine::RegisterFrameSystems()
+{
+    frameScheduler.AddSystem<Write<GLFWwindow, RenderSystem, FramePacket>>("PollEvents",
+        [this](float) { PollEvents(); }, SystemFlags::MainThread);
+    frameScheduler.AddSystem<Write<World>>("Simulate",
+        [this](float frameTime) { Simulate(frameTime); });
+    frameScheduler.AddSystem<Read<World>, Write<FramePacket>>("BuildFramePacket",
+        [this](float) { BuildFramePacket(); });
+    frameScheduler.AddSystem<Write<RenderSystem, FramePacket>>("SubmitFrame",
+        [this](float) { renderInstance->SubmitFrame(); framePacket = nullptr; }, SystemFlags::MainThread);
+}
+
+/**
+ * @brief Pumps window events and claims this frame's packet. GLFW requires the main thread.
+ * The frame rate cap, and in low latency mode the wait for a free frame slot, happen
+ * first, so input is sampled as late as possible.
+ *
+ */
+void Engine::PollEvents()
+{
+    renderInstance->PaceFrame();
+    if (window)
+    {
+        glfwPollEvents();
+    }
+    framePacket = &renderInstance->BeginFrame();
+}
+
+/**
+ * @brief Runs as many fixed ticks as the accumulated real time allows.
+ *
+ * @param frameTime Real time since the last frame in seconds.
+ */
+void Engine::Simulate(float frameTime)
+{
+    accumulator += std::min(static_cast<double>(frameTime), MAX_FRAME_TIME);
+
+    uint32_t ticks = 0;
+    while (accumulator >= fixedDeltaTime && ticks < MAX_TICKS_PER_FRAME)
+    {
+        PROFILE_ZONE("Tick");
+        previousTransforms.swap(currentTransforms);
+        previousEntities.swap(currentEntities);
+        tickScheduler.Run(*jobSystem, static_cast<float>(fixedDeltaTime));
+        commands.Playback(world);
+        GatherTransforms();
+        accumulator -= fixedDeltaTime;
+        ticks++;
+    }
+
+    // Still behind after the tick budget, drop the backlog instead of compounding it
+    if (accumulator >= fixedDeltaTime)
+    {
+        accumulator = std::fmod(accumulator, fixedDeltaTime);
+    }
+}
+
+/**
+ * @brief Hands the last two ticks to the render thread, it blends them by alpha.
+ * Destroyed entities and archetype moves reorder rows between ticks, so each
+ * current transform is paired with the previous one of the same entity.
+ *
+ */
+void Engine::BuildFramePacket()
+{
+    for (uint32_t row = 0; row < previousEntities.size(); row++)
+    {
+        uint32_t index = previousEntities[row].index;
+        if (index >= previousRows.size())
+        {
+            previousRows.resize(index + 1, UINT32_MAX);
+        }
+        previousRows[index] = row;
+    }
+
+    framePacket->previousTransforms.resize(currentTransforms.size());
+    for (size_t i = 0; i < currentEntities.size(); i++)
+    {
+        const Entity& entity = currentEntities[i];
+        uint32_t row = entity.index < previousRows.size() ? previousRows[entity.index] : UINT32_MAX;
+        // Spawned this tick, or a new entity in a reused slot: nothing to blend from
+        bool matched = row != UINT32_MAX && previousEntities[row] == entity;
+        framePacket->previousTransforms[i] = matched ? previousTransforms[row] : currentTransforms[i];
+    }
+
+    for (const Entity& entity : previousEntities)
+    {
+        previousRows[entity.index] = UINT32_MAX;
+    }
+
+    framePacket->currentTransforms.assign(currentTransforms.begin(), currentTransforms.end());
+    framePacket->renderables.assign(renderables.begin(), renderables.end());
+    framePacket->interpolationAlpha = static_cast<float>(accumulator / fixedDeltaTime);
+}
+
+/**
+ * @brief Snapshots the Transform and Renderable of every drawn entity after a tick.
+ *
+ */
+void Engine::GatherTransforms()
+{
+    currentTransforms.clear();
+    currentTransforms.reserve(previousTransforms.size());
+    currentEntities.clear();
+    currentEntities.reserve(previousTransforms.size());
+    renderables.clear();
+    renderables.reserve(previousTransforms.size());
+    world.EachChunk<const Transform, const Renderable>([this](uint32_t count, const Entity* entities, const Transform* transforms, const Renderable* chunkRenderables)
+    {
+        currentTransforms.insert(currentTransforms.end(), transforms, transforms + count);
+        currentEntities.insert(currentEntities.end(), entities, entities + count);
+        renderables.insert(renderables.end(), chunkRenderables, chunkRenderables + count);
+    });
+}
+
+/**
+ * @brief Sets the simulation tick rate.
+ *
+ * @param ticksPerSecond Fixed ticks per second, must be positive.
+ */
+void Engine::SetTickRate(double ticksPerSecond)
+{
+    if (ticksPerSecond <= 0.0)
+    {
+        throw std::runtime_error("Tick rate must be positive!");
     }
+    fixedDeltaTime = 1.0 / ticksPerSecond;
 }
+
 /**
  * @brief Engine Destructor.
  * 
  */
 Engine::~Engine()
 {
-    
+    frameScheduler.PrintReport(std::cout);
+    tickScheduler.PrintReport(std::cout);
+
+    FrameAllocatorStats frameMemory = frameAllocator.GetStats();
+    std::cout << "Frame allocator: peak " << frameMemory.peak / 1024 << " KB of " << frameMemory.capacity / 1024
+        << " KB per frame" << std::endl;
 }
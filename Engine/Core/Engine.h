@@ -8,27 +8,127 @@
 #pragma once
 #include <chrono> //deltatime 
 #include <memory> //unique ptr
+#include <vector>
+#include "EntityCommandBuffer.h"
+#include "FrameAllocator.h"
+#include "JobSystem.h"
 #include "RenderSystem.h"
-
+#include "Renderable.h"
+#include "SystemScheduler.h"
+#include "Transform.h"
+#include "World.h"
 
 class Engine
 {
 public:
 
-    Engine();
+    /**
+     * @param renderSettings Renderer options, e.g. from the command line.
+     */
+    explicit Engine(const RenderSettings& renderSettings = {});
 
 
+    /**
+     * @brief Runs frames until the window closes or the frame limit is reached.
+     */
     void Run();
 
+    /**
+     * @brief Stops Run after this many frames, 0 for no limit. The only way out of
+     * Run when rendering headless.
+     */
+    void SetFrameLimit(uint64_t frames) { frameLimit = frames; }
+
+    /**
+     * @brief Registers a per-tick system (physics, ai, animation, render prep) that
+     * receives the fixed dt. Access lists what it touches, e.g.
+     * AddSystem<Read<Velocity>, Write<Transform>>("Integrate", ...). Systems that
+     * don't conflict run in parallel, conflicting ones run in registration order.
+     */
+    template <typename... Access>
+    void AddSystem(const std::string& name, SystemFunction function, SystemFlags flags = SystemFlags::None)
+    {
+        tickScheduler.AddSystem<Access...>(name, std::move(function), flags);
+    }
+
+    /**
+     * @brief Sets how many fixed simulation ticks run per second.
+     */
+    void SetTickRate(double ticksPerSecond);
+
+    double GetTickRate() const { return 1.0 / fixedDeltaTime; }
+
+    JobSystem& GetJobSystem() { return *jobSystem; }
+
+    //entities and components, entities with a Transform are rendered
+    World& GetWorld() { return world; }
+
+    /**
+     * @brief Command buffer of the calling job thread. Systems record spawns, destroys
+     * and component adds/removes here instead of changing the World while other
+     * systems iterate it; they are applied after every tick.
+     */
+    EntityCommandBuffer& GetCommandBuffer() { return commands.GetBuffer(); }
+
+    /**
+     * @brief Transient memory for per-frame data, any thread may allocate. Valid
+     * until the render thread is done with the frame, FRAME_ARENA_COUNT frames.
+     */
+    FrameAllocator& GetFrameAllocator() { return frameAllocator; }
 
     ~Engine();
 
 private:
+    void RegisterFrameSystems();
+    void PollEvents();
+    void Simulate(float frameTime);
+    void GatherTransforms();
+    void BuildFramePacket();
+
+    //frames longer than this are clamped so a stall doesn't snowball into more ticks
+    static constexpr double MAX_FRAME_TIME = 0.25;
+    //upper bound on simulation work per rendered frame
+    static constexpr uint32_t MAX_TICKS_PER_FRAME = 8;
+    //frame allocator budget, overflow goes to the heap and shows up in the stats
+    static constexpr size_t FRAME_ARENA_SIZE = 4 * 1024 * 1024;
+    //frame being built, frame published, frame being recorded (see TripleBuffer)
+    static constexpr uint32_t FRAME_ARENA_COUNT = 3;
+
     //for deltatime calcs
     std::chrono::steady_clock::time_point prevTime;
+    //fixed simulation step in seconds
+    double fixedDeltaTime;
+    //real time not yet consumed by simulation ticks
+    double accumulator;
+    //simulation state
+    World world;
+    //transforms of the last two ticks of every Renderable entity, the renderer interpolates between them.
+    //Rows move between ticks, so the entities are kept to match them up
+    std::vector<Transform> previousTransforms;
+    std::vector<Transform> currentTransforms;
+    std::vector<Entity> previousEntities;
+    std::vector<Entity> currentEntities;
+    //by entity index, the entity's row in previousTransforms while matching, else UINT32_MAX
+    std::vector<uint32_t> previousRows;
+    //mesh and material of each current transform
+    std::vector<Renderable> renderables;
+    //workers for everything that can run off the main thread
+    std::unique_ptr<JobSystem> jobSystem;
+    //structural changes recorded by systems during a tick
+    EntityCommandQueue commands;
+    //per-frame transient memory
+    FrameAllocator frameAllocator;
+    //user systems, run once per fixed tick
+    SystemScheduler tickScheduler;
+    //engine systems, run once per rendered frame
+    SystemScheduler frameScheduler;
+    //packet being filled this frame, valid between PollEvents and SubmitFrame
+    FramePacket* framePacket;
     //rendering system
     std::unique_ptr<RenderSystem> renderInstance;
-    //FOR GLFW SHOULD WINDOW CLOSE AAAA
+    //FOR GLFW SHOULD WINDOW CLOSE AAAA, nullptr when headless
     GLFWwindow* window;
+    //frames Run stops after, 0 for no limit
+    uint64_t frameLimit = 0;
 };
 
@@ -0,0 +1,111 @@
+/*****************************************************************//**
+ * \file   Entity.h
+ * \brief  Generational entity handle and component type registry
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Handle to an entity. The generation changes every time an index is
+ * reused, so stale handles to destroyed entities are detected instead of
+ * silently pointing at whoever got the slot next.
+ */
+struct Entity
+{
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != INVALID_INDEX; }
+
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+//one bit per component type, archetypes are identified by their mask
+constexpr uint32_t MAX_COMPONENT_TYPES = 64;
+typedef uint64_t ComponentMask;
+typedef uint32_t ComponentTypeId;
+
+/**
+ * @brief Type-erased operations the archetype storage needs for a component.
+ */
+struct ComponentInfo
+{
+    size_t size;
+    size_t alignment;
+    //moves src into uninitialized dst, src stays constructed
+    void (*moveConstruct)(void* dst, void* src);
+    //nullptr for trivially destructible types
+    void (*destroy)(void* component);
+    const char* name;
+};
+
+class ComponentRegistry
+{
+public:
+    /**
+     * @brief Id of component type T, assigned on first use.
+     */
+    template <typename T>
+    static ComponentTypeId GetId()
+    {
+        static_assert(!std::is_const_v<T> && !std::is_reference_v<T>, "Use the plain component type");
+        static const ComponentTypeId id = Register(MakeInfo<T>());
+        return id;
+    }
+
+    template <typename T>
+    static ComponentMask GetBit()
+    {
+        return ComponentMask(1) << GetId<T>();
+    }
+
+    static const ComponentInfo& GetInfo(ComponentTypeId id);
+
+    static uint32_t GetTypeCount();
+
+private:
+    template <typename T>
+    static ComponentInfo MakeInfo()
+    {
+        ComponentInfo info{};
+        info.size = sizeof(T);
+        info.alignment = alignof(T);
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            info.moveConstruct = [](void* dst, void* src) { std::memcpy(dst, src, sizeof(T)); };
+        }
+        else
+        {
+            info.moveConstruct = [](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); };
+        }
+        if constexpr (!std::is_trivially_destructible_v<T>)
+        {
+            info.destroy = [](void* component) { static_cast<T*>(component)->~T(); };
+        }
+        info.name = TypeName<T>();
+        return info;
+    }
+
+    template <typename T>
+    static const char* TypeName()
+    {
+#if defined(_MSC_VER)
+        return __FUNCSIG__;
+#else
+        return __PRETTY_FUNCTION__;
+#endif
+    }
+
+    static ComponentTypeId Register(const ComponentInfo& info);
+};
@@ -0,0 +1,102 @@
+/*****************************************************************//**
+ * \file   EntityCommandBuffer.cpp
+ * \brief  Deferred structural changes recorded by jobs and applied at sync points
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "EntityCommandBuffer.h"
+#include <stdexcept>
+#include "JobSystem.h"
+#include "World.h"
+
+/**
+ * @brief EntityCommandBuffer Constructor.
+ *
+ */
+EntityCommandBuffer::EntityCommandBuffer()
+    : spawnCount(0)
+{
+}
+
+/**
+ * @brief EntityCommandBuffer Destructor.
+ *
+ */
+EntityCommandBuffer::~EntityCommandBuffer()
+{
+    Clear();
+}
+
+/**
+ * @brief Drops every command and rewinds the arena.
+ *
+ */
+void EntityCommandBuffer::Clear()
+{
+    for (EntityCommand& command : commands)
+    {
+        if (command.payload)
+        {
+            const ComponentInfo& info = ComponentRegistry::GetInfo(command.component);
+            if (info.destroy)
+            {
+                info.destroy(command.payload);
+            }
+            command.payload = nullptr;
+        }
+    }
+    commands.clear();
+    spawnCount = 0;
+    arena.Reset();
+}
+
+/**
+ * @brief EntityCommandQueue Constructor.
+ *
+ * @param jobSystem Decides how many threads may record.
+ */
+EntityCommandQueue::EntityCommandQueue(const JobSystem& jobSystem)
+{
+    for (uint32_t i = 0; i < jobSystem.GetMaxThreads(); i++)
+    {
+        buffers.push_back(std::make_unique<EntityCommandBuffer>());
+    }
+}
+
+EntityCommandBuffer& EntityCommandQueue::GetBuffer()
+{
+    int thread = JobSystem::GetThreadIndex();
+    if (thread < 0 || static_cast<size_t>(thread) >= buffers.size())
+    {
+        throw std::runtime_error("Recording entity commands from a thread outside the job system!");
+    }
+    return *buffers[thread];
+}
+
+/**
+ * @brief Applies and clears every buffer.
+ *
+ * @param world The world the commands were recorded for.
+ */
+void EntityCommandQueue::Playback(World& world)
+{
+    pendingBuffers.clear();
+    for (auto& buffer : buffers)
+    {
+        if (!buffer->IsEmpty())
+        {
+            pendingBuffers.push_back(buffer.get());
+        }
+    }
+    if (pendingBuffers.empty())
+    {
+        return;
+    }
+
+    world.ApplyCommands(pendingBuffers.data(), pendingBuffers.size());
+    for (EntityCommandBuffer* buffer : pendingBuffers)
+    {
+        buffer->Clear();
+    }
+}
@@ -0,0 +1,148 @@
+/*****************************************************************//**
+ * \file   EntityCommandBuffer.h
+ * \brief  Deferred structural changes recorded by jobs and applied at sync points
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Entity.h"
+#include "LinearArena.h"
+
+class JobSystem;
+class World;
+
+enum class EntityCommandType : uint8_t
+{
+    Spawn,
+    Destroy,
+    AddComponent,
+    RemoveComponent,
+};
+
+/**
+ * @brief One recorded change. Component values live in the buffer's arena.
+ */
+struct EntityCommand
+{
+    EntityCommandType type;
+    ComponentTypeId component;
+    Entity entity;
+    //moved-in component value for AddComponent, nullptr once consumed
+    void* payload;
+};
+
+/**
+ * @brief Records spawns, destroys and component adds/removes without touching the
+ * World, so jobs can make structural changes while others iterate. One buffer
+ * must only be used by one thread at a time, EntityCommandQueue hands out one
+ * per job system thread.
+ */
+class EntityCommandBuffer
+{
+public:
+    //marks handles returned by Spawn until playback assigns a real entity
+    static constexpr uint32_t PENDING_GENERATION = UINT32_MAX;
+
+    EntityCommandBuffer();
+    ~EntityCommandBuffer();
+
+    EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+    EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+    /**
+     * @brief Records a new entity with the given components.
+     *
+     * @return Entity Placeholder that is only valid for further commands in this buffer.
+     */
+    template <typename... Ts>
+    Entity Spawn(Ts&&... components)
+    {
+        Entity entity{ spawnCount++, PENDING_GENERATION };
+        Record(EntityCommandType::Spawn, entity, 0, nullptr);
+        (AddComponent(entity, std::forward<Ts>(components)), ...);
+        return entity;
+    }
+
+    /**
+     * @brief Records an entity destruction. Stale handles are ignored at playback.
+     */
+    void Destroy(Entity entity)
+    {
+        Record(EntityCommandType::Destroy, entity, 0, nullptr);
+    }
+
+    /**
+     * @brief Records adding or replacing a component. The value is moved into the buffer.
+     */
+    template <typename T>
+    void AddComponent(Entity entity, T&& component)
+    {
+        using Component = std::decay_t<T>;
+        void* memory = arena.Allocate(sizeof(Component), alignof(Component));
+        new (memory) Component(std::forward<T>(component));
+        Record(EntityCommandType::AddComponent, entity, ComponentRegistry::GetId<Component>(), memory);
+    }
+
+    template <typename T>
+    void RemoveComponent(Entity entity)
+    {
+        Record(EntityCommandType::RemoveComponent, entity, ComponentRegistry::GetId<T>(), nullptr);
+    }
+
+    bool IsEmpty() const { return commands.empty(); }
+
+    size_t GetCommandCount() const { return commands.size(); }
+
+    //placeholders handed out by Spawn since the last Clear
+    uint32_t GetSpawnCount() const { return spawnCount; }
+
+    std::vector<EntityCommand>& GetCommands() { return commands; }
+
+    /**
+     * @brief Drops every command, destroying component values that were never
+     * applied. Arena blocks and command storage are kept for reuse.
+     */
+    void Clear();
+
+private:
+    void Record(EntityCommandType type, Entity entity, ComponentTypeId component, void* payload)
+    {
+        commands.push_back(EntityCommand{ type, component, entity, payload });
+    }
+
+    std::vector<EntityCommand> commands;
+    uint32_t spawnCount;
+    //component values
+    LinearArena arena;
+};
+
+/**
+ * @brief One command buffer per job system thread, so any job can record without
+ * locking. Playback applies all of them at once.
+ */
+class EntityCommandQueue
+{
+public:
+    explicit EntityCommandQueue(const JobSystem& jobSystem);
+
+    /**
+     * @brief The calling thread's buffer. The thread must belong to the job system.
+     */
+    EntityCommandBuffer& GetBuffer();
+
+    /**
+     * @brief Applies and clears every buffer. Must run at a sync point where no
+     * job is recording or iterating the world.
+     */
+    void Playback(World& world);
+
+private:
+    std::vector<std::unique_ptr<EntityCommandBuffer>> buffers;
+    //non-empty buffers of the current playback
+    std::vector<EntityCommandBuffer*> pendingBuffers;
+};
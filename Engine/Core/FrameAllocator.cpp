@@ -0,0 +1,136 @@
+/*****************************************************************//**
+ * \file   FrameAllocator.cpp
+ * \brief  Frame scoped bump allocator shared by all threads
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "FrameAllocator.h"
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+/**
+ * @brief FrameAllocator Constructor.
+ *
+ * @param bytesPerFrame Arena size of one frame.
+ * @param frameCount How many frames an allocation stays valid.
+ */
+FrameAllocator::FrameAllocator(size_t bytesPerFrame, uint32_t frameCount)
+    : capacity(bytesPerFrame),
+    current(0),
+    peak(0),
+    resource(*this)
+{
+    if (frameCount == 0)
+    {
+        throw std::runtime_error("Frame allocator needs at least one frame!");
+    }
+    for (uint32_t i = 0; i < frameCount; i++)
+    {
+        auto arena = std::make_unique<FrameArena>();
+        arena->memory = static_cast<std::byte*>(::operator new(capacity, std::align_val_t(ARENA_ALIGNMENT)));
+        frames.push_back(std::move(arena));
+    }
+}
+
+/**
+ * @brief FrameAllocator Destructor.
+ *
+ */
+FrameAllocator::~FrameAllocator()
+{
+    for (auto& arena : frames)
+    {
+        ReleaseOverflow(*arena);
+        ::operator delete(arena->memory, std::align_val_t(ARENA_ALIGNMENT));
+    }
+}
+
+/**
+ * @brief Recycles the oldest frame's arena.
+ *
+ */
+void FrameAllocator::BeginFrame()
+{
+    FrameArena& finished = *frames[current];
+    peak = std::max(peak, finished.offset.load(std::memory_order_relaxed) + finished.overflowBytes);
+
+    current = (current + 1) % frames.size();
+    FrameArena& arena = *frames[current];
+    arena.offset.store(0, std::memory_order_relaxed);
+    ReleaseOverflow(arena);
+}
+
+/**
+ * @brief Bumps the current frame's offset.
+ *
+ * @param size Bytes needed.
+ * @param alignment Power of two alignment.
+ * @return void* Uninitialized memory.
+ */
+void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+    FrameArena& arena = *frames[current];
+    const uintptr_t base = reinterpret_cast<uintptr_t>(arena.memory);
+
+    size_t offset = arena.offset.load(std::memory_order_relaxed);
+    while (true)
+    {
+        size_t aligned = ((base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+        if (aligned + size > capacity)
+        {
+            return AllocateOverflow(arena, size, alignment);
+        }
+        // Usually succeeds first try, threads only retry when they raced for the same bytes
+        if (arena.offset.compare_exchange_weak(offset, aligned + size, std::memory_order_relaxed))
+        {
+            return arena.memory + aligned;
+        }
+    }
+}
+
+/**
+ * @brief Heap fallback once the frame's arena is full, released by BeginFrame.
+ *
+ * @param arena The full arena.
+ * @param size Bytes needed.
+ * @param alignment Power of two alignment.
+ * @return void* Heap memory.
+ */
+void* FrameAllocator::AllocateOverflow(FrameArena& arena, size_t size, size_t alignment)
+{
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    void* memory = ::operator new(size, std::align_val_t(alignment));
+
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    arena.overflow.emplace_back(memory, alignment);
+    arena.overflowBytes += size;
+    return memory;
+}
+
+void FrameAllocator::ReleaseOverflow(FrameArena& arena)
+{
+    for (auto& [memory, alignment] : arena.overflow)
+    {
+        ::operator delete(memory, std::align_val_t(alignment));
+    }
+    arena.overflow.clear();
+    arena.overflowBytes = 0;
+}
+
+/**
+ * @brief Usage of the frame currently being allocated from.
+ *
+ * @return FrameAllocatorStats Current, peak and overflow bytes.
+ */
+FrameAllocatorStats FrameAllocator::GetStats() const
+{
+    const FrameArena& arena = *frames[current];
+    FrameAllocatorStats stats;
+    stats.capacity = capacity;
+    stats.used = arena.offset.load(std::memory_order_relaxed);
+    stats.peak = std::max(peak, stats.used + arena.overflowBytes);
+    stats.overflow = arena.overflowBytes;
+    return stats;
+}
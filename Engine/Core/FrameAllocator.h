@@ -0,0 +1,114 @@
+/*****************************************************************//**
+ * \file   FrameAllocator.h
+ * \brief  Frame scoped bump allocator shared by all threads
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Usage of the current frame's arena.
+ */
+struct FrameAllocatorStats
+{
+    size_t capacity = 0;
+    size_t used = 0;
+    //highest use of any frame since startup
+    size_t peak = 0;
+    //bytes that didn't fit this frame and went to the heap
+    size_t overflow = 0;
+};
+
+/**
+ * @brief Memory that lives for a fixed number of frames. Each frame allocates from
+ * its own arena with a single atomic add, so any thread may allocate; nothing is
+ * freed individually. BeginFrame recycles the arena used frameCount frames ago,
+ * which lets data outlive its frame while the render thread still reads it.
+ */
+class FrameAllocator
+{
+public:
+    /**
+     * @param bytesPerFrame Arena size of one frame, requests beyond it fall back to the heap.
+     * @param frameCount How many frames an allocation stays valid.
+     */
+    FrameAllocator(size_t bytesPerFrame, uint32_t frameCount);
+    ~FrameAllocator();
+
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    /**
+     * @brief Moves to the next frame's arena and releases everything in it. Must not
+     * overlap with Allocate calls.
+     */
+    void BeginFrame();
+
+    /**
+     * @brief Allocates uninitialized memory, valid for frameCount frames. Thread safe.
+     *
+     * @param size Bytes needed.
+     * @param alignment Power of two alignment.
+     * @return void* The memory.
+     */
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * @brief std::pmr adaptor for containers that live no longer than the frame.
+     */
+    std::pmr::memory_resource* GetResource() { return &resource; }
+
+    uint32_t GetFrameCount() const { return static_cast<uint32_t>(frames.size()); }
+
+    FrameAllocatorStats GetStats() const;
+
+private:
+    //arenas are cache line aligned so frames never share a line
+    static constexpr size_t ARENA_ALIGNMENT = 64;
+
+    struct FrameArena
+    {
+        std::byte* memory = nullptr;
+        std::atomic<size_t> offset{ 0 };
+        //heap allocations made after the arena filled up
+        std::vector<std::pair<void*, size_t>> overflow;
+        size_t overflowBytes = 0;
+    };
+
+    class Resource : public std::pmr::memory_resource
+    {
+    public:
+        explicit Resource(FrameAllocator& owner) : owner(owner) {}
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override { return owner.Allocate(bytes, alignment); }
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+        FrameAllocator& owner;
+    };
+
+    void* AllocateOverflow(FrameArena& arena, size_t size, size_t alignment);
+    void ReleaseOverflow(FrameArena& arena);
+
+    std::vector<std::unique_ptr<FrameArena>> frames;
+    size_t capacity;
+    uint32_t current;
+    size_t peak;
+    std::mutex overflowMutex;
+    Resource resource;
+};
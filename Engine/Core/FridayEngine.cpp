@@ -2,20 +2,131 @@
 //
 
 #include "Engine.h"
+#include "Benchmarks.h"
+#include "Profiler.h"
 #include <iostream>
+#include <string>
 
-int main() {
-    Engine instance;
-    try
+int main(int argc, char** argv) {
+    // Microbenchmarks run without opening a window
+    if (argc > 2 && std::string(argv[1]) == "--bench")
     {
-        instance.Run();
+        return RunBenchmark(argv[2]);
     }
-    catch (const std::exception& e) 
+
+    RenderSettings renderSettings;
+    // Headless runs stop on their own after this many frames
+    uint64_t frameLimit = 0;
+    std::string cpuTracePath;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--gpu-driven")
+        {
+            renderSettings.gpuDriven = true;
+        }
+        else if (argument == "--no-instancing")
+        {
+            renderSettings.instancing = false;
+        }
+        else if (argument == "--headless" && i + 1 < argc)
+        {
+            renderSettings.headless = true;
+            frameLimit = std::stoull(argv[++i]);
+        }
+        else if (argument == "--readback" && i + 1 < argc)
+        {
+            renderSettings.readbackPath = argv[++i];
+        }
+        else if (argument == "--gpu-profile" && i + 1 < argc)
+        {
+            renderSettings.gpuProfilePath = argv[++i];
+        }
+        else if (argument == "--pipeline-stats")
+        {
+            renderSettings.pipelineStatistics = true;
+        }
+        else if (argument == "--overlay")
+        {
+            renderSettings.overlay = true;
+        }
+        else if (argument == "--frames-in-flight" && i + 1 < argc)
+        {
+            renderSettings.framesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (argument == "--low-latency")
+        {
+            renderSettings.lowLatency = true;
+        }
+        else if (argument == "--present-mode" && i + 1 < argc)
+        {
+            if (!ParsePresentMode(argv[++i], renderSettings.swapchain.presentMode))
+            {
+                std::cerr << "--present-mode must be vsync, mailbox, immediate or fifo-relaxed" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        else if (argument == "--swapchain-images" && i + 1 < argc)
+        {
+            renderSettings.swapchain.imageCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (argument == "--fps-cap" && i + 1 < argc)
+        {
+            renderSettings.swapchain.frameRateCap = std::stod(argv[++i]);
+        }
+        else if (argument == "--no-hot-reload")
+        {
+            renderSettings.hotReload = false;
+        }
+        else if (argument == "--cpu-trace" && i + 1 < argc)
+        {
+            cpuTracePath = argv[++i];
+        }
+    }
+    if (renderSettings.headless && frameLimit == 0)
+    {
+        std::cerr << "--headless needs a frame count greater than 0" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (renderSettings.framesInFlight == 0 || renderSettings.framesInFlight > FramePacer::MAX_FRAMES_IN_FLIGHT)
     {
-        std::cerr << e.what() << std::endl;
+        std::cerr << "--frames-in-flight must be between 1 and " << FramePacer::MAX_FRAMES_IN_FLIGHT << std::endl;
         return EXIT_FAILURE;
     }
 
-    return EXIT_SUCCESS;
+    // Before the engine starts so its worker and render threads are traced from the start
+    if (!cpuTracePath.empty())
+    {
+        CpuProfiler::SetEnabled(true);
+        CpuProfiler::SetThreadName("Main");
+    }
+
+    int status = EXIT_SUCCESS;
+    {
+        Engine instance(renderSettings);
+        instance.SetFrameLimit(frameLimit);
+        try
+        {
+            instance.Run();
+        }
+        catch (const std::exception& e) 
+        {
+            std::cerr << e.what() << std::endl;
+            status = EXIT_FAILURE;
+        }
+    }
+
+    // The engine is gone, so shutdown work is in the trace too
+    if (!cpuTracePath.empty())
+    {
+        CpuProfiler::SetEnabled(false);
+        CpuProfiler::PrintReport(std::cout);
+        if (!CpuProfiler::WriteChromeTrace(cpuTracePath))
+        {
+            std::cerr << "failed to write CPU trace to " << cpuTracePath << std::endl;
+        }
+    }
+
+    return status;
  }
     
\ No newline at end of file
@@ -0,0 +1,494 @@
+/*****************************************************************//**
+ * \file   JobSystem.cpp
+ * \brief  Work-stealing job system
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+namespace
+{
+    //slot of the calling thread in the active job system
+    thread_local int tlsThreadIndex = -1;
+    //how many failed steal rounds a worker spins before going to sleep
+    constexpr uint32_t IDLE_SPIN_COUNT = 64;
+
+    using JobFunction = void (*)(Job&);
+
+    // A pool slot is free while its function is null, Execute clears it once the job has run
+    std::atomic_ref<JobFunction> JobFunctionOf(Job& job)
+    {
+        return std::atomic_ref<JobFunction>(job.function);
+    }
+
+    int64_t NowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    uint32_t XorShift(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+/**
+ * @brief JobSystem Constructor.
+ *
+ * @param requestedThreads Total threads including the caller, 0 for one per core.
+ */
+JobSystem::JobSystem(uint32_t requestedThreads)
+    : threadCount(requestedThreads),
+    running(true),
+    pendingJobs(0),
+    queuedJobs(0),
+    sleepingWorkers(0),
+    parkedCount(0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    slots.reserve(threadCount + EXTERNAL_THREAD_SLOTS);
+    for (uint32_t i = 0; i < threadCount + EXTERNAL_THREAD_SLOTS; i++)
+    {
+        slots.push_back(std::make_unique<ThreadSlot>());
+        slots[i]->stealSeed = 0x9E3779B9u * (i + 1);
+    }
+
+    // Calling thread is slot 0
+    slots[0]->inUse = true;
+    tlsThreadIndex = 0;
+
+    workers.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; i++)
+    {
+        slots[i]->inUse = true;
+        workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+/**
+ * @brief JobSystem Destructor. Outstanding jobs are drained before the workers exit.
+ * Jobs must not schedule new work once shutdown has started.
+ *
+ */
+JobSystem::~JobSystem()
+{
+    while (pendingJobs.load(std::memory_order_acquire) > 0)
+    {
+        if (!TryRunJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    sleepCondition.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    tlsThreadIndex = -1;
+}
+
+/**
+ * @brief Registers the calling thread so it can schedule jobs.
+ *
+ */
+void JobSystem::RegisterThread()
+{
+    if (tlsThreadIndex >= 0)
+    {
+        return;
+    }
+
+    for (uint32_t i = threadCount; i < slots.size(); i++)
+    {
+        bool expected = false;
+        if (slots[i]->inUse.compare_exchange_strong(expected, true))
+        {
+            tlsThreadIndex = static_cast<int>(i);
+            return;
+        }
+    }
+    throw std::runtime_error("Out of external job system thread slots!");
+}
+
+/**
+ * @brief Unregisters the calling thread. Its queue must be empty.
+ *
+ */
+void JobSystem::UnregisterThread()
+{
+    if (tlsThreadIndex < static_cast<int>(threadCount))
+    {
+        return;
+    }
+
+    ThreadSlot& slot = *slots[tlsThreadIndex];
+    while (Job* job = slot.queue.Pop())
+    {
+        Execute(job);
+    }
+    slot.inUse = false;
+    tlsThreadIndex = -1;
+}
+
+int JobSystem::GetThreadIndex()
+{
+    return tlsThreadIndex;
+}
+
+/**
+ * @brief Takes the next free job from the calling thread's ring. Skips jobs still
+ * queued, parked or running, and runs other jobs while every slot is taken.
+ *
+ * @return Job* Storage for a new job.
+ */
+Job* JobSystem::AllocateJob()
+{
+    if (tlsThreadIndex < 0)
+    {
+        throw std::runtime_error("Scheduling a job from a thread unknown to the job system!");
+    }
+
+    ThreadSlot& slot = *slots[tlsThreadIndex];
+    while (true)
+    {
+        for (uint32_t i = 0; i < JOB_POOL_SIZE; i++)
+        {
+            Job* job = &slot.jobPool[slot.jobPoolIndex & (JOB_POOL_SIZE - 1)];
+            slot.jobPoolIndex++;
+            if (JobFunctionOf(*job).load(std::memory_order_acquire) == nullptr)
+            {
+                return job;
+            }
+        }
+        if (!TryRunJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief Pushes a job onto the calling thread's deque and wakes a sleeper if needed.
+ *
+ * @param job The job to submit.
+ */
+void JobSystem::Submit(Job* job)
+{
+    if (job->counter)
+    {
+        job->counter->value.fetch_add(1, std::memory_order_relaxed);
+    }
+    pendingJobs.fetch_add(1, std::memory_order_relaxed);
+
+    if (job->dependency && Park(job))
+    {
+        return;
+    }
+    Enqueue(job);
+}
+
+/**
+ * @brief Pushes a ready job onto the calling thread's deque and wakes a sleeper if needed.
+ *
+ * @param job The job, its dependency done.
+ */
+void JobSystem::Enqueue(Job* job)
+{
+    if (!slots[tlsThreadIndex]->queue.Push(job))
+    {
+        // Deque full, run it right here rather than dropping it
+        Execute(job);
+        return;
+    }
+    queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+    if (sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        sleepCondition.notify_one();
+    }
+}
+
+/**
+ * @brief Holds a job back until its dependency reaches zero.
+ *
+ * parkedCount goes up before the dependency is checked and the counter goes down
+ * before parkedCount is read, both seq_cst, so either this sees the dependency
+ * done or the job that finished it sees the parked job and releases it.
+ *
+ * @param job The job, with a dependency.
+ * @return bool False if the dependency is already done, the job wasn't parked.
+ */
+bool JobSystem::Park(Job* job)
+{
+    std::lock_guard<std::mutex> lock(parkMutex);
+    parkedCount.fetch_add(1, std::memory_order_seq_cst);
+    if (job->dependency->value.load(std::memory_order_seq_cst) == 0)
+    {
+        parkedCount.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    parkedJobs.push_back(job);
+    return true;
+}
+
+/**
+ * @brief Moves the parked jobs whose dependency is done onto the calling thread's deque.
+ *
+ */
+void JobSystem::ReleaseParked()
+{
+    std::vector<Job*> overflow;
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        WorkStealingQueue& queue = slots[tlsThreadIndex]->queue;
+        auto ready = std::partition(parkedJobs.begin(), parkedJobs.end(), [](Job* job) { return !job->dependency->IsDone(); });
+        for (auto it = ready; it != parkedJobs.end(); ++it)
+        {
+            if (queue.Push(*it))
+            {
+                queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+            }
+            else
+            {
+                overflow.push_back(*it);
+            }
+        }
+        parkedCount.fetch_sub(static_cast<uint32_t>(parkedJobs.end() - ready), std::memory_order_relaxed);
+        parkedJobs.erase(ready, parkedJobs.end());
+    }
+
+    if (sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        sleepCondition.notify_all();
+    }
+    // Deque full, run them right here. Outside the lock, they may release more
+    for (Job* job : overflow)
+    {
+        Execute(job);
+    }
+}
+
+/**
+ * @brief Pops from the own deque, otherwise steals from a random victim.
+ *
+ * @param slot The calling thread's slot.
+ * @return Job* A job, or nullptr if nothing was found.
+ */
+Job* JobSystem::FindJob(ThreadSlot& slot)
+{
+    if (Job* job = slot.queue.Pop())
+    {
+        return job;
+    }
+
+    const uint32_t slotCount = static_cast<uint32_t>(slots.size());
+    const uint32_t start = XorShift(slot.stealSeed) % slotCount;
+    for (uint32_t i = 0; i < slotCount; i++)
+    {
+        ThreadSlot& victim = *slots[(start + i) % slotCount];
+        if (&victim == &slot)
+        {
+            continue;
+        }
+        if (Job* job = victim.queue.Steal())
+        {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Runs one job if any is available.
+ *
+ * @return True if a job was executed.
+ */
+bool JobSystem::TryRunJob()
+{
+    ThreadSlot& slot = *slots[tlsThreadIndex];
+    Job* job = FindJob(slot);
+    if (!job)
+    {
+        return false;
+    }
+    queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+    // Its dependency counter was reused after the job was queued, hold it back again
+    if (job->dependency && Park(job))
+    {
+        return false;
+    }
+
+    Execute(job);
+    return true;
+}
+
+/**
+ * @brief Runs a job and signals its counter.
+ *
+ * @param job The job to run.
+ */
+void JobSystem::Execute(Job* job)
+{
+    // A worker's idle stretch ends with its first job, the clock is only read on that transition
+    ThreadSlot& slot = *slots[tlsThreadIndex];
+    const int64_t idleSince = slot.idleSinceNs.load(std::memory_order_relaxed);
+    if (idleSince != 0)
+    {
+        slot.idleNs.fetch_add(NowNs() - idleSince, std::memory_order_relaxed);
+        slot.idleSinceNs.store(0, std::memory_order_relaxed);
+    }
+
+    JobCounter* counter = job->counter;
+    {
+        PROFILE_ZONE("Job");
+        job->function(*job);
+    }
+    // The owner may reuse the job from here on
+    JobFunctionOf(*job).store(nullptr, std::memory_order_release);
+
+    // Don't touch the counter after it reaches zero, its owner may destroy it
+    if (counter && counter->value.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+        parkedCount.load(std::memory_order_seq_cst) > 0)
+    {
+        ReleaseParked();
+    }
+    pendingJobs.fetch_sub(1, std::memory_order_release);
+    slot.jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Idle time of a thread, including the stretch it is idle in right now.
+ *
+ * @param thread Slot index.
+ * @return double Seconds.
+ */
+double JobSystem::GetIdleSeconds(uint32_t thread) const
+{
+    const ThreadSlot& slot = *slots[thread];
+    int64_t idle = slot.idleNs.load(std::memory_order_relaxed);
+    const int64_t idleSince = slot.idleSinceNs.load(std::memory_order_relaxed);
+    if (idleSince != 0)
+    {
+        idle += std::max<int64_t>(0, NowNs() - idleSince);
+    }
+    return idle * 1e-9;
+}
+
+/**
+ * @brief Waits for a counter by executing other jobs in the meantime.
+ *
+ * @param counter The counter to wait on.
+ */
+void JobSystem::Wait(const JobCounter& counter)
+{
+    const bool canHelp = tlsThreadIndex >= 0;
+    while (!counter.IsDone())
+    {
+        if (!canHelp || !TryRunJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/**
+ * @brief Waits for a counter, running only the calling thread's own jobs for it.
+ * The deque pops newest first, so once it hands out a job for another counter
+ * (e.g. one released from the parked list), everything below that is foreign
+ * too. The job goes back for thieves and the rest of the wait just yields.
+ *
+ * @param counter The counter to wait on.
+ */
+void JobSystem::WaitForOwnJobs(const JobCounter& counter)
+{
+    if (tlsThreadIndex < 0)
+    {
+        Wait(counter);
+        return;
+    }
+
+    WorkStealingQueue& queue = slots[tlsThreadIndex]->queue;
+    bool ownJobsLeft = true;
+    while (!counter.IsDone())
+    {
+        Job* job = ownJobsLeft ? queue.Pop() : nullptr;
+        if (job && (job->counter != &counter || job->dependency))
+        {
+            // Room is guaranteed, it was just popped
+            queue.Push(job);
+            job = nullptr;
+        }
+        if (!job)
+        {
+            ownJobsLeft = false;
+            std::this_thread::yield();
+            continue;
+        }
+        queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        Execute(job);
+    }
+}
+
+/**
+ * @brief Worker thread main loop.
+ *
+ * @param index Slot owned by this worker.
+ */
+void JobSystem::WorkerLoop(uint32_t index)
+{
+    tlsThreadIndex = static_cast<int>(index);
+    CpuProfiler::SetThreadName("Job worker " + std::to_string(index));
+    uint32_t idleSpins = 0;
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        if (TryRunJob())
+        {
+            idleSpins = 0;
+            continue;
+        }
+
+        if (idleSpins == 0 && slots[index]->idleSinceNs.load(std::memory_order_relaxed) == 0)
+        {
+            slots[index]->idleSinceNs.store(NowNs(), std::memory_order_relaxed);
+        }
+        if (++idleSpins < IDLE_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Nothing to do for a while, sleep until someone schedules work
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        sleepCondition.wait(lock, [this]()
+        {
+            return queuedJobs.load(std::memory_order_seq_cst) > 0 || !running.load(std::memory_order_relaxed);
+        });
+        sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+        idleSpins = 0;
+    }
+    tlsThreadIndex = -1;
+}
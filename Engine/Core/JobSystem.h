@@ -0,0 +1,230 @@
+/*****************************************************************//**
+ * \file   JobSystem.h
+ * \brief  Work-stealing job system
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "WorkStealingQueue.h"
+
+/**
+ * @brief Counts outstanding jobs. Jobs scheduled with a counter increment it and
+ * decrement it when they finish, so a counter reaching zero means "all done".
+ * Counters are also used as dependencies for other jobs.
+ */
+struct JobCounter
+{
+    std::atomic<uint32_t> value{ 0 };
+
+    bool IsDone() const { return value.load(std::memory_order_acquire) == 0; }
+};
+
+/**
+ * @brief A unit of work. Small callables are stored inline so scheduling never
+ * touches the heap.
+ */
+struct alignas(64) Job
+{
+    static constexpr size_t PAYLOAD_SIZE = 40;
+
+    void (*function)(Job&);
+    JobCounter* counter;
+    const JobCounter* dependency;
+    alignas(8) unsigned char payload[PAYLOAD_SIZE];
+};
+static_assert(sizeof(Job) == 64, "Job should fill exactly one cache line");
+
+class JobSystem
+{
+public:
+    /**
+     * @brief Starts the worker threads. The constructing thread becomes thread 0
+     * and helps execute jobs whenever it waits.
+     *
+     * @param threadCount Total threads including the caller, 0 for one per core.
+     */
+    explicit JobSystem(uint32_t threadCount = 0);
+
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Schedules a callable.
+     *
+     * @param function Callable with signature void(), at most Job::PAYLOAD_SIZE bytes.
+     * @param counter Optional counter incremented now and decremented on completion.
+     * @param dependency Optional counter that must reach zero before the job runs. Until
+     * it does, the job is held back instead of queued. It must outlive the job's start.
+     */
+    template <typename F>
+    void Schedule(F&& function, JobCounter* counter = nullptr, const JobCounter* dependency = nullptr)
+    {
+        using Callable = std::decay_t<F>;
+        static_assert(sizeof(Callable) <= Job::PAYLOAD_SIZE, "Job callable captures too much, capture a pointer instead");
+        static_assert(alignof(Callable) <= 8, "Job callable is over-aligned");
+
+        Job* job = AllocateJob();
+        job->function = [](Job& self)
+        {
+            Callable* callable = std::launder(reinterpret_cast<Callable*>(self.payload));
+            (*callable)();
+            callable->~Callable();
+        };
+        job->counter = counter;
+        job->dependency = dependency;
+        new (job->payload) Callable(std::forward<F>(function));
+
+        Submit(job);
+    }
+
+    /**
+     * @brief Splits [0, count) into batches and runs function(begin, end) for each.
+     *
+     * @param count Number of elements.
+     * @param batchSize Elements per job.
+     * @param function Callable with signature void(uint32_t begin, uint32_t end),
+     * referenced by the jobs so it must outlive them.
+     * @param counter Counter to wait on for completion.
+     */
+    template <typename F>
+    void ParallelFor(uint32_t count, uint32_t batchSize, const F& function, JobCounter* counter)
+    {
+        if (batchSize == 0)
+        {
+            batchSize = 1;
+        }
+        for (uint32_t begin = 0; begin < count; begin += batchSize)
+        {
+            uint32_t end = begin + batchSize < count ? begin + batchSize : count;
+            const F* fn = &function;
+            Schedule([fn, begin, end]() { (*fn)(begin, end); }, counter);
+        }
+    }
+
+    //a temporary would be destroyed while the jobs still reference it
+    template <typename F>
+    void ParallelFor(uint32_t count, uint32_t batchSize, const F&& function, JobCounter* counter) = delete;
+
+    /**
+     * @brief Waits for a counter to reach zero. The calling thread runs other
+     * jobs while it waits instead of sleeping.
+     *
+     * @param counter The counter to wait on.
+     */
+    void Wait(const JobCounter& counter);
+
+    /**
+     * @brief Waits for a counter like Wait, but only runs jobs for that counter
+     * which the calling thread queued itself and nobody stole yet. For threads that
+     * must not get stuck in unrelated work, e.g. the render thread while recording.
+     *
+     * @param counter The counter to wait on, its jobs scheduled from this thread.
+     */
+    void WaitForOwnJobs(const JobCounter& counter);
+
+    /**
+     * @brief Runs one queued job on the calling thread, for callers that wait on
+     * something other than a counter. The thread must be registered.
+     *
+     * @return True if a job was executed.
+     */
+    bool TryRunJob();
+
+    /**
+     * @brief Lets a thread that was not created by the job system (e.g. the render
+     * thread) schedule and help with jobs. Must be called once on that thread.
+     */
+    void RegisterThread();
+
+    /**
+     * @brief Releases the slot claimed by RegisterThread.
+     */
+    void UnregisterThread();
+
+    /**
+     * @brief Total threads that execute jobs, including the main thread.
+     */
+    uint32_t GetThreadCount() const { return threadCount; }
+
+    /**
+     * @brief Upper bound on GetThreadIndex, counting the slots for registered threads.
+     */
+    uint32_t GetMaxThreads() const { return static_cast<uint32_t>(slots.size()); }
+
+    /**
+     * @brief Index of the calling thread, or -1 if it is not registered.
+     */
+    static int GetThreadIndex();
+
+    /**
+     * @brief Jobs executed by a thread since startup.
+     */
+    uint64_t GetJobsExecuted(uint32_t thread) const { return slots[thread]->jobsExecuted.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Time a worker spent without a job since startup, spinning or asleep.
+     * Sample it twice to get a worker's utilization over the interval. Always 0
+     * for the main thread and registered threads, which do other work between jobs.
+     */
+    double GetIdleSeconds(uint32_t thread) const;
+
+private:
+    //extra slots for threads that register themselves (render thread, loaders)
+    static constexpr uint32_t EXTERNAL_THREAD_SLOTS = 4;
+    //jobs are recycled in a ring, a slot is only reused once its job has finished
+    static constexpr uint32_t JOB_POOL_SIZE = WorkStealingQueue::CAPACITY;
+
+    struct ThreadSlot
+    {
+        WorkStealingQueue queue;
+        std::unique_ptr<Job[]> jobPool = std::make_unique<Job[]>(JOB_POOL_SIZE);
+        uint32_t jobPoolIndex = 0;
+        uint32_t stealSeed = 0;
+        std::atomic<bool> inUse{ false };
+        std::atomic<uint64_t> jobsExecuted{ 0 };
+        //steady clock nanoseconds, summed when a worker finds work again
+        std::atomic<int64_t> idleNs{ 0 };
+        //when the worker last ran out of work, 0 while it has some
+        std::atomic<int64_t> idleSinceNs{ 0 };
+    };
+
+    Job* AllocateJob();
+    void Submit(Job* job);
+    void Enqueue(Job* job);
+    bool Park(Job* job);
+    void ReleaseParked();
+    Job* FindJob(ThreadSlot& slot);
+    void Execute(Job* job);
+    void WorkerLoop(uint32_t index);
+
+    uint32_t threadCount;
+    std::vector<std::unique_ptr<ThreadSlot>> slots;
+    std::vector<std::thread> workers;
+
+    std::atomic<bool> running;
+    //scheduled but not finished
+    std::atomic<int64_t> pendingJobs;
+    //sitting in a deque, what sleeping workers wake up for
+    std::atomic<int64_t> queuedJobs;
+    std::atomic<uint32_t> sleepingWorkers;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+
+    //jobs whose dependency wasn't done yet, requeued when a counter reaches zero
+    std::mutex parkMutex;
+    std::vector<Job*> parkedJobs;
+    std::atomic<uint32_t> parkedCount;
+};
@@ -0,0 +1,117 @@
+/*****************************************************************//**
+ * \file   LinearArena.cpp
+ * \brief  Bump allocator and per-thread scratch memory
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "LinearArena.h"
+#include <algorithm>
+
+namespace
+{
+    //scratch blocks are large enough that typical setup and per-frame temporaries never chain
+    constexpr size_t SCRATCH_BLOCK_SIZE = 256 * 1024;
+}
+
+/**
+ * @brief LinearArena Constructor. No memory is reserved until the first allocation.
+ *
+ * @param blockSize Size of each block.
+ */
+LinearArena::LinearArena(size_t blockSize)
+    : blockIndex(0),
+    blockOffset(0),
+    blockSize(blockSize)
+{
+}
+
+/**
+ * @brief Bump allocates from the current block, moving on to the next block when
+ * it doesn't fit.
+ *
+ * @param size Bytes needed.
+ * @param alignment Power of two alignment.
+ * @return void* Uninitialized memory.
+ */
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+    while (blockIndex < blocks.size())
+    {
+        Block& block = blocks[blockIndex];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+        size_t offset = ((base + blockOffset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+        if (offset + size <= block.size)
+        {
+            blockOffset = offset + size;
+            return block.memory.get() + offset;
+        }
+        blockIndex++;
+        blockOffset = 0;
+    }
+
+    // Out of blocks, add one and keep it for after the next Reset
+    Block block;
+    block.size = std::max(blockSize, size + alignment);
+    block.memory = std::make_unique<std::byte[]>(block.size);
+    blocks.push_back(std::move(block));
+    blockIndex = blocks.size() - 1;
+    return Allocate(size, alignment);
+}
+
+/**
+ * @brief Frees everything allocated after marker.
+ *
+ * @param marker Taken with GetMarker.
+ */
+void LinearArena::Rewind(Marker marker)
+{
+    blockIndex = marker.block;
+    blockOffset = marker.offset;
+}
+
+size_t LinearArena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const Block& block : blocks)
+    {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+size_t LinearArena::GetUsed() const
+{
+    size_t used = blockOffset;
+    for (size_t i = 0; i < blockIndex && i < blocks.size(); i++)
+    {
+        used += blocks[i].size;
+    }
+    return used;
+}
+
+LinearArena& GetScratchArena()
+{
+    thread_local LinearArena scratch(SCRATCH_BLOCK_SIZE);
+    return scratch;
+}
+
+/**
+ * @brief Opens a scope on the calling thread's scratch arena.
+ *
+ */
+ScratchScope::ScratchScope()
+    : arena(GetScratchArena()),
+    marker(arena.GetMarker()),
+    resource(arena)
+{
+}
+
+/**
+ * @brief Releases everything allocated during the scope.
+ *
+ */
+ScratchScope::~ScratchScope()
+{
+    arena.Rewind(marker);
+}
@@ -0,0 +1,140 @@
+/*****************************************************************//**
+ * \file   LinearArena.h
+ * \brief  Bump allocator and per-thread scratch memory
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @brief Hands out memory by bumping an offset through a list of blocks. There is
+ * no per-allocation free: memory is released all at once by Reset, or back to a
+ * marker by Rewind. Blocks are kept, so a warmed up arena never touches the heap.
+ * Not thread safe.
+ */
+class LinearArena
+{
+public:
+    //position to Rewind to
+    struct Marker
+    {
+        size_t block;
+        size_t offset;
+    };
+
+    /**
+     * @param blockSize Size of each block, larger requests get a block of their own.
+     */
+    explicit LinearArena(size_t blockSize = 64 * 1024);
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    /**
+     * @brief Allocates uninitialized memory, valid until Reset or Rewind past it.
+     *
+     * @param size Bytes needed.
+     * @param alignment Power of two alignment.
+     * @return void* The memory.
+     */
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Uninitialized storage for count objects of type T.
+     */
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    Marker GetMarker() const { return Marker{ blockIndex, blockOffset }; }
+
+    /**
+     * @brief Frees everything allocated after marker. Destructors are not run.
+     */
+    void Rewind(Marker marker);
+
+    /**
+     * @brief Frees everything. Destructors are not run.
+     */
+    void Reset() { Rewind(Marker{ 0, 0 }); }
+
+    //bytes reserved in blocks
+    size_t GetCapacity() const;
+
+    //bytes handed out since the last Reset, including alignment padding
+    size_t GetUsed() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockIndex;
+    size_t blockOffset;
+    size_t blockSize;
+};
+
+/**
+ * @brief std::pmr adaptor so standard containers can allocate from a LinearArena.
+ * Deallocation is a no-op, memory comes back when the arena is reset.
+ */
+class ArenaResource : public std::pmr::memory_resource
+{
+public:
+    explicit ArenaResource(LinearArena& arena) : arena(arena) {}
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override { return arena.Allocate(bytes, alignment); }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    LinearArena& arena;
+};
+
+/**
+ * @brief The calling thread's scratch arena. Use it through ScratchScope.
+ */
+LinearArena& GetScratchArena();
+
+/**
+ * @brief Temporary memory for the current scope. Everything allocated from the
+ * thread's scratch arena while the scope is alive is released when it ends, so
+ * scopes must be destroyed in reverse order of creation, e.g.
+ *
+ *     ScratchScope scratch;
+ *     std::pmr::vector<VkPhysicalDevice> devices(count, scratch.GetResource());
+ *
+ * Containers using the scope must not outlive it.
+ */
+class ScratchScope
+{
+public:
+    ScratchScope();
+    ~ScratchScope();
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) { return arena.Allocate(size, alignment); }
+
+    template <typename T>
+    T* AllocateArray(size_t count) { return arena.AllocateArray<T>(count); }
+
+    std::pmr::memory_resource* GetResource() { return &resource; }
+
+private:
+    LinearArena& arena;
+    LinearArena::Marker marker;
+    ArenaResource resource;
+};
@@ -0,0 +1,361 @@
+/*****************************************************************//**
+ * \file   Profiler.cpp
+ * \brief  Scoped CPU profiler with per-thread event buffers and Chrome trace export
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    //events per chunk, one chunk is 128 KiB
+    constexpr uint32_t CHUNK_EVENTS = 4096;
+    //zones listed by PrintReport, by total time
+    constexpr size_t REPORT_ZONES = 16;
+
+    enum class EventType : uint32_t
+    {
+        Zone,
+        Frame,
+        Counter
+    };
+
+    struct Event
+    {
+        const char* name;
+        uint64_t begin;
+        //end tick of a zone, frame number of a marker, bit cast double of a counter
+        uint64_t value;
+        EventType type;
+    };
+
+    struct Chunk
+    {
+        Event events[CHUNK_EVENTS];
+        //events written, published by the owning thread
+        std::atomic<uint32_t> count{ 0 };
+        std::atomic<Chunk*> next{ nullptr };
+    };
+
+    struct ThreadBuffer
+    {
+        //tid in the trace
+        uint32_t id = 0;
+        //guarded by the registry mutex
+        std::string name;
+        Chunk* head = nullptr;
+        //owning thread only
+        Chunk* tail = nullptr;
+        uint32_t written = 0;
+        std::atomic<uint64_t> dropped{ 0 };
+
+        ~ThreadBuffer()
+        {
+            while (head)
+            {
+                Chunk* next = head->next.load(std::memory_order_relaxed);
+                delete head;
+                head = next;
+            }
+        }
+    };
+
+    struct Registry
+    {
+        std::atomic<bool> enabled{ false };
+        std::mutex mutex;
+        //guarded by mutex, buffers live until exit so traces can outlive threads
+        std::vector<std::unique_ptr<ThreadBuffer>> threads;
+        std::unordered_set<std::string> names;
+        //clock both tick and wall time are measured from, set by the first enable
+        bool started = false;
+        uint64_t startTicks = 0;
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+    Registry registry;
+    thread_local ThreadBuffer* tlsBuffer = nullptr;
+    //name given before the thread's first event, threads that never record get no buffer
+    thread_local std::string tlsThreadName;
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        if (!tlsBuffer)
+        {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            buffer->head = new Chunk;
+            buffer->tail = buffer->head;
+
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            buffer->id = static_cast<uint32_t>(registry.threads.size());
+            buffer->name = tlsThreadName.empty() ? "Thread " + std::to_string(buffer->id) : tlsThreadName;
+            tlsBuffer = buffer.get();
+            registry.threads.push_back(std::move(buffer));
+        }
+        return *tlsBuffer;
+    }
+
+    void Push(const Event& event)
+    {
+        ThreadBuffer& buffer = GetThreadBuffer();
+        if (buffer.written >= CpuProfiler::MAX_EVENTS_PER_THREAD)
+        {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Chunk* chunk = buffer.tail;
+        uint32_t count = chunk->count.load(std::memory_order_relaxed);
+        if (count == CHUNK_EVENTS)
+        {
+            Chunk* next = new Chunk;
+            chunk->next.store(next, std::memory_order_release);
+            buffer.tail = next;
+            chunk = next;
+            count = 0;
+        }
+        chunk->events[count] = event;
+        chunk->count.store(count + 1, std::memory_order_release);
+        buffer.written++;
+    }
+
+    /**
+     * @brief Calls fn on every event the buffer's owner has published so far.
+     */
+    template <typename Fn>
+    void ForEachEvent(const ThreadBuffer& buffer, Fn&& fn)
+    {
+        for (const Chunk* chunk = buffer.head; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            const uint32_t count = chunk->count.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                fn(chunk->events[i]);
+            }
+        }
+    }
+
+    /**
+     * @brief Ticks per microsecond, measured over everything since the first enable.
+     */
+    double TicksPerMicrosecond()
+    {
+        const uint64_t ticks = CpuProfiler::Now() - registry.startTicks;
+        const double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - registry.startTime).count();
+        return microseconds > 0.0 && ticks > 0 ? ticks / microseconds : 1.0;
+    }
+
+    std::string Quoted(const char* text)
+    {
+        std::string result = "\"";
+        for (const char* c = text; *c; c++)
+        {
+            if (*c == '"' || *c == '\\')
+            {
+                result += '\\';
+            }
+            result += *c;
+        }
+        return result + "\"";
+    }
+}
+
+void CpuProfiler::SetEnabled(bool enabled)
+{
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if (enabled && !registry.started)
+        {
+            registry.startTicks = Now();
+            registry.startTime = std::chrono::steady_clock::now();
+            registry.started = true;
+        }
+    }
+    registry.enabled.store(enabled, std::memory_order_release);
+}
+
+bool CpuProfiler::IsEnabled()
+{
+    return registry.enabled.load(std::memory_order_relaxed);
+}
+
+void CpuProfiler::SetThreadName(const std::string& name)
+{
+    if (!tlsBuffer)
+    {
+        tlsThreadName = name;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    tlsBuffer->name = name;
+}
+
+const char* CpuProfiler::InternName(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    return registry.names.insert(name).first->c_str();
+}
+
+void CpuProfiler::RecordZone(const char* name, uint64_t begin, uint64_t end)
+{
+    Push({ name, begin, end, EventType::Zone });
+}
+
+void CpuProfiler::MarkFrame(uint64_t frame)
+{
+    if (IsEnabled())
+    {
+        Push({ "Frame", Now(), frame, EventType::Frame });
+    }
+}
+
+void CpuProfiler::RecordCounter(const char* name, double value)
+{
+    if (IsEnabled())
+    {
+        Push({ name, Now(), std::bit_cast<uint64_t>(value), EventType::Counter });
+    }
+}
+
+bool CpuProfiler::WriteChromeTrace(const std::string& path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    const double ticksPerMicrosecond = TicksPerMicrosecond();
+    // Ticks read on another core may trail the start slightly, clamp them to 0
+    auto microseconds = [&](uint64_t ticks)
+    {
+        return ticks > registry.startTicks ? (ticks - registry.startTicks) / ticksPerMicrosecond : 0.0;
+    };
+
+    char line[256];
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]()
+    {
+        file << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    for (const std::unique_ptr<ThreadBuffer>& buffer : registry.threads)
+    {
+        const uint32_t tid = buffer->id;
+        separator();
+        std::snprintf(line, sizeof(line), "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", tid);
+        file << line << Quoted(buffer->name.c_str()) << "}}";
+        separator();
+        std::snprintf(line, sizeof(line), "{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}", tid, tid);
+        file << line;
+
+        ForEachEvent(*buffer, [&](const Event& event)
+        {
+            separator();
+            switch (event.type)
+            {
+            case EventType::Zone:
+                std::snprintf(line, sizeof(line), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                    microseconds(event.begin), (event.value - event.begin) / ticksPerMicrosecond, tid);
+                file << "{\"name\":" << Quoted(event.name) << line;
+                break;
+            case EventType::Frame:
+                std::snprintf(line, sizeof(line), "{\"name\":\"Frame %llu\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                    static_cast<unsigned long long>(event.value), microseconds(event.begin), tid);
+                file << line;
+                break;
+            case EventType::Counter:
+                std::snprintf(line, sizeof(line), ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%.17g}}",
+                    microseconds(event.begin), tid, std::bit_cast<double>(event.value));
+                file << "{\"name\":" << Quoted(event.name) << line;
+                break;
+            }
+        });
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+CpuProfilerStats CpuProfiler::GetStats()
+{
+    CpuProfilerStats stats;
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : registry.threads)
+    {
+        uint64_t events = 0;
+        for (const Chunk* chunk = buffer->head; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            events += chunk->count.load(std::memory_order_acquire);
+        }
+        const uint64_t dropped = buffer->dropped.load(std::memory_order_relaxed);
+        stats.threads += events + dropped > 0 ? 1 : 0;
+        stats.events += events;
+        stats.droppedEvents += dropped;
+    }
+    return stats;
+}
+
+void CpuProfiler::PrintReport(std::ostream& out)
+{
+    const CpuProfilerStats stats = GetStats();
+    char line[256];
+    std::snprintf(line, sizeof(line), "[CPU profiler] %llu events on %u threads, %llu dropped\n",
+        static_cast<unsigned long long>(stats.events), stats.threads, static_cast<unsigned long long>(stats.droppedEvents));
+    out << line;
+
+    struct ZoneTotal
+    {
+        uint64_t count = 0;
+        uint64_t ticks = 0;
+        uint64_t maxTicks = 0;
+    };
+
+    // Equal names may be different literals, so zones are summed by text
+    std::unordered_map<std::string, ZoneTotal> totals;
+    double ticksPerMicrosecond = 1.0;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        ticksPerMicrosecond = TicksPerMicrosecond();
+        for (const std::unique_ptr<ThreadBuffer>& buffer : registry.threads)
+        {
+            ForEachEvent(*buffer, [&](const Event& event)
+            {
+                if (event.type == EventType::Zone)
+                {
+                    ZoneTotal& total = totals[event.name];
+                    const uint64_t ticks = event.value - event.begin;
+                    total.count++;
+                    total.ticks += ticks;
+                    total.maxTicks = std::max(total.maxTicks, ticks);
+                }
+            });
+        }
+    }
+
+    std::vector<std::pair<std::string, ZoneTotal>> sorted(totals.begin(), totals.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second.ticks > b.second.ticks; });
+    const double ticksPerMillisecond = ticksPerMicrosecond * 1000.0;
+    for (size_t i = 0; i < std::min(sorted.size(), REPORT_ZONES); i++)
+    {
+        const ZoneTotal& total = sorted[i].second;
+        std::snprintf(line, sizeof(line), "[CPU profiler] %-24s total %.3f ms, avg %.4f, max %.4f, %llu calls\n", sorted[i].first.c_str(),
+            total.ticks / ticksPerMillisecond, total.ticks / ticksPerMillisecond / total.count, total.maxTicks / ticksPerMillisecond,
+            static_cast<unsigned long long>(total.count));
+        out << line;
+    }
+}
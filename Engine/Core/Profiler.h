@@ -0,0 +1,160 @@
+/*****************************************************************//**
+ * \file   Profiler.h
+ * \brief  Scoped CPU profiler with per-thread event buffers and Chrome trace export
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#include <chrono>
+#endif
+
+/**
+ * @brief Counters since the profiler was first enabled.
+ */
+struct CpuProfilerStats
+{
+    //threads that recorded at least one event
+    uint32_t threads = 0;
+    uint64_t events = 0;
+    //events lost because their thread's buffer was full
+    uint64_t droppedEvents = 0;
+};
+
+/**
+ * @brief Records zones, frame markers and counters from any thread into a buffer
+ * owned by that thread, so recording never locks: the owner appends, then
+ * publishes the new count with a release store. Buffers grow in fixed chunks up
+ * to MAX_EVENTS_PER_THREAD and outlive their threads, so a trace can be written
+ * after the job system and render thread have shut down.
+ *
+ * Timestamps are raw TSC ticks on x86-64 and steady_clock nanoseconds elsewhere,
+ * converted to time when the trace is written. Disabled, a zone costs one
+ * relaxed load. Use the PROFILE_ macros rather than the class directly.
+ */
+class CpuProfiler
+{
+public:
+    //per-thread cap, about 32 MiB of events per thread
+    static constexpr uint32_t MAX_EVENTS_PER_THREAD = 1u << 20;
+
+    /**
+     * @brief Starts or stops recording. The first enable also starts the clock
+     * trace timestamps are relative to.
+     */
+    static void SetEnabled(bool enabled);
+
+    static bool IsEnabled();
+
+    /**
+     * @brief Name shown for the calling thread's timeline.
+     *
+     * @param name Copied.
+     */
+    static void SetThreadName(const std::string& name);
+
+    /**
+     * @brief Stable copy of a name that doesn't outlive the trace on its own,
+     * e.g. a system name. Takes a lock, so call it once, not per zone.
+     *
+     * @return const char* Valid until the program exits.
+     */
+    static const char* InternName(const std::string& name);
+
+    /**
+     * @brief A zone of the calling thread that ran from begin to end, in Now ticks.
+     *
+     * @param name String literal or InternName result.
+     */
+    static void RecordZone(const char* name, uint64_t begin, uint64_t end);
+
+    /**
+     * @brief Marks the start of a frame on every thread's timeline.
+     */
+    static void MarkFrame(uint64_t frame);
+
+    /**
+     * @brief Samples a value drawn as a graph above the timelines.
+     *
+     * @param name String literal or InternName result.
+     */
+    static void RecordCounter(const char* name, double value);
+
+    /**
+     * @brief Writes everything recorded so far as Chrome trace event JSON, which
+     * chrome://tracing and ui.perfetto.dev both open. Threads may keep recording.
+     *
+     * @return bool False if the file could not be written.
+     */
+    static bool WriteChromeTrace(const std::string& path);
+
+    static CpuProfilerStats GetStats();
+
+    static void PrintReport(std::ostream& out);
+
+    static uint64_t Now()
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+};
+
+/**
+ * @brief Records the enclosing scope as a zone of the calling thread.
+ */
+class CpuProfileZone
+{
+public:
+    explicit CpuProfileZone(const char* zoneName)
+        : name(CpuProfiler::IsEnabled() ? zoneName : nullptr),
+        begin(name ? CpuProfiler::Now() : 0)
+    {
+    }
+
+    ~CpuProfileZone()
+    {
+        if (name)
+        {
+            CpuProfiler::RecordZone(name, begin, CpuProfiler::Now());
+        }
+    }
+
+    CpuProfileZone(const CpuProfileZone&) = delete;
+    CpuProfileZone& operator=(const CpuProfileZone&) = delete;
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+#define FRIDAY_PROFILE_CONCAT_INNER(a, b) a##b
+#define FRIDAY_PROFILE_CONCAT(a, b) FRIDAY_PROFILE_CONCAT_INNER(a, b)
+
+// Compile every zone out with FRIDAY_DISABLE_PROFILER
+#ifdef FRIDAY_DISABLE_PROFILER
+#define PROFILE_ZONE(name)
+#define PROFILE_FUNCTION()
+#define PROFILE_FRAME(frame)
+#define PROFILE_COUNTER(name, value)
+#else
+//name must be a string literal or come from CpuProfiler::InternName
+#define PROFILE_ZONE(name) CpuProfileZone FRIDAY_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#define PROFILE_FRAME(frame) CpuProfiler::MarkFrame(frame)
+#define PROFILE_COUNTER(name, value) CpuProfiler::RecordCounter(name, static_cast<double>(value))
+#endif
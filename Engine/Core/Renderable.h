@@ -0,0 +1,21 @@
+/*****************************************************************//**
+ * \file   Renderable.h
+ * \brief  What a simulated object is drawn with
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Entities with a Transform and a Renderable are drawn. Objects sharing
+ * mesh and material are batched into one instanced draw.
+ */
+struct Renderable
+{
+    //index returned by GpuScene::AddMesh, 0 is the built-in quad
+    uint32_t mesh = 0;
+    //index into the material table, wraps around past its end
+    uint32_t material = 0;
+};
@@ -0,0 +1,346 @@
+/*****************************************************************//**
+ * \file   SystemScheduler.cpp
+ * \brief  Runs engine systems in parallel based on their declared data access
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "SystemScheduler.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include "LinearArena.h"
+#include "Profiler.h"
+
+namespace
+{
+    std::atomic<uint32_t> accessTypeCount{ 0 };
+
+    double Milliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+uint32_t AccessRegistry::NextId()
+{
+    uint32_t id = accessTypeCount.fetch_add(1, std::memory_order_relaxed);
+    if (id >= MAX_ACCESS_TYPES)
+    {
+        throw std::runtime_error("Too many system access types!");
+    }
+    return id;
+}
+
+/**
+ * @brief SystemScheduler Constructor.
+ *
+ * @param name Shown in the timing report.
+ */
+SystemScheduler::SystemScheduler(std::string name)
+    : schedulerName(std::move(name)),
+    graphDirty(true),
+    activeJobSystem(nullptr),
+    systemsLeft(0),
+    runDt(0.0f),
+    runFailed(false),
+    criticalPathMs(0.0),
+    lastRunMs(0.0),
+    totalRunMs(0.0),
+    totalCriticalPathMs(0.0),
+    runCount(0)
+{
+}
+
+/**
+ * @brief Adds a system with explicit access masks.
+ *
+ * @param name Shown in the timing report.
+ * @param reads Types the system only reads.
+ * @param writes Types the system modifies.
+ * @param function The system body.
+ * @param flags SystemFlags::MainThread to pin it to the calling thread.
+ */
+void SystemScheduler::AddSystem(const std::string& name, const AccessMask& reads, const AccessMask& writes, SystemFunction function, SystemFlags flags)
+{
+    auto node = std::make_unique<SystemNode>();
+    node->name = name;
+    node->profileName = CpuProfiler::InternName(name);
+    node->reads = reads;
+    node->writes = writes;
+    node->function = std::move(function);
+    node->mainThread = (static_cast<uint32_t>(flags) & static_cast<uint32_t>(SystemFlags::MainThread)) != 0;
+    systems.push_back(std::move(node));
+    graphDirty = true;
+}
+
+/**
+ * @brief Rebuilds the dependency edges. A later system depends on an earlier one
+ * whenever one of them writes something the other reads or writes.
+ *
+ */
+void SystemScheduler::BuildGraph()
+{
+    for (auto& node : systems)
+    {
+        node->successors.clear();
+        node->predecessorCount = 0;
+    }
+
+    for (uint32_t later = 0; later < systems.size(); later++)
+    {
+        SystemNode& b = *systems[later];
+        for (uint32_t earlier = 0; earlier < later; earlier++)
+        {
+            SystemNode& a = *systems[earlier];
+            bool conflict = (a.writes & (b.reads | b.writes)).any() || (a.reads & b.writes).any();
+            if (conflict)
+            {
+                a.successors.push_back(later);
+                b.predecessorCount++;
+            }
+        }
+    }
+    graphDirty = false;
+}
+
+/**
+ * @brief Runs every system once.
+ *
+ * @param jobSystem Where the systems run, the calling thread must belong to it.
+ * @param dt Passed to every system.
+ */
+void SystemScheduler::Run(JobSystem& jobSystem, float dt)
+{
+    if (systems.empty())
+    {
+        return;
+    }
+    if (graphDirty)
+    {
+        BuildGraph();
+    }
+
+    activeJobSystem = &jobSystem;
+    runDt = dt;
+    systemsLeft.store(static_cast<uint32_t>(systems.size()), std::memory_order_relaxed);
+    for (auto& node : systems)
+    {
+        node->remaining.store(node->predecessorCount, std::memory_order_relaxed);
+        node->readyOnMain.store(false, std::memory_order_relaxed);
+    }
+
+    auto runBegin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < systems.size(); i++)
+    {
+        if (systems[i]->predecessorCount == 0)
+        {
+            MakeReady(i);
+        }
+    }
+
+    // Run main thread systems as they become ready, help with jobs otherwise
+    while (systemsLeft.load(std::memory_order_acquire) > 0)
+    {
+        bool didWork = false;
+        for (uint32_t i = 0; i < systems.size(); i++)
+        {
+            if (systems[i]->mainThread && systems[i]->readyOnMain.exchange(false, std::memory_order_acq_rel))
+            {
+                Execute(i);
+                didWork = true;
+            }
+        }
+        if (!didWork && !jobSystem.TryRunJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+    jobSystem.Wait(runCounter);
+    activeJobSystem = nullptr;
+
+    if (runFailed.load(std::memory_order_acquire))
+    {
+        std::exception_ptr error = std::move(runError);
+        runError = nullptr;
+        runFailed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(error);
+    }
+    UpdateStats(runBegin);
+}
+
+/**
+ * @brief Queues a system whose dependencies have all finished.
+ *
+ * @param index The system.
+ */
+void SystemScheduler::MakeReady(uint32_t index)
+{
+    if (systems[index]->mainThread)
+    {
+        systems[index]->readyOnMain.store(true, std::memory_order_release);
+        return;
+    }
+    activeJobSystem->Schedule([this, index]() { Execute(index); }, &runCounter);
+}
+
+/**
+ * @brief Runs a system and releases the systems waiting on it.
+ *
+ * @param index The system.
+ */
+void SystemScheduler::Execute(uint32_t index)
+{
+    SystemNode& node = *systems[index];
+    node.begin = std::chrono::steady_clock::now();
+    if (!runFailed.load(std::memory_order_acquire))
+    {
+        PROFILE_ZONE(node.profileName);
+        // Jobs can't throw, Run rethrows on the calling thread
+        try
+        {
+            node.function(runDt);
+        }
+        catch (...)
+        {
+            RecordError(std::current_exception());
+        }
+    }
+    node.end = std::chrono::steady_clock::now();
+
+    for (uint32_t successor : node.successors)
+    {
+        if (systems[successor]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            MakeReady(successor);
+        }
+    }
+    systemsLeft.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Keeps the first exception of the run, later ones are dropped.
+ *
+ * @param error What a system threw.
+ */
+void SystemScheduler::RecordError(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (!runError)
+    {
+        runError = std::move(error);
+        runFailed.store(true, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Records per-system durations and finds the critical path of the run.
+ *
+ * @param runBegin When the run started.
+ */
+void SystemScheduler::UpdateStats(std::chrono::steady_clock::time_point runBegin)
+{
+    const uint32_t count = static_cast<uint32_t>(systems.size());
+    lastRunMs = Milliseconds(std::chrono::steady_clock::now() - runBegin);
+
+    // Systems are registered in topological order, so one forward pass finds the longest chain
+    ScratchScope scratch;
+    std::pmr::vector<double> pathMs(count, scratch.GetResource());
+    std::pmr::vector<uint32_t> parent(count, UINT32_MAX, scratch.GetResource());
+    for (uint32_t i = 0; i < count; i++)
+    {
+        SystemNode& node = *systems[i];
+        node.lastMs = Milliseconds(node.end - node.begin);
+        node.totalMs += node.lastMs;
+        node.runs++;
+        pathMs[i] = node.lastMs;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (uint32_t successor : systems[i]->successors)
+        {
+            double through = pathMs[i] + systems[successor]->lastMs;
+            if (through > pathMs[successor])
+            {
+                pathMs[successor] = through;
+                parent[successor] = i;
+            }
+        }
+    }
+
+    uint32_t last = static_cast<uint32_t>(std::max_element(pathMs.begin(), pathMs.end()) - pathMs.begin());
+    criticalPathMs = pathMs[last];
+    lastCriticalPath.clear();
+    for (uint32_t i = last; i != UINT32_MAX; i = parent[i])
+    {
+        lastCriticalPath.push_back(i);
+        systems[i]->criticalCount++;
+    }
+    std::reverse(lastCriticalPath.begin(), lastCriticalPath.end());
+
+    totalRunMs += lastRunMs;
+    totalCriticalPathMs += criticalPathMs;
+    runCount++;
+}
+
+/**
+ * @brief Per-system timings since startup.
+ *
+ * @return std::vector<SystemStats> One entry per system in registration order.
+ */
+std::vector<SystemStats> SystemScheduler::GetStats() const
+{
+    std::vector<SystemStats> stats;
+    stats.reserve(systems.size());
+    for (const auto& node : systems)
+    {
+        SystemStats entry;
+        entry.name = node->name;
+        entry.lastMs = node->lastMs;
+        entry.averageMs = node->runs ? node->totalMs / node->runs : 0.0;
+        entry.criticalCount = node->criticalCount;
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+/**
+ * @brief Writes the timing report.
+ *
+ * @param out Where to write it.
+ */
+void SystemScheduler::PrintReport(std::ostream& out) const
+{
+    if (runCount == 0)
+    {
+        return;
+    }
+
+    double systemMs = 0.0;
+    for (const auto& node : systems)
+    {
+        systemMs += node->totalMs;
+    }
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "[%s] %zu systems, %llu runs, avg run %.3f ms, avg critical path %.3f ms, parallelism %.2fx\n",
+        schedulerName.c_str(), systems.size(), static_cast<unsigned long long>(runCount),
+        totalRunMs / runCount, totalCriticalPathMs / runCount, totalRunMs > 0.0 ? systemMs / totalRunMs : 0.0);
+    out << line;
+
+    for (const auto& node : systems)
+    {
+        std::snprintf(line, sizeof(line), "    %-24s avg %8.3f ms  on critical path %5.1f%%%s\n",
+            node->name.c_str(), node->runs ? node->totalMs / node->runs : 0.0,
+            100.0 * node->criticalCount / runCount, node->mainThread ? "  (main thread)" : "");
+        out << line;
+    }
+
+    out << "    last critical path:";
+    for (uint32_t index : lastCriticalPath)
+    {
+        out << " " << systems[index]->name;
+    }
+    out << "\n";
+}
@@ -0,0 +1,202 @@
+/*****************************************************************//**
+ * \file   SystemScheduler.h
+ * \brief  Runs engine systems in parallel based on their declared data access
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "JobSystem.h"
+
+//one bit per component or resource type a system can touch
+constexpr uint32_t MAX_ACCESS_TYPES = 128;
+typedef std::bitset<MAX_ACCESS_TYPES> AccessMask;
+
+/**
+ * @brief Ids for anything systems read or write: components, the World itself,
+ * engine resources like the frame packet or the window.
+ */
+class AccessRegistry
+{
+public:
+    template <typename T>
+    static uint32_t GetId()
+    {
+        static const uint32_t id = NextId();
+        return id;
+    }
+
+private:
+    static uint32_t NextId();
+};
+
+//access declarations, e.g. AddSystem<Read<Transform>, Write<Velocity>>(...)
+template <typename... Ts> struct Read {};
+template <typename... Ts> struct Write {};
+
+namespace SystemAccess
+{
+    template <typename... Ts>
+    AccessMask MaskOf()
+    {
+        AccessMask mask;
+        (mask.set(AccessRegistry::GetId<Ts>()), ...);
+        return mask;
+    }
+
+    template <typename T> struct Traits;
+
+    template <typename... Ts>
+    struct Traits<Read<Ts...>>
+    {
+        static AccessMask Reads() { return MaskOf<Ts...>(); }
+        static AccessMask Writes() { return AccessMask(); }
+    };
+
+    template <typename... Ts>
+    struct Traits<Write<Ts...>>
+    {
+        static AccessMask Reads() { return AccessMask(); }
+        static AccessMask Writes() { return MaskOf<Ts...>(); }
+    };
+}
+
+//receives the dt of the phase the scheduler runs in
+typedef std::function<void(float)> SystemFunction;
+
+enum class SystemFlags : uint32_t
+{
+    None = 0,
+    //must run on the thread that calls Run (GLFW, OS events)
+    MainThread = 1,
+};
+
+/**
+ * @brief Timings of one system, averaged over all runs.
+ */
+struct SystemStats
+{
+    std::string name;
+    double lastMs = 0.0;
+    double averageMs = 0.0;
+    //how often the system was on the critical path
+    uint64_t criticalCount = 0;
+};
+
+/**
+ * @brief Orders systems into a DAG from their read/write sets: a system depends
+ * on every earlier system it conflicts with (write/write or read/write on the
+ * same type). Systems without a path between them run concurrently as jobs.
+ */
+class SystemScheduler
+{
+public:
+    explicit SystemScheduler(std::string name);
+
+    /**
+     * @brief Adds a system. Order of registration decides order between conflicting systems.
+     *
+     * @param name Shown in the timing report.
+     * @param function The system body.
+     * @param flags SystemFlags::MainThread to pin it to the calling thread.
+     */
+    template <typename... Access>
+    void AddSystem(const std::string& name, SystemFunction function, SystemFlags flags = SystemFlags::None)
+    {
+        AccessMask reads;
+        AccessMask writes;
+        ((reads |= SystemAccess::Traits<Access>::Reads()), ...);
+        ((writes |= SystemAccess::Traits<Access>::Writes()), ...);
+        AddSystem(name, reads, writes, std::move(function), flags);
+    }
+
+    void AddSystem(const std::string& name, const AccessMask& reads, const AccessMask& writes, SystemFunction function, SystemFlags flags);
+
+    /**
+     * @brief Runs every system once and waits for all of them, helping with jobs
+     * and running main thread systems on the calling thread. If a system throws,
+     * the systems that haven't started yet are skipped and the first exception is
+     * rethrown here once the rest have finished.
+     *
+     * @param jobSystem Where the systems run.
+     * @param dt Passed to every system.
+     */
+    void Run(JobSystem& jobSystem, float dt);
+
+    std::vector<SystemStats> GetStats() const;
+
+    //longest dependency chain of the last run, by duration
+    double GetCriticalPathMs() const { return criticalPathMs; }
+
+    //wall time of the last run
+    double GetLastRunMs() const { return lastRunMs; }
+
+    /**
+     * @brief Per-system averages, the critical path and how much parallelism was achieved.
+     */
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct SystemNode
+    {
+        std::string name;
+        //name as a CPU profiler zone
+        const char* profileName = nullptr;
+        AccessMask reads;
+        AccessMask writes;
+        SystemFunction function;
+        bool mainThread;
+        std::vector<uint32_t> successors;
+        uint32_t predecessorCount = 0;
+
+        //per run state
+        std::atomic<uint32_t> remaining{ 0 };
+        std::atomic<bool> readyOnMain{ false };
+        std::chrono::steady_clock::time_point begin;
+        std::chrono::steady_clock::time_point end;
+
+        //accumulated stats
+        double lastMs = 0.0;
+        double totalMs = 0.0;
+        uint64_t runs = 0;
+        uint64_t criticalCount = 0;
+    };
+
+    void BuildGraph();
+    void MakeReady(uint32_t index);
+    void Execute(uint32_t index);
+    void RecordError(std::exception_ptr error);
+    void UpdateStats(std::chrono::steady_clock::time_point runBegin);
+
+    std::string schedulerName;
+    std::vector<std::unique_ptr<SystemNode>> systems;
+    bool graphDirty;
+
+    //valid during Run
+    JobSystem* activeJobSystem;
+    JobCounter runCounter;
+    std::atomic<uint32_t> systemsLeft;
+    float runDt;
+    //first exception a system threw this run, rethrown by Run
+    std::mutex errorMutex;
+    std::exception_ptr runError;
+    std::atomic<bool> runFailed;
+
+    double criticalPathMs;
+    double lastRunMs;
+    double totalRunMs;
+    double totalCriticalPathMs;
+    uint64_t runCount;
+    std::vector<uint32_t> lastCriticalPath;
+};
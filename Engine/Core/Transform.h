@@ -0,0 +1,44 @@
+/*****************************************************************//**
+ * \file   Transform.h
+ * \brief  Position/rotation/scale of a simulated object
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+struct Transform
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    /**
+     * @brief Blends two simulation states for rendering between ticks.
+     *
+     * @param from State at the previous tick.
+     * @param to State at the current tick.
+     * @param alpha 0 gives from, 1 gives to.
+     * @return Transform The interpolated transform.
+     */
+    static Transform Interpolate(const Transform& from, const Transform& to, float alpha)
+    {
+        Transform result;
+        result.position = glm::mix(from.position, to.position, alpha);
+        result.rotation = glm::slerp(from.rotation, to.rotation, alpha);
+        result.scale = glm::mix(from.scale, to.scale, alpha);
+        return result;
+    }
+
+    glm::mat4 ToMatrix() const
+    {
+        glm::mat4 matrix = glm::mat4_cast(rotation);
+        matrix[0] *= scale.x;
+        matrix[1] *= scale.y;
+        matrix[2] *= scale.z;
+        matrix[3] = glm::vec4(position, 1.0f);
+        return matrix;
+    }
+};
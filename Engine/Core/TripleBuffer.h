@@ -0,0 +1,81 @@
+/*****************************************************************//**
+ * \file   TripleBuffer.h
+ * \brief  Lock-free single producer / single consumer triple buffer
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Three copies of T: one owned by the writer, one owned by the reader and
+ * one in the middle that they swap with a single atomic exchange. Neither side
+ * ever waits on the other to finish using its copy.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /**
+     * @brief The writer's private copy. Writer thread only.
+     */
+    T& WriteBuffer() { return buffers[writeIndex]; }
+
+    /**
+     * @brief Hands the write buffer to the reader and takes the middle one back.
+     * Writer thread only.
+     */
+    void Publish()
+    {
+        uint8_t previous = middle.exchange(writeIndex | DIRTY_BIT, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+        middle.notify_one();
+    }
+
+    /**
+     * @brief Blocks until the writer has published something the reader has not
+     * acquired yet. Reader thread only.
+     */
+    void WaitForPublish() const
+    {
+        uint8_t current = middle.load(std::memory_order_acquire);
+        while (!(current & DIRTY_BIT))
+        {
+            middle.wait(current, std::memory_order_acquire);
+            current = middle.load(std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * @brief Swaps the newest published buffer in for reading. Reader thread only.
+     *
+     * @return False if nothing new was published since the last call.
+     */
+    bool Acquire()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & DIRTY_BIT))
+        {
+            return false;
+        }
+        uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief The reader's private copy. Reader thread only.
+     */
+    const T& ReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY_BIT = 0x4;
+
+    T buffers[3];
+    uint8_t writeIndex = 0;
+    uint8_t readIndex = 1;
+    //index of the shared buffer plus a flag set when it holds unread data
+    std::atomic<uint8_t> middle{ 2 };
+};
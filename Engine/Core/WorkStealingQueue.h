@@ -0,0 +1,133 @@
+/*****************************************************************//**
+ * \file   WorkStealingQueue.h
+ * \brief  Lock-free Chase-Lev work-stealing deque used by the job system
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+struct Job;
+
+/**
+ * @brief Fixed capacity Chase-Lev deque.
+ *
+ * The owning thread pushes and pops at the bottom (LIFO, cache friendly),
+ * every other thread steals from the top (FIFO). Follows the C11 formulation
+ * from "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al.).
+ */
+class WorkStealingQueue
+{
+public:
+    static constexpr int64_t CAPACITY = 4096;
+
+    WorkStealingQueue() : top(0), bottom(0)
+    {
+        for (auto& slot : jobs)
+        {
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    WorkStealingQueue(const WorkStealingQueue&) = delete;
+    WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+    /**
+     * @brief Pushes a job at the bottom. Owner thread only.
+     *
+     * @param job The job to push.
+     * @return False if the queue is full.
+     */
+    bool Push(Job* job)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= CAPACITY)
+        {
+            return false;
+        }
+
+        jobs[b & MASK].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Pops the most recently pushed job. Owner thread only.
+     *
+     * @return The job, or nullptr if the queue is empty or the last job was stolen.
+     */
+    Job* Pop()
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // Empty, restore bottom
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = jobs[b & MASK].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // Last job, race against thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                job = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    /**
+     * @brief Steals the oldest job. Safe to call from any thread.
+     *
+     * @return The job, or nullptr if the queue is empty or another thief won.
+     */
+    Job* Steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+        {
+            return nullptr;
+        }
+
+        Job* job = jobs[t & MASK].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return job;
+    }
+
+    /**
+     * @brief Approximate number of queued jobs.
+     */
+    size_t Size() const
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+private:
+    static constexpr int64_t MASK = CAPACITY - 1;
+    static_assert((CAPACITY & MASK) == 0, "CAPACITY must be a power of two");
+
+    //thieves and owner hammer different ends, keep them on separate lines
+    alignas(64) std::atomic<int64_t> top;
+    alignas(64) std::atomic<int64_t> bottom;
+    alignas(64) std::atomic<Job*> jobs[CAPACITY];
+};
@@ -0,0 +1,456 @@
+/*****************************************************************//**
+ * \file   World.cpp
+ * \brief  Archetype based entity component storage
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "World.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include "EntityCommandBuffer.h"
+
+namespace
+{
+    std::array<ComponentInfo, MAX_COMPONENT_TYPES> componentInfos;
+    std::atomic<uint32_t> componentTypeCount{ 0 };
+    std::mutex registryMutex;
+
+    //destroys a component value that playback did not apply
+    void DiscardPayload(EntityCommand& command)
+    {
+        const ComponentInfo& info = ComponentRegistry::GetInfo(command.component);
+        if (info.destroy)
+        {
+            info.destroy(command.payload);
+        }
+        command.payload = nullptr;
+    }
+}
+
+/**
+ * @brief Assigns the next free id to a component type.
+ *
+ * @param info Size, alignment and lifetime functions of the type.
+ * @return ComponentTypeId The new id.
+ */
+ComponentTypeId ComponentRegistry::Register(const ComponentInfo& info)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint32_t id = componentTypeCount.load(std::memory_order_relaxed);
+    if (id >= MAX_COMPONENT_TYPES)
+    {
+        throw std::runtime_error("Too many component types!");
+    }
+    componentInfos[id] = info;
+    componentTypeCount.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+const ComponentInfo& ComponentRegistry::GetInfo(ComponentTypeId id)
+{
+    return componentInfos[id];
+}
+
+uint32_t ComponentRegistry::GetTypeCount()
+{
+    return componentTypeCount.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief World Constructor.
+ *
+ */
+World::World()
+    : aliveCount(0)
+{
+    // Entities without components still need somewhere to live
+    GetOrCreateArchetype(0);
+}
+
+/**
+ * @brief World Destructor.
+ *
+ */
+World::~World()
+{
+}
+
+/**
+ * @brief Destroys an entity and its components.
+ *
+ * @param entity The entity to destroy, ignored if already dead.
+ */
+void World::DestroyEntity(Entity entity)
+{
+    if (!IsAlive(entity))
+    {
+        return;
+    }
+
+    EntityRecord& record = records[entity.index];
+    Entity moved = record.archetype->RemoveRow(record.location, true);
+    if (moved.IsValid())
+    {
+        records[moved.index].location = record.location;
+    }
+
+    record.archetype = nullptr;
+    record.generation++;
+    freeIndices.push_back(entity.index);
+    aliveCount--;
+}
+
+/**
+ * @brief Hands out an index, reusing destroyed ones first.
+ *
+ * @return Entity The handle, not yet placed in any archetype.
+ */
+Entity World::AllocateEntity()
+{
+    Entity entity;
+    if (!freeIndices.empty())
+    {
+        entity.index = freeIndices.back();
+        freeIndices.pop_back();
+    }
+    else
+    {
+        entity.index = static_cast<uint32_t>(records.size());
+        records.emplace_back();
+    }
+    entity.generation = records[entity.index].generation;
+    aliveCount++;
+    return entity;
+}
+
+World::EntityRecord& World::GetRecord(Entity entity)
+{
+    if (!IsAlive(entity))
+    {
+        throw std::runtime_error("Using a destroyed entity!");
+    }
+    return records[entity.index];
+}
+
+void World::SetRecord(Entity entity, Archetype& archetype, Archetype::Location location)
+{
+    EntityRecord& record = records[entity.index];
+    record.archetype = &archetype;
+    record.location = location;
+}
+
+/**
+ * @brief Finds the archetype for a component mask, creating it if needed.
+ *
+ * @param mask The component set.
+ * @return Archetype& The archetype.
+ */
+Archetype& World::GetOrCreateArchetype(ComponentMask mask)
+{
+    auto it = archetypes.find(mask);
+    if (it != archetypes.end())
+    {
+        return *it->second;
+    }
+
+    auto archetype = std::make_unique<Archetype>(mask);
+    Archetype* pointer = archetype.get();
+    archetypes.emplace(mask, std::move(archetype));
+    archetypeList.push_back(pointer);
+    return *pointer;
+}
+
+Archetype& World::GetAddTarget(Archetype& source, ComponentTypeId id)
+{
+    if (!source.addEdges[id])
+    {
+        Archetype& target = GetOrCreateArchetype(source.GetMask() | (ComponentMask(1) << id));
+        source.addEdges[id] = &target;
+        target.removeEdges[id] = &source;
+    }
+    return *source.addEdges[id];
+}
+
+Archetype& World::GetRemoveTarget(Archetype& source, ComponentTypeId id)
+{
+    if (!source.removeEdges[id])
+    {
+        Archetype& target = GetOrCreateArchetype(source.GetMask() & ~(ComponentMask(1) << id));
+        source.removeEdges[id] = &target;
+        target.addEdges[id] = &source;
+    }
+    return *source.removeEdges[id];
+}
+
+/**
+ * @brief Moves an entity to another archetype. Components both archetypes share
+ * are moved over, components the target lacks are destroyed, components only the
+ * target has are left uninitialized for the caller.
+ *
+ * @param entity The entity to move.
+ * @param target The destination archetype.
+ */
+void World::MoveEntity(Entity entity, Archetype& target)
+{
+    EntityRecord& record = records[entity.index];
+    Archetype& source = *record.archetype;
+    Archetype::Location from = record.location;
+    Archetype::Location to = target.AllocateRow(entity);
+
+    for (ComponentTypeId id : source.GetComponentTypes())
+    {
+        const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+        void* component = source.GetComponent(from, id);
+        if (target.HasComponent(id))
+        {
+            info.moveConstruct(target.GetComponent(to, id), component);
+        }
+        if (info.destroy)
+        {
+            info.destroy(component);
+        }
+    }
+
+    Entity moved = source.RemoveRow(from, false);
+    if (moved.IsValid())
+    {
+        records[moved.index].location = from;
+    }
+    SetRecord(entity, target, to);
+}
+
+/**
+ * @brief Frees the index of an entity that never got placed in an archetype.
+ *
+ * @param entity The entity to release.
+ */
+void World::ReleaseEntity(Entity entity)
+{
+    EntityRecord& record = records[entity.index];
+    record.archetype = nullptr;
+    record.generation++;
+    freeIndices.push_back(entity.index);
+    aliveCount--;
+}
+
+/**
+ * @brief Applies recorded structural changes.
+ *
+ * @param buffers Buffers to apply.
+ * @param count Number of buffers.
+ */
+void World::ApplyCommands(EntityCommandBuffer* const* buffers, size_t count)
+{
+    // Placeholders from Spawn become real entities first, placed once their final archetype is known
+    playbackSpawns.clear();
+    playbackSpawnBase.resize(count);
+    for (size_t b = 0; b < count; b++)
+    {
+        playbackSpawnBase[b] = static_cast<uint32_t>(playbackSpawns.size());
+        for (uint32_t i = 0; i < buffers[b]->GetSpawnCount(); i++)
+        {
+            playbackSpawns.push_back(AllocateEntity());
+        }
+    }
+
+    // Group commands per entity in one pass, each group keeps recording order
+    playbackCommands.clear();
+    playbackGroups.clear();
+    for (size_t b = 0; b < count; b++)
+    {
+        std::vector<EntityCommand>& commands = buffers[b]->GetCommands();
+        for (EntityCommand& command : commands)
+        {
+            Entity entity = command.entity;
+            if (entity.generation == EntityCommandBuffer::PENDING_GENERATION)
+            {
+                if (entity.index >= buffers[b]->GetSpawnCount())
+                {
+                    throw std::runtime_error("Spawned entity used outside the command buffer that spawned it!");
+                }
+                entity = playbackSpawns[playbackSpawnBase[b] + entity.index];
+            }
+
+            // Stale handle, the entity died before playback
+            if (entity.index >= records.size() || records[entity.index].generation != entity.generation)
+            {
+                if (command.payload)
+                {
+                    DiscardPayload(command);
+                }
+                continue;
+            }
+
+            const uint32_t commandIndex = static_cast<uint32_t>(playbackCommands.size());
+            playbackCommands.push_back(PlaybackCommand{ &command, NO_PLAYBACK_INDEX });
+
+            EntityRecord& record = records[entity.index];
+            if (record.playbackGroup == NO_PLAYBACK_INDEX)
+            {
+                record.playbackGroup = static_cast<uint32_t>(playbackGroups.size());
+                playbackGroups.push_back(PlaybackGroup{ entity, commandIndex, commandIndex });
+            }
+            else
+            {
+                PlaybackGroup& group = playbackGroups[record.playbackGroup];
+                playbackCommands[group.last].next = commandIndex;
+                group.last = commandIndex;
+            }
+        }
+    }
+
+    playbackChanges.clear();
+    playbackValues.clear();
+    for (const PlaybackGroup& group : playbackGroups)
+    {
+        records[group.entity.index].playbackGroup = NO_PLAYBACK_INDEX;
+        ResolveCommands(group);
+    }
+
+    ApplyChanges();
+}
+
+/**
+ * @brief Collapses the commands of one entity into its final component set.
+ * Destroys are applied right away, everything else becomes a PlaybackChange.
+ *
+ * @param group The entity and its list of commands.
+ */
+void World::ResolveCommands(const PlaybackGroup& group)
+{
+    const Entity entity = group.entity;
+    // Spawn is always the first command recorded for its placeholder
+    const bool spawned = playbackCommands[group.first].command->type == EntityCommandType::Spawn;
+
+    ComponentMask mask = spawned ? 0 : records[entity.index].archetype->GetMask();
+    ComponentMask valueMask = 0;
+    std::array<EntityCommand*, MAX_COMPONENT_TYPES> values;
+    bool destroyed = false;
+
+    for (uint32_t i = group.first; i != NO_PLAYBACK_INDEX; i = playbackCommands[i].next)
+    {
+        EntityCommand& command = *playbackCommands[i].command;
+        const ComponentMask bit = ComponentMask(1) << command.component;
+        switch (command.type)
+        {
+        case EntityCommandType::Spawn:
+            break;
+        case EntityCommandType::Destroy:
+            destroyed = true;
+            break;
+        case EntityCommandType::AddComponent:
+            if (destroyed)
+            {
+                DiscardPayload(command);
+                break;
+            }
+            // Last value wins
+            if (valueMask & bit)
+            {
+                DiscardPayload(*values[command.component]);
+            }
+            mask |= bit;
+            valueMask |= bit;
+            values[command.component] = &command;
+            break;
+        case EntityCommandType::RemoveComponent:
+            mask &= ~bit;
+            if (valueMask & bit)
+            {
+                DiscardPayload(*values[command.component]);
+                valueMask &= ~bit;
+            }
+            break;
+        }
+    }
+
+    if (destroyed)
+    {
+        for (ComponentMask remaining = valueMask; remaining; remaining &= remaining - 1)
+        {
+            DiscardPayload(*values[std::countr_zero(remaining)]);
+        }
+        if (spawned)
+        {
+            ReleaseEntity(entity);
+        }
+        else
+        {
+            DestroyEntity(entity);
+        }
+        return;
+    }
+
+    Archetype* source = spawned ? nullptr : records[entity.index].archetype;
+    if (source && source->GetMask() == mask && !valueMask)
+    {
+        return;
+    }
+
+    PlaybackChange change{ entity, mask, source, static_cast<uint32_t>(playbackValues.size()), 0 };
+    for (ComponentMask remaining = valueMask; remaining; remaining &= remaining - 1)
+    {
+        playbackValues.push_back(values[std::countr_zero(remaining)]);
+        change.valueCount++;
+    }
+    playbackChanges.push_back(change);
+}
+
+/**
+ * @brief Moves every changed entity to its final archetype, grouped by destination
+ * so each archetype pair is looked up once and rows are appended back to back.
+ *
+ */
+void World::ApplyChanges()
+{
+    std::sort(playbackChanges.begin(), playbackChanges.end(), [](const PlaybackChange& a, const PlaybackChange& b)
+    {
+        if (a.targetMask != b.targetMask)
+        {
+            return a.targetMask < b.targetMask;
+        }
+        return std::less<Archetype*>()(a.source, b.source);
+    });
+
+    Archetype* target = nullptr;
+    for (const PlaybackChange& change : playbackChanges)
+    {
+        if (!target || target->GetMask() != change.targetMask)
+        {
+            target = &GetOrCreateArchetype(change.targetMask);
+        }
+
+        // Components kept from the old archetype get replaced, new ones constructed
+        ComponentMask existing = 0;
+        if (!change.source)
+        {
+            SetRecord(change.entity, *target, target->AllocateRow(change.entity));
+        }
+        else
+        {
+            existing = change.source->GetMask() & change.targetMask;
+            if (change.source != target)
+            {
+                MoveEntity(change.entity, *target);
+            }
+        }
+
+        const Archetype::Location location = records[change.entity.index].location;
+        for (uint32_t i = 0; i < change.valueCount; i++)
+        {
+            EntityCommand& command = *playbackValues[change.valueBegin + i];
+            const ComponentInfo& info = ComponentRegistry::GetInfo(command.component);
+            void* component = target->GetComponent(location, command.component);
+            if ((existing & (ComponentMask(1) << command.component)) && info.destroy)
+            {
+                info.destroy(component);
+            }
+            info.moveConstruct(component, command.payload);
+            DiscardPayload(command);
+        }
+    }
+}
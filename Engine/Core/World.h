@@ -0,0 +1,244 @@
+/*****************************************************************//**
+ * \file   World.h
+ * \brief  Archetype based entity component storage
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "Archetype.h"
+
+class EntityCommandBuffer;
+struct EntityCommand;
+
+class World
+{
+public:
+    World();
+    ~World();
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    /**
+     * @brief Creates an entity with the given components.
+     *
+     * @param components Initial component values, at most one of each type.
+     * @return Entity Handle to the new entity.
+     */
+    template <typename... Ts>
+    Entity CreateEntity(Ts&&... components)
+    {
+        Archetype& archetype = GetOrCreateArchetype(MakeMask<std::decay_t<Ts>...>());
+        Entity entity = AllocateEntity();
+        Archetype::Location location = archetype.AllocateRow(entity);
+        (ConstructComponent(archetype, location, std::forward<Ts>(components)), ...);
+        SetRecord(entity, archetype, location);
+        return entity;
+    }
+
+    /**
+     * @brief Destroys an entity and its components. Stale handles are ignored.
+     */
+    void DestroyEntity(Entity entity);
+
+    bool IsAlive(Entity entity) const
+    {
+        return entity.index < records.size() && records[entity.index].generation == entity.generation && records[entity.index].archetype;
+    }
+
+    /**
+     * @brief Adds or replaces a component, moving the entity to a new archetype.
+     */
+    template <typename T>
+    void AddComponent(Entity entity, T&& component)
+    {
+        using Component = std::decay_t<T>;
+        const ComponentTypeId id = ComponentRegistry::GetId<Component>();
+        EntityRecord& record = GetRecord(entity);
+
+        if (record.archetype->HasComponent(id))
+        {
+            *static_cast<Component*>(record.archetype->GetComponent(record.location, id)) = std::forward<T>(component);
+            return;
+        }
+
+        Archetype& target = GetAddTarget(*record.archetype, id);
+        MoveEntity(entity, target);
+        ConstructComponent(target, records[entity.index].location, std::forward<T>(component));
+    }
+
+    /**
+     * @brief Removes a component, moving the entity to a new archetype.
+     */
+    template <typename T>
+    void RemoveComponent(Entity entity)
+    {
+        const ComponentTypeId id = ComponentRegistry::GetId<T>();
+        EntityRecord& record = GetRecord(entity);
+        if (!record.archetype->HasComponent(id))
+        {
+            return;
+        }
+        MoveEntity(entity, GetRemoveTarget(*record.archetype, id));
+    }
+
+    /**
+     * @brief Component of an entity, nullptr if it has none. Invalidated by any
+     * structural change.
+     */
+    template <typename T>
+    T* GetComponent(Entity entity)
+    {
+        const ComponentTypeId id = ComponentRegistry::GetId<std::remove_const_t<T>>();
+        EntityRecord& record = GetRecord(entity);
+        if (!record.archetype->HasComponent(id))
+        {
+            return nullptr;
+        }
+        return static_cast<T*>(record.archetype->GetComponent(record.location, id));
+    }
+
+    template <typename T>
+    bool HasComponent(Entity entity) const
+    {
+        return IsAlive(entity) && records[entity.index].archetype->HasComponent(ComponentRegistry::GetId<T>());
+    }
+
+    /**
+     * @brief Calls function(count, entities, arrays...) once per chunk that has all
+     * of Ts. Use const T for components that are only read.
+     */
+    template <typename... Ts, typename F>
+    void EachChunk(F&& function)
+    {
+        const ComponentMask required = MakeMask<std::remove_const_t<Ts>...>();
+        for (Archetype* archetype : archetypeList)
+        {
+            if ((archetype->GetMask() & required) != required)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < archetype->GetChunkCount(); i++)
+            {
+                Archetype::Chunk& chunk = archetype->GetChunk(i);
+                function(chunk.count, const_cast<const Entity*>(archetype->GetEntities(chunk)), archetype->GetComponents<Ts>(chunk)...);
+            }
+        }
+    }
+
+    /**
+     * @brief Calls function(components&...) for every entity that has all of Ts.
+     * Walks the component arrays linearly, chunk by chunk.
+     */
+    template <typename... Ts, typename F>
+    void Each(F&& function)
+    {
+        EachChunk<Ts...>([&function](uint32_t count, const Entity*, Ts*... arrays)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                function(arrays[i]...);
+            }
+        });
+    }
+
+    /**
+     * @brief Applies recorded structural changes in one sorted pass: commands are
+     * grouped per entity and collapsed to a final component set, then entities are
+     * moved grouped by destination archetype. Use EntityCommandQueue::Playback.
+     *
+     * @param buffers Buffers to apply, not cleared.
+     * @param count Number of buffers.
+     */
+    void ApplyCommands(EntityCommandBuffer* const* buffers, size_t count);
+
+    uint32_t GetEntityCount() const { return aliveCount; }
+
+    size_t GetArchetypeCount() const { return archetypeList.size(); }
+
+    template <typename... Ts>
+    static ComponentMask MakeMask()
+    {
+        return (ComponentMask(0) | ... | ComponentRegistry::GetBit<Ts>());
+    }
+
+private:
+    static constexpr uint32_t NO_PLAYBACK_INDEX = UINT32_MAX;
+
+    struct EntityRecord
+    {
+        uint32_t generation = 0;
+        Archetype* archetype = nullptr;
+        Archetype::Location location{};
+        //group of this entity during command playback
+        uint32_t playbackGroup = NO_PLAYBACK_INDEX;
+    };
+
+    Entity AllocateEntity();
+    EntityRecord& GetRecord(Entity entity);
+    void SetRecord(Entity entity, Archetype& archetype, Archetype::Location location);
+    Archetype& GetOrCreateArchetype(ComponentMask mask);
+    Archetype& GetAddTarget(Archetype& source, ComponentTypeId id);
+    Archetype& GetRemoveTarget(Archetype& source, ComponentTypeId id);
+    void MoveEntity(Entity entity, Archetype& target);
+    void ReleaseEntity(Entity entity);
+    struct PlaybackGroup;
+    void ResolveCommands(const PlaybackGroup& group);
+    void ApplyChanges();
+
+    template <typename T>
+    static void ConstructComponent(Archetype& archetype, Archetype::Location location, T&& component)
+    {
+        using Component = std::decay_t<T>;
+        void* memory = archetype.GetComponent(location, ComponentRegistry::GetId<Component>());
+        new (memory) Component(std::forward<T>(component));
+    }
+
+    std::vector<EntityRecord> records;
+    std::vector<uint32_t> freeIndices;
+    uint32_t aliveCount;
+
+    std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> archetypes;
+    //stable iteration order for queries
+    std::vector<Archetype*> archetypeList;
+
+    //one command during playback, linked to the next command on the same entity
+    struct PlaybackCommand
+    {
+        EntityCommand* command;
+        uint32_t next;
+    };
+
+    //all commands on one entity, in recording order
+    struct PlaybackGroup
+    {
+        Entity entity;
+        uint32_t first;
+        uint32_t last;
+    };
+
+    //net effect of all commands on one entity
+    struct PlaybackChange
+    {
+        Entity entity;
+        ComponentMask targetMask;
+        Archetype* source;
+        //range in playbackValues of AddComponent commands whose value wins
+        uint32_t valueBegin;
+        uint32_t valueCount;
+    };
+
+    //playback scratch, kept to avoid reallocating every sync point
+    std::vector<PlaybackCommand> playbackCommands;
+    std::vector<PlaybackGroup> playbackGroups;
+    std::vector<PlaybackChange> playbackChanges;
+    std::vector<EntityCommand*> playbackValues;
+    std::vector<Entity> playbackSpawns;
+    //first playbackSpawns entry of each buffer
+    std::vector<uint32_t> playbackSpawnBase;
+};
@@ -0,0 +1,280 @@
+/*****************************************************************//**
+ * \file   BindlessDescriptors.cpp
+ * \brief  One global descriptor set of images, samplers and buffers, indexed from shaders
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "BindlessDescriptors.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    //indexed by BindlessType
+    constexpr VkDescriptorType DESCRIPTOR_TYPES[] =
+    {
+        VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+        VK_DESCRIPTOR_TYPE_SAMPLER,
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+    };
+    constexpr const char* TYPE_NAMES[] = { "images", "samplers", "buffers" };
+    static_assert(std::size(DESCRIPTOR_TYPES) == static_cast<size_t>(BindlessType::Count));
+    static_assert(std::size(TYPE_NAMES) == static_cast<size_t>(BindlessType::Count));
+}
+
+/**
+ * @param supported Vulkan 1.2 features the physical device reports.
+ * @return bool True if runtime sized, partially bound, update-after-bind arrays of
+ * every BindlessType can be indexed non-uniformly.
+ */
+bool BindlessDescriptors::IsSupported(const VkPhysicalDeviceVulkan12Features& supported)
+{
+    return supported.runtimeDescriptorArray && supported.descriptorBindingPartiallyBound &&
+        supported.descriptorBindingUpdateUnusedWhilePending && supported.descriptorBindingSampledImageUpdateAfterBind &&
+        supported.descriptorBindingStorageBufferUpdateAfterBind && supported.shaderSampledImageArrayNonUniformIndexing &&
+        supported.shaderStorageBufferArrayNonUniformIndexing;
+}
+
+void BindlessDescriptors::EnableFeatures(VkPhysicalDeviceVulkan12Features& features)
+{
+    features.descriptorIndexing = VK_TRUE;
+    features.runtimeDescriptorArray = VK_TRUE;
+    features.descriptorBindingPartiallyBound = VK_TRUE;
+    features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    // Also covers the sampler array
+    features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    features.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+}
+
+/**
+ * @brief Sizes the arrays to the device limits and creates the set.
+ *
+ * @param logicalDevice The logical device.
+ * @param physicalDevice Its physical device.
+ */
+void BindlessDescriptors::Init(VkDevice logicalDevice, VkPhysicalDevice physicalDevice)
+{
+    device = logicalDevice;
+
+    VkPhysicalDeviceVulkan12Properties properties12{};
+    properties12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &properties12;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    std::array<uint32_t, static_cast<size_t>(BindlessType::Count)> capacities =
+    {
+        std::min({ MAX_SAMPLED_IMAGES, properties12.maxPerStageDescriptorUpdateAfterBindSampledImages, properties12.maxDescriptorSetUpdateAfterBindSampledImages }),
+        std::min({ MAX_SAMPLERS, properties12.maxPerStageDescriptorUpdateAfterBindSamplers, properties12.maxDescriptorSetUpdateAfterBindSamplers }),
+        std::min({ MAX_STORAGE_BUFFERS, properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers, properties12.maxDescriptorSetUpdateAfterBindStorageBuffers }),
+    };
+    // Every array is visible to every stage, so all of them count towards one stage's limit. Images give way first
+    uint32_t resourceLimit = properties12.maxPerStageUpdateAfterBindResources;
+    uint32_t others = capacities[1] + capacities[2];
+    capacities[0] = std::min(capacities[0], resourceLimit > others ? resourceLimit - others : 0u);
+    if (std::find(capacities.begin(), capacities.end(), 0u) != capacities.end())
+    {
+        throw std::runtime_error("Device limits leave no room for bindless descriptors!");
+    }
+
+    std::array<VkDescriptorSetLayoutBinding, static_cast<size_t>(BindlessType::Count)> bindings{};
+    std::array<VkDescriptorBindingFlags, static_cast<size_t>(BindlessType::Count)> bindingFlags{};
+    std::array<VkDescriptorPoolSize, static_cast<size_t>(BindlessType::Count)> poolSizes{};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = DESCRIPTOR_TYPES[i];
+        bindings[i].descriptorCount = capacities[i];
+        bindings[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+        // Unused entries may be empty or stale, and written while frames in flight use the set
+        bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+        poolSizes[i] = { DESCRIPTOR_TYPES[i], capacities[i] };
+
+        pools[i] = {};
+        pools[i].stats.capacity = capacities[i];
+    }
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo{};
+    flagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    flagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &flagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+    if (vkAllocateDescriptorSets(device, &allocInfo, &set) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+}
+
+/**
+ * @brief Destroys the pool, which frees the set, and the layout.
+ *
+ */
+void BindlessDescriptors::Shutdown()
+{
+    if (pool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(device, pool, nullptr);
+        pool = VK_NULL_HANDLE;
+        set = VK_NULL_HANDLE;
+    }
+    if (setLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        setLayout = VK_NULL_HANDLE;
+    }
+    pendingRemovals.clear();
+}
+
+uint32_t BindlessDescriptors::AddImage(VkImageView imageView, VkImageLayout layout)
+{
+    uint32_t index = Allocate(BindlessType::SampledImage);
+    VkDescriptorImageInfo imageInfo{ VK_NULL_HANDLE, imageView, layout };
+    Write(BindlessType::SampledImage, index, &imageInfo, nullptr);
+    return index;
+}
+
+uint32_t BindlessDescriptors::AddSampler(VkSampler sampler)
+{
+    uint32_t index = Allocate(BindlessType::Sampler);
+    VkDescriptorImageInfo imageInfo{ sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED };
+    Write(BindlessType::Sampler, index, &imageInfo, nullptr);
+    return index;
+}
+
+uint32_t BindlessDescriptors::AddBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+    uint32_t index = Allocate(BindlessType::StorageBuffer);
+    VkDescriptorBufferInfo bufferInfo{ buffer, offset, range };
+    Write(BindlessType::StorageBuffer, index, nullptr, &bufferInfo);
+    return index;
+}
+
+/**
+ * @brief Queues an index for reuse. The descriptor itself is left as it is, partially
+ * bound arrays may hold stale entries as long as shaders don't read them.
+ *
+ * @param type Array the index is in.
+ * @param index Index returned by an Add call.
+ * @param value Frame timeline value after which nothing reads the index.
+ */
+void BindlessDescriptors::Remove(BindlessType type, uint32_t index, uint64_t value)
+{
+    pendingRemovals.push_back({ type, index, value });
+    BindlessTypeStats& stats = pools[static_cast<size_t>(type)].stats;
+    stats.used--;
+    stats.removed++;
+}
+
+/**
+ * @brief Frees the removed indices that are due, oldest first.
+ *
+ * @param completedValue Frame timeline value the GPU has reached.
+ */
+void BindlessDescriptors::Collect(uint64_t completedValue)
+{
+    while (!pendingRemovals.empty() && pendingRemovals.front().value <= completedValue)
+    {
+        const PendingRemoval& removal = pendingRemovals.front();
+        pools[static_cast<size_t>(removal.type)].freeIndices.push_back(removal.index);
+        pendingRemovals.pop_front();
+    }
+}
+
+void BindlessDescriptors::Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const
+{
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, 0, 1, &set, 0, nullptr);
+}
+
+/**
+ * @brief Writes one line per array.
+ *
+ * @param out Where to write it.
+ */
+void BindlessDescriptors::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    for (size_t i = 0; i < pools.size(); i++)
+    {
+        const BindlessTypeStats& stats = pools[i].stats;
+        std::snprintf(line, sizeof(line), "[Bindless] %-8s %u of %u in use, peak %u, %llu added, %llu removed\n",
+            TYPE_NAMES[i], stats.used, stats.capacity, stats.peakUsed,
+            static_cast<unsigned long long>(stats.added), static_cast<unsigned long long>(stats.removed));
+        out << line;
+    }
+}
+
+/**
+ * @brief Takes a free index, reusing removed ones before growing into the array.
+ *
+ * @param type Array to take it from.
+ * @return uint32_t The index.
+ */
+uint32_t BindlessDescriptors::Allocate(BindlessType type)
+{
+    IndexPool& indexPool = pools[static_cast<size_t>(type)];
+    uint32_t index;
+    if (!indexPool.freeIndices.empty())
+    {
+        index = indexPool.freeIndices.back();
+        indexPool.freeIndices.pop_back();
+    }
+    else if (indexPool.next < indexPool.stats.capacity)
+    {
+        index = indexPool.next++;
+    }
+    else
+    {
+        throw std::runtime_error("Bindless descriptor array is full!");
+    }
+    indexPool.stats.used++;
+    indexPool.stats.peakUsed = std::max(indexPool.stats.peakUsed, indexPool.stats.used);
+    indexPool.stats.added++;
+    return index;
+}
+
+void BindlessDescriptors::Write(BindlessType type, uint32_t index, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+{
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = set;
+    write.dstBinding = static_cast<uint32_t>(type);
+    write.dstArrayElement = index;
+    write.descriptorCount = 1;
+    write.descriptorType = DESCRIPTOR_TYPES[static_cast<size_t>(type)];
+    write.pImageInfo = imageInfo;
+    write.pBufferInfo = bufferInfo;
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
@@ -0,0 +1,168 @@
+/*****************************************************************//**
+ * \file   BindlessDescriptors.h
+ * \brief  One global descriptor set of images, samplers and buffers, indexed from shaders
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief What a bindless index refers to. Also the binding of its array in the set.
+ */
+enum class BindlessType : uint32_t
+{
+    //VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, binding 0
+    SampledImage,
+    //VK_DESCRIPTOR_TYPE_SAMPLER, binding 1
+    Sampler,
+    //VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, binding 2
+    StorageBuffer,
+    Count
+};
+
+/**
+ * @brief Counters of one BindlessType since startup.
+ */
+struct BindlessTypeStats
+{
+    //array size, after clamping to the device limits
+    uint32_t capacity = 0;
+    uint32_t used = 0;
+    uint32_t peakUsed = 0;
+    uint64_t added = 0;
+    uint64_t removed = 0;
+};
+
+/**
+ * @brief A single descriptor set holding every sampled image, sampler and storage
+ * buffer in large arrays (descriptor indexing, core since Vulkan 1.2). Resources are
+ * added once and get an index into their array, and shaders pick resources by
+ * index, so drawing binds this set once per command buffer instead of a set per
+ * draw or per material.
+ *
+ * Indices come from a free list per array. A removed index is only handed out
+ * again once the frame timeline has passed the last frame that may read it, see
+ * Collect. The set is created update-after-bind and partially bound, so adding
+ * and removing never waits for frames in flight. Render thread only.
+ */
+class BindlessDescriptors
+{
+public:
+    //array sizes requested, lowered to what the device allows
+    static constexpr uint32_t MAX_SAMPLED_IMAGES = 16384;
+    static constexpr uint32_t MAX_SAMPLERS = 256;
+    static constexpr uint32_t MAX_STORAGE_BUFFERS = 4096;
+
+    //stand-in for no resource, e.g. a material without a texture
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    BindlessDescriptors() = default;
+
+    BindlessDescriptors(const BindlessDescriptors&) = delete;
+    BindlessDescriptors& operator=(const BindlessDescriptors&) = delete;
+
+    /**
+     * @brief Checks for the descriptor indexing features the set needs.
+     *
+     * @param supported Vulkan 1.2 features the physical device reports.
+     */
+    static bool IsSupported(const VkPhysicalDeviceVulkan12Features& supported);
+
+    /**
+     * @brief Turns on the features IsSupported checks for, before device creation.
+     */
+    static void EnableFeatures(VkPhysicalDeviceVulkan12Features& features);
+
+    /**
+     * @param device The logical device, created with EnableFeatures.
+     * @param physicalDevice Its physical device, for the descriptor limits.
+     */
+    void Init(VkDevice device, VkPhysicalDevice physicalDevice);
+
+    /**
+     * @brief Destroys the set, its pool and layout. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Adds an image view to the sampled image array.
+     *
+     * @param layout Layout the image is in whenever a shader samples it.
+     * @return uint32_t Its index.
+     */
+    uint32_t AddImage(VkImageView imageView, VkImageLayout layout);
+
+    /**
+     * @return uint32_t Index of the sampler in the sampler array.
+     */
+    uint32_t AddSampler(VkSampler sampler);
+
+    /**
+     * @return uint32_t Index of the buffer range in the storage buffer array.
+     */
+    uint32_t AddBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range);
+
+    /**
+     * @brief Gives an index back. It may be reused once the GPU reaches value, so
+     * the resource can go to the deletion queue with the same value.
+     *
+     * @param value Frame timeline value after which nothing reads the index.
+     */
+    void Remove(BindlessType type, uint32_t index, uint64_t value);
+
+    /**
+     * @brief Returns removed indices the GPU is done with to their free lists.
+     *
+     * @param completedValue Frame timeline value the GPU has reached.
+     */
+    void Collect(uint64_t completedValue);
+
+    /**
+     * @brief Binds the set as set 0 of layout, which must be created with GetSetLayout there.
+     */
+    void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout) const;
+
+    VkDescriptorSetLayout GetSetLayout() const { return setLayout; }
+
+    VkDescriptorSet GetSet() const { return set; }
+
+    const BindlessTypeStats& GetStats(BindlessType type) const { return pools[static_cast<size_t>(type)].stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    //free list of one array
+    struct IndexPool
+    {
+        std::vector<uint32_t> freeIndices;
+        //indices below this were handed out at least once
+        uint32_t next = 0;
+        BindlessTypeStats stats;
+    };
+
+    struct PendingRemoval
+    {
+        BindlessType type;
+        uint32_t index;
+        uint64_t value;
+    };
+
+    uint32_t Allocate(BindlessType type);
+    void Write(BindlessType type, uint32_t index, const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo);
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkDescriptorSet set = VK_NULL_HANDLE;
+
+    std::array<IndexPool, static_cast<size_t>(BindlessType::Count)> pools;
+    //oldest first, values don't decrease
+    std::deque<PendingRemoval> pendingRemovals;
+};
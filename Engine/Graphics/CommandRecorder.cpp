@@ -0,0 +1,203 @@
+/*****************************************************************//**
+ * \file   CommandRecorder.cpp
+ * \brief  Per-thread, per-frame command pools and parallel secondary recording
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "CommandRecorder.h"
+#include <cstdio>
+
+/**
+ * @brief Creates framesInFlight * threadCount transient pools.
+ *
+ * @param logicalDevice The logical device.
+ * @param queueFamily Family the recorded buffers are submitted to.
+ * @param threads JobSystem::GetMaxThreads() of the recording job system.
+ * @param frames Frames whose command buffers can be pending at once.
+ */
+void CommandRecorder::Init(VkDevice logicalDevice, uint32_t queueFamily, uint32_t threads, uint32_t frames)
+{
+    device = logicalDevice;
+    threadCount = threads;
+    framesInFlight = frames;
+    currentFrame = 0;
+    pools = std::vector<ThreadPool>(static_cast<size_t>(threadCount) * framesInFlight);
+
+    // No RESET_COMMAND_BUFFER_BIT, buffers are only ever reset together with their pool
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    for (ThreadPool& pool : pools)
+    {
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &pool.pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create command pool!");
+        }
+    }
+}
+
+/**
+ * @brief Destroys every pool along with its buffers.
+ *
+ */
+void CommandRecorder::Shutdown()
+{
+    for (ThreadPool& pool : pools)
+    {
+        if (pool.pool != VK_NULL_HANDLE)
+        {
+            vkDestroyCommandPool(device, pool.pool, nullptr);
+        }
+    }
+    pools.clear();
+    secondaries.clear();
+}
+
+/**
+ * @brief Resets all of the frame's pools and makes them current.
+ *
+ * @param frame Frame in flight index.
+ */
+void CommandRecorder::BeginFrame(uint32_t frame)
+{
+    currentFrame = frame;
+    for (uint32_t thread = 0; thread < threadCount; thread++)
+    {
+        ThreadPool& pool = pools[static_cast<size_t>(currentFrame) * threadCount + thread];
+        // Untouched pools have nothing to reset
+        if (pool.primariesUsed == 0 && pool.secondariesUsed == 0)
+        {
+            continue;
+        }
+        if (vkResetCommandPool(device, pool.pool, 0) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to reset command pool!");
+        }
+        pool.primariesUsed = 0;
+        pool.secondariesUsed = 0;
+    }
+    stats.frames++;
+}
+
+/**
+ * @brief A primary buffer from the calling thread's pool.
+ *
+ * @return VkCommandBuffer Buffer ready for vkBeginCommandBuffer.
+ */
+VkCommandBuffer CommandRecorder::AllocatePrimary()
+{
+    VkCommandBuffer commandBuffer = NextBuffer(GetThreadPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    if (commandBuffer == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("failed to allocate command buffers!");
+    }
+    stats.primaryBuffers++;
+    return commandBuffer;
+}
+
+CommandRecorderStats CommandRecorder::GetStats() const
+{
+    CommandRecorderStats current = stats;
+    current.allocatedBuffers = 0;
+    for (const ThreadPool& pool : pools)
+    {
+        current.allocatedBuffers += static_cast<uint32_t>(pool.primaries.size() + pool.secondaries.size());
+    }
+    return current;
+}
+
+/**
+ * @brief Writes how many buffers were recorded and how many that took allocating.
+ *
+ * @param out Where to write it.
+ */
+void CommandRecorder::PrintReport(std::ostream& out) const
+{
+    CommandRecorderStats current = GetStats();
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Command recording] %llu frames, %llu split across threads, %llu secondary buffers, %u buffers in %zu pools\n",
+        static_cast<unsigned long long>(current.frames), static_cast<unsigned long long>(current.parallelFrames),
+        static_cast<unsigned long long>(current.secondaryBuffers), current.allocatedBuffers, pools.size());
+    out << line;
+}
+
+/**
+ * @brief The calling thread's pool for the current frame.
+ *
+ * @return ThreadPool& Pool no other thread touches this frame.
+ */
+CommandRecorder::ThreadPool& CommandRecorder::GetThreadPool()
+{
+    int thread = JobSystem::GetThreadIndex();
+    if (thread < 0 || static_cast<uint32_t>(thread) >= threadCount)
+    {
+        throw std::runtime_error("Command recording thread is not registered with the job system!");
+    }
+    return pools[static_cast<size_t>(currentFrame) * threadCount + thread];
+}
+
+/**
+ * @brief Reuses a buffer reset with the pool, or allocates one the first time.
+ *
+ * @param pool Calling thread's pool.
+ * @param level Primary or secondary.
+ * @return VkCommandBuffer The buffer, null if allocation failed.
+ */
+VkCommandBuffer CommandRecorder::NextBuffer(ThreadPool& pool, VkCommandBufferLevel level)
+{
+    bool primary = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    std::vector<VkCommandBuffer>& buffers = primary ? pool.primaries : pool.secondaries;
+    uint32_t& used = primary ? pool.primariesUsed : pool.secondariesUsed;
+
+    if (used == buffers.size())
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = pool.pool;
+        allocInfo.level = level;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+        {
+            return VK_NULL_HANDLE;
+        }
+        buffers.push_back(commandBuffer);
+    }
+    return buffers[used++];
+}
+
+/**
+ * @brief Begins a secondary buffer from the calling thread's pool.
+ *
+ * @param inheritance Render pass state the buffer continues.
+ * @return VkCommandBuffer Buffer being recorded, null on failure.
+ */
+VkCommandBuffer CommandRecorder::BeginSecondary(const VkCommandBufferInheritanceInfo& inheritance)
+{
+    int thread = JobSystem::GetThreadIndex();
+    if (thread < 0 || static_cast<uint32_t>(thread) >= threadCount)
+    {
+        return VK_NULL_HANDLE;
+    }
+    ThreadPool& pool = pools[static_cast<size_t>(currentFrame) * threadCount + thread];
+    VkCommandBuffer commandBuffer = NextBuffer(pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    if (commandBuffer == VK_NULL_HANDLE)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritance;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        return VK_NULL_HANDLE;
+    }
+    return commandBuffer;
+}
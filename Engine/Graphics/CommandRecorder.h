@@ -0,0 +1,166 @@
+/*****************************************************************//**
+ * \file   CommandRecorder.h
+ * \brief  Per-thread, per-frame command pools and parallel secondary recording
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Counters since startup.
+ */
+struct CommandRecorderStats
+{
+    uint64_t frames = 0;
+    uint64_t primaryBuffers = 0;
+    uint64_t secondaryBuffers = 0;
+    //frames whose draws were split across jobs
+    uint64_t parallelFrames = 0;
+    //command buffers allocated over all pools, reused every frame after that
+    uint32_t allocatedBuffers = 0;
+};
+
+/**
+ * @brief Owns one command pool per job system thread per frame in flight, so
+ * threads record without ever sharing a pool, and a finished frame's pools are
+ * reset with one vkResetCommandPool each instead of buffer by buffer.
+ *
+ * RecordSecondary splits a draw range into batches, records each batch into a
+ * secondary command buffer on whichever thread runs the job, and returns them in
+ * draw order for the primary to execute. Every recording thread must be
+ * registered with the job system.
+ */
+class CommandRecorder
+{
+public:
+    //fewer draws than this aren't worth a job and a secondary buffer of their own
+    static constexpr uint32_t MIN_DRAWS_PER_JOB = 512;
+
+    CommandRecorder() = default;
+
+    CommandRecorder(const CommandRecorder&) = delete;
+    CommandRecorder& operator=(const CommandRecorder&) = delete;
+
+    /**
+     * @param device The logical device.
+     * @param queueFamily Family the recorded buffers are submitted to.
+     * @param threadCount JobSystem::GetMaxThreads() of the recording job system.
+     * @param framesInFlight Frames whose command buffers can be pending at once.
+     */
+    void Init(VkDevice device, uint32_t queueFamily, uint32_t threadCount, uint32_t framesInFlight);
+
+    /**
+     * @brief Destroys every pool. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Resets all of the frame's pools and makes them current. Call once the
+     * GPU is done with the buffers recorded the last time this frame was current.
+     *
+     * @param frame Frame in flight index.
+     */
+    void BeginFrame(uint32_t frame);
+
+    /**
+     * @brief A primary buffer from the calling thread's pool, valid until the frame
+     * is begun again.
+     */
+    VkCommandBuffer AllocatePrimary();
+
+    /**
+     * @brief True if drawCount is large enough to record across threads.
+     */
+    static bool ShouldSplit(uint32_t drawCount) { return drawCount >= 2 * MIN_DRAWS_PER_JOB; }
+
+    /**
+     * @brief Records [0, drawCount) into secondary buffers in parallel and waits.
+     *
+     * @param jobs Job system the batches run on.
+     * @param inheritance Render pass, subpass and framebuffer the buffers execute in.
+     * @param drawCount Draws to record.
+     * @param recordDraws Callable with signature void(VkCommandBuffer, uint32_t begin,
+     * uint32_t end), called concurrently. It must set all state the draws need,
+     * secondary buffers inherit none.
+     * @return const std::vector<VkCommandBuffer>& Buffers in draw order, valid until
+     * the next call.
+     */
+    template <typename F>
+    const std::vector<VkCommandBuffer>& RecordSecondary(JobSystem& jobs, const VkCommandBufferInheritanceInfo& inheritance, uint32_t drawCount, const F& recordDraws)
+    {
+        // About one batch per thread, as the primary pays for every buffer it executes
+        uint32_t threads = jobs.GetThreadCount();
+        uint32_t batchSize = std::max(MIN_DRAWS_PER_JOB, (drawCount + threads - 1) / threads);
+        uint32_t batchCount = (drawCount + batchSize - 1) / batchSize;
+        secondaries.assign(batchCount, VK_NULL_HANDLE);
+
+        std::atomic<bool> failed{ false };
+        auto recordBatch = [&](uint32_t begin, uint32_t end)
+        {
+            VkCommandBuffer commandBuffer = BeginSecondary(inheritance);
+            if (commandBuffer == VK_NULL_HANDLE)
+            {
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+            recordDraws(commandBuffer, begin, end);
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+            {
+                failed.store(true, std::memory_order_relaxed);
+            }
+            secondaries[begin / batchSize] = commandBuffer;
+        };
+
+        JobCounter counter;
+        jobs.ParallelFor(drawCount, batchSize, recordBatch, &counter);
+        // Only our own batches, the render thread mustn't pick up simulation work
+        jobs.WaitForOwnJobs(counter);
+
+        // Jobs can't throw, report failures from the calling thread
+        if (failed.load(std::memory_order_relaxed))
+        {
+            throw std::runtime_error("failed to record secondary command buffer!");
+        }
+        stats.secondaryBuffers += batchCount;
+        stats.parallelFrames++;
+        return secondaries;
+    }
+
+    CommandRecorderStats GetStats() const;
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    //one thread's pool for one frame, padded so threads never share a cache line
+    struct alignas(64) ThreadPool
+    {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> primaries;
+        uint32_t primariesUsed = 0;
+        std::vector<VkCommandBuffer> secondaries;
+        uint32_t secondariesUsed = 0;
+    };
+
+    ThreadPool& GetThreadPool();
+    VkCommandBuffer NextBuffer(ThreadPool& pool, VkCommandBufferLevel level);
+    //null on failure, called from jobs
+    VkCommandBuffer BeginSecondary(const VkCommandBufferInheritanceInfo& inheritance);
+
+    VkDevice device = VK_NULL_HANDLE;
+    uint32_t threadCount = 0;
+    uint32_t framesInFlight = 0;
+    uint32_t currentFrame = 0;
+    //framesInFlight * threadCount, indexed frame major
+    std::vector<ThreadPool> pools;
+    //result of the last RecordSecondary
+    std::vector<VkCommandBuffer> secondaries;
+    CommandRecorderStats stats;
+};
@@ -0,0 +1,261 @@
+/*****************************************************************//**
+ * \file   DebugOverlay.cpp
+ * \brief  ImGui performance overlay drawn in a render graph pass of its own
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "DebugOverlay.h"
+#include "GpuProfiler.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "RenderGraph.h"
+#include "imgui.h"
+#include "imgui_impl_vulkan.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+/**
+ * @brief Creates the ImGui context, its pipeline against the overlay pass and the
+ * font texture.
+ *
+ * @param instance The Vulkan instance.
+ * @param physicalDevice The physical device.
+ * @param logicalDevice The logical device.
+ * @param queueFamily Family of queue.
+ * @param queue Graphics queue the font upload is submitted to.
+ * @param renderPass Render pass of the graph pass the overlay is recorded in.
+ * @param framesInFlight Vertex and index buffers ImGui keeps, one per frame in flight.
+ * @param pipelineCache Cache for ImGui's pipeline, may be VK_NULL_HANDLE.
+ */
+void DebugOverlay::Init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t queueFamily, VkQueue queue,
+    VkRenderPass renderPass, uint32_t framesInFlight, VkPipelineCache pipelineCache)
+{
+    device = logicalDevice;
+
+    // Only the font texture is ever bound, ImGui frees its set at shutdown
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create debug overlay descriptor pool!");
+    }
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    // Nothing to restore between runs
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    ImGui::StyleColorsDark();
+
+    ImGui_ImplVulkan_InitInfo initInfo{};
+    initInfo.Instance = instance;
+    initInfo.PhysicalDevice = physicalDevice;
+    initInfo.Device = device;
+    initInfo.QueueFamily = queueFamily;
+    initInfo.Queue = queue;
+    initInfo.DescriptorPool = descriptorPool;
+    initInfo.RenderPass = renderPass;
+    initInfo.MinImageCount = std::max(framesInFlight, 2u);
+    initInfo.ImageCount = initInfo.MinImageCount;
+    initInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
+    initInfo.PipelineCache = pipelineCache;
+    if (!ImGui_ImplVulkan_Init(&initInfo) || !ImGui_ImplVulkan_CreateFontsTexture())
+    {
+        ImGui::DestroyContext();
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+        throw std::runtime_error("failed to initialize the debug overlay!");
+    }
+
+    history.assign(HISTORY_SIZE, 0.0f);
+    historyNext = 0;
+    lastSample = {};
+    stats = {};
+}
+
+/**
+ * @brief Destroys the ImGui context and its Vulkan objects. The device must be idle.
+ */
+void DebugOverlay::Shutdown()
+{
+    if (descriptorPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    ImGui_ImplVulkan_Shutdown();
+    ImGui::DestroyContext();
+    vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    descriptorPool = VK_NULL_HANDLE;
+}
+
+/**
+ * @brief Lays out this frame's overlay and measures what that cost.
+ *
+ * @param frame What was drawn this frame.
+ * @param extent Size of the image the overlay is drawn into.
+ * @param graph Its passes are listed with their CPU and GPU times.
+ * @param profiler GPU time per pass, from a few frames ago.
+ * @param jobs Worker utilization.
+ * @param allocator Heap usage.
+ */
+void DebugOverlay::Build(const DebugOverlayFrame& frame, VkExtent2D extent, const RenderGraph& graph, const GpuProfiler& profiler,
+    const JobSystem& jobs, const GpuAllocator& allocator)
+{
+    PROFILE_FUNCTION();
+    auto buildBegin = std::chrono::steady_clock::now();
+
+    if (frame.frameMilliseconds > 0.0)
+    {
+        history[historyNext] = static_cast<float>(frame.frameMilliseconds);
+        historyNext = (historyNext + 1) % HISTORY_SIZE;
+    }
+    if (buildBegin - lastSample >= SAMPLE_INTERVAL)
+    {
+        SampleCounters(jobs, allocator, buildBegin);
+    }
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(extent.width), static_cast<float>(extent.height));
+    io.DeltaTime = std::max(static_cast<float>(frame.frameMilliseconds) * 0.001f, 1e-4f);
+    ImGui_ImplVulkan_NewFrame();
+    ImGui::NewFrame();
+
+    const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoInputs |
+        ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+    ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f));
+    ImGui::SetNextWindowBgAlpha(0.75f);
+    ImGui::Begin("Performance", nullptr, flags);
+
+    // Frame times, scaled so a spike stays on the graph
+    float maxMilliseconds = *std::max_element(history.begin(), history.end());
+    ImGui::Text("Frame %.2f ms (%.0f fps), GPU %.2f ms", frame.frameMilliseconds,
+        frame.frameMilliseconds > 0.0 ? 1000.0 / frame.frameMilliseconds : 0.0, profiler.GetLatestFrameMilliseconds());
+    ImGui::PlotLines("##frameTimes", history.data(), static_cast<int>(HISTORY_SIZE), static_cast<int>(historyNext), nullptr,
+        0.0f, std::max(maxMilliseconds * 1.1f, 1.0f), ImVec2(320.0f, 60.0f));
+    ImGui::Text("%u objects, %u draws, %llu triangles", frame.objects, frame.draws, static_cast<unsigned long long>(frame.triangles));
+
+    // GPU times trail by the frames in flight, matched to passes by scope name
+    ImGui::Separator();
+    if (ImGui::BeginTable("passes", 3, ImGuiTableFlags_SizingFixedFit))
+    {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableHeadersRow();
+        const std::vector<GpuScopeSample>& samples = profiler.GetLatestFrame();
+        for (const RenderGraphPass* pass : graph.GetPasses())
+        {
+            if (!pass->IsEnabled())
+            {
+                continue;
+            }
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(pass->GetName().c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", pass->GetCpuMilliseconds());
+            ImGui::TableNextColumn();
+            auto sample = std::find_if(samples.begin(), samples.end(),
+                [&](const GpuScopeSample& s) { return profiler.GetScopeName(s.scope) == pass->GetName(); });
+            if (sample != samples.end())
+            {
+                ImGui::Text("%.3f", sample->milliseconds);
+            }
+            else
+            {
+                ImGui::TextUnformatted("-");
+            }
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::Separator();
+    char label[64];
+    for (size_t i = 0; i < workerUtilization.size(); i++)
+    {
+        std::snprintf(label, sizeof(label), "Worker %zu %.0f%%", i + 1, workerUtilization[i] * 100.0f);
+        ImGui::ProgressBar(workerUtilization[i], ImVec2(320.0f, 0.0f), label);
+    }
+
+    ImGui::Separator();
+    for (size_t i = 0; i < heaps.size(); i++)
+    {
+        const GpuHeapStats& heap = heaps[i];
+        if (heap.heapSize == 0)
+        {
+            continue;
+        }
+        ImGui::Text("Heap %zu (%s): %.1f used, %.1f reserved of %.0f MB", i,
+            (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "device" : "host",
+            heap.used / (1024.0 * 1024.0), heap.reserved / (1024.0 * 1024.0), heap.heapSize / (1024.0 * 1024.0));
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Overlay build %.3f ms, avg %.3f", stats.lastBuildMilliseconds, stats.AverageBuildMilliseconds());
+    ImGui::End();
+    ImGui::Render();
+
+    double buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildBegin).count();
+    stats.frames++;
+    stats.totalBuildMilliseconds += buildMilliseconds;
+    stats.lastBuildMilliseconds = buildMilliseconds;
+    stats.maxBuildMilliseconds = std::max(stats.maxBuildMilliseconds, buildMilliseconds);
+}
+
+/**
+ * @brief Records the draws of the last Build.
+ *
+ * @param commandBuffer Inside the overlay pass's render pass.
+ */
+void DebugOverlay::Record(VkCommandBuffer commandBuffer)
+{
+    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
+}
+
+void DebugOverlay::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Debug overlay] %llu frames drawn, build avg %.3f ms, max %.3f ms\n",
+        static_cast<unsigned long long>(stats.frames), stats.AverageBuildMilliseconds(), stats.maxBuildMilliseconds);
+    out << line;
+}
+
+/**
+ * @brief Turns the job threads' idle time since the last sample into utilization
+ * and copies the heap usage.
+ *
+ * @param now Time of this sample.
+ */
+void DebugOverlay::SampleCounters(const JobSystem& jobs, const GpuAllocator& allocator, std::chrono::steady_clock::time_point now)
+{
+    // Thread 0 is the main thread, it runs systems between jobs so idle time means nothing there
+    const uint32_t threads = jobs.GetThreadCount();
+    const double elapsed = std::chrono::duration<double>(now - lastSample).count();
+    const bool first = lastIdleSeconds.size() != threads;
+    lastIdleSeconds.resize(threads, 0.0);
+    workerUtilization.resize(threads > 0 ? threads - 1 : 0, 0.0f);
+    for (uint32_t thread = 1; thread < threads; thread++)
+    {
+        double idle = jobs.GetIdleSeconds(thread);
+        if (!first && elapsed > 0.0)
+        {
+            double busy = 1.0 - (idle - lastIdleSeconds[thread]) / elapsed;
+            workerUtilization[thread - 1] = static_cast<float>(std::clamp(busy, 0.0, 1.0));
+        }
+        lastIdleSeconds[thread] = idle;
+    }
+
+    heaps = allocator.GetHeapStats();
+    lastSample = now;
+}
@@ -0,0 +1,129 @@
+/*****************************************************************//**
+ * \file   DebugOverlay.h
+ * \brief  ImGui performance overlay drawn in a render graph pass of its own
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "GpuAllocator.h"
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+class GpuProfiler;
+class JobSystem;
+class RenderGraph;
+
+/**
+ * @brief What the renderer drew this frame, gathered by VulkanRender.
+ */
+struct DebugOverlayFrame
+{
+    //render thread time since the previous frame started, 0 if that frame didn't
+    //show the overlay
+    double frameMilliseconds = 0.0;
+    uint32_t objects = 0;
+    uint32_t draws = 0;
+    //submitted to the main pass, before GPU culling
+    uint64_t triangles = 0;
+};
+
+/**
+ * @brief Frames the overlay was drawn in and what building them cost on the CPU.
+ * Its GPU cost is the "Overlay" scope of the GPU profiler.
+ */
+struct DebugOverlayStats
+{
+    uint64_t frames = 0;
+    double totalBuildMilliseconds = 0.0;
+    double lastBuildMilliseconds = 0.0;
+    double maxBuildMilliseconds = 0.0;
+
+    double AverageBuildMilliseconds() const { return frames > 0 ? totalBuildMilliseconds / frames : 0.0; }
+};
+
+/**
+ * @brief Frame time graph, CPU and GPU time per render graph pass, job worker
+ * utilization, GPU heap usage and draw counts, drawn with ImGui in front of the
+ * scene. The overlay only displays, it takes no input: GLFW input is main thread
+ * only and the overlay is built on the render thread, so the ImGui GLFW backend
+ * isn't used and display size and time step are fed in directly.
+ *
+ * Nothing runs while it is hidden, the caller skips Build and the graph skips the
+ * overlay pass. Counters that need a delta, or cost an allocation to read, are
+ * sampled every SAMPLE_INTERVAL rather than every frame. Render thread only.
+ */
+class DebugOverlay
+{
+public:
+    //frames in the frame time graph
+    static constexpr uint32_t HISTORY_SIZE = 240;
+    //worker utilization and heap usage refresh rate
+    static constexpr std::chrono::milliseconds SAMPLE_INTERVAL{ 250 };
+
+    DebugOverlay() = default;
+
+    DebugOverlay(const DebugOverlay&) = delete;
+    DebugOverlay& operator=(const DebugOverlay&) = delete;
+
+    /**
+     * @brief Creates the ImGui context and its Vulkan objects and uploads the font,
+     * waiting on the queue. Call before the render thread starts.
+     *
+     * @param renderPass Render pass of the graph pass the overlay is recorded in.
+     * @param framesInFlight Vertex and index buffers ImGui keeps, one per frame in flight.
+     * @param pipelineCache Cache for ImGui's pipeline, may be VK_NULL_HANDLE.
+     */
+    void Init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, VkQueue queue,
+        VkRenderPass renderPass, uint32_t framesInFlight, VkPipelineCache pipelineCache);
+
+    /**
+     * @brief Destroys the ImGui context and its Vulkan objects. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Lays out this frame's overlay. Call only in frames that draw it,
+     * before recording the overlay pass.
+     *
+     * @param frame What was drawn this frame.
+     * @param extent Size of the image the overlay is drawn into.
+     */
+    void Build(const DebugOverlayFrame& frame, VkExtent2D extent, const RenderGraph& graph, const GpuProfiler& profiler,
+        const JobSystem& jobs, const GpuAllocator& allocator);
+
+    /**
+     * @brief Records the draws of the last Build.
+     *
+     * @param commandBuffer Inside the overlay pass's render pass.
+     */
+    void Record(VkCommandBuffer commandBuffer);
+
+    bool IsInitialized() const { return descriptorPool != VK_NULL_HANDLE; }
+
+    const DebugOverlayStats& GetStats() const { return stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    void SampleCounters(const JobSystem& jobs, const GpuAllocator& allocator, std::chrono::steady_clock::time_point now);
+
+    VkDevice device = VK_NULL_HANDLE;
+    //holds the font texture's descriptor set
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+    //ring of frame times in milliseconds, historyNext is the oldest
+    std::vector<float> history;
+    uint32_t historyNext = 0;
+
+    std::chrono::steady_clock::time_point lastSample;
+    //idle seconds of each job thread at lastSample
+    std::vector<double> lastIdleSeconds;
+    //busy fraction of each job worker over the last interval
+    std::vector<float> workerUtilization;
+    std::vector<GpuHeapStats> heaps;
+
+    DebugOverlayStats stats;
+};
@@ -0,0 +1,193 @@
+/*****************************************************************//**
+ * \file   DeletionQueue.cpp
+ * \brief  Vulkan objects destroyed once the GPU has passed the last frame using them
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "DeletionQueue.h"
+#include <algorithm>
+#include <cstdio>
+#include <type_traits>
+
+namespace
+{
+    template <typename Handle>
+    uint64_t ToBits(Handle handle)
+    {
+        if constexpr (std::is_pointer_v<Handle>)
+        {
+            return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+        }
+        else
+        {
+            return static_cast<uint64_t>(handle);
+        }
+    }
+
+    template <typename Handle>
+    Handle FromBits(uint64_t bits)
+    {
+        if constexpr (std::is_pointer_v<Handle>)
+        {
+            return reinterpret_cast<Handle>(static_cast<uintptr_t>(bits));
+        }
+        else
+        {
+            return static_cast<Handle>(bits);
+        }
+    }
+}
+
+/**
+ * @param logicalDevice The logical device.
+ * @param gpuAllocator Memory queued with a buffer or image goes back here.
+ */
+void DeletionQueue::Init(VkDevice logicalDevice, GpuAllocator& gpuAllocator)
+{
+    device = logicalDevice;
+    allocator = &gpuAllocator;
+    entries.clear();
+    stats = {};
+}
+
+/**
+ * @brief Destroys everything still queued.
+ *
+ */
+void DeletionQueue::Shutdown()
+{
+    if (device == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    Collect(UINT64_MAX);
+    device = VK_NULL_HANDLE;
+}
+
+void DeletionQueue::Destroy(VkBuffer buffer, GpuAllocation& allocation, uint64_t value)
+{
+    Push(HandleType::Buffer, buffer, &allocation, value);
+}
+
+void DeletionQueue::Destroy(VkImage image, GpuAllocation& allocation, uint64_t value)
+{
+    Push(HandleType::Image, image, &allocation, value);
+}
+
+void DeletionQueue::Free(GpuAllocation& allocation, uint64_t value)
+{
+    Push(HandleType::Memory, uint64_t{ 0 }, &allocation, value);
+}
+
+void DeletionQueue::Destroy(VkImage image, uint64_t value) { Push(HandleType::Image, image, nullptr, value); }
+void DeletionQueue::Destroy(VkImageView imageView, uint64_t value) { Push(HandleType::ImageView, imageView, nullptr, value); }
+void DeletionQueue::Destroy(VkFramebuffer framebuffer, uint64_t value) { Push(HandleType::Framebuffer, framebuffer, nullptr, value); }
+void DeletionQueue::Destroy(VkSwapchainKHR swapChain, uint64_t value) { Push(HandleType::SwapChain, swapChain, nullptr, value); }
+void DeletionQueue::Destroy(VkPipeline pipeline, uint64_t value) { Push(HandleType::Pipeline, pipeline, nullptr, value); }
+void DeletionQueue::Destroy(VkPipelineLayout layout, uint64_t value) { Push(HandleType::PipelineLayout, layout, nullptr, value); }
+void DeletionQueue::Destroy(VkShaderModule module, uint64_t value) { Push(HandleType::ShaderModule, module, nullptr, value); }
+void DeletionQueue::Destroy(VkSampler sampler, uint64_t value) { Push(HandleType::Sampler, sampler, nullptr, value); }
+void DeletionQueue::Destroy(VkDescriptorPool pool, uint64_t value) { Push(HandleType::DescriptorPool, pool, nullptr, value); }
+void DeletionQueue::Destroy(VkDescriptorSetLayout layout, uint64_t value) { Push(HandleType::DescriptorSetLayout, layout, nullptr, value); }
+void DeletionQueue::Destroy(VkRenderPass renderPass, uint64_t value) { Push(HandleType::RenderPass, renderPass, nullptr, value); }
+
+/**
+ * @brief Destroys the due entries, oldest first.
+ *
+ * @param completedValue Frame timeline value the GPU has reached.
+ */
+void DeletionQueue::Collect(uint64_t completedValue)
+{
+    if (entries.empty() || entries.front().value > completedValue)
+    {
+        return;
+    }
+    while (!entries.empty() && entries.front().value <= completedValue)
+    {
+        DestroyEntry(entries.front());
+        entries.pop_front();
+        stats.destroyed++;
+    }
+    stats.batches++;
+}
+
+/**
+ * @brief Writes the deletion counters.
+ *
+ * @param out Where to write it.
+ */
+void DeletionQueue::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Deletion queue] %llu objects queued, %llu destroyed in %llu batches, peak %llu waiting\n",
+        static_cast<unsigned long long>(stats.queued), static_cast<unsigned long long>(stats.destroyed),
+        static_cast<unsigned long long>(stats.batches), static_cast<unsigned long long>(stats.peakPending));
+    out << line;
+}
+
+/**
+ * @brief Queues a handle, and the allocation it owns if any.
+ *
+ * @param allocation Moved into the entry and cleared, may be null.
+ */
+template <typename Handle>
+void DeletionQueue::Push(HandleType type, Handle handle, GpuAllocation* allocation, uint64_t value)
+{
+    Entry entry{ type, ToBits(handle), {}, value };
+    if (allocation)
+    {
+        entry.allocation = *allocation;
+        *allocation = {};
+    }
+    entries.push_back(entry);
+    stats.queued++;
+    stats.peakPending = std::max<uint64_t>(stats.peakPending, entries.size());
+}
+
+void DeletionQueue::DestroyEntry(Entry& entry)
+{
+    switch (entry.type)
+    {
+    case HandleType::Memory:
+        break;
+    case HandleType::Buffer:
+        vkDestroyBuffer(device, FromBits<VkBuffer>(entry.handle), nullptr);
+        break;
+    case HandleType::Image:
+        vkDestroyImage(device, FromBits<VkImage>(entry.handle), nullptr);
+        break;
+    case HandleType::ImageView:
+        vkDestroyImageView(device, FromBits<VkImageView>(entry.handle), nullptr);
+        break;
+    case HandleType::Framebuffer:
+        vkDestroyFramebuffer(device, FromBits<VkFramebuffer>(entry.handle), nullptr);
+        break;
+    case HandleType::SwapChain:
+        vkDestroySwapchainKHR(device, FromBits<VkSwapchainKHR>(entry.handle), nullptr);
+        break;
+    case HandleType::Pipeline:
+        vkDestroyPipeline(device, FromBits<VkPipeline>(entry.handle), nullptr);
+        break;
+    case HandleType::PipelineLayout:
+        vkDestroyPipelineLayout(device, FromBits<VkPipelineLayout>(entry.handle), nullptr);
+        break;
+    case HandleType::ShaderModule:
+        vkDestroyShaderModule(device, FromBits<VkShaderModule>(entry.handle), nullptr);
+        break;
+    case HandleType::Sampler:
+        vkDestroySampler(device, FromBits<VkSampler>(entry.handle), nullptr);
+        break;
+    case HandleType::DescriptorPool:
+        vkDestroyDescriptorPool(device, FromBits<VkDescriptorPool>(entry.handle), nullptr);
+        break;
+    case HandleType::DescriptorSetLayout:
+        vkDestroyDescriptorSetLayout(device, FromBits<VkDescriptorSetLayout>(entry.handle), nullptr);
+        break;
+    case HandleType::RenderPass:
+        vkDestroyRenderPass(device, FromBits<VkRenderPass>(entry.handle), nullptr);
+        break;
+    }
+    // Memory goes after the object bound to it
+    allocator->Free(entry.allocation);
+}
@@ -0,0 +1,141 @@
+/*****************************************************************//**
+ * \file   DeletionQueue.h
+ * \brief  Vulkan objects destroyed once the GPU has passed the last frame using them
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "GpuAllocator.h"
+#include <cstdint>
+#include <deque>
+#include <ostream>
+
+/**
+ * @brief Counters since startup.
+ */
+struct DeletionQueueStats
+{
+    //objects and allocations queued, and how many of those are destroyed so far
+    uint64_t queued = 0;
+    uint64_t destroyed = 0;
+    //Collect calls that destroyed anything
+    uint64_t batches = 0;
+    //most entries waiting at once
+    uint64_t peakPending = 0;
+};
+
+/**
+ * @brief Lets the render thread drop a buffer, image, pipeline or any other object
+ * mid-run without stalling. Each object is queued with the frame timeline value after
+ * which the GPU no longer uses it (FramePacer::GetSignalValue() for anything the
+ * frame being recorded, or an earlier one, may use) and Collect destroys everything
+ * the timeline has passed, in bulk, once per frame.
+ *
+ * Entries are kept in the order queued and collection stops at the first that isn't
+ * due yet, so values should not decrease. Render thread only.
+ */
+class DeletionQueue
+{
+public:
+    DeletionQueue() = default;
+
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+    /**
+     * @param device The logical device.
+     * @param allocator Memory queued with a buffer or image goes back here.
+     */
+    void Init(VkDevice device, GpuAllocator& allocator);
+
+    /**
+     * @brief Destroys everything still queued. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Queues a buffer and the memory it was created with. allocation is cleared.
+     *
+     * @param value Frame timeline value after which nothing uses the buffer.
+     */
+    void Destroy(VkBuffer buffer, GpuAllocation& allocation, uint64_t value);
+
+    /**
+     * @brief Queues an image and the memory bound to it. allocation is cleared.
+     *
+     * @param value Frame timeline value after which nothing uses the image.
+     */
+    void Destroy(VkImage image, GpuAllocation& allocation, uint64_t value);
+
+    /**
+     * @brief Queues memory whose objects are queued separately, e.g. shared by aliased images.
+     */
+    void Free(GpuAllocation& allocation, uint64_t value);
+
+    // Objects without memory of their own
+    void Destroy(VkImage image, uint64_t value);
+    void Destroy(VkImageView imageView, uint64_t value);
+    void Destroy(VkFramebuffer framebuffer, uint64_t value);
+    void Destroy(VkSwapchainKHR swapChain, uint64_t value);
+    void Destroy(VkPipeline pipeline, uint64_t value);
+    void Destroy(VkPipelineLayout layout, uint64_t value);
+    void Destroy(VkShaderModule module, uint64_t value);
+    void Destroy(VkSampler sampler, uint64_t value);
+    void Destroy(VkDescriptorPool pool, uint64_t value);
+    void Destroy(VkDescriptorSetLayout layout, uint64_t value);
+    void Destroy(VkRenderPass renderPass, uint64_t value);
+
+    /**
+     * @brief Destroys every entry whose value the GPU has reached.
+     *
+     * @param completedValue Frame timeline value the GPU has reached.
+     */
+    void Collect(uint64_t completedValue);
+
+    size_t GetPendingCount() const { return entries.size(); }
+
+    const DeletionQueueStats& GetStats() const { return stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    enum class HandleType : uint32_t
+    {
+        //allocation only
+        Memory,
+        Buffer,
+        Image,
+        ImageView,
+        Framebuffer,
+        SwapChain,
+        Pipeline,
+        PipelineLayout,
+        ShaderModule,
+        Sampler,
+        DescriptorPool,
+        DescriptorSetLayout,
+        RenderPass
+    };
+
+    struct Entry
+    {
+        HandleType type;
+        //the handle's bits, non-dispatchable handles are pointers or 64-bit integers
+        uint64_t handle;
+        //freed after the handle is destroyed, empty if it has none
+        GpuAllocation allocation;
+        uint64_t value;
+    };
+
+    template <typename Handle>
+    void Push(HandleType type, Handle handle, GpuAllocation* allocation, uint64_t value);
+    void DestroyEntry(Entry& entry);
+
+    VkDevice device = VK_NULL_HANDLE;
+    GpuAllocator* allocator = nullptr;
+    std::deque<Entry> entries;
+
+    DeletionQueueStats stats;
+};
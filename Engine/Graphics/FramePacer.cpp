@@ -0,0 +1,160 @@
+/*****************************************************************//**
+ * \file   FramePacer.cpp
+ * \brief  Frames in flight paced with a timeline semaphore, plus latency counters
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "FramePacer.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+/**
+ * @brief Creates the frame timeline.
+ *
+ * @param logicalDevice The logical device, created with the timelineSemaphore feature.
+ * @param framesInFlight From 1 to MAX_FRAMES_IN_FLIGHT.
+ */
+void FramePacer::Init(VkDevice logicalDevice, uint32_t framesInFlight)
+{
+    if (framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT)
+    {
+        throw std::runtime_error("frames in flight must be between 1 and 4!");
+    }
+    device = logicalDevice;
+
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create frame timeline semaphore!");
+    }
+
+    slots = std::vector<Slot>(framesInFlight);
+    frameIndex = 0;
+    submittedValue = 0;
+    stats = {};
+}
+
+/**
+ * @brief Destroys the timeline.
+ *
+ */
+void FramePacer::Shutdown()
+{
+    if (device == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    // Idle now, but when the last frames finished is unknown, so they aren't counted
+    vkDestroySemaphore(device, timeline, nullptr);
+    timeline = VK_NULL_HANDLE;
+    slots.clear();
+    device = VK_NULL_HANDLE;
+}
+
+/**
+ * @brief Blocks until the current slot's last frame has finished on the GPU.
+ *
+ */
+void FramePacer::WaitForFrameSlot()
+{
+    Slot& slot = slots[frameIndex];
+    uint64_t completed = GetCompletedValue();
+    if (completed < slot.value)
+    {
+        auto waitBegin = std::chrono::steady_clock::now();
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &timeline;
+        waitInfo.pValues = &slot.value;
+        if (vkWaitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to wait for a frame in flight!");
+        }
+        auto waitEnd = std::chrono::steady_clock::now();
+        stats.slotWaits++;
+        stats.slotWaitSeconds += std::chrono::duration<double>(waitEnd - waitBegin).count();
+        // Other frames may have finished during the wait too
+        completed = std::max(slot.value, GetCompletedValue());
+        Retire(completed, waitEnd);
+        return;
+    }
+    Retire(completed, std::chrono::steady_clock::now());
+}
+
+/**
+ * @brief Records the frame just submitted against its slot.
+ *
+ * @param inputTime When the frame's input was sampled.
+ */
+void FramePacer::FrameSubmitted(std::chrono::steady_clock::time_point inputTime)
+{
+    submittedValue++;
+    Slot& slot = slots[frameIndex];
+    slot.value = submittedValue;
+    slot.inputTime = inputTime;
+    slot.pending = true;
+
+    double inputToSubmit = std::chrono::duration<double>(std::chrono::steady_clock::now() - inputTime).count();
+    stats.frames++;
+    stats.totalInputToSubmitSeconds += inputToSubmit;
+    stats.maxInputToSubmitSeconds = std::max(stats.maxInputToSubmitSeconds, inputToSubmit);
+
+    frameIndex = (frameIndex + 1) % static_cast<uint32_t>(slots.size());
+}
+
+/**
+ * @brief Writes the pacing and latency counters.
+ *
+ * @param out Where to write it.
+ */
+void FramePacer::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Frame pacing] %llu frames, %u in flight, %llu slot waits totalling %.1f ms\n",
+        static_cast<unsigned long long>(stats.frames), GetFramesInFlight(), static_cast<unsigned long long>(stats.slotWaits),
+        stats.slotWaitSeconds * 1000.0);
+    out << line;
+    std::snprintf(line, sizeof(line), "[Frame pacing] Input to submit avg %.2f ms, max %.2f; input to GPU done avg %.2f ms, max %.2f\n",
+        stats.AverageInputToSubmitSeconds() * 1000.0, stats.maxInputToSubmitSeconds * 1000.0,
+        stats.AverageInputToGpuSeconds() * 1000.0, stats.maxInputToGpuSeconds * 1000.0);
+    out << line;
+}
+
+uint64_t FramePacer::GetCompletedValue() const
+{
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(device, timeline, &value);
+    return value;
+}
+
+/**
+ * @brief Counts the input to GPU latency of every pending frame the timeline has passed.
+ *
+ * @param completedValue Timeline value known to have been reached.
+ * @param now When it was seen.
+ */
+void FramePacer::Retire(uint64_t completedValue, std::chrono::steady_clock::time_point now)
+{
+    for (Slot& slot : slots)
+    {
+        if (!slot.pending || slot.value > completedValue)
+        {
+            continue;
+        }
+        double inputToGpu = std::chrono::duration<double>(now - slot.inputTime).count();
+        stats.completedFrames++;
+        stats.totalInputToGpuSeconds += inputToGpu;
+        stats.maxInputToGpuSeconds = std::max(stats.maxInputToGpuSeconds, inputToGpu);
+        slot.pending = false;
+    }
+}
@@ -0,0 +1,120 @@
+/*****************************************************************//**
+ * \file   FramePacer.h
+ * \brief  Frames in flight paced with a timeline semaphore, plus latency counters
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Frame pacing and latency counters since startup. A frame's GPU completion
+ * is when the pacer saw the timeline pass it, which trails the real completion
+ * unless something was waiting on exactly that frame.
+ */
+struct FramePacerStats
+{
+    uint64_t frames = 0;
+    //frames whose completion was seen, the rest were still running at shutdown
+    uint64_t completedFrames = 0;
+    //waits that blocked because the GPU still had the slot's previous frame
+    uint64_t slotWaits = 0;
+    double slotWaitSeconds = 0.0;
+    //from input sampling to the queue submit
+    double totalInputToSubmitSeconds = 0.0;
+    double maxInputToSubmitSeconds = 0.0;
+    //from input sampling to the GPU finishing the frame
+    double totalInputToGpuSeconds = 0.0;
+    double maxInputToGpuSeconds = 0.0;
+
+    double AverageInputToSubmitSeconds() const { return frames > 0 ? totalInputToSubmitSeconds / frames : 0.0; }
+    double AverageInputToGpuSeconds() const { return completedFrames > 0 ? totalInputToGpuSeconds / completedFrames : 0.0; }
+};
+
+/**
+ * @brief Lets the CPU run up to framesInFlight frames ahead of the GPU. Every frame's
+ * submission signals the next value of one timeline semaphore, and a frame slot is
+ * reused once the timeline has passed the value of the frame that last used it, so
+ * there is no per-frame fence to reset and any thread can wait on any frame.
+ *
+ * Fewer frames in flight means less latency and less CPU/GPU overlap. Render thread
+ * only, except that WaitForFrameSlot may run on another thread while the render
+ * thread is between frames.
+ */
+class FramePacer
+{
+public:
+    //frames in flight the renderer supports, every per-frame resource has this many copies at most
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+    FramePacer() = default;
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    /**
+     * @param device The logical device, created with the timelineSemaphore feature.
+     * @param framesInFlight From 1 to MAX_FRAMES_IN_FLIGHT.
+     */
+    void Init(VkDevice device, uint32_t framesInFlight);
+
+    /**
+     * @brief Destroys the timeline. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Blocks until the GPU has finished the frame that last used the current
+     * slot, so its per-frame resources can be reused, and takes note of every frame
+     * that has finished since the last call.
+     */
+    void WaitForFrameSlot();
+
+    /**
+     * @brief Records the frame just submitted and moves on to the next slot. The
+     * submission must signal GetTimeline() with GetSignalValue().
+     *
+     * @param inputTime When the frame's input was sampled.
+     */
+    void FrameSubmitted(std::chrono::steady_clock::time_point inputTime);
+
+    //slot of the frame being recorded, indexes every per-frame resource
+    uint32_t GetFrameIndex() const { return frameIndex; }
+
+    uint32_t GetFramesInFlight() const { return static_cast<uint32_t>(slots.size()); }
+
+    VkSemaphore GetTimeline() const { return timeline; }
+
+    uint64_t GetSignalValue() const { return submittedValue + 1; }
+
+    //timeline value the GPU has reached, every frame up to it has finished
+    uint64_t GetCompletedValue() const;
+
+    const FramePacerStats& GetStats() const { return stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct Slot
+    {
+        //timeline value of the slot's last frame, 0 if it has none
+        uint64_t value = 0;
+        std::chrono::steady_clock::time_point inputTime;
+        //not yet seen to complete
+        bool pending = false;
+    };
+
+    void Retire(uint64_t completedValue, std::chrono::steady_clock::time_point now);
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    std::vector<Slot> slots;
+    uint32_t frameIndex = 0;
+    uint64_t submittedValue = 0;
+
+    FramePacerStats stats;
+};
@@ -0,0 +1,49 @@
+/*****************************************************************//**
+ * \file   FramePacket.h
+ * \brief  Snapshot of everything the render thread needs for one frame
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Renderable.h"
+#include "SwapchainPolicy.h"
+#include "Transform.h"
+
+/**
+ * @brief Built by the simulation thread, read-only once published. The render
+ * thread must not look at simulation state directly, only at the packet.
+ */
+struct FramePacket
+{
+    uint64_t frameIndex = 0;
+
+    //window framebuffer size sampled on the main thread (GLFW is main thread only)
+    int framebufferWidth = 0;
+    int framebufferHeight = 0;
+
+    //debug overlay shown, toggled with F1 on the main thread
+    bool showOverlay = false;
+
+    //draw the scene as wireframe, toggled with F3
+    bool wireframe = false;
+
+    //swap chain policy as of this frame, the render thread recreates the swap chain when it changes
+    SwapchainPolicy swapchainPolicy;
+
+    //when the simulation thread started and finished building this frame
+    std::chrono::steady_clock::time_point simBegin;
+    std::chrono::steady_clock::time_point simEnd;
+
+    //object transforms at the last two simulation ticks, blended by the render thread.
+    //Same length and order, an object without a previous state has its current one twice
+    std::vector<Transform> previousTransforms;
+    std::vector<Transform> currentTransforms;
+    //mesh and material of each current transform
+    std::vector<Renderable> renderables;
+    //how far real time is between previous (0) and current (1)
+    float interpolationAlpha = 1.0f;
+};
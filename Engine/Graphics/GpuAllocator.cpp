@@ -0,0 +1,403 @@
+/*****************************************************************//**
+ * \file   GpuAllocator.cpp
+ * \brief  Sub-allocates buffers and images from large VkDeviceMemory blocks
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "GpuAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    double Megabytes(VkDeviceSize bytes)
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+GpuAllocator::~GpuAllocator()
+{
+    Shutdown();
+}
+
+/**
+ * @brief Reads the device's memory types and limits.
+ *
+ * @param physicalDevice Where the memory types come from.
+ * @param logicalDevice Device all memory is allocated on.
+ */
+void GpuAllocator::Init(VkPhysicalDevice physicalDevice, VkDevice logicalDevice)
+{
+    device = logicalDevice;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    nonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+    maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+    dedicatedBytes.assign(memoryProperties.memoryHeapCount, 0);
+    dedicatedCounts.assign(memoryProperties.memoryHeapCount, 0);
+}
+
+/**
+ * @brief Frees every block.
+ *
+ */
+void GpuAllocator::Shutdown()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Block& block : blocks)
+    {
+        if (block.memory != VK_NULL_HANDLE)
+        {
+            FreeDeviceMemory(block.memory);
+        }
+    }
+    blocks.clear();
+    device = VK_NULL_HANDLE;
+}
+
+/**
+ * @brief Finds memory for a resource, in an existing block if possible.
+ *
+ * @param requirements From vkGet*MemoryRequirements.
+ * @param properties Flags the memory type must have.
+ * @param kind What the memory will be bound to.
+ * @return GpuAllocation The memory range.
+ */
+GpuAllocation GpuAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, GpuResourceKind kind)
+{
+    GpuAllocation allocation;
+    allocation.memoryType = FindMemoryType(requirements.memoryTypeBits, properties);
+    allocation.size = requirements.size;
+    allocation.kind = kind;
+
+    // Flushes and invalidates of non coherent memory work on whole atoms, keep
+    // them from reaching into a neighbour
+    const VkMemoryPropertyFlags typeFlags = memoryProperties.memoryTypes[allocation.memoryType].propertyFlags;
+    VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+    VkDeviceSize size = requirements.size;
+    if ((typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        alignment = std::max(alignment, nonCoherentAtomSize);
+        size = (size + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const VkDeviceSize blockSize = GetBlockSize(allocation.memoryType);
+
+    // Big resources would waste most of a block, give them their own memory
+    if (std::bit_ceil(std::max(size, alignment)) > blockSize / 2)
+    {
+        if (AllocateDeviceMemory(size, allocation.memoryType, allocation.memory, allocation.mapped) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate GPU memory!");
+        }
+        uint32_t heap = GetHeapIndex(allocation.memoryType);
+        dedicatedBytes[heap] += allocation.size;
+        dedicatedCounts[heap]++;
+        return allocation;
+    }
+
+    uint32_t freeIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < blocks.size(); i++)
+    {
+        Block& block = blocks[i];
+        if (block.memory == VK_NULL_HANDLE)
+        {
+            freeIndex = std::min(freeIndex, i);
+            continue;
+        }
+        if (block.memoryType != allocation.memoryType || block.kind != kind)
+        {
+            continue;
+        }
+        uint64_t offset = block.ranges->Allocate(size, alignment);
+        if (offset != BuddyAllocator::INVALID_OFFSET)
+        {
+            block.requested += allocation.size;
+            allocation.memory = block.memory;
+            allocation.offset = offset;
+            allocation.mapped = block.mapped ? block.mapped + offset : nullptr;
+            allocation.block = i;
+            return allocation;
+        }
+    }
+
+    // No room anywhere, add a block. Halve it while the heap is too full for a whole one
+    Block block;
+    block.memoryType = allocation.memoryType;
+    block.kind = kind;
+    VkDeviceSize newBlockSize = blockSize;
+    void* mapped = nullptr;
+    while (AllocateDeviceMemory(newBlockSize, allocation.memoryType, block.memory, mapped) != VK_SUCCESS)
+    {
+        newBlockSize /= 2;
+        if (newBlockSize < std::bit_ceil(std::max(size, alignment)))
+        {
+            throw std::runtime_error("failed to allocate GPU memory!");
+        }
+    }
+    block.mapped = static_cast<std::byte*>(mapped);
+    block.ranges = std::make_unique<BuddyAllocator>(newBlockSize, MIN_ALLOCATION_SIZE);
+
+    allocation.memory = block.memory;
+    allocation.offset = block.ranges->Allocate(size, alignment);
+    allocation.mapped = block.mapped ? block.mapped + allocation.offset : nullptr;
+    block.requested += allocation.size;
+
+    if (freeIndex == UINT32_MAX)
+    {
+        freeIndex = static_cast<uint32_t>(blocks.size());
+        blocks.push_back(std::move(block));
+    }
+    else
+    {
+        blocks[freeIndex] = std::move(block);
+    }
+    allocation.block = freeIndex;
+    return allocation;
+}
+
+/**
+ * @brief Returns a range to its block.
+ *
+ * @param allocation The range, reset to empty.
+ */
+void GpuAllocator::Free(GpuAllocation& allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (allocation.block == UINT32_MAX)
+    {
+        uint32_t heap = GetHeapIndex(allocation.memoryType);
+        dedicatedBytes[heap] -= allocation.size;
+        dedicatedCounts[heap]--;
+        FreeDeviceMemory(allocation.memory);
+    }
+    else
+    {
+        Block& block = blocks[allocation.block];
+        block.ranges->Free(allocation.offset);
+        block.requested -= allocation.size;
+    }
+    allocation = GpuAllocation{};
+}
+
+/**
+ * @brief Creates a buffer and binds it to sub-allocated memory.
+ *
+ * @param size Buffer size in bytes.
+ * @param usage How the buffer will be used.
+ * @param properties Flags the memory type must have.
+ * @param allocation Receives the buffer's memory.
+ * @return VkBuffer The bound buffer.
+ */
+VkBuffer GpuAllocator::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, GpuAllocation& allocation)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer buffer;
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create buffer!");
+    }
+
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
+    try
+    {
+        allocation = Allocate(memRequirements, properties, GpuResourceKind::Linear);
+    }
+    catch (...)
+    {
+        vkDestroyBuffer(device, buffer, nullptr);
+        throw;
+    }
+
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+    return buffer;
+}
+
+void GpuAllocator::DestroyBuffer(VkBuffer buffer, GpuAllocation& allocation)
+{
+    vkDestroyBuffer(device, buffer, nullptr);
+    Free(allocation);
+}
+
+/**
+ * @brief Releases empty blocks back to the driver. Live allocations are never
+ * moved, since nothing outside the allocator knows how to rebind them.
+ *
+ * @return GpuBlockReleaseStats What was released and how fragmented the rest is.
+ */
+GpuBlockReleaseStats GpuAllocator::ReleaseEmptyBlocks()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    GpuBlockReleaseStats stats;
+    for (Block& block : blocks)
+    {
+        if (block.memory == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+        if (block.ranges->IsEmpty())
+        {
+            stats.blocksReleased++;
+            stats.bytesReleased += block.ranges->GetSize();
+            FreeDeviceMemory(block.memory);
+            block = Block{};
+            continue;
+        }
+        stats.freeBytes += block.ranges->GetSize() - block.ranges->GetUsed();
+        stats.largestFreeRange = std::max(stats.largestFreeRange, block.ranges->GetLargestFree());
+    }
+
+    // Released blocks at the end don't need to keep their index
+    while (!blocks.empty() && blocks.back().memory == VK_NULL_HANDLE)
+    {
+        blocks.pop_back();
+    }
+    return stats;
+}
+
+/**
+ * @brief Usage per memory heap.
+ *
+ * @return std::vector<GpuHeapStats> One entry per memory heap.
+ */
+std::vector<GpuHeapStats> GpuAllocator::GetHeapStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<GpuHeapStats> stats(memoryProperties.memoryHeapCount);
+    for (uint32_t heap = 0; heap < memoryProperties.memoryHeapCount; heap++)
+    {
+        stats[heap].heapSize = memoryProperties.memoryHeaps[heap].size;
+        stats[heap].flags = memoryProperties.memoryHeaps[heap].flags;
+        stats[heap].reserved = dedicatedBytes[heap];
+        stats[heap].used = dedicatedBytes[heap];
+        stats[heap].requested = dedicatedBytes[heap];
+        stats[heap].dedicatedCount = dedicatedCounts[heap];
+        stats[heap].allocationCount = dedicatedCounts[heap];
+    }
+    for (const Block& block : blocks)
+    {
+        if (block.memory == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+        GpuHeapStats& heap = stats[GetHeapIndex(block.memoryType)];
+        heap.reserved += block.ranges->GetSize();
+        heap.used += block.ranges->GetUsed();
+        heap.requested += block.requested;
+        heap.blockCount++;
+        heap.allocationCount += block.ranges->GetAllocationCount();
+    }
+    return stats;
+}
+
+/**
+ * @brief Writes per-heap usage.
+ *
+ * @param out Where to write it.
+ */
+void GpuAllocator::PrintReport(std::ostream& out) const
+{
+    std::vector<GpuHeapStats> stats = GetHeapStats();
+    char line[256];
+    for (uint32_t heap = 0; heap < stats.size(); heap++)
+    {
+        const GpuHeapStats& entry = stats[heap];
+        std::snprintf(line, sizeof(line), "[GPU heap %u%s] %.1f MB reserved in %u blocks + %u dedicated of %.0f MB, %.1f MB used, %.1f MB requested, %u allocations\n",
+            heap, (entry.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " device local" : "",
+            Megabytes(entry.reserved), entry.blockCount, entry.dedicatedCount, Megabytes(entry.heapSize),
+            Megabytes(entry.used), Megabytes(entry.requested), entry.allocationCount);
+        out << line;
+    }
+}
+
+uint32_t GpuAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+/**
+ * @brief Block size for a memory type, smaller on small heaps so one block can't
+ * take most of it.
+ *
+ * @param memoryType The memory type.
+ * @return VkDeviceSize A power of two.
+ */
+VkDeviceSize GpuAllocator::GetBlockSize(uint32_t memoryType) const
+{
+    VkDeviceSize heapSize = memoryProperties.memoryHeaps[GetHeapIndex(memoryType)].size;
+    return std::max(std::min(DEFAULT_BLOCK_SIZE, std::bit_floor(heapSize / 8)), MIN_ALLOCATION_SIZE);
+}
+
+/**
+ * @brief Allocates a VkDeviceMemory and maps it if the host can see it.
+ *
+ * @param size Bytes to allocate.
+ * @param memoryType Memory type index.
+ * @param memory Receives the memory.
+ * @param mapped Receives the mapped pointer, or null.
+ * @return VkResult Result of vkAllocateMemory.
+ */
+VkResult GpuAllocator::AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, VkDeviceMemory& memory, void*& mapped)
+{
+    if (deviceAllocationCount >= maxAllocationCount)
+    {
+        throw std::runtime_error("Reached maxMemoryAllocationCount!");
+    }
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+    deviceAllocationCount++;
+
+    mapped = nullptr;
+    if (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+        {
+            FreeDeviceMemory(memory);
+            throw std::runtime_error("failed to map GPU memory!");
+        }
+    }
+    return VK_SUCCESS;
+}
+
+void GpuAllocator::FreeDeviceMemory(VkDeviceMemory memory)
+{
+    // Mapped memory is unmapped implicitly
+    vkFreeMemory(device, memory, nullptr);
+    deviceAllocationCount--;
+}
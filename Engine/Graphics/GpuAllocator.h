@@ -0,0 +1,171 @@
+/*****************************************************************//**
+ * \file   GpuAllocator.h
+ * \brief  Sub-allocates buffers and images from large VkDeviceMemory blocks
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "BuddyAllocator.h"
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief What kind of resource the memory is bound to. Linear and optimal resources
+ * never share a block, so neighbouring allocations can't violate
+ * bufferImageGranularity.
+ */
+enum class GpuResourceKind : uint32_t
+{
+    //buffers and linear tiled images
+    Linear,
+    //optimal tiled images
+    Optimal,
+};
+
+/**
+ * @brief A range of device memory handed out by GpuAllocator.
+ */
+struct GpuAllocation
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    //persistently mapped pointer to offset, null for memory the host can't see
+    void* mapped = nullptr;
+    uint32_t memoryType = 0;
+    //owning block, UINT32_MAX for a dedicated allocation
+    uint32_t block = UINT32_MAX;
+    GpuResourceKind kind = GpuResourceKind::Linear;
+};
+
+/**
+ * @brief Usage of one memory heap.
+ */
+struct GpuHeapStats
+{
+    VkDeviceSize heapSize = 0;
+    VkMemoryHeapFlags flags = 0;
+    //bytes held in VkDeviceMemory objects
+    VkDeviceSize reserved = 0;
+    //bytes handed out, including rounding
+    VkDeviceSize used = 0;
+    //bytes callers asked for
+    VkDeviceSize requested = 0;
+    uint32_t blockCount = 0;
+    uint32_t dedicatedCount = 0;
+    uint32_t allocationCount = 0;
+};
+
+/**
+ * @brief Result of GpuAllocator::ReleaseEmptyBlocks.
+ */
+struct GpuBlockReleaseStats
+{
+    uint32_t blocksReleased = 0;
+    VkDeviceSize bytesReleased = 0;
+    //free bytes left in blocks that still hold allocations
+    VkDeviceSize freeBytes = 0;
+    //largest allocation that would still fit in one of those blocks
+    VkDeviceSize largestFreeRange = 0;
+};
+
+/**
+ * @brief Keeps a few large VkDeviceMemory blocks per memory type and places
+ * resources inside them with a buddy allocator, instead of one vkAllocateMemory
+ * per resource. Host visible blocks are mapped once for their whole life.
+ * Resources larger than half a block get memory of their own. Thread safe.
+ */
+class GpuAllocator
+{
+public:
+    GpuAllocator() = default;
+    ~GpuAllocator();
+
+    GpuAllocator(const GpuAllocator&) = delete;
+    GpuAllocator& operator=(const GpuAllocator&) = delete;
+
+    /**
+     * @brief Reads the device's memory types and limits. Call once the logical device exists.
+     */
+    void Init(VkPhysicalDevice physicalDevice, VkDevice device);
+
+    /**
+     * @brief Frees every block. All allocations must have been freed already.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Finds memory for a resource.
+     *
+     * @param requirements From vkGet*MemoryRequirements.
+     * @param properties Flags the memory type must have.
+     * @param kind What the memory will be bound to.
+     * @return GpuAllocation The memory range, throws if the device is out of memory.
+     */
+    GpuAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, GpuResourceKind kind);
+
+    /**
+     * @brief Returns a range to its block. The block itself stays until ReleaseEmptyBlocks.
+     */
+    void Free(GpuAllocation& allocation);
+
+    /**
+     * @brief Creates a buffer and binds it to sub-allocated memory.
+     */
+    VkBuffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, GpuAllocation& allocation);
+
+    void DestroyBuffer(VkBuffer buffer, GpuAllocation& allocation);
+
+    /**
+     * @brief Gives blocks that no longer hold anything back to the driver and
+     * measures what is left. This is not a defragmenter: live allocations are never
+     * moved or compacted, so a block with a single allocation left stays resident.
+     */
+    GpuBlockReleaseStats ReleaseEmptyBlocks();
+
+    /**
+     * @return std::vector<GpuHeapStats> One entry per memory heap.
+     */
+    std::vector<GpuHeapStats> GetHeapStats() const;
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    //smallest range a block hands out
+    static constexpr VkDeviceSize MIN_ALLOCATION_SIZE = 256;
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+    struct Block
+    {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        std::byte* mapped = nullptr;
+        uint32_t memoryType = 0;
+        GpuResourceKind kind = GpuResourceKind::Linear;
+        std::unique_ptr<BuddyAllocator> ranges;
+        VkDeviceSize requested = 0;
+    };
+
+    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    VkDeviceSize GetBlockSize(uint32_t memoryType) const;
+    VkResult AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, VkDeviceMemory& memory, void*& mapped);
+    void FreeDeviceMemory(VkDeviceMemory memory);
+    uint32_t GetHeapIndex(uint32_t memoryType) const { return memoryProperties.memoryTypes[memoryType].heapIndex; }
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    VkDeviceSize nonCoherentAtomSize = 1;
+    uint32_t maxAllocationCount = 0;
+    //live VkDeviceMemory objects, checked against maxMemoryAllocationCount
+    uint32_t deviceAllocationCount = 0;
+
+    //entries without memory are released blocks whose index can be reused
+    std::vector<Block> blocks;
+    //dedicated allocations per heap, for stats
+    std::vector<VkDeviceSize> dedicatedBytes;
+    std::vector<uint32_t> dedicatedCounts;
+    mutable std::mutex mutex;
+};
@@ -0,0 +1,470 @@
+/*****************************************************************//**
+ * \file   GpuProfiler.cpp
+ * \brief  Per-pass GPU timestamps and pipeline statistics through query pools
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "GpuProfiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+//values a statistics query returns, one per bit of GpuProfiler::STATISTICS
+static constexpr uint32_t STATISTIC_COUNT = 6;
+
+/**
+ * @brief Creates the query pools if the queue can write timestamps.
+ *
+ * @param physicalDevice Checked for timestamp support and the tick period.
+ * @param logicalDevice The logical device.
+ * @param queueFamily Family the profiled command buffers are submitted to.
+ * @param framesInFlight Query ranges, one per frame in flight.
+ * @param pipelineStatistics Also count STATISTICS per scope.
+ */
+void GpuProfiler::Init(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t queueFamily, uint32_t framesInFlight, bool pipelineStatistics)
+{
+    device = logicalDevice;
+    slots = std::vector<Slot>(framesInFlight);
+    for (Slot& slot : slots)
+    {
+        slot.scopes.reserve(MAX_SCOPES);
+    }
+    latest.reserve(MAX_SCOPES);
+    history.reserve(HISTORY_CAPACITY);
+    timestampScratch.resize(MAX_SCOPES * 2);
+    statisticsScratch.resize(MAX_SCOPES * STATISTIC_COUNT);
+
+    // Without valid timestamp bits there is nothing to measure with
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    const uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+    if (validBits == 0)
+    {
+        return;
+    }
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    timestampPeriod = properties.limits.timestampPeriod;
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    VkQueryPoolCreateInfo timestampInfo{};
+    timestampInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    timestampInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    timestampInfo.queryCount = framesInFlight * MAX_SCOPES * 2;
+    if (vkCreateQueryPool(device, &timestampInfo, nullptr, &timestampPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create timestamp query pool!");
+    }
+
+    if (pipelineStatistics)
+    {
+        VkQueryPoolCreateInfo statisticsInfo{};
+        statisticsInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        statisticsInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        statisticsInfo.queryCount = framesInFlight * MAX_SCOPES;
+        statisticsInfo.pipelineStatistics = STATISTICS;
+        if (vkCreateQueryPool(device, &statisticsInfo, nullptr, &statisticsPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create pipeline statistics query pool!");
+        }
+    }
+}
+
+/**
+ * @brief Destroys the query pools.
+ *
+ */
+void GpuProfiler::Shutdown()
+{
+    if (statisticsPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, statisticsPool, nullptr);
+        statisticsPool = VK_NULL_HANDLE;
+    }
+    if (timestampPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, timestampPool, nullptr);
+        timestampPool = VK_NULL_HANDLE;
+    }
+    slots.clear();
+    currentSlot = UINT32_MAX;
+}
+
+/**
+ * @brief Collects the slot's last results and resets its queries for this frame.
+ *
+ * @param commandBuffer The frame's primary buffer, outside a render pass.
+ * @param frame Frame in flight index.
+ */
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+    ReadSlot(frame);
+
+    vkCmdResetQueryPool(commandBuffer, timestampPool, frame * MAX_SCOPES * 2, MAX_SCOPES * 2);
+    if (statisticsPool != VK_NULL_HANDLE)
+    {
+        vkCmdResetQueryPool(commandBuffer, statisticsPool, frame * MAX_SCOPES, MAX_SCOPES);
+    }
+    slots[frame].frame = frameCounter++;
+    currentSlot = frame;
+    inScope = false;
+}
+
+void GpuProfiler::EndFrame()
+{
+    if (inScope)
+    {
+        throw std::runtime_error("GPU profiler frame ended inside a scope!");
+    }
+    currentSlot = UINT32_MAX;
+}
+
+/**
+ * @brief Writes the scope's start timestamp and begins its statistics query.
+ *
+ * @param commandBuffer The frame's primary buffer, outside a render pass.
+ * @param name Scopes with the same name are aggregated.
+ */
+void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const std::string& name)
+{
+    if (currentSlot == UINT32_MAX)
+    {
+        return;
+    }
+    if (inScope)
+    {
+        throw std::runtime_error("GPU profiler scopes can't nest!");
+    }
+    inScope = true;
+
+    Slot& slot = slots[currentSlot];
+    scopeTimed = slot.scopes.size() < MAX_SCOPES;
+    if (!scopeTimed)
+    {
+        droppedScopes++;
+        return;
+    }
+    const uint32_t scope = currentSlot * MAX_SCOPES + static_cast<uint32_t>(slot.scopes.size());
+    slot.scopes.push_back(FindName(name));
+
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, scope * 2);
+    if (statisticsPool != VK_NULL_HANDLE)
+    {
+        vkCmdBeginQuery(commandBuffer, statisticsPool, scope, 0);
+    }
+}
+
+/**
+ * @brief Ends the scope's statistics query and writes its end timestamp.
+ *
+ * @param commandBuffer The buffer BeginScope was recorded into.
+ */
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer)
+{
+    if (currentSlot == UINT32_MAX)
+    {
+        return;
+    }
+    if (!inScope)
+    {
+        throw std::runtime_error("GPU profiler scope ended without beginning!");
+    }
+    inScope = false;
+
+    // Dropped at BeginScope, nothing was written
+    if (!scopeTimed)
+    {
+        return;
+    }
+    const uint32_t scope = currentSlot * MAX_SCOPES + static_cast<uint32_t>(slots[currentSlot].scopes.size()) - 1;
+    if (statisticsPool != VK_NULL_HANDLE)
+    {
+        vkCmdEndQuery(commandBuffer, statisticsPool, scope);
+    }
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, scope * 2 + 1);
+}
+
+/**
+ * @brief Reads every slot, oldest frame first so history stays in order.
+ *
+ */
+void GpuProfiler::Finish()
+{
+    if (!IsEnabled())
+    {
+        return;
+    }
+    std::vector<uint32_t> order(slots.size());
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+    {
+        return slots[a].frame < slots[b].frame;
+    });
+    for (uint32_t slot : order)
+    {
+        ReadSlot(slot);
+    }
+}
+
+/**
+ * @brief Copies the kept samples out of the ring.
+ *
+ * @return std::vector<GpuScopeSample> Oldest first.
+ */
+std::vector<GpuScopeSample> GpuProfiler::GetHistory() const
+{
+    std::vector<GpuScopeSample> samples;
+    samples.reserve(history.size());
+    if (history.size() < HISTORY_CAPACITY)
+    {
+        samples.assign(history.begin(), history.end());
+        return samples;
+    }
+    samples.insert(samples.end(), history.begin() + historyNext, history.end());
+    samples.insert(samples.end(), history.begin(), history.begin() + historyNext);
+    return samples;
+}
+
+/**
+ * @brief One row per sample: frame, scope, milliseconds, then the statistics if enabled.
+ *
+ * @param path File to create or overwrite.
+ * @return bool False if the file could not be written.
+ */
+bool GpuProfiler::WriteCsv(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    const bool statistics = statisticsPool != VK_NULL_HANDLE;
+    file << "frame,scope,gpu_ms";
+    if (statistics)
+    {
+        file << ",ia_vertices,ia_primitives,vs_invocations,clipping_primitives,fs_invocations,cs_invocations";
+    }
+    file << "\n";
+
+    char line[256];
+    for (const GpuScopeSample& sample : GetHistory())
+    {
+        std::snprintf(line, sizeof(line), "%llu,%s,%.6f", static_cast<unsigned long long>(sample.frame), names[sample.scope].c_str(), sample.milliseconds);
+        file << line;
+        if (statistics)
+        {
+            const GpuPipelineStatistics& s = sample.statistics;
+            std::snprintf(line, sizeof(line), ",%llu,%llu,%llu,%llu,%llu,%llu",
+                static_cast<unsigned long long>(s.inputVertices), static_cast<unsigned long long>(s.inputPrimitives),
+                static_cast<unsigned long long>(s.vertexInvocations), static_cast<unsigned long long>(s.clippingPrimitives),
+                static_cast<unsigned long long>(s.fragmentInvocations), static_cast<unsigned long long>(s.computeInvocations));
+            file << line;
+        }
+        file << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+/**
+ * @brief A "scopes" object of per-name summaries and a "samples" array like the CSV rows.
+ *
+ * @param path File to create or overwrite.
+ * @return bool False if the file could not be written.
+ */
+bool GpuProfiler::WriteJson(const std::string& path) const
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        return false;
+    }
+    const bool statistics = statisticsPool != VK_NULL_HANDLE;
+
+    // Pass names are plain identifiers, only quotes and backslashes need escaping
+    auto quoted = [](const std::string& text)
+    {
+        std::string result = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result + "\"";
+    };
+
+    char line[256];
+    file << "{\n  \"timestampPeriodNs\": " << timestampPeriod << ",\n  \"scopes\": {";
+    for (uint32_t i = 0; i < names.size(); i++)
+    {
+        const GpuScopeStats& stats = scopeStats[i];
+        std::snprintf(line, sizeof(line), ": { \"samples\": %llu, \"avgMs\": %.6f, \"minMs\": %.6f, \"maxMs\": %.6f }",
+            static_cast<unsigned long long>(stats.samples), stats.AverageMilliseconds(), stats.minMilliseconds, stats.maxMilliseconds);
+        file << (i > 0 ? ",\n    " : "\n    ") << quoted(names[i]) << line;
+    }
+    file << "\n  },\n  \"samples\": [";
+
+    bool first = true;
+    for (const GpuScopeSample& sample : GetHistory())
+    {
+        std::snprintf(line, sizeof(line), "{ \"frame\": %llu, \"scope\": ", static_cast<unsigned long long>(sample.frame));
+        file << (first ? "\n    " : ",\n    ") << line << quoted(names[sample.scope]);
+        std::snprintf(line, sizeof(line), ", \"ms\": %.6f", sample.milliseconds);
+        file << line;
+        if (statistics)
+        {
+            const GpuPipelineStatistics& s = sample.statistics;
+            std::snprintf(line, sizeof(line), ", \"iaVertices\": %llu, \"iaPrimitives\": %llu, \"vsInvocations\": %llu, \"clippingPrimitives\": %llu, \"fsInvocations\": %llu, \"csInvocations\": %llu",
+                static_cast<unsigned long long>(s.inputVertices), static_cast<unsigned long long>(s.inputPrimitives),
+                static_cast<unsigned long long>(s.vertexInvocations), static_cast<unsigned long long>(s.clippingPrimitives),
+                static_cast<unsigned long long>(s.fragmentInvocations), static_cast<unsigned long long>(s.computeInvocations));
+            file << line;
+        }
+        file << " }";
+        first = false;
+    }
+    file << "\n  ]\n}\n";
+    return static_cast<bool>(file);
+}
+
+void GpuProfiler::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    if (!IsEnabled())
+    {
+        out << "[GPU profiler] Disabled, the queue has no timestamp support\n";
+        return;
+    }
+    std::snprintf(line, sizeof(line), "[GPU profiler] %llu frames, latest %.3f ms, %llu scopes over the %u per frame limit\n",
+        static_cast<unsigned long long>(frameCounter), latestFrameMilliseconds, static_cast<unsigned long long>(droppedScopes), MAX_SCOPES);
+    out << line;
+    for (uint32_t i = 0; i < names.size(); i++)
+    {
+        const GpuScopeStats& stats = scopeStats[i];
+        std::snprintf(line, sizeof(line), "[GPU profiler] %-16s avg %.3f ms, min %.3f, max %.3f, %llu samples\n", names[i].c_str(),
+            stats.AverageMilliseconds(), stats.minMilliseconds, stats.maxMilliseconds, static_cast<unsigned long long>(stats.samples));
+        out << line;
+    }
+    if (statisticsPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    for (const GpuScopeSample& sample : latest)
+    {
+        const GpuPipelineStatistics& s = sample.statistics;
+        std::snprintf(line, sizeof(line), "[GPU profiler] %-16s %llu vertices, %llu primitives (%llu after clipping), %llu VS, %llu FS, %llu CS invocations\n",
+            names[sample.scope].c_str(), static_cast<unsigned long long>(s.inputVertices), static_cast<unsigned long long>(s.inputPrimitives),
+            static_cast<unsigned long long>(s.clippingPrimitives), static_cast<unsigned long long>(s.vertexInvocations),
+            static_cast<unsigned long long>(s.fragmentInvocations), static_cast<unsigned long long>(s.computeInvocations));
+        out << line;
+    }
+}
+
+/**
+ * @brief Turns the slot's queries into samples. Its fence must have signaled, so
+ * results are available without waiting.
+ *
+ * @param slot Frame in flight index.
+ */
+void GpuProfiler::ReadSlot(uint32_t slot)
+{
+    Slot& recorded = slots[slot];
+    const uint32_t count = static_cast<uint32_t>(recorded.scopes.size());
+    if (count == 0)
+    {
+        return;
+    }
+
+    const uint32_t first = slot * MAX_SCOPES;
+    VkResult result = vkGetQueryPoolResults(device, timestampPool, first * 2, count * 2, count * 2 * sizeof(uint64_t),
+        timestampScratch.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result == VK_SUCCESS && statisticsPool != VK_NULL_HANDLE)
+    {
+        result = vkGetQueryPoolResults(device, statisticsPool, first, count, count * STATISTIC_COUNT * sizeof(uint64_t),
+            statisticsScratch.data(), STATISTIC_COUNT * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    }
+    if (result != VK_SUCCESS)
+    {
+        // The frame never ran, e.g. recorded and then dropped by a swap chain recreation
+        recorded.scopes.clear();
+        return;
+    }
+
+    latest.clear();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        GpuScopeSample sample;
+        sample.frame = recorded.frame;
+        sample.scope = recorded.scopes[i];
+        const uint64_t ticks = (timestampScratch[i * 2 + 1] - timestampScratch[i * 2]) & timestampMask;
+        sample.milliseconds = ticks * timestampPeriod * 1e-6;
+        if (statisticsPool != VK_NULL_HANDLE)
+        {
+            const uint64_t* values = &statisticsScratch[i * STATISTIC_COUNT];
+            sample.statistics.inputVertices = values[0];
+            sample.statistics.inputPrimitives = values[1];
+            sample.statistics.vertexInvocations = values[2];
+            sample.statistics.clippingPrimitives = values[3];
+            sample.statistics.fragmentInvocations = values[4];
+            sample.statistics.computeInvocations = values[5];
+        }
+
+        GpuScopeStats& stats = scopeStats[sample.scope];
+        stats.minMilliseconds = stats.samples > 0 ? std::min(stats.minMilliseconds, sample.milliseconds) : sample.milliseconds;
+        stats.maxMilliseconds = std::max(stats.maxMilliseconds, sample.milliseconds);
+        stats.totalMilliseconds += sample.milliseconds;
+        stats.lastMilliseconds = sample.milliseconds;
+        stats.samples++;
+
+        latest.push_back(sample);
+        AddHistory(sample);
+    }
+    const uint64_t frameTicks = (timestampScratch[count * 2 - 1] - timestampScratch[0]) & timestampMask;
+    latestFrameMilliseconds = frameTicks * timestampPeriod * 1e-6;
+    recorded.scopes.clear();
+}
+
+/**
+ * @brief Index of the scope name, added on first use.
+ *
+ * @param name Scope name.
+ * @return uint32_t Index into names and scopeStats.
+ */
+uint32_t GpuProfiler::FindName(const std::string& name)
+{
+    for (uint32_t i = 0; i < names.size(); i++)
+    {
+        if (names[i] == name)
+        {
+            return i;
+        }
+    }
+    names.push_back(name);
+    scopeStats.emplace_back();
+    return static_cast<uint32_t>(names.size() - 1);
+}
+
+void GpuProfiler::AddHistory(const GpuScopeSample& sample)
+{
+    if (history.size() < HISTORY_CAPACITY)
+    {
+        history.push_back(sample);
+        return;
+    }
+    history[historyNext] = sample;
+    historyNext = (historyNext + 1) % HISTORY_CAPACITY;
+}
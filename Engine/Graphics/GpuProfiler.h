@@ -0,0 +1,208 @@
+/*****************************************************************//**
+ * \file   GpuProfiler.h
+ * \brief  Per-pass GPU timestamps and pipeline statistics through query pools
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Pipeline statistics of one scope, all zero unless statistics are enabled.
+ */
+struct GpuPipelineStatistics
+{
+    uint64_t inputVertices = 0;
+    uint64_t inputPrimitives = 0;
+    uint64_t vertexInvocations = 0;
+    //primitives that survived clipping
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentInvocations = 0;
+    uint64_t computeInvocations = 0;
+};
+
+/**
+ * @brief One scope of one frame.
+ */
+struct GpuScopeSample
+{
+    //frame number counted by the profiler, from 0
+    uint64_t frame = 0;
+    //index for GetScopeName
+    uint32_t scope = 0;
+    double milliseconds = 0.0;
+    GpuPipelineStatistics statistics;
+};
+
+/**
+ * @brief Every frame read back so far of one scope name.
+ */
+struct GpuScopeStats
+{
+    uint64_t samples = 0;
+    double totalMilliseconds = 0.0;
+    double minMilliseconds = 0.0;
+    double maxMilliseconds = 0.0;
+    //of the latest frame
+    double lastMilliseconds = 0.0;
+
+    double AverageMilliseconds() const { return samples > 0 ? totalMilliseconds / samples : 0.0; }
+};
+
+/**
+ * @brief Times GPU work per scope, usually one scope per render graph pass. Each
+ * scope writes a timestamp at its start and end, and optionally wraps a pipeline
+ * statistics query, into query pool ranges owned by the frame in flight. A slot's
+ * results are read when it is reused, after its fence was waited on, so reading
+ * never stalls and results trail recording by the number of frames in flight.
+ *
+ * Scopes don't nest and must begin and end outside a render pass. Render thread only.
+ */
+class GpuProfiler
+{
+public:
+    //scopes per frame, further scopes are not timed
+    static constexpr uint32_t MAX_SCOPES = 32;
+    //samples kept for GetHistory and the dumps, the oldest are overwritten
+    static constexpr uint32_t HISTORY_CAPACITY = 16384;
+    //what a statistics query counts, in the order results come back
+    static constexpr VkQueryPipelineStatisticFlags STATISTICS =
+        VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+
+    GpuProfiler() = default;
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    /**
+     * @param physicalDevice Checked for timestamp support and the tick period.
+     * @param device The logical device.
+     * @param queueFamily Family the profiled command buffers are submitted to.
+     * @param framesInFlight Query ranges, one per frame in flight.
+     * @param pipelineStatistics Also count STATISTICS per scope. The device must
+     * have been created with pipelineStatisticsQuery and inheritedQueries.
+     */
+    void Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t framesInFlight, bool pipelineStatistics);
+
+    /**
+     * @brief Destroys the query pools. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Reads the results of the frame that last used this slot and resets its
+     * queries. Call once the slot's fence has been waited on.
+     *
+     * @param commandBuffer The frame's primary buffer, outside a render pass.
+     * @param frame Frame in flight index.
+     */
+    void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+
+    /**
+     * @brief Closes the frame, scopes outside BeginFrame and EndFrame are ignored.
+     */
+    void EndFrame();
+
+    /**
+     * @brief Starts timing a scope.
+     *
+     * @param name Kept by the profiler, scopes with the same name are aggregated.
+     */
+    void BeginScope(VkCommandBuffer commandBuffer, const std::string& name);
+
+    void EndScope(VkCommandBuffer commandBuffer);
+
+    /**
+     * @brief Reads every slot still holding results. The device must be idle.
+     */
+    void Finish();
+
+    //false if the queue can't write timestamps, every call is then a no-op
+    bool IsEnabled() const { return timestampPool != VK_NULL_HANDLE; }
+
+    //flags secondary buffers executed inside a scope must inherit, 0 without statistics
+    VkQueryPipelineStatisticFlags GetInheritedStatistics() const { return statisticsPool != VK_NULL_HANDLE ? STATISTICS : 0; }
+
+    const std::string& GetScopeName(uint32_t scope) const { return names[scope]; }
+
+    uint32_t GetScopeCount() const { return static_cast<uint32_t>(names.size()); }
+
+    const GpuScopeStats& GetScopeStats(uint32_t scope) const { return scopeStats[scope]; }
+
+    //scopes of the latest frame read back, in recording order
+    const std::vector<GpuScopeSample>& GetLatestFrame() const { return latest; }
+
+    //first timestamp to last of the latest frame read back
+    double GetLatestFrameMilliseconds() const { return latestFrameMilliseconds; }
+
+    /**
+     * @brief Samples kept so far, oldest first.
+     */
+    std::vector<GpuScopeSample> GetHistory() const;
+
+    /**
+     * @brief Writes every kept sample, one row per scope per frame.
+     *
+     * @return bool False if the file could not be written.
+     */
+    bool WriteCsv(const std::string& path) const;
+
+    /**
+     * @brief Writes the per-scope summary and every kept sample.
+     *
+     * @return bool False if the file could not be written.
+     */
+    bool WriteJson(const std::string& path) const;
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct Slot
+    {
+        //profiler frame number recorded into the slot
+        uint64_t frame = 0;
+        //name index of each scope recorded, empty once read
+        std::vector<uint32_t> scopes;
+    };
+
+    void ReadSlot(uint32_t slot);
+    uint32_t FindName(const std::string& name);
+    void AddHistory(const GpuScopeSample& sample);
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueryPool timestampPool = VK_NULL_HANDLE;
+    //VK_NULL_HANDLE unless statistics were asked for
+    VkQueryPool statisticsPool = VK_NULL_HANDLE;
+    //nanoseconds per tick
+    double timestampPeriod = 1.0;
+    uint64_t timestampMask = ~0ull;
+
+    std::vector<Slot> slots;
+    //slot being recorded, UINT32_MAX outside BeginFrame and EndFrame
+    uint32_t currentSlot = UINT32_MAX;
+    bool inScope = false;
+    //false if the open scope was past MAX_SCOPES
+    bool scopeTimed = false;
+    uint64_t frameCounter = 0;
+    //scopes past MAX_SCOPES that were not timed
+    uint64_t droppedScopes = 0;
+
+    std::vector<std::string> names;
+    std::vector<GpuScopeStats> scopeStats;
+    std::vector<GpuScopeSample> latest;
+    double latestFrameMilliseconds = 0.0;
+
+    //ring of the last HISTORY_CAPACITY samples
+    std::vector<GpuScopeSample> history;
+    uint32_t historyNext = 0;
+
+    //query results of one slot, kept to avoid reallocating every frame
+    std::vector<uint64_t> timestampScratch;
+    std::vector<uint64_t> statisticsScratch;
+};
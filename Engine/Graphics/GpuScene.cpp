@@ -0,0 +1,382 @@
+/*****************************************************************//**
+ * \file   GpuScene.cpp
+ * \brief  Shared mesh buffers, per-instance storage buffers and GPU culling
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "GpuScene.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <stdexcept>
+
+/**
+ * @brief Creates the shared geometry buffers, the mesh table and the per-frame buffers.
+ *
+ * @param logicalDevice The logical device.
+ * @param gpuAllocator Where every buffer comes from.
+ * @param uploadQueue Queue mesh data is uploaded through.
+ * @param stride Size of one vertex in bytes.
+ * @param framesInFlight Copies of the per-frame buffers.
+ */
+void GpuScene::Init(VkDevice logicalDevice, GpuAllocator& gpuAllocator, UploadQueue& uploadQueue, uint32_t stride, uint32_t framesInFlight)
+{
+    device = logicalDevice;
+    allocator = &gpuAllocator;
+    uploads = &uploadQueue;
+    vertexStride = stride;
+
+    vertexBuffer = allocator->CreateBuffer(static_cast<VkDeviceSize>(MAX_VERTICES) * vertexStride,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, vertexAllocation);
+    indexBuffer = allocator->CreateBuffer(static_cast<VkDeviceSize>(MAX_INDICES) * sizeof(uint32_t),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexAllocation);
+    meshBuffer = allocator->CreateBuffer(MAX_MESHES * sizeof(MeshInfo),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, meshAllocation);
+
+    CreateDescriptors(framesInFlight);
+    for (FrameResources& frame : frames)
+    {
+        CreateFrameBuffers(frame, INITIAL_INSTANCE_CAPACITY);
+        WriteDescriptorSet(frame);
+    }
+    stats.instanceCapacity = INITIAL_INSTANCE_CAPACITY;
+}
+
+/**
+ * @brief Frees every buffer and the descriptors.
+ *
+ */
+void GpuScene::Shutdown()
+{
+    for (FrameResources& frame : frames)
+    {
+        DestroyFrameBuffers(frame);
+    }
+    frames.clear();
+
+    if (descriptorPool != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        descriptorPool = VK_NULL_HANDLE;
+    }
+    if (setLayout != VK_NULL_HANDLE)
+    {
+        vkDestroyDescriptorSetLayout(device, setLayout, nullptr);
+        setLayout = VK_NULL_HANDLE;
+    }
+
+    if (vertexBuffer != VK_NULL_HANDLE)
+    {
+        allocator->DestroyBuffer(meshBuffer, meshAllocation);
+        allocator->DestroyBuffer(indexBuffer, indexAllocation);
+        allocator->DestroyBuffer(vertexBuffer, vertexAllocation);
+        meshBuffer = indexBuffer = vertexBuffer = VK_NULL_HANDLE;
+    }
+    meshes.clear();
+}
+
+/**
+ * @brief Appends a mesh to the shared buffers through the upload queue.
+ *
+ * @param vertices vertexCount vertices of the stride given to Init.
+ * @param meshVertexCount Number of vertices.
+ * @param indices Indices relative to the mesh's first vertex.
+ * @param meshIndexCount Number of indices.
+ * @param boundingSphere Mesh space sphere enclosing every vertex, w is the radius.
+ * @return uint32_t Mesh index for GpuInstance::meshIndex.
+ */
+uint32_t GpuScene::AddMesh(const void* vertices, uint32_t meshVertexCount, const uint32_t* indices, uint32_t meshIndexCount, const glm::vec4& boundingSphere)
+{
+    if (meshes.size() >= MAX_MESHES || vertexCount + meshVertexCount > MAX_VERTICES || indexCount + meshIndexCount > MAX_INDICES)
+    {
+        throw std::runtime_error("GPU scene geometry buffers are full!");
+    }
+
+    MeshInfo mesh;
+    mesh.indexCount = meshIndexCount;
+    mesh.firstIndex = indexCount;
+    mesh.vertexOffset = static_cast<int32_t>(vertexCount);
+    mesh.boundingSphere = boundingSphere;
+
+    uploads->Upload(vertexBuffer, static_cast<VkDeviceSize>(vertexCount) * vertexStride, vertices, static_cast<VkDeviceSize>(meshVertexCount) * vertexStride);
+    uploads->Upload(indexBuffer, static_cast<VkDeviceSize>(indexCount) * sizeof(uint32_t), indices, static_cast<VkDeviceSize>(meshIndexCount) * sizeof(uint32_t));
+    uploads->Upload(meshBuffer, meshes.size() * sizeof(MeshInfo), &mesh, sizeof(MeshInfo));
+
+    vertexCount += meshVertexCount;
+    indexCount += meshIndexCount;
+    meshes.push_back(mesh);
+
+    stats.meshes = static_cast<uint32_t>(meshes.size());
+    stats.vertices = vertexCount;
+    stats.indices = indexCount;
+    return stats.meshes - 1;
+}
+
+/**
+ * @brief Writes this frame's instances into its persistently mapped buffer.
+ *
+ * @param frameIndex Frame in flight index, the GPU must be done with it.
+ * @param transforms One model matrix per instance.
+ * @param mesh Mesh every instance draws.
+ */
+void GpuScene::UpdateInstances(uint32_t frameIndex, const std::vector<glm::mat4>& transforms, uint32_t mesh)
+{
+    FrameResources& frame = frames[frameIndex];
+    uint32_t count = static_cast<uint32_t>(transforms.size());
+
+    // Only this frame's buffers are replaced, the others may still be in use
+    if (count > frame.capacity)
+    {
+        uint32_t capacity = frame.capacity;
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+        DestroyFrameBuffers(frame);
+        CreateFrameBuffers(frame, capacity);
+        WriteDescriptorSet(frame);
+        stats.bufferGrowths++;
+        stats.instanceCapacity = std::max(stats.instanceCapacity, capacity);
+    }
+
+    GpuInstance* instances = static_cast<GpuInstance*>(frame.instanceAllocation.mapped);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        instances[i].model = transforms[i];
+        instances[i].meshIndex = mesh;
+    }
+    frame.instanceCount = count;
+    stats.instances = count;
+}
+
+/**
+ * @brief Resets the draw count and dispatches cull.comp over every instance. The
+ * draws are ready for the indirect stage once the caller's barrier has run.
+ *
+ * @param commandBuffer Graphics command buffer, outside a render pass.
+ * @param frameIndex Frame in flight index.
+ * @param pipeline cull.comp pipeline.
+ * @param layout Its layout.
+ * @param viewProjection Matrix the frustum is taken from.
+ */
+void GpuScene::RecordCull(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkPipeline pipeline, VkPipelineLayout layout, const glm::mat4& viewProjection)
+{
+    FrameResources& frame = frames[frameIndex];
+    if (frame.instanceCount == 0)
+    {
+        return;
+    }
+
+    vkCmdFillBuffer(commandBuffer, frame.drawCount, 0, sizeof(uint32_t), 0);
+
+    VkBufferMemoryBarrier countReset{};
+    countReset.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    countReset.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    countReset.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    countReset.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    countReset.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    countReset.buffer = frame.drawCount;
+    countReset.offset = 0;
+    countReset.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+        0, nullptr, 1, &countReset, 0, nullptr);
+
+    CullConstants constants{};
+    ExtractFrustumPlanes(viewProjection, constants.frustumPlanes);
+    constants.instanceCount = frame.instanceCount;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &frame.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(commandBuffer, (frame.instanceCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+}
+
+/**
+ * @brief Draws every instance RecordCull kept with one indirect count draw.
+ *
+ * @param commandBuffer Graphics command buffer, inside the render pass.
+ * @param frameIndex Frame in flight index.
+ * @param pipeline indirect.vert pipeline.
+ * @param layout Its layout.
+ * @param viewProjection Matrix the instances are drawn with.
+ */
+void GpuScene::RecordDraw(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkPipeline pipeline, VkPipelineLayout layout, const glm::mat4& viewProjection)
+{
+    FrameResources& frame = frames[frameIndex];
+    if (frame.instanceCount == 0)
+    {
+        return;
+    }
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &frame.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &viewProjection);
+
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+    vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    vkCmdDrawIndexedIndirectCount(commandBuffer, frame.drawCommands, 0, frame.drawCount, 0,
+        frame.instanceCount, sizeof(VkDrawIndexedIndirectCommand));
+}
+
+/**
+ * @brief Gribb/Hartmann plane extraction from the rows of the matrix.
+ *
+ * @param viewProjection The matrix, clip space depth 0 to 1.
+ * @param planes Receives left, right, bottom, top, near, far, normalized.
+ */
+void GpuScene::ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+    // glm is column major, row i is m[0][i] .. m[3][i]
+    auto row = [&viewProjection](int i)
+    {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+    planes[0] = row(3) + row(0);
+    planes[1] = row(3) - row(0);
+    planes[2] = row(3) + row(1);
+    planes[3] = row(3) - row(1);
+    planes[4] = row(2);
+    planes[5] = row(3) - row(2);
+
+    for (int i = 0; i < 6; i++)
+    {
+        float length = glm::length(glm::vec3(planes[i]));
+        if (length > 0.0f)
+        {
+            planes[i] /= length;
+        }
+    }
+}
+
+/**
+ * @brief Writes geometry usage and instance buffer sizes.
+ *
+ * @param out Where to write it.
+ */
+void GpuScene::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "[GPU scene] %u meshes, %u/%u vertices, %u/%u indices, %u instances last frame, capacity %u (%u growths)\n",
+        stats.meshes, stats.vertices, MAX_VERTICES, stats.indices, MAX_INDICES, stats.instances, stats.instanceCapacity, stats.bufferGrowths);
+    out << line;
+}
+
+/**
+ * @brief Creates the set layout shared by the culling and drawing pipelines and
+ * one descriptor set per frame in flight.
+ *
+ * @param framesInFlight Number of sets.
+ */
+void GpuScene::CreateDescriptors(uint32_t framesInFlight)
+{
+    std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+    for (uint32_t i = 0; i < bindings.size(); i++)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    // Instances are also read by indirect.vert
+    bindings[0].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &setLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = static_cast<uint32_t>(bindings.size()) * framesInFlight;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = framesInFlight;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create descriptor pool!");
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(framesInFlight, setLayout);
+    std::vector<VkDescriptorSet> sets(framesInFlight);
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = descriptorPool;
+    allocInfo.descriptorSetCount = framesInFlight;
+    allocInfo.pSetLayouts = layouts.data();
+    if (vkAllocateDescriptorSets(device, &allocInfo, sets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to allocate descriptor sets!");
+    }
+
+    frames.resize(framesInFlight);
+    for (uint32_t i = 0; i < framesInFlight; i++)
+    {
+        frames[i].descriptorSet = sets[i];
+    }
+}
+
+/**
+ * @brief Creates a frame's instance, draw command and draw count buffers.
+ *
+ * @param frame Frame to fill in.
+ * @param capacity Instances the buffers hold.
+ */
+void GpuScene::CreateFrameBuffers(FrameResources& frame, uint32_t capacity)
+{
+    // Rewritten by the CPU every frame, read straight from mapped memory
+    frame.instances = allocator->CreateBuffer(static_cast<VkDeviceSize>(capacity) * sizeof(GpuInstance), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.instanceAllocation);
+    frame.drawCommands = allocator->CreateBuffer(static_cast<VkDeviceSize>(capacity) * sizeof(VkDrawIndexedIndirectCommand),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.drawCommandAllocation);
+    frame.drawCount = allocator->CreateBuffer(sizeof(uint32_t),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, frame.drawCountAllocation);
+    frame.capacity = capacity;
+}
+
+void GpuScene::DestroyFrameBuffers(FrameResources& frame)
+{
+    if (frame.instances == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    allocator->DestroyBuffer(frame.drawCount, frame.drawCountAllocation);
+    allocator->DestroyBuffer(frame.drawCommands, frame.drawCommandAllocation);
+    allocator->DestroyBuffer(frame.instances, frame.instanceAllocation);
+    frame.instances = frame.drawCommands = frame.drawCount = VK_NULL_HANDLE;
+    frame.capacity = 0;
+}
+
+/**
+ * @brief Points a frame's descriptor set at its current buffers.
+ *
+ * @param frame The frame, its set must not be in use by the GPU.
+ */
+void GpuScene::WriteDescriptorSet(const FrameResources& frame)
+{
+    std::array<VkDescriptorBufferInfo, 4> bufferInfos{};
+    bufferInfos[0] = { frame.instances, 0, VK_WHOLE_SIZE };
+    bufferInfos[1] = { meshBuffer, 0, VK_WHOLE_SIZE };
+    bufferInfos[2] = { frame.drawCommands, 0, VK_WHOLE_SIZE };
+    bufferInfos[3] = { frame.drawCount, 0, VK_WHOLE_SIZE };
+
+    std::array<VkWriteDescriptorSet, 4> writes{};
+    for (uint32_t i = 0; i < writes.size(); i++)
+    {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = frame.descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+}
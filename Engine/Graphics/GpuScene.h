@@ -0,0 +1,215 @@
+/*****************************************************************//**
+ * \file   GpuScene.h
+ * \brief  Shared mesh buffers, per-instance storage buffers and GPU culling
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "GpuAllocator.h"
+#include "UploadQueue.h"
+#include <glm/glm.hpp>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Where a mesh lives in the shared buffers. Layout matches Mesh in cull.comp.
+ */
+struct MeshInfo
+{
+    uint32_t indexCount = 0;
+    uint32_t firstIndex = 0;
+    int32_t vertexOffset = 0;
+    uint32_t padding = 0;
+    //xyz center, w radius, in mesh space
+    glm::vec4 boundingSphere{ 0.0f };
+};
+
+/**
+ * @brief One object to draw. Layout matches Instance in cull.comp and indirect.vert.
+ */
+struct GpuInstance
+{
+    glm::mat4 model;
+    uint32_t meshIndex;
+    uint32_t padding[3];
+};
+
+/**
+ * @brief Push constants of the culling pass. Layout matches cull.comp.
+ */
+struct CullConstants
+{
+    //left, right, bottom, top, near, far; xyz normal pointing inwards, w distance
+    glm::vec4 frustumPlanes[6];
+    uint32_t instanceCount;
+    uint32_t padding[3];
+};
+
+/**
+ * @brief Counters of the last frame and since startup.
+ */
+struct GpuSceneStats
+{
+    uint32_t meshes = 0;
+    uint32_t vertices = 0;
+    uint32_t indices = 0;
+    //instances submitted for culling last frame
+    uint32_t instances = 0;
+    //instances the per-frame buffers can hold before growing
+    uint32_t instanceCapacity = 0;
+    uint32_t bufferGrowths = 0;
+};
+
+/**
+ * @brief GPU-driven scene data. Every mesh is appended to one vertex and one index
+ * buffer, and every frame the visible instances are found by a compute shader
+ * that writes one VkDrawIndexedIndirectCommand per instance that survives frustum
+ * culling, plus the count consumed by vkCmdDrawIndexedIndirectCount. The CPU
+ * records the same handful of commands whatever the instance count.
+ *
+ * Instance, draw command and draw count buffers exist once per frame in flight,
+ * so a frame only touches buffers the GPU is done with. Render thread only.
+ */
+class GpuScene
+{
+public:
+    //shared geometry capacity, meshes past this throw
+    static constexpr uint32_t MAX_VERTICES = 1024 * 1024;
+    static constexpr uint32_t MAX_INDICES = 4 * 1024 * 1024;
+    static constexpr uint32_t MAX_MESHES = 1024;
+    //local_size_x of cull.comp
+    static constexpr uint32_t CULL_GROUP_SIZE = 64;
+    //per-frame instance capacity before the first growth
+    static constexpr uint32_t INITIAL_INSTANCE_CAPACITY = 1024;
+
+    GpuScene() = default;
+
+    GpuScene(const GpuScene&) = delete;
+    GpuScene& operator=(const GpuScene&) = delete;
+
+    /**
+     * @param device The logical device.
+     * @param allocator Where every buffer comes from.
+     * @param uploads Queue mesh data is uploaded through.
+     * @param vertexStride Size of one vertex in bytes.
+     * @param framesInFlight Copies of the per-frame buffers.
+     */
+    void Init(VkDevice device, GpuAllocator& allocator, UploadQueue& uploads, uint32_t vertexStride, uint32_t framesInFlight);
+
+    /**
+     * @brief Frees everything. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Appends a mesh to the shared buffers.
+     *
+     * @param vertices vertexCount vertices of the stride given to Init.
+     * @param vertexCount Number of vertices.
+     * @param indices Indices relative to the mesh's first vertex.
+     * @param indexCount Number of indices.
+     * @param boundingSphere Mesh space sphere enclosing every vertex, w is the radius.
+     * @return uint32_t Mesh index for GpuInstance::meshIndex.
+     */
+    uint32_t AddMesh(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const glm::vec4& boundingSphere);
+
+    const MeshInfo& GetMesh(uint32_t mesh) const { return meshes[mesh]; }
+
+    uint32_t GetMeshCount() const { return static_cast<uint32_t>(meshes.size()); }
+
+    VkBuffer GetVertexBuffer() const { return vertexBuffer; }
+
+    //indices are VK_INDEX_TYPE_UINT32
+    VkBuffer GetIndexBuffer() const { return indexBuffer; }
+
+    //instances, meshes, draw commands and draw count, bindings 0 to 3
+    VkDescriptorSetLayout GetDescriptorSetLayout() const { return setLayout; }
+
+    /**
+     * @brief Writes this frame's instances, growing its buffers when they don't fit.
+     * Call once the GPU is done with the frame.
+     *
+     * @param frame Frame in flight index.
+     * @param transforms One model matrix per instance.
+     * @param mesh Mesh every instance draws.
+     */
+    void UpdateInstances(uint32_t frame, const std::vector<glm::mat4>& transforms, uint32_t mesh);
+
+    /**
+     * @brief Records the culling pass. Outside a render pass, before RecordDraw,
+     * which must wait for its shader writes at VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT.
+     *
+     * @param commandBuffer Graphics command buffer.
+     * @param frame Frame in flight index.
+     * @param pipeline cull.comp pipeline.
+     * @param layout Its layout: GetDescriptorSetLayout at set 0, CullConstants.
+     * @param viewProjection Matrix the frustum is taken from.
+     */
+    void RecordCull(VkCommandBuffer commandBuffer, uint32_t frame, VkPipeline pipeline, VkPipelineLayout layout, const glm::mat4& viewProjection);
+
+    /**
+     * @brief Draws what RecordCull found visible. Inside the render pass.
+     *
+     * @param commandBuffer Graphics command buffer.
+     * @param frame Frame in flight index.
+     * @param pipeline indirect.vert pipeline, viewport and scissor already set.
+     * @param layout Its layout: GetDescriptorSetLayout at set 0, a mat4 vertex push constant.
+     * @param viewProjection Matrix the instances are drawn with.
+     */
+    void RecordDraw(VkCommandBuffer commandBuffer, uint32_t frame, VkPipeline pipeline, VkPipelineLayout layout, const glm::mat4& viewProjection);
+
+    /**
+     * @brief Frustum planes of a Vulkan (0 to 1 depth) view projection matrix.
+     *
+     * @param viewProjection The matrix.
+     * @param planes Receives left, right, bottom, top, near, far, normalized.
+     */
+    static void ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+
+    const GpuSceneStats& GetStats() const { return stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    //everything one frame in flight owns
+    struct FrameResources
+    {
+        VkBuffer instances = VK_NULL_HANDLE;
+        GpuAllocation instanceAllocation;
+        VkBuffer drawCommands = VK_NULL_HANDLE;
+        GpuAllocation drawCommandAllocation;
+        VkBuffer drawCount = VK_NULL_HANDLE;
+        GpuAllocation drawCountAllocation;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        uint32_t capacity = 0;
+        uint32_t instanceCount = 0;
+    };
+
+    void CreateDescriptors(uint32_t framesInFlight);
+    void CreateFrameBuffers(FrameResources& frame, uint32_t capacity);
+    void DestroyFrameBuffers(FrameResources& frame);
+    void WriteDescriptorSet(const FrameResources& frame);
+
+    VkDevice device = VK_NULL_HANDLE;
+    GpuAllocator* allocator = nullptr;
+    UploadQueue* uploads = nullptr;
+    uint32_t vertexStride = 0;
+
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    GpuAllocation vertexAllocation;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    GpuAllocation indexAllocation;
+    VkBuffer meshBuffer = VK_NULL_HANDLE;
+    GpuAllocation meshAllocation;
+    std::vector<MeshInfo> meshes;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    std::vector<FrameResources> frames;
+
+    GpuSceneStats stats;
+};
@@ -0,0 +1,320 @@
+/*****************************************************************//**
+ * \file   HeadlessTarget.cpp
+ * \brief  Offscreen frame targets with readback, for running without a window
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "HeadlessTarget.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+/**
+ * @brief Creates an image, a readback buffer and a timestamp pair per frame in flight.
+ *
+ * @param physicalDevice Checked for timestamp support.
+ * @param logicalDevice The logical device.
+ * @param gpuAllocator Where the images and readback buffers come from.
+ * @param frameExtent Size of every frame.
+ * @param queueFamily Family frames are submitted to.
+ * @param framesInFlight Images, one per frame in flight.
+ */
+void HeadlessTarget::Init(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, GpuAllocator& gpuAllocator, VkExtent2D frameExtent, uint32_t queueFamily, uint32_t framesInFlight)
+{
+    device = logicalDevice;
+    allocator = &gpuAllocator;
+    extent = frameExtent;
+    frames = std::vector<Frame>(framesInFlight);
+    images.assign(framesInFlight, VK_NULL_HANDLE);
+    views.assign(framesInFlight, VK_NULL_HANDLE);
+    lastFrame = UINT32_MAX;
+
+    const VkDeviceSize frameBytes = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+    for (uint32_t i = 0; i < framesInFlight; i++)
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = FORMAT;
+        imageInfo.extent = { extent.width, extent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(device, &imageInfo, nullptr, &images[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create headless image!");
+        }
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device, images[i], &requirements);
+        frames[i].imageMemory = allocator->Allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuResourceKind::Optimal);
+        vkBindImageMemory(device, images[i], frames[i].imageMemory.memory, frames[i].imageMemory.offset);
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = images[i];
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = FORMAT;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &viewInfo, nullptr, &views[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create headless image view!");
+        }
+
+        // Read on the CPU once the frame's fence signals, so no flush or invalidate is needed
+        frames[i].readback = allocator->CreateBuffer(frameBytes, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frames[i].readbackMemory);
+    }
+
+    // Queues with no valid timestamp bits can't time frames, CPU times are still kept
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+    const uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+    if (validBits > 0)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        timestampPeriod = properties.limits.timestampPeriod;
+        timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+        VkQueryPoolCreateInfo queryInfo{};
+        queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = framesInFlight * 2;
+        if (vkCreateQueryPool(device, &queryInfo, nullptr, &queryPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create headless query pool!");
+        }
+    }
+}
+
+/**
+ * @brief Destroys everything Init created.
+ *
+ */
+void HeadlessTarget::Shutdown()
+{
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        vkDestroyQueryPool(device, queryPool, nullptr);
+        queryPool = VK_NULL_HANDLE;
+    }
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        vkDestroyImageView(device, views[i], nullptr);
+        vkDestroyImage(device, images[i], nullptr);
+        allocator->Free(frames[i].imageMemory);
+        allocator->DestroyBuffer(frames[i].readback, frames[i].readbackMemory);
+    }
+    frames.clear();
+    images.clear();
+    views.clear();
+    lastFrame = UINT32_MAX;
+}
+
+/**
+ * @brief Reads the slot's previous timestamps and writes the new frame's first one.
+ *
+ * @param commandBuffer The frame's primary buffer, outside a render pass.
+ * @param frame Frame in flight index.
+ */
+void HeadlessTarget::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    if (queryPool == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    CollectGpuTime(frame);
+    vkCmdResetQueryPool(commandBuffer, queryPool, frame * 2, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, frame * 2);
+}
+
+/**
+ * @brief Records the copy into the readback buffer and the frame's last timestamp.
+ *
+ * @param commandBuffer The frame's primary buffer, outside a render pass.
+ * @param frame Frame in flight index.
+ */
+void HeadlessTarget::EndFrame(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = { 0, 0, 0 };
+    region.imageExtent = { extent.width, extent.height, 1 };
+    vkCmdCopyImageToBuffer(commandBuffer, images[frame], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, frames[frame].readback, 1, &region);
+
+    // Make the copy visible to the host reads after the fence
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = frames[frame].readback;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    if (queryPool != VK_NULL_HANDLE)
+    {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, frame * 2 + 1);
+        frames[frame].pending = true;
+    }
+    lastFrame = frame;
+    stats.frames++;
+}
+
+void HeadlessTarget::AddCpuTime(double seconds)
+{
+    stats.cpuMilliseconds.push_back(seconds * 1000.0);
+}
+
+/**
+ * @brief Reads every slot's outstanding timestamps.
+ *
+ */
+void HeadlessTarget::Finish()
+{
+    for (uint32_t frame = 0; frame < frames.size(); frame++)
+    {
+        CollectGpuTime(frame);
+    }
+}
+
+/**
+ * @brief Hashes the readback buffer of the last frame.
+ *
+ * @return uint64_t 0 before the first frame.
+ */
+uint64_t HeadlessTarget::Checksum() const
+{
+    if (lastFrame == UINT32_MAX)
+    {
+        return 0;
+    }
+    const uint8_t* pixels = static_cast<const uint8_t*>(frames[lastFrame].readbackMemory.mapped);
+    const size_t size = static_cast<size_t>(extent.width) * extent.height * 4;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ pixels[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Writes the last frame as a P6 PPM, dropping alpha.
+ *
+ * @param path File to create or overwrite.
+ * @return bool False if there is no frame yet or the file could not be written.
+ */
+bool HeadlessTarget::WritePpm(const std::string& path) const
+{
+    if (lastFrame == UINT32_MAX)
+    {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+
+    const uint8_t* pixels = static_cast<const uint8_t*>(frames[lastFrame].readbackMemory.mapped);
+    std::vector<char> row(static_cast<size_t>(extent.width) * 3);
+    for (uint32_t y = 0; y < extent.height; y++)
+    {
+        const uint8_t* source = pixels + static_cast<size_t>(y) * extent.width * 4;
+        for (uint32_t x = 0; x < extent.width; x++)
+        {
+            row[x * 3 + 0] = static_cast<char>(source[x * 4 + 0]);
+            row[x * 3 + 1] = static_cast<char>(source[x * 4 + 1]);
+            row[x * 3 + 2] = static_cast<char>(source[x * 4 + 2]);
+        }
+        file.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    return static_cast<bool>(file);
+}
+
+/**
+ * @brief Averages and percentiles of one list of frame times.
+ *
+ * @param label Printed before the numbers.
+ * @param milliseconds Frame times, copied to sort.
+ */
+static void PrintFrameTimes(std::ostream& out, const char* label, std::vector<double> milliseconds)
+{
+    if (milliseconds.empty())
+    {
+        return;
+    }
+    std::sort(milliseconds.begin(), milliseconds.end());
+    double total = 0.0;
+    for (double value : milliseconds)
+    {
+        total += value;
+    }
+    const size_t last = milliseconds.size() - 1;
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Headless] %s ms/frame: avg %.3f, p50 %.3f, p99 %.3f, max %.3f\n", label,
+        total / milliseconds.size(), milliseconds[last / 2], milliseconds[last * 99 / 100], milliseconds[last]);
+    out << line;
+}
+
+void HeadlessTarget::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Headless] %llu frames at %ux%u, last frame checksum %016llx\n",
+        static_cast<unsigned long long>(stats.frames), extent.width, extent.height, static_cast<unsigned long long>(Checksum()));
+    out << line;
+    PrintFrameTimes(out, "CPU", stats.cpuMilliseconds);
+    if (HasTimestamps())
+    {
+        PrintFrameTimes(out, "GPU", stats.gpuMilliseconds);
+    }
+    else
+    {
+        out << "[Headless] GPU times unavailable, the queue has no timestamp support\n";
+    }
+}
+
+/**
+ * @brief Turns the slot's timestamp pair into a frame time, if it has one.
+ *
+ * @param frame Frame in flight index, its fence must have signaled.
+ */
+void HeadlessTarget::CollectGpuTime(uint32_t frame)
+{
+    if (queryPool == VK_NULL_HANDLE || !frames[frame].pending)
+    {
+        return;
+    }
+    uint64_t timestamps[2] = {};
+    if (vkGetQueryPoolResults(device, queryPool, frame * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+    {
+        const uint64_t ticks = (timestamps[1] - timestamps[0]) & timestampMask;
+        stats.gpuMilliseconds.push_back(ticks * timestampPeriod * 1e-6);
+    }
+    frames[frame].pending = false;
+}
@@ -0,0 +1,137 @@
+/*****************************************************************//**
+ * \file   HeadlessTarget.h
+ * \brief  Offscreen frame targets with readback, for running without a window
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "GpuAllocator.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Frames rendered so far and what each one cost, in milliseconds.
+ */
+struct HeadlessStats
+{
+    uint64_t frames = 0;
+    //CPU time from the frame's fence wait to its submit
+    std::vector<double> cpuMilliseconds;
+    //GPU time between the frame's first and last command, empty without timestamps
+    std::vector<double> gpuMilliseconds;
+};
+
+/**
+ * @brief Stands in for the swap chain when there is no window. Each frame in
+ * flight renders into an image of its own, which is copied into a host visible
+ * buffer at the end of the frame, so the last finished frame can be checked or
+ * saved. A timestamp pair around each frame gives its GPU time; results are read
+ * once the frame's fence has been waited on, so reading them never stalls.
+ * Render thread only.
+ */
+class HeadlessTarget
+{
+public:
+    //R8G8B8A8 so readback rows are plain RGBA bytes
+    static constexpr VkFormat FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+    HeadlessTarget() = default;
+
+    HeadlessTarget(const HeadlessTarget&) = delete;
+    HeadlessTarget& operator=(const HeadlessTarget&) = delete;
+
+    /**
+     * @param physicalDevice Checked for timestamp support.
+     * @param device The logical device.
+     * @param allocator Where the images and readback buffers come from.
+     * @param extent Size of every frame.
+     * @param queueFamily Family frames are submitted to.
+     * @param framesInFlight Images, one per frame in flight.
+     */
+    void Init(VkPhysicalDevice physicalDevice, VkDevice device, GpuAllocator& allocator, VkExtent2D extent, uint32_t queueFamily, uint32_t framesInFlight);
+
+    /**
+     * @brief Frees the images, buffers and queries. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Collects the GPU time of the frame that last used this slot and starts
+     * timing the new one. Call once the slot's fence has been waited on.
+     *
+     * @param commandBuffer The frame's primary buffer, outside a render pass.
+     * @param frame Frame in flight index, also the image rendered into.
+     */
+    void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+
+    /**
+     * @brief Copies the frame's image into its readback buffer and stops timing.
+     * The image must be in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
+     */
+    void EndFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+
+    //CPU time of the frame just submitted
+    void AddCpuTime(double seconds);
+
+    /**
+     * @brief Collects the GPU times still outstanding. The device must be idle.
+     */
+    void Finish();
+
+    /**
+     * @brief FNV-1a hash of the last frame's pixels, to compare runs. Call after Finish.
+     */
+    uint64_t Checksum() const;
+
+    /**
+     * @brief Saves the last frame as a binary PPM. Call after Finish.
+     *
+     * @return bool False if the file could not be written.
+     */
+    bool WritePpm(const std::string& path) const;
+
+    const std::vector<VkImage>& GetImages() const { return images; }
+
+    const std::vector<VkImageView>& GetImageViews() const { return views; }
+
+    VkExtent2D GetExtent() const { return extent; }
+
+    bool HasTimestamps() const { return queryPool != VK_NULL_HANDLE; }
+
+    const HeadlessStats& GetStats() const { return stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct Frame
+    {
+        GpuAllocation imageMemory;
+        VkBuffer readback = VK_NULL_HANDLE;
+        GpuAllocation readbackMemory;
+        //timestamps written and not yet read
+        bool pending = false;
+    };
+
+    void CollectGpuTime(uint32_t frame);
+
+    VkDevice device = VK_NULL_HANDLE;
+    GpuAllocator* allocator = nullptr;
+    VkExtent2D extent{};
+
+    std::vector<Frame> frames;
+    std::vector<VkImage> images;
+    std::vector<VkImageView> views;
+    //slot of the last EndFrame, UINT32_MAX before the first
+    uint32_t lastFrame = UINT32_MAX;
+
+    //two timestamps per frame in flight, VK_NULL_HANDLE if the queue can't write them
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    //nanoseconds per tick
+    double timestampPeriod = 1.0;
+    uint64_t timestampMask = ~0ull;
+
+    HeadlessStats stats;
+};
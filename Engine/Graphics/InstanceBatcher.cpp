@@ -0,0 +1,165 @@
+/*****************************************************************//**
+ * \file   InstanceBatcher.cpp
+ * \brief  Groups objects by mesh and material into instanced draws
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "InstanceBatcher.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+/**
+ * @brief Creates one mapped instance buffer per frame in flight.
+ *
+ * @param gpuAllocator Where the instance buffers come from.
+ * @param framesInFlight Copies of the instance buffer.
+ */
+void InstanceBatcher::Init(GpuAllocator& gpuAllocator, uint32_t framesInFlight)
+{
+    allocator = &gpuAllocator;
+    frames = std::vector<FrameBuffer>(framesInFlight);
+    for (FrameBuffer& frame : frames)
+    {
+        CreateFrameBuffer(frame, INITIAL_CAPACITY);
+    }
+    stats.capacity = INITIAL_CAPACITY;
+}
+
+/**
+ * @brief Frees every instance buffer.
+ *
+ */
+void InstanceBatcher::Shutdown()
+{
+    for (FrameBuffer& frame : frames)
+    {
+        DestroyFrameBuffer(frame);
+    }
+    frames.clear();
+    batches.clear();
+}
+
+/**
+ * @brief Buckets the objects by mesh and material and writes each bucket's
+ * instances next to each other.
+ *
+ * @param frameIndex Frame in flight index.
+ * @param transforms Model matrix of each object.
+ * @param renderables Mesh and material of each object.
+ * @param meshCount Meshes in the scene.
+ * @param merge False gives every object a draw of its own.
+ */
+void InstanceBatcher::Build(uint32_t frameIndex, const std::vector<glm::mat4>& transforms, const std::vector<Renderable>& renderables, uint32_t meshCount, bool merge)
+{
+    if (renderables.size() != transforms.size())
+    {
+        throw std::runtime_error("Every transform needs a renderable!");
+    }
+    FrameBuffer& frame = frames[frameIndex];
+    uint32_t count = static_cast<uint32_t>(transforms.size());
+
+    // Only this frame's buffer is replaced, the others may still be in use
+    if (count > frame.capacity)
+    {
+        uint32_t capacity = frame.capacity;
+        while (capacity < count)
+        {
+            capacity *= 2;
+        }
+        DestroyFrameBuffer(frame);
+        CreateFrameBuffer(frame, capacity);
+        stats.bufferGrowths++;
+        stats.capacity = std::max(stats.capacity, capacity);
+    }
+
+    // Count the objects of every mesh and material, in order of first appearance
+    batches.clear();
+    batchLookup.clear();
+    objectBatches.resize(count);
+    uint64_t lastKey = UINT64_MAX;
+    uint32_t lastBatch = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const Renderable& renderable = renderables[i];
+        if (renderable.mesh >= meshCount)
+        {
+            throw std::runtime_error("Renderable mesh index out of range!");
+        }
+
+        uint64_t key = (static_cast<uint64_t>(renderable.mesh) << 32) | renderable.material;
+        if (!merge)
+        {
+            lastBatch = static_cast<uint32_t>(batches.size());
+            batches.push_back(InstanceBatch{ renderable.mesh, renderable.material, 0, 0 });
+        }
+        // Neighbours usually share a mesh, as they come from the same chunk
+        else if (key != lastKey)
+        {
+            auto [it, inserted] = batchLookup.try_emplace(key, static_cast<uint32_t>(batches.size()));
+            if (inserted)
+            {
+                batches.push_back(InstanceBatch{ renderable.mesh, renderable.material, 0, 0 });
+            }
+            lastBatch = it->second;
+            lastKey = key;
+        }
+        objectBatches[i] = lastBatch;
+        batches[lastBatch].instanceCount++;
+    }
+
+    // Each batch starts where the previous one ends
+    batchCursors.resize(batches.size());
+    uint32_t firstInstance = 0;
+    for (size_t b = 0; b < batches.size(); b++)
+    {
+        batches[b].firstInstance = firstInstance;
+        batchCursors[b] = firstInstance;
+        firstInstance += batches[b].instanceCount;
+    }
+
+    InstanceData* instances = static_cast<InstanceData*>(frame.allocation.mapped);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        InstanceData& instance = instances[batchCursors[objectBatches[i]]++];
+        instance.model = transforms[i];
+        instance.material = renderables[i].material;
+    }
+
+    stats.frames++;
+    stats.objects = count;
+    stats.draws = static_cast<uint32_t>(batches.size());
+}
+
+/**
+ * @brief Writes how many draws the last frame's objects were merged into.
+ *
+ * @param out Where to write it.
+ */
+void InstanceBatcher::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Instancing] %llu frames, %u objects in %u draws last frame, capacity %u (%u growths)\n",
+        static_cast<unsigned long long>(stats.frames), stats.objects, stats.draws, stats.capacity, stats.bufferGrowths);
+    out << line;
+}
+
+void InstanceBatcher::CreateFrameBuffer(FrameBuffer& frame, uint32_t capacity)
+{
+    // Written by the CPU every frame, read by the vertex fetch straight from mapped memory
+    frame.buffer = allocator->CreateBuffer(static_cast<VkDeviceSize>(capacity) * sizeof(InstanceData), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, frame.allocation);
+    frame.capacity = capacity;
+}
+
+void InstanceBatcher::DestroyFrameBuffer(FrameBuffer& frame)
+{
+    if (frame.buffer == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    allocator->DestroyBuffer(frame.buffer, frame.allocation);
+    frame.buffer = VK_NULL_HANDLE;
+    frame.capacity = 0;
+}
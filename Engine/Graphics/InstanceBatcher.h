@@ -0,0 +1,157 @@
+/*****************************************************************//**
+ * \file   InstanceBatcher.h
+ * \brief  Groups objects by mesh and material into instanced draws
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "GpuAllocator.h"
+#include "Renderable.h"
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Per-instance vertex data, binding 1 at VK_VERTEX_INPUT_RATE_INSTANCE.
+ * Layout matches the instance inputs of shader.vert.
+ */
+struct InstanceData
+{
+    glm::mat4 model;
+    uint32_t material;
+    uint32_t padding[3];
+
+    static VkVertexInputBindingDescription getBindingDescription()
+    {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 1;
+        bindingDescription.stride = sizeof(InstanceData);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        return bindingDescription;
+    }
+
+    //a mat4 takes one location per column, locations 2 to 5, then the material at 6
+    static std::array<VkVertexInputAttributeDescription, 5> getAttributeDescriptions()
+    {
+        std::array<VkVertexInputAttributeDescription, 5> attributeDescriptions{};
+        for (uint32_t column = 0; column < 4; column++)
+        {
+            attributeDescriptions[column].binding = 1;
+            attributeDescriptions[column].location = 2 + column;
+            attributeDescriptions[column].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            attributeDescriptions[column].offset = static_cast<uint32_t>(offsetof(InstanceData, model) + column * sizeof(glm::vec4));
+        }
+
+        attributeDescriptions[4].binding = 1;
+        attributeDescriptions[4].location = 6;
+        attributeDescriptions[4].format = VK_FORMAT_R32_UINT;
+        attributeDescriptions[4].offset = offsetof(InstanceData, material);
+        return attributeDescriptions;
+    }
+};
+
+/**
+ * @brief One instanced draw: instanceCount instances of mesh starting at
+ * firstInstance in the frame's instance buffer.
+ */
+struct InstanceBatch
+{
+    uint32_t mesh = 0;
+    uint32_t material = 0;
+    uint32_t firstInstance = 0;
+    uint32_t instanceCount = 0;
+};
+
+/**
+ * @brief Counters of the last frame and since startup.
+ */
+struct InstanceBatcherStats
+{
+    uint64_t frames = 0;
+    //objects and draws of the last frame
+    uint32_t objects = 0;
+    uint32_t draws = 0;
+    //instances the per-frame buffers can hold before growing
+    uint32_t capacity = 0;
+    uint32_t bufferGrowths = 0;
+};
+
+/**
+ * @brief Turns a frame's objects into as few draws as possible. Objects are
+ * bucketed by mesh and material with a counting sort, so building is linear in
+ * the object count, and each bucket's instances are written contiguously into a
+ * persistently mapped buffer, one per frame in flight, bound as the per-instance
+ * vertex binding. Render thread only.
+ */
+class InstanceBatcher
+{
+public:
+    //per-frame instance capacity before the first growth
+    static constexpr uint32_t INITIAL_CAPACITY = 1024;
+
+    InstanceBatcher() = default;
+
+    InstanceBatcher(const InstanceBatcher&) = delete;
+    InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+
+    /**
+     * @param allocator Where the instance buffers come from.
+     * @param framesInFlight Copies of the instance buffer.
+     */
+    void Init(GpuAllocator& allocator, uint32_t framesInFlight);
+
+    /**
+     * @brief Frees the instance buffers. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Buckets this frame's objects and writes their instances. Call once the
+     * GPU is done with the frame.
+     *
+     * @param frame Frame in flight index.
+     * @param transforms Model matrix of each object.
+     * @param renderables Mesh and material of each object, same order as transforms.
+     * @param meshCount Meshes in the scene, objects must use one of them.
+     * @param merge False gives every object a draw of its own, to compare against.
+     */
+    void Build(uint32_t frame, const std::vector<glm::mat4>& transforms, const std::vector<Renderable>& renderables, uint32_t meshCount, bool merge = true);
+
+    //draws of the last Build, ordered by first appearance of each mesh and material
+    const std::vector<InstanceBatch>& GetBatches() const { return batches; }
+
+    //binding 1 for the frame's draws, firstInstance indexes into it
+    VkBuffer GetInstanceBuffer(uint32_t frame) const { return frames[frame].buffer; }
+
+    const InstanceBatcherStats& GetStats() const { return stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct FrameBuffer
+    {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        GpuAllocation allocation;
+        uint32_t capacity = 0;
+    };
+
+    void CreateFrameBuffer(FrameBuffer& frame, uint32_t capacity);
+    void DestroyFrameBuffer(FrameBuffer& frame);
+
+    GpuAllocator* allocator = nullptr;
+    std::vector<FrameBuffer> frames;
+
+    std::vector<InstanceBatch> batches;
+    //scratch kept between frames: (mesh << 32 | material) to batch index, batch of
+    //each object, next free instance of each batch
+    std::unordered_map<uint64_t, uint32_t> batchLookup;
+    std::vector<uint32_t> objectBatches;
+    std::vector<uint32_t> batchCursors;
+
+    InstanceBatcherStats stats;
+};
@@ -0,0 +1,291 @@
+/*****************************************************************//**
+ * \file   PipelineCache.cpp
+ * \brief  VkPipelineCache that persists to disk between runs
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "PipelineCache.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+    //layout of the header every driver puts in front of its cache data
+    constexpr size_t DRIVER_HEADER_SIZE = 16 + VK_UUID_SIZE;
+
+    uint64_t HashBytes(const char* data, size_t size)
+    {
+        // FNV-1a, only guards against truncated or damaged files
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    uint32_t ReadUint32(const char* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+}
+
+/**
+ * @brief Creates the cache, seeded from path if the file fits this device.
+ *
+ * @param physicalDevice Used to validate the file header.
+ * @param logicalDevice The logical device.
+ * @param path Cache file, written back by Save.
+ */
+void PipelineCache::Load(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, const std::string& path)
+{
+    device = logicalDevice;
+    filePath = path;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+    std::vector<char> file;
+    std::ifstream stream(path, std::ios::ate | std::ios::binary);
+    if (stream.is_open())
+    {
+        file.resize(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        stream.read(file.data(), file.size());
+    }
+
+    stats.coldReason = stream.is_open() ? ValidateFile(file) : "no cache file";
+    if (stats.coldReason == nullptr)
+    {
+        initialData.assign(file.begin() + sizeof(FileHeader), file.end());
+        stats.warm = true;
+        stats.loadedBytes = initialData.size();
+    }
+
+    cache = CreateCache(initialData.data(), initialData.size());
+}
+
+/**
+ * @brief Merges the thread caches and writes the result next to a temporary
+ * file first, so a crash mid-write never leaves a half written cache behind.
+ *
+ */
+void PipelineCache::Save()
+{
+    if (cache == VK_NULL_HANDLE)
+    {
+        return;
+    }
+    MergeThreadCaches();
+
+    size_t size = 0;
+    vkGetPipelineCacheData(device, cache, &size, nullptr);
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(device, cache, &size, data.data()) != VK_SUCCESS)
+    {
+        std::cerr << "Failed to read pipeline cache data!" << std::endl;
+        return;
+    }
+    data.resize(size);
+
+    FileHeader header{};
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.driverVersion = deviceProperties.driverVersion;
+    header.dataSize = size;
+    header.dataHash = HashBytes(data.data(), size);
+
+    std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(data.data(), data.size());
+        if (!stream)
+        {
+            std::cerr << "Failed to write pipeline cache " << tempPath << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, filePath, error);
+    if (error)
+    {
+        std::cerr << "Failed to replace pipeline cache " << filePath << ": " << error.message() << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.savedBytes = size;
+}
+
+/**
+ * @brief Destroys the main and thread caches.
+ *
+ */
+void PipelineCache::Destroy()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [thread, threadCache] : threadCaches)
+    {
+        vkDestroyPipelineCache(device, threadCache, nullptr);
+    }
+    threadCaches.clear();
+    if (cache != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineCache(device, cache, nullptr);
+        cache = VK_NULL_HANDLE;
+    }
+}
+
+/**
+ * @brief The calling thread's own cache, created on first use.
+ *
+ * @return VkPipelineCache Cache only this thread creates pipelines with.
+ */
+VkPipelineCache PipelineCache::GetThreadCache()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = threadCaches.find(std::this_thread::get_id());
+    if (found != threadCaches.end())
+    {
+        return found->second;
+    }
+    VkPipelineCache threadCache = CreateCache(initialData.data(), initialData.size());
+    threadCaches.emplace(std::this_thread::get_id(), threadCache);
+    return threadCache;
+}
+
+/**
+ * @brief Folds every thread cache into the main cache.
+ *
+ */
+void PipelineCache::MergeThreadCaches()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (threadCaches.empty())
+    {
+        return;
+    }
+
+    std::vector<VkPipelineCache> sources;
+    sources.reserve(threadCaches.size());
+    for (auto& [thread, threadCache] : threadCaches)
+    {
+        sources.push_back(threadCache);
+    }
+    if (vkMergePipelineCaches(device, cache, static_cast<uint32_t>(sources.size()), sources.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to merge pipeline caches!");
+    }
+}
+
+/**
+ * @brief Adds a vkCreate*Pipelines call to the timing stats.
+ *
+ * @param duration Time spent in the call.
+ * @param pipelineCount Pipelines it created.
+ */
+void PipelineCache::RecordCreation(std::chrono::steady_clock::duration duration, uint32_t pipelineCount)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.createMs += std::chrono::duration<double, std::milli>(duration).count();
+    stats.pipelinesCreated += pipelineCount;
+}
+
+PipelineCacheStats PipelineCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Writes whether the cache was warm and what pipeline creation cost.
+ *
+ * @param out Where to write it.
+ */
+void PipelineCache::PrintReport(std::ostream& out) const
+{
+    PipelineCacheStats current = GetStats();
+    char line[256];
+    if (current.warm)
+    {
+        std::snprintf(line, sizeof(line), "[Pipeline cache] warm, %.1f KB loaded, %u pipelines created in %.3f ms\n",
+            current.loadedBytes / 1024.0, current.pipelinesCreated, current.createMs);
+    }
+    else
+    {
+        std::snprintf(line, sizeof(line), "[Pipeline cache] cold (%s), %u pipelines created in %.3f ms\n",
+            current.coldReason, current.pipelinesCreated, current.createMs);
+    }
+    out << line;
+}
+
+/**
+ * @brief Checks a cache file against this device and driver.
+ *
+ * @param file Whole file contents.
+ * @return const char* Why the file can't be used, or null if it can.
+ */
+const char* PipelineCache::ValidateFile(const std::vector<char>& file) const
+{
+    FileHeader header{};
+    if (file.size() < sizeof(FileHeader))
+    {
+        return "cache file truncated";
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+    {
+        return "unknown cache file format";
+    }
+    if (header.dataSize != file.size() - sizeof(FileHeader))
+    {
+        return "cache file truncated";
+    }
+    const char* data = file.data() + sizeof(FileHeader);
+    if (header.dataHash != HashBytes(data, header.dataSize))
+    {
+        return "cache file corrupted";
+    }
+    if (header.driverVersion != deviceProperties.driverVersion)
+    {
+        return "driver version changed";
+    }
+
+    // The driver's own header, drivers are allowed to crash on data from someone else
+    if (header.dataSize < DRIVER_HEADER_SIZE || ReadUint32(data) < DRIVER_HEADER_SIZE ||
+        ReadUint32(data + 4) != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+    {
+        return "unknown driver cache header";
+    }
+    if (ReadUint32(data + 8) != deviceProperties.vendorID || ReadUint32(data + 12) != deviceProperties.deviceID)
+    {
+        return "cache from another GPU";
+    }
+    if (std::memcmp(data + 16, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        return "pipeline cache UUID changed";
+    }
+    return nullptr;
+}
+
+VkPipelineCache PipelineCache::CreateCache(const void* data, size_t size) const
+{
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = size;
+    createInfo.pInitialData = size > 0 ? data : nullptr;
+
+    VkPipelineCache result;
+    if (vkCreatePipelineCache(device, &createInfo, nullptr, &result) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+    return result;
+}
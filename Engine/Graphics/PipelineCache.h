@@ -0,0 +1,122 @@
+/*****************************************************************//**
+ * \file   PipelineCache.h
+ * \brief  VkPipelineCache that persists to disk between runs
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief How the cache was loaded and how long pipeline creation took with it.
+ */
+struct PipelineCacheStats
+{
+    //true if usable data was loaded from disk
+    bool warm = false;
+    //why the file wasn't used, null when warm
+    const char* coldReason = nullptr;
+    size_t loadedBytes = 0;
+    size_t savedBytes = 0;
+    uint32_t pipelinesCreated = 0;
+    //total time spent in vkCreate*Pipelines
+    double createMs = 0.0;
+};
+
+/**
+ * @brief Keeps compiled pipelines across runs. Load reads the cache file and only
+ * hands it to the driver if its header matches this exact device and driver;
+ * otherwise the cache starts empty. Save writes the merged cache back.
+ *
+ * Threads that create pipelines concurrently should use GetThreadCache, each is
+ * seeded with the loaded data and merged into the main cache before saving.
+ */
+class PipelineCache
+{
+public:
+    PipelineCache() = default;
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    /**
+     * @brief Creates the cache, seeded from path if the file fits this device.
+     *
+     * @param physicalDevice Used to validate the file header.
+     * @param device The logical device.
+     * @param path Cache file, written back by Save.
+     */
+    void Load(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path);
+
+    /**
+     * @brief Merges the thread caches and writes everything to the file given to Load.
+     */
+    void Save();
+
+    /**
+     * @brief Destroys the main and thread caches.
+     */
+    void Destroy();
+
+    VkPipelineCache Get() const { return cache; }
+
+    /**
+     * @brief The calling thread's own cache, so pipeline creation on different threads
+     * never contends on one cache.
+     */
+    VkPipelineCache GetThreadCache();
+
+    /**
+     * @brief Folds every thread cache into the main cache.
+     */
+    void MergeThreadCaches();
+
+    /**
+     * @brief Adds a vkCreate*Pipelines call to the timing stats.
+     *
+     * @param duration Time spent in the call.
+     * @param pipelineCount Pipelines it created.
+     */
+    void RecordCreation(std::chrono::steady_clock::duration duration, uint32_t pipelineCount);
+
+    PipelineCacheStats GetStats() const;
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    //written in front of the driver's data to catch truncated or stale files
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t driverVersion;
+        uint32_t reserved;
+        uint64_t dataSize;
+        uint64_t dataHash;
+    };
+
+    static constexpr uint32_t FILE_MAGIC = 0x48435046; //"FPCH"
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    const char* ValidateFile(const std::vector<char>& file) const;
+    VkPipelineCache CreateCache(const void* data, size_t size) const;
+
+    VkDevice device = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties deviceProperties{};
+    std::string filePath;
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    //driver data from the file, seeds thread caches
+    std::vector<char> initialData;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::thread::id, VkPipelineCache> threadCaches;
+    PipelineCacheStats stats;
+};
@@ -0,0 +1,670 @@
+/*****************************************************************//**
+ * \file   PipelineLibrary.cpp
+ * \brief  Graphics pipelines cached by a hash of their state, compiled in the background
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "PipelineLibrary.h"
+#include "DeletionQueue.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+    // FNV-1a, continued from hash
+    uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t HashValue(uint64_t hash, const T& value)
+    {
+        return HashBytes(hash, &value, sizeof(value));
+    }
+
+    // Vulkan description structs are plain 32-bit fields without padding
+    template <typename T>
+    uint64_t HashArray(uint64_t hash, const std::vector<T>& values)
+    {
+        hash = HashValue(hash, values.size());
+        return HashBytes(hash, values.data(), values.size() * sizeof(T));
+    }
+}
+
+/**
+ * @param logicalDevice The logical device.
+ * @param cache Every thread compiles with its own cache from here.
+ * @param threadCount Compile threads, at least 1.
+ */
+void PipelineLibrary::Init(VkDevice logicalDevice, PipelineCache& cache, uint32_t threadCount)
+{
+    device = logicalDevice;
+    pipelineCache = &cache;
+    stopping = false;
+    stats = {};
+    fallbackUses = 0;
+    for (uint32_t i = 0; i < std::max(threadCount, 1u); i++)
+    {
+        threads.emplace_back(&PipelineLibrary::CompileThreadMain, this);
+    }
+}
+
+/**
+ * @brief Stops the compile threads, then destroys the pipelines and shader modules.
+ *
+ */
+void PipelineLibrary::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    queueChanged.notify_all();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    threads.clear();
+
+    for (std::unique_ptr<Entry>& entry : entries)
+    {
+        VkPipeline pipeline = entry->pipeline.load(std::memory_order_acquire);
+        if (pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        }
+    }
+    entries.clear();
+    pipelineIds.clear();
+    reloads.clear();
+    abandonedReloads.clear();
+
+    for (auto& [path, shader] : shaders)
+    {
+        vkDestroyShaderModule(device, shader.module, nullptr);
+    }
+    shaders.clear();
+    for (VkShaderModule module : retiredModules)
+    {
+        vkDestroyShaderModule(device, module, nullptr);
+    }
+    retiredModules.clear();
+}
+
+/**
+ * @brief Finds or compiles the pipeline, it is ready on return.
+ *
+ * @param desc Pipeline state.
+ * @return uint32_t Pipeline id for Get.
+ */
+uint32_t PipelineLibrary::Request(const GraphicsPipelineDesc& desc)
+{
+    uint64_t hash;
+    uint32_t id = Find(desc, hash);
+    if (id == INVALID_PIPELINE)
+    {
+        id = AddEntry(desc, hash, INVALID_PIPELINE);
+        pipelineIds.emplace(hash, id);
+    }
+
+    Entry* entry;
+    bool compileHere = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        entry = entries[id].get();
+        // New, or still queued: compile it here instead of waiting for a compile thread to get to it
+        if (entry->state.load(std::memory_order_acquire) == State::Queued)
+        {
+            queue.erase(std::remove(queue.begin(), queue.end(), entry), queue.end());
+            entry->state.store(State::Compiling, std::memory_order_relaxed);
+            stats.syncCompiles++;
+            compileHere = true;
+        }
+        else
+        {
+            compileFinished.wait(lock, [entry]()
+            {
+                State state = entry->state.load(std::memory_order_acquire);
+                return state == State::Ready || state == State::Failed;
+            });
+        }
+    }
+
+    if (compileHere)
+    {
+        Compile(*entry);
+    }
+    if (entry->state.load(std::memory_order_acquire) == State::Failed)
+    {
+        throw std::runtime_error("failed to create graphics pipeline!");
+    }
+    return id;
+}
+
+/**
+ * @brief Finds the pipeline, or queues it for a compile thread.
+ *
+ * @param desc Pipeline state.
+ * @param fallback Ready pipeline handed out in its place until it is compiled.
+ * @return uint32_t Pipeline id for Get.
+ */
+uint32_t PipelineLibrary::RequestAsync(const GraphicsPipelineDesc& desc, uint32_t fallback)
+{
+    uint64_t hash;
+    uint32_t id = Find(desc, hash);
+    if (id != INVALID_PIPELINE)
+    {
+        return id;
+    }
+
+    id = AddEntry(desc, hash, fallback);
+    pipelineIds.emplace(hash, id);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(entries[id].get());
+        stats.asyncCompiles++;
+    }
+    queueChanged.notify_one();
+    return id;
+}
+
+/**
+ * @param pipeline Id from a request.
+ * @return VkPipeline The pipeline if it is ready, else its fallback.
+ */
+VkPipeline PipelineLibrary::Get(uint32_t pipeline) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const Entry& entry = *entries[pipeline];
+    if (entry.state.load(std::memory_order_acquire) == State::Ready)
+    {
+        return entry.pipeline.load(std::memory_order_relaxed);
+    }
+    fallbackUses.fetch_add(1, std::memory_order_relaxed);
+    return entry.fallback != INVALID_PIPELINE ? entries[entry.fallback]->pipeline.load(std::memory_order_acquire) : VK_NULL_HANDLE;
+}
+
+bool PipelineLibrary::IsReady(uint32_t pipeline) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries[pipeline]->state.load(std::memory_order_acquire) == State::Ready;
+}
+
+/**
+ * @brief Replaces the file's module and queues a replacement for every pipeline
+ * built from it, including ones still waiting for their first compile.
+ *
+ * @param path SPIR-V file, as named in the descs.
+ * @return uint32_t Pipelines queued.
+ */
+uint32_t PipelineLibrary::ReloadShader(const std::string& path)
+{
+    auto found = shaders.find(path);
+    if (found == shaders.end())
+    {
+        return 0;
+    }
+    Shader shader = CreateShader(path);
+    if (shader.hash == found->second.hash)
+    {
+        vkDestroyShaderModule(device, shader.module, nullptr);
+        return 0;
+    }
+    retiredModules.push_back(found->second.module);
+    found->second = shader;
+
+    // Only this thread adds entries, so they can be read without the lock
+    uint32_t count = 0;
+    size_t entryCount = entries.size();
+    for (uint32_t id = 0; id < entryCount; id++)
+    {
+        const Entry& entry = *entries[id];
+        if (entry.reload || (entry.desc.vertexShader != path && entry.desc.fragmentShader != path))
+        {
+            continue;
+        }
+
+        // A replacement from an earlier reload of the same pipeline is out of date now
+        auto reload = std::find_if(reloads.begin(), reloads.end(), [id](const Reload& pending) { return pending.pipeline == id; });
+        if (reload != reloads.end())
+        {
+            abandonedReloads.push_back(reload->replacement);
+            reloads.erase(reload);
+        }
+
+        uint32_t replacement = AddEntry(entry.desc, Hash(entry.desc), INVALID_PIPELINE);
+        entries[replacement]->reload = true;
+        reloads.push_back({ id, replacement });
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(entries[replacement].get());
+            stats.asyncCompiles++;
+        }
+        count++;
+    }
+    queueChanged.notify_all();
+    return count;
+}
+
+/**
+ * @brief Moves each finished replacement's pipeline into the entry it replaces.
+ * Waits for the entry's own compile first if it is still running.
+ *
+ * @param deletions Takes the old pipelines and shader modules.
+ * @param retireValue Frame timeline value after which no frame uses the old pipelines.
+ * @return uint32_t Pipelines swapped.
+ */
+uint32_t PipelineLibrary::SwapReloaded(DeletionQueue& deletions, uint64_t retireValue)
+{
+    auto isFinished = [](const Entry& entry)
+    {
+        State state = entry.state.load(std::memory_order_acquire);
+        return state == State::Ready || state == State::Failed;
+    };
+
+    // Never handed out, so no frame uses them
+    auto abandoned = std::remove_if(abandonedReloads.begin(), abandonedReloads.end(), [&](uint32_t replacement)
+    {
+        Entry& entry = *entries[replacement];
+        if (!isFinished(entry))
+        {
+            return false;
+        }
+        VkPipeline pipeline = entry.pipeline.exchange(VK_NULL_HANDLE, std::memory_order_acq_rel);
+        if (pipeline != VK_NULL_HANDLE)
+        {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        }
+        return true;
+    });
+    abandonedReloads.erase(abandoned, abandonedReloads.end());
+
+    uint32_t swapped = 0;
+    auto finished = std::remove_if(reloads.begin(), reloads.end(), [&](const Reload& reload)
+    {
+        Entry& entry = *entries[reload.pipeline];
+        Entry& replacement = *entries[reload.replacement];
+        if (!isFinished(entry) || !isFinished(replacement))
+        {
+            return false;
+        }
+        // Compile failures were already counted, the old pipeline stays
+        if (replacement.state.load(std::memory_order_acquire) == State::Failed)
+        {
+            return true;
+        }
+
+        VkPipeline oldPipeline;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            oldPipeline = entry.pipeline.exchange(replacement.pipeline.exchange(VK_NULL_HANDLE, std::memory_order_relaxed), std::memory_order_relaxed);
+            entry.state.store(State::Ready, std::memory_order_release);
+            entry.vertexModule = replacement.vertexModule;
+            entry.fragmentModule = replacement.fragmentModule;
+            stats.reloadedPipelines++;
+        }
+        if (oldPipeline != VK_NULL_HANDLE)
+        {
+            deletions.Destroy(oldPipeline, retireValue);
+        }
+
+        // Requests for the new state find the entry, the old state is gone
+        auto key = pipelineIds.find(entry.hash);
+        if (key != pipelineIds.end() && key->second == reload.pipeline)
+        {
+            pipelineIds.erase(key);
+        }
+        entry.hash = replacement.hash;
+        pipelineIds[entry.hash] = reload.pipeline;
+        swapped++;
+        return true;
+    });
+    reloads.erase(finished, reloads.end());
+
+    // Old modules can go once no compile started before the reload is left
+    if (!retiredModules.empty() && reloads.empty() && abandonedReloads.empty())
+    {
+        bool idle;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle = queue.empty() && compilesRunning == 0;
+        }
+        if (idle)
+        {
+            for (VkShaderModule module : retiredModules)
+            {
+                deletions.Destroy(module, retireValue);
+            }
+            retiredModules.clear();
+        }
+    }
+    return swapped;
+}
+
+/**
+ * @brief Blocks until the queue is empty and no compile is running.
+ *
+ */
+void PipelineLibrary::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    compileFinished.wait(lock, [this]() { return queue.empty() && compilesRunning == 0; });
+}
+
+/**
+ * @brief Hashes every field, with the shaders' SPIR-V in place of their paths, so
+ * the same code under another name is the same pipeline.
+ *
+ * @param desc Pipeline state.
+ * @return uint64_t The key.
+ */
+uint64_t PipelineLibrary::Hash(const GraphicsPipelineDesc& desc)
+{
+    uint64_t hash = FNV_OFFSET;
+    hash = HashValue(hash, LoadShader(desc.vertexShader).hash);
+    hash = HashValue(hash, LoadShader(desc.fragmentShader).hash);
+    hash = HashArray(hash, desc.vertexBindings);
+    hash = HashArray(hash, desc.vertexAttributes);
+    hash = HashValue(hash, desc.topology);
+    hash = HashValue(hash, desc.polygonMode);
+    hash = HashValue(hash, desc.cullMode);
+    hash = HashValue(hash, desc.frontFace);
+    hash = HashValue(hash, desc.blendEnable);
+    if (desc.blendEnable)
+    {
+        hash = HashValue(hash, desc.srcColorBlendFactor);
+        hash = HashValue(hash, desc.dstColorBlendFactor);
+        hash = HashValue(hash, desc.colorBlendOp);
+        hash = HashValue(hash, desc.srcAlphaBlendFactor);
+        hash = HashValue(hash, desc.dstAlphaBlendFactor);
+        hash = HashValue(hash, desc.alphaBlendOp);
+    }
+    hash = HashValue(hash, desc.depthTest);
+    hash = HashValue(hash, desc.depthWrite);
+    hash = HashValue(hash, desc.depthCompareOp);
+    hash = HashValue(hash, desc.layout);
+    hash = HashValue(hash, desc.renderPass);
+    hash = HashValue(hash, desc.subpass);
+    return hash;
+}
+
+PipelineLibraryStats PipelineLibrary::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    PipelineLibraryStats result = stats;
+    result.pipelines = static_cast<uint32_t>(entries.size());
+    result.fallbackUses = fallbackUses.load(std::memory_order_relaxed);
+    return result;
+}
+
+/**
+ * @brief Writes the request and compile counters.
+ *
+ * @param out Where to write it.
+ */
+void PipelineLibrary::PrintReport(std::ostream& out) const
+{
+    PipelineLibraryStats current = GetStats();
+    char line[256];
+    std::snprintf(line, sizeof(line),
+        "[Pipelines] %u pipelines, %llu cache hits, %u compiled in place, %u in the background, %u failed, %u reloaded; %.2f ms avg, %.2f ms max; fallback used %llu times\n",
+        current.pipelines, static_cast<unsigned long long>(current.hits), current.syncCompiles, current.asyncCompiles, current.failedCompiles, current.reloadedPipelines,
+        current.AverageCompileMs(), current.maxCompileMs, static_cast<unsigned long long>(current.fallbackUses));
+    out << line;
+}
+
+/**
+ * @brief Creates a SPIR-V file's module, once per path.
+ *
+ * @param path SPIR-V file.
+ * @return const Shader& The cached module.
+ */
+const PipelineLibrary::Shader& PipelineLibrary::LoadShader(const std::string& path)
+{
+    auto found = shaders.find(path);
+    if (found != shaders.end())
+    {
+        return found->second;
+    }
+    return shaders.emplace(path, CreateShader(path)).first->second;
+}
+
+/**
+ * @brief Reads and hashes a SPIR-V file and creates its module.
+ *
+ * @param path SPIR-V file.
+ * @return Shader Its module and hash.
+ */
+PipelineLibrary::Shader PipelineLibrary::CreateShader(const std::string& path)
+{
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("failed to open file!");
+    }
+    std::vector<char> code(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(code.data(), code.size());
+
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size();
+    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    Shader shader;
+    if (vkCreateShaderModule(device, &createInfo, nullptr, &shader.module) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create shader module!");
+    }
+    shader.hash = HashBytes(FNV_OFFSET, code.data(), code.size());
+    return shader;
+}
+
+/**
+ * @param desc Pipeline state.
+ * @param hash Receives its key.
+ * @return uint32_t Id of the existing pipeline, INVALID_PIPELINE if there is none.
+ */
+uint32_t PipelineLibrary::Find(const GraphicsPipelineDesc& desc, uint64_t& hash)
+{
+    hash = Hash(desc);
+    auto found = pipelineIds.find(hash);
+    if (found == pipelineIds.end())
+    {
+        return INVALID_PIPELINE;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.hits++;
+    return found->second;
+}
+
+uint32_t PipelineLibrary::AddEntry(const GraphicsPipelineDesc& desc, uint64_t hash, uint32_t fallback)
+{
+    auto entry = std::make_unique<Entry>();
+    entry->desc = desc;
+    entry->vertexModule = LoadShader(desc.vertexShader).module;
+    entry->fragmentModule = LoadShader(desc.fragmentShader).module;
+    entry->fallback = fallback;
+    entry->hash = hash;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t id = static_cast<uint32_t>(entries.size());
+    entries.push_back(std::move(entry));
+    return id;
+}
+
+/**
+ * @brief Creates the entry's pipeline on the calling thread, with its own pipeline cache.
+ *
+ * @param entry Entry in the Compiling state, Ready or Failed on return.
+ */
+void PipelineLibrary::Compile(Entry& entry)
+{
+    PROFILE_FUNCTION();
+    const GraphicsPipelineDesc& desc = entry.desc;
+
+    std::array<VkPipelineShaderStageCreateInfo, 2> shaderStages{};
+    shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    shaderStages[0].module = entry.vertexModule;
+    shaderStages[0].pName = "main";
+    shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    shaderStages[1].module = entry.fragmentModule;
+    shaderStages[1].pName = "main";
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(desc.vertexBindings.size());
+    vertexInputInfo.pVertexBindingDescriptions = desc.vertexBindings.data();
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(desc.vertexAttributes.size());
+    vertexInputInfo.pVertexAttributeDescriptions = desc.vertexAttributes.data();
+
+    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    inputAssembly.topology = desc.topology;
+    inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+    VkPipelineViewportStateCreateInfo viewportState{};
+    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportState.viewportCount = 1;
+    viewportState.scissorCount = 1;
+
+    VkPipelineRasterizationStateCreateInfo rasterizer{};
+    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterizer.depthClampEnable = VK_FALSE;
+    rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    rasterizer.polygonMode = desc.polygonMode;
+    rasterizer.lineWidth = 1.0f;
+    rasterizer.cullMode = desc.cullMode;
+    rasterizer.frontFace = desc.frontFace;
+    rasterizer.depthBiasEnable = VK_FALSE;
+
+    VkPipelineMultisampleStateCreateInfo multisampling{};
+    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisampling.sampleShadingEnable = VK_FALSE;
+    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkPipelineDepthStencilStateCreateInfo depthStencil{};
+    depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    depthStencil.depthTestEnable = desc.depthTest ? VK_TRUE : VK_FALSE;
+    depthStencil.depthWriteEnable = desc.depthWrite ? VK_TRUE : VK_FALSE;
+    depthStencil.depthCompareOp = desc.depthCompareOp;
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    colorBlendAttachment.blendEnable = desc.blendEnable ? VK_TRUE : VK_FALSE;
+    colorBlendAttachment.srcColorBlendFactor = desc.srcColorBlendFactor;
+    colorBlendAttachment.dstColorBlendFactor = desc.dstColorBlendFactor;
+    colorBlendAttachment.colorBlendOp = desc.colorBlendOp;
+    colorBlendAttachment.srcAlphaBlendFactor = desc.srcAlphaBlendFactor;
+    colorBlendAttachment.dstAlphaBlendFactor = desc.dstAlphaBlendFactor;
+    colorBlendAttachment.alphaBlendOp = desc.alphaBlendOp;
+
+    VkPipelineColorBlendStateCreateInfo colorBlending{};
+    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    colorBlending.logicOpEnable = VK_FALSE;
+    colorBlending.logicOp = VK_LOGIC_OP_COPY;
+    colorBlending.attachmentCount = 1;
+    colorBlending.pAttachments = &colorBlendAttachment;
+
+    std::array<VkDynamicState, 2> dynamicStates = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR
+    };
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
+    dynamicState.pDynamicStates = dynamicStates.data();
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineInfo.pStages = shaderStages.data();
+    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pInputAssemblyState = &inputAssembly;
+    pipelineInfo.pViewportState = &viewportState;
+    pipelineInfo.pRasterizationState = &rasterizer;
+    pipelineInfo.pMultisampleState = &multisampling;
+    pipelineInfo.pDepthStencilState = &depthStencil;
+    pipelineInfo.pColorBlendState = &colorBlending;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = desc.layout;
+    pipelineInfo.renderPass = desc.renderPass;
+    pipelineInfo.subpass = desc.subpass;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    auto createBegin = std::chrono::steady_clock::now();
+    VkResult result = vkCreateGraphicsPipelines(device, pipelineCache->GetThreadCache(), 1, &pipelineInfo, nullptr, &pipeline);
+    std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - createBegin;
+    pipelineCache->RecordCreation(duration, 1);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (result == VK_SUCCESS)
+        {
+            double ms = std::chrono::duration<double, std::milli>(duration).count();
+            stats.compiledPipelines++;
+            stats.totalCompileMs += ms;
+            stats.maxCompileMs = std::max(stats.maxCompileMs, ms);
+            entry.pipeline.store(pipeline, std::memory_order_relaxed);
+            entry.state.store(State::Ready, std::memory_order_release);
+        }
+        else
+        {
+            stats.failedCompiles++;
+            entry.state.store(State::Failed, std::memory_order_release);
+        }
+    }
+    compileFinished.notify_all();
+}
+
+/**
+ * @brief Compile thread loop: take the oldest queued pipeline and compile it.
+ *
+ */
+void PipelineLibrary::CompileThreadMain()
+{
+    CpuProfiler::SetThreadName("Pipeline compile");
+    while (true)
+    {
+        Entry* entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (stopping)
+            {
+                return;
+            }
+            entry = queue.front();
+            queue.pop_front();
+            entry->state.store(State::Compiling, std::memory_order_relaxed);
+            compilesRunning++;
+        }
+
+        Compile(*entry);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            compilesRunning--;
+        }
+        compileFinished.notify_all();
+    }
+}
@@ -0,0 +1,255 @@
+/*****************************************************************//**
+ * \file   PipelineLibrary.h
+ * \brief  Graphics pipelines cached by a hash of their state, compiled in the background
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "PipelineCache.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class DeletionQueue;
+
+/**
+ * @brief Everything that tells two graphics pipelines apart. Viewport and scissor
+ * are always dynamic and rasterization is always single sampled.
+ */
+struct GraphicsPipelineDesc
+{
+    //SPIR-V files, relative to the working directory
+    std::string vertexShader;
+    std::string fragmentShader;
+
+    std::vector<VkVertexInputBindingDescription> vertexBindings;
+    std::vector<VkVertexInputAttributeDescription> vertexAttributes;
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+    //color attachment 0, the blend factors only count when blendEnable is set
+    bool blendEnable = false;
+    VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    VkBlendOp colorBlendOp = VK_BLEND_OP_ADD;
+    VkBlendFactor srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    VkBlendFactor dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    VkBlendOp alphaBlendOp = VK_BLEND_OP_ADD;
+
+    //only used if the subpass has a depth attachment
+    bool depthTest = false;
+    bool depthWrite = false;
+    VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+};
+
+/**
+ * @brief Counters since startup.
+ */
+struct PipelineLibraryStats
+{
+    uint32_t pipelines = 0;
+    //requests answered by a pipeline that already existed
+    uint64_t hits = 0;
+    uint32_t syncCompiles = 0;
+    uint32_t asyncCompiles = 0;
+    uint32_t failedCompiles = 0;
+    //pipelines handed out by Get in place of one still compiling
+    uint64_t fallbackUses = 0;
+    //pipelines swapped for ones built from a changed shader
+    uint32_t reloadedPipelines = 0;
+    //successful compiles and their vkCreateGraphicsPipelines time
+    uint32_t compiledPipelines = 0;
+    double totalCompileMs = 0.0;
+    double maxCompileMs = 0.0;
+
+    double AverageCompileMs() const { return compiledPipelines > 0 ? totalCompileMs / compiledPipelines : 0.0; }
+};
+
+/**
+ * @brief Every graphics pipeline the renderer uses, keyed by a hash of its shaders'
+ * SPIR-V and every other field of its GraphicsPipelineDesc, so asking for the same
+ * state twice gives the same pipeline.
+ *
+ * New pipelines are either compiled on the spot (Request), for what the first
+ * frame needs, or queued for the library's own compile threads (RequestAsync) with
+ * a fallback that Get hands out until the real one is ready, so a new permutation
+ * never stalls a frame. The compile threads are separate from the job system,
+ * whose waiting threads run any queued job, the render thread included.
+ *
+ * When a shader changes on disk, ReloadShader recompiles the pipelines using it
+ * in the background and SwapReloaded swaps them in under the same ids, so ids
+ * held by the renderer stay valid across reloads.
+ *
+ * Request, RequestAsync, ReloadShader, SwapReloaded and Shutdown are for one
+ * thread at a time, Get and IsReady may be called from any thread, e.g. while
+ * recording secondary buffers.
+ */
+class PipelineLibrary
+{
+public:
+    //threads compiling RequestAsync pipelines
+    static constexpr uint32_t COMPILE_THREADS = 2;
+
+    //never returned by a request
+    static constexpr uint32_t INVALID_PIPELINE = UINT32_MAX;
+
+    PipelineLibrary() = default;
+
+    PipelineLibrary(const PipelineLibrary&) = delete;
+    PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+
+    /**
+     * @param device The logical device.
+     * @param cache Every thread compiles with its own cache from here.
+     * @param threadCount Compile threads, at least 1.
+     */
+    void Init(VkDevice device, PipelineCache& cache, uint32_t threadCount = COMPILE_THREADS);
+
+    /**
+     * @brief Drops queued compiles, waits for running ones and destroys every
+     * pipeline and shader module. The device must be idle.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Finds the pipeline for desc, compiling it on the calling thread if it
+     * doesn't exist yet, or waiting for it if it is being compiled.
+     *
+     * @return uint32_t Pipeline id for Get.
+     */
+    uint32_t Request(const GraphicsPipelineDesc& desc);
+
+    /**
+     * @brief Finds the pipeline for desc, or queues it for a compile thread.
+     *
+     * @param fallback Ready pipeline Get returns until this one is, e.g. from Request.
+     * @return uint32_t Pipeline id for Get.
+     */
+    uint32_t RequestAsync(const GraphicsPipelineDesc& desc, uint32_t fallback);
+
+    /**
+     * @brief The pipeline, or its fallback while it is still compiling or if it failed.
+     */
+    VkPipeline Get(uint32_t pipeline) const;
+
+    bool IsReady(uint32_t pipeline) const;
+
+    /**
+     * @brief Rereads a SPIR-V file and queues every pipeline using it for a
+     * recompile. Get hands out the old pipelines until SwapReloaded.
+     *
+     * @param path SPIR-V file, as named in the descs.
+     * @return uint32_t Pipelines queued, 0 if none uses the file or it is unchanged.
+     */
+    uint32_t ReloadShader(const std::string& path);
+
+    /**
+     * @brief Swaps in the recompiled pipelines that are ready. The old pipelines go
+     * to the deletion queue, a failed recompile keeps the old pipeline.
+     *
+     * @param retireValue Frame timeline value after which no frame uses the old pipelines.
+     * @return uint32_t Pipelines swapped.
+     */
+    uint32_t SwapReloaded(DeletionQueue& deletions, uint64_t retireValue);
+
+    /**
+     * @brief Blocks until every queued compile has finished.
+     */
+    void WaitIdle();
+
+    /**
+     * @brief Hash of a desc, including the contents of its shader files.
+     */
+    uint64_t Hash(const GraphicsPipelineDesc& desc);
+
+    PipelineLibraryStats GetStats() const;
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    enum class State : uint32_t
+    {
+        Queued,
+        Compiling,
+        Ready,
+        Failed
+    };
+
+    struct Entry
+    {
+        GraphicsPipelineDesc desc;
+        VkShaderModule vertexModule = VK_NULL_HANDLE;
+        VkShaderModule fragmentModule = VK_NULL_HANDLE;
+        std::atomic<VkPipeline> pipeline{ VK_NULL_HANDLE };
+        std::atomic<State> state{ State::Queued };
+        uint32_t fallback = INVALID_PIPELINE;
+        //key in pipelineIds
+        uint64_t hash = 0;
+        //builds another entry's pipeline from a reloaded shader, never handed out
+        bool reload = false;
+    };
+
+    //an entry and the one compiling its replacement
+    struct Reload
+    {
+        uint32_t pipeline;
+        uint32_t replacement;
+    };
+
+    //a SPIR-V file loaded once, its hash goes into every key using it
+    struct Shader
+    {
+        VkShaderModule module = VK_NULL_HANDLE;
+        uint64_t hash = 0;
+    };
+
+    const Shader& LoadShader(const std::string& path);
+    Shader CreateShader(const std::string& path);
+    uint32_t Find(const GraphicsPipelineDesc& desc, uint64_t& hash);
+    uint32_t AddEntry(const GraphicsPipelineDesc& desc, uint64_t hash, uint32_t fallback);
+    void Compile(Entry& entry);
+    void CompileThreadMain();
+
+    VkDevice device = VK_NULL_HANDLE;
+    PipelineCache* pipelineCache = nullptr;
+
+    //requesting thread only
+    std::unordered_map<std::string, Shader> shaders;
+    std::unordered_map<uint64_t, uint32_t> pipelineIds;
+    std::vector<Reload> reloads;
+    //replacements made stale by another reload of their shader, destroyed once compiled
+    std::vector<uint32_t> abandonedReloads;
+    //modules of reloaded shaders, destroyed once no compile can be using them
+    std::vector<VkShaderModule> retiredModules;
+
+    //guards entries, the queue and stats
+    mutable std::mutex mutex;
+    //Entry pointers stay valid as the list grows, compile threads hold on to them
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::condition_variable queueChanged;
+    std::condition_variable compileFinished;
+    std::deque<Entry*> queue;
+    uint32_t compilesRunning = 0;
+    bool stopping = false;
+    std::vector<std::thread> threads;
+
+    PipelineLibraryStats stats;
+    mutable std::atomic<uint64_t> fallbackUses{ 0 };
+};
@@ -0,0 +1,1112 @@
+/*****************************************************************//**
+ * \file   RenderGraph.cpp
+ * \brief  Declarative frame graph: passes, barriers and transient memory
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "RenderGraph.h"
+#include "DeletionQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+//access bits that make a later access need a memory dependency
+static constexpr VkAccessFlags WRITE_ACCESS = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+/**
+ * @brief Begins the pass's render pass on its framebuffer for this frame.
+ *
+ * @param contents Inline draws, or secondary buffers made with GetInheritanceInfo.
+ */
+void RenderGraphContext::BeginRenderPass(VkSubpassContents contents)
+{
+    if (pass->renderPass == VK_NULL_HANDLE || framebuffer == VK_NULL_HANDLE)
+    {
+        throw std::runtime_error("Render graph pass '" + pass->name + "' has no render pass!");
+    }
+
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = pass->renderPass;
+    renderPassInfo.framebuffer = framebuffer;
+    renderPassInfo.renderArea.offset = { 0, 0 };
+    renderPassInfo.renderArea.extent = extent;
+    renderPassInfo.clearValueCount = static_cast<uint32_t>(pass->clearValues.size());
+    renderPassInfo.pClearValues = pass->clearValues.data();
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+    inRenderPass = true;
+}
+
+/**
+ * @brief Ends the render pass BeginRenderPass began.
+ *
+ */
+void RenderGraphContext::EndRenderPass()
+{
+    vkCmdEndRenderPass(commandBuffer);
+    inRenderPass = false;
+}
+
+/**
+ * @brief Render pass, framebuffer and profiler statistics secondary buffers inherit.
+ *
+ * @return VkCommandBufferInheritanceInfo For CommandRecorder::RecordSecondary.
+ */
+VkCommandBufferInheritanceInfo RenderGraphContext::GetInheritanceInfo() const
+{
+    VkCommandBufferInheritanceInfo inheritance{};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass = pass->renderPass;
+    inheritance.subpass = 0;
+    inheritance.framebuffer = framebuffer;
+    inheritance.pipelineStatistics = pipelineStatistics;
+    return inheritance;
+}
+
+RenderGraphPass::RenderGraphPass(RenderGraph& graph, const char* name, RenderGraphPassKind kind)
+    : graph(graph), name(name), kind(kind)
+{
+}
+
+/**
+ * @brief Declares a read of something earlier passes wrote.
+ *
+ * @param resource Resource of this pass's graph.
+ * @param access One of the read accesses.
+ */
+void RenderGraphPass::Read(RenderGraphResource resource, RenderGraphAccess access)
+{
+    if (access < RenderGraphAccess::DepthRead)
+    {
+        throw std::runtime_error("Render graph pass '" + name + "' reads with a write access!");
+    }
+    AddUse(resource, access, false, VkClearValue{});
+}
+
+/**
+ * @brief Declares a write that keeps what it doesn't overwrite.
+ *
+ * @param resource Resource of this pass's graph.
+ * @param access One of the write accesses.
+ */
+void RenderGraphPass::Write(RenderGraphResource resource, RenderGraphAccess access)
+{
+    if (access >= RenderGraphAccess::DepthRead)
+    {
+        throw std::runtime_error("Render graph pass '" + name + "' writes with a read access!");
+    }
+    AddUse(resource, access, false, VkClearValue{});
+}
+
+/**
+ * @brief Declares an attachment cleared at the start of the render pass.
+ *
+ * @param resource Image or backbuffer of this pass's graph.
+ * @param value Color, or depth and stencil for depth formats.
+ */
+void RenderGraphPass::Clear(RenderGraphResource resource, const VkClearValue& value)
+{
+    if (resource.index >= graph.resources.size())
+    {
+        throw std::runtime_error("Render graph pass '" + name + "' uses an unknown resource!");
+    }
+    RenderGraphAccess access = RenderGraph::IsDepthFormat(graph.resources[resource.index].desc.format) ?
+        RenderGraphAccess::DepthAttachment : RenderGraphAccess::ColorAttachment;
+    AddUse(resource, access, true, value);
+}
+
+/**
+ * @brief Switches an optional pass on or off for the following frames.
+ *
+ * @param value False to skip the pass.
+ */
+void RenderGraphPass::SetEnabled(bool value)
+{
+    if (!value && !optional)
+    {
+        throw std::runtime_error("Render graph pass '" + name + "' can't be disabled, it isn't optional!");
+    }
+    enabled = value;
+}
+
+void RenderGraphPass::AddUse(RenderGraphResource resource, RenderGraphAccess access, bool clear, const VkClearValue& value)
+{
+    if (graph.compiled)
+    {
+        throw std::runtime_error("Render graph is already compiled!");
+    }
+    if (resource.index >= graph.resources.size())
+    {
+        throw std::runtime_error("Render graph pass '" + name + "' uses an unknown resource!");
+    }
+    for (const Use& use : uses)
+    {
+        if (use.resource == resource.index)
+        {
+            throw std::runtime_error("Render graph pass '" + name + "' uses '" + graph.resources[resource.index].name + "' twice!");
+        }
+    }
+
+    bool attachment = access == RenderGraphAccess::ColorAttachment || access == RenderGraphAccess::DepthAttachment ||
+        access == RenderGraphAccess::DepthRead;
+    if (attachment && kind != RenderGraphPassKind::Raster)
+    {
+        throw std::runtime_error("Render graph pass '" + name + "' has attachments but no render pass!");
+    }
+    bool buffer = graph.resources[resource.index].type == RenderGraph::ResourceType::Buffer;
+    if (buffer && (attachment || access == RenderGraphAccess::Sampled))
+    {
+        throw std::runtime_error("Render graph pass '" + name + "' uses buffer '" + graph.resources[resource.index].name + "' as an image!");
+    }
+    if (!buffer && access == RenderGraphAccess::IndirectRead)
+    {
+        throw std::runtime_error("Render graph pass '" + name + "' reads draws from image '" + graph.resources[resource.index].name + "'!");
+    }
+
+    Use use;
+    use.resource = resource.index;
+    use.access = access;
+    use.clear = clear;
+    use.clearValue = value;
+    uses.push_back(use);
+}
+
+/**
+ * @brief Declares the image the frame ends in.
+ *
+ * @param name For errors and reports.
+ * @param format Swap chain or offscreen target format.
+ * @param finalLayout Present, or transfer source for a readback.
+ * @return RenderGraphResource Handle passes write it through.
+ */
+RenderGraphResource RenderGraph::ImportBackbuffer(const char* name, VkFormat format, VkImageLayout finalLayout)
+{
+    if (finalLayout != VK_IMAGE_LAYOUT_PRESENT_SRC_KHR && finalLayout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+    {
+        throw std::runtime_error("Render graph backbuffer must end ready to present or to copy from!");
+    }
+
+    for (const Resource& resource : resources)
+    {
+        if (resource.type == ResourceType::Backbuffer)
+        {
+            throw std::runtime_error("Render graph already has a backbuffer!");
+        }
+    }
+
+    Resource resource;
+    resource.name = name;
+    resource.type = ResourceType::Backbuffer;
+    resource.desc.format = format;
+    resource.finalLayout = finalLayout;
+    resources.push_back(resource);
+    return RenderGraphResource{ static_cast<uint32_t>(resources.size() - 1) };
+}
+
+/**
+ * @brief Declares a buffer passes are ordered on.
+ *
+ * @param name For errors and reports.
+ * @return RenderGraphResource Handle passes read and write it through.
+ */
+RenderGraphResource RenderGraph::ImportBuffer(const char* name)
+{
+    Resource resource;
+    resource.name = name;
+    resource.type = ResourceType::Buffer;
+    resources.push_back(resource);
+    return RenderGraphResource{ static_cast<uint32_t>(resources.size() - 1) };
+}
+
+/**
+ * @brief Declares an image created, aliased and destroyed by the graph.
+ *
+ * @param name For errors and reports.
+ * @param desc Format and size.
+ * @return RenderGraphResource Handle passes read and write it through.
+ */
+RenderGraphResource RenderGraph::CreateImage(const char* name, const RenderGraphImageDesc& desc)
+{
+    if (desc.format == VK_FORMAT_UNDEFINED)
+    {
+        throw std::runtime_error("Render graph image needs a format!");
+    }
+
+    Resource resource;
+    resource.name = name;
+    resource.type = ResourceType::Image;
+    resource.desc = desc;
+    resources.push_back(resource);
+    return RenderGraphResource{ static_cast<uint32_t>(resources.size() - 1) };
+}
+
+/**
+ * @brief Adds a pass after every pass added so far.
+ *
+ * @param name For errors and reports.
+ * @param kind Raster passes get a render pass over their attachments.
+ * @return RenderGraphPass& Declares the pass's resources and callback, stays valid
+ * until Shutdown.
+ */
+RenderGraphPass& RenderGraph::AddPass(const char* name, RenderGraphPassKind kind)
+{
+    if (compiled)
+    {
+        throw std::runtime_error("Render graph is already compiled!");
+    }
+    passes.push_back(std::unique_ptr<RenderGraphPass>(new RenderGraphPass(*this, name, kind)));
+    return *passes.back();
+}
+
+/**
+ * @brief Culls, orders and synchronizes the declared passes.
+ *
+ * @param vulkanDevice Device the render passes are created on.
+ */
+void RenderGraph::Compile(VkDevice vulkanDevice)
+{
+    if (compiled)
+    {
+        throw std::runtime_error("Render graph is already compiled!");
+    }
+    device = vulkanDevice;
+
+    CullPasses();
+    ComputeBarriers();
+    for (RenderGraphPass* pass : order)
+    {
+        if (pass->kind == RenderGraphPassKind::Raster)
+        {
+            CreateRenderPass(*pass);
+        }
+    }
+    compiled = true;
+}
+
+/**
+ * @brief Allocates the transient images and creates every framebuffer.
+ *
+ * @param gpuAllocator Where transient memory comes from.
+ * @param extent Backbuffer size.
+ * @param images Swap chain images.
+ * @param views Their views.
+ */
+void RenderGraph::CreateResources(GpuAllocator& gpuAllocator, VkExtent2D extent, const std::vector<VkImage>& images,
+    const std::vector<VkImageView>& views)
+{
+    if (!compiled)
+    {
+        throw std::runtime_error("Render graph must be compiled before creating its resources!");
+    }
+    allocator = &gpuAllocator;
+    backbufferImages = images;
+
+    CreateTransientImages(extent);
+    CreateFramebuffers(extent, views);
+}
+
+/**
+ * @brief Frees the transient images and the framebuffers.
+ *
+ */
+void RenderGraph::DestroyResources()
+{
+    for (RenderGraphPass* pass : order)
+    {
+        for (VkFramebuffer framebuffer : pass->framebuffers)
+        {
+            vkDestroyFramebuffer(device, framebuffer, nullptr);
+        }
+        pass->framebuffers.clear();
+    }
+
+    for (Resource& resource : resources)
+    {
+        if (resource.view != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(device, resource.view, nullptr);
+            resource.view = VK_NULL_HANDLE;
+        }
+        if (resource.type == ResourceType::Image && resource.image != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(device, resource.image, nullptr);
+            resource.image = VK_NULL_HANDLE;
+        }
+        resource.slot = UINT32_MAX;
+    }
+
+    for (MemorySlot& slot : slots)
+    {
+        allocator->Free(slot.allocation);
+    }
+    slots.clear();
+    backbufferImages.clear();
+}
+
+/**
+ * @brief Queues the transient images and the framebuffers for deletion. Aliased
+ * memory is queued after every image placed in it.
+ *
+ * @param deletions Destroys them once the GPU reaches value.
+ * @param value Frame timeline value after which nothing uses them.
+ */
+void RenderGraph::RetireResources(DeletionQueue& deletions, uint64_t value)
+{
+    for (RenderGraphPass* pass : order)
+    {
+        for (VkFramebuffer framebuffer : pass->framebuffers)
+        {
+            deletions.Destroy(framebuffer, value);
+        }
+        pass->framebuffers.clear();
+    }
+
+    for (Resource& resource : resources)
+    {
+        if (resource.view != VK_NULL_HANDLE)
+        {
+            deletions.Destroy(resource.view, value);
+            resource.view = VK_NULL_HANDLE;
+        }
+        if (resource.type == ResourceType::Image && resource.image != VK_NULL_HANDLE)
+        {
+            deletions.Destroy(resource.image, value);
+            resource.image = VK_NULL_HANDLE;
+        }
+        resource.slot = UINT32_MAX;
+    }
+
+    for (MemorySlot& slot : slots)
+    {
+        deletions.Free(slot.allocation, value);
+    }
+    slots.clear();
+    backbufferImages.clear();
+}
+
+/**
+ * @brief Destroys the resources, the render passes and every declaration.
+ *
+ */
+void RenderGraph::Shutdown()
+{
+    if (compiled)
+    {
+        DestroyResources();
+        for (RenderGraphPass* pass : order)
+        {
+            if (pass->renderPass != VK_NULL_HANDLE)
+            {
+                vkDestroyRenderPass(device, pass->renderPass, nullptr);
+            }
+        }
+    }
+    order.clear();
+    passes.clear();
+    resources.clear();
+    barriers.clear();
+    compiled = false;
+}
+
+/**
+ * @brief Records the frame: every live pass that is enabled, behind its barriers.
+ *
+ * @param commandBuffer Primary buffer, outside a render pass.
+ * @param backbufferIndex Acquired swap chain image.
+ */
+void RenderGraph::Execute(VkCommandBuffer commandBuffer, uint32_t backbufferIndex)
+{
+    for (RenderGraphPass* pass : order)
+    {
+        if (!pass->enabled)
+        {
+            continue;
+        }
+        auto cpuBegin = std::chrono::steady_clock::now();
+        if (profiler)
+        {
+            profiler->BeginScope(commandBuffer, pass->name);
+        }
+        RecordBarriers(commandBuffer, pass->barrierBegin, pass->barrierCount, backbufferIndex);
+        if (pass->execute)
+        {
+            RenderGraphContext context = GetContext(*pass, commandBuffer, backbufferIndex);
+            pass->execute(context);
+            if (context.inRenderPass)
+            {
+                throw std::runtime_error("Render graph pass '" + pass->name + "' left its render pass open!");
+            }
+        }
+        if (profiler)
+        {
+            profiler->EndScope(commandBuffer);
+        }
+        pass->cpuMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cpuBegin).count();
+    }
+    RecordBarriers(commandBuffer, finalBarrierBegin, finalBarrierCount, backbufferIndex);
+}
+
+/**
+ * @brief Context for recording a pass outside Execute.
+ *
+ * @param pass Live pass of this graph.
+ * @param commandBuffer Primary buffer, outside a render pass.
+ * @param backbufferIndex Picks the framebuffer of passes drawing into the backbuffer.
+ * @return RenderGraphContext The context Execute would hand the pass.
+ */
+RenderGraphContext RenderGraph::GetContext(const RenderGraphPass& pass, VkCommandBuffer commandBuffer, uint32_t backbufferIndex) const
+{
+    RenderGraphContext context;
+    context.pass = &pass;
+    context.commandBuffer = commandBuffer;
+    context.extent = pass.extent;
+    context.pipelineStatistics = profiler ? profiler->GetInheritedStatistics() : 0;
+    if (!pass.framebuffers.empty())
+    {
+        context.framebuffer = pass.framebuffers[pass.usesBackbuffer ? backbufferIndex : 0];
+    }
+    return context;
+}
+
+/**
+ * @brief Writes the pass counts, barriers per frame and transient memory saved by aliasing.
+ *
+ * @param out Where to write it.
+ */
+void RenderGraph::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Render graph] %u passes (%u culled), %u barriers in %u batches per frame, %u transient images in %u memory ranges, %.1f MB for %.1f MB\n",
+        stats.passes, stats.culledPasses, stats.barriers, stats.barrierBatches, stats.transientImages, stats.memorySlots,
+        static_cast<double>(stats.allocatedBytes) / (1024.0 * 1024.0), static_cast<double>(stats.transientBytes) / (1024.0 * 1024.0));
+    out << line;
+}
+
+/**
+ * @brief Stages, access, layout and image usage of an access in a kind of pass.
+ *
+ * @param access How the resource is touched.
+ * @param kind Kind of the pass touching it, picks the shader stages.
+ * @return AccessInfo What the barriers synchronize against.
+ */
+RenderGraph::AccessInfo RenderGraph::GetAccessInfo(RenderGraphAccess access, RenderGraphPassKind kind)
+{
+    VkPipelineStageFlags shaderStages = kind == RenderGraphPassKind::Compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT :
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    VkPipelineStageFlags depthStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+    switch (access)
+    {
+    case RenderGraphAccess::ColorAttachment:
+        return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true };
+    case RenderGraphAccess::DepthAttachment:
+        return { depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true };
+    case RenderGraphAccess::StorageWrite:
+        return { shaderStages, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true };
+    case RenderGraphAccess::TransferWrite:
+        return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true };
+    case RenderGraphAccess::DepthRead:
+        return { depthStages, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false };
+    case RenderGraphAccess::Sampled:
+        return { shaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false };
+    case RenderGraphAccess::StorageRead:
+        return { shaderStages, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, false };
+    case RenderGraphAccess::IndirectRead:
+        return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, 0, false };
+    case RenderGraphAccess::TransferRead:
+        return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false };
+    }
+    throw std::runtime_error("Unknown render graph access!");
+}
+
+bool RenderGraph::IsDepthFormat(VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D32_SFLOAT || format == VK_FORMAT_D16_UNORM_S8_UINT ||
+        format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+}
+
+VkExtent2D RenderGraph::GetImageExtent(const Resource& resource, VkExtent2D backbuffer)
+{
+    if (resource.type == ResourceType::Image && resource.desc.width != 0 && resource.desc.height != 0)
+    {
+        return VkExtent2D{ resource.desc.width, resource.desc.height };
+    }
+    return backbuffer;
+}
+
+/**
+ * @brief Walks the passes backwards from the backbuffer. A pass is live if it
+ * writes something a later live pass needs, and then needs what it reads. A
+ * cleared attachment needs nothing written before it.
+ *
+ */
+void RenderGraph::CullPasses()
+{
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t r = 0; r < resources.size(); r++)
+    {
+        needed[r] = resources[r].type == ResourceType::Backbuffer;
+    }
+
+    for (size_t p = passes.size(); p-- > 0;)
+    {
+        RenderGraphPass& pass = *passes[p];
+        pass.live = false;
+        for (const RenderGraphPass::Use& use : pass.uses)
+        {
+            if (use.access < RenderGraphAccess::DepthRead && needed[use.resource])
+            {
+                pass.live = true;
+            }
+        }
+        if (!pass.live)
+        {
+            continue;
+        }
+
+        for (const RenderGraphPass::Use& use : pass.uses)
+        {
+            needed[use.resource] = !use.clear;
+        }
+    }
+
+    order.clear();
+    for (const std::unique_ptr<RenderGraphPass>& pass : passes)
+    {
+        if (pass->live)
+        {
+            order.push_back(pass.get());
+        }
+    }
+    stats.passes = static_cast<uint32_t>(passes.size());
+    stats.culledPasses = static_cast<uint32_t>(passes.size() - order.size());
+}
+
+/**
+ * @brief Follows every resource through the live passes and records a barrier
+ * only where an access has to wait: a layout change, anything after a write,
+ * or a write after reads. Reads after reads in the same layout need none.
+ *
+ */
+void RenderGraph::ComputeBarriers()
+{
+    struct State
+    {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        //stages and access of the last write or transition
+        VkPipelineStageFlags writeStages = 0;
+        VkAccessFlags writeAccess = 0;
+        //stages that read since, and those the write was already made visible to
+        VkPipelineStageFlags readStages = 0;
+        VkPipelineStageFlags visibleStages = 0;
+        bool written = false;
+    };
+
+    std::vector<State> states(resources.size());
+    // What optional passes wait for, the final barrier waits for it too in case they are skipped
+    std::vector<VkPipelineStageFlags> skippableStages(resources.size(), 0);
+    std::vector<VkAccessFlags> skippableAccess(resources.size(), 0);
+    for (size_t r = 0; r < resources.size(); r++)
+    {
+        Resource& resource = resources[r];
+        resource.firstPass = UINT32_MAX;
+        resource.lastPass = 0;
+        resource.usage = 0;
+        resource.stages = 0;
+        resource.writeAccess = 0;
+
+        // The acquire semaphore is waited on at color output, the first transition chains to it
+        if (resource.type == ResourceType::Backbuffer)
+        {
+            states[r].writeStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        }
+    }
+
+    barriers.clear();
+    for (uint32_t position = 0; position < order.size(); position++)
+    {
+        RenderGraphPass& pass = *order[position];
+        pass.barrierBegin = static_cast<uint32_t>(barriers.size());
+
+        for (const RenderGraphPass::Use& use : pass.uses)
+        {
+            Resource& resource = resources[use.resource];
+            State& state = states[use.resource];
+            AccessInfo info = GetAccessInfo(use.access, pass.kind);
+            bool image = resource.type != ResourceType::Buffer;
+
+            if (!info.write && !state.written && image)
+            {
+                throw std::runtime_error("Render graph pass '" + pass.name + "' reads '" + resource.name + "' before anything writes it!");
+            }
+
+            resource.firstPass = std::min(resource.firstPass, position);
+            resource.lastPass = position;
+            resource.usage |= info.usage;
+            resource.stages |= info.stages;
+            resource.writeAccess |= info.access & WRITE_ACCESS;
+
+            Barrier barrier;
+            barrier.resource = use.resource;
+            barrier.oldLayout = state.layout;
+            barrier.newLayout = image ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.dstStages = info.stages;
+            barrier.dstAccess = info.access;
+            barrier.firstUse = resource.type == ResourceType::Image && state.layout == VK_IMAGE_LAYOUT_UNDEFINED;
+
+            bool transition = image && info.layout != state.layout;
+            if (pass.optional)
+            {
+                if (transition)
+                {
+                    throw std::runtime_error("Render graph pass '" + pass.name + "' is optional but changes the layout of '" + resource.name + "'!");
+                }
+                skippableStages[use.resource] |= state.writeStages | state.readStages;
+                skippableAccess[use.resource] |= state.writeAccess;
+            }
+            bool needed = false;
+            if (transition || info.write)
+            {
+                // Write after write or after read, or a layout change, waits for everything before
+                barrier.srcStages = state.writeStages | state.readStages;
+                barrier.srcAccess = state.writeAccess;
+                needed = transition || barrier.srcStages != 0;
+            }
+            else if (state.writeStages != 0 && (info.stages & ~state.visibleStages) != 0)
+            {
+                // Read after write, once per stage the write isn't visible to yet
+                barrier.srcStages = state.writeStages;
+                barrier.srcAccess = state.writeAccess;
+                needed = true;
+            }
+
+            if (info.write)
+            {
+                state.writeStages = info.stages;
+                state.writeAccess = info.access & WRITE_ACCESS;
+                state.readStages = 0;
+                state.visibleStages = 0;
+                state.written = true;
+            }
+            else if (transition)
+            {
+                // Later readers chain to the transition, which already made the write available
+                state.writeStages = info.stages;
+                state.writeAccess = 0;
+                state.readStages = info.stages;
+                state.visibleStages = info.stages;
+            }
+            else
+            {
+                state.readStages |= info.stages;
+                if (needed)
+                {
+                    state.visibleStages |= info.stages;
+                }
+            }
+            state.layout = barrier.newLayout;
+
+            if (needed)
+            {
+                barriers.push_back(barrier);
+            }
+        }
+        pass.barrierCount = static_cast<uint32_t>(barriers.size()) - pass.barrierBegin;
+    }
+
+    for (uint32_t position = 0; position < order.size(); position++)
+    {
+        const RenderGraphPass& pass = *order[position];
+        for (const RenderGraphPass::Use& use : pass.uses)
+        {
+            if (pass.optional && resources[use.resource].lastPass != position)
+            {
+                throw std::runtime_error("Render graph pass '" + pass.name + "' is optional but '" + resources[use.resource].name + "' is used after it!");
+            }
+        }
+    }
+
+    // The backbuffer leaves the frame ready to present or to be copied out
+    finalBarrierBegin = static_cast<uint32_t>(barriers.size());
+    for (size_t r = 0; r < resources.size(); r++)
+    {
+        if (resources[r].type != ResourceType::Backbuffer)
+        {
+            continue;
+        }
+        const State& state = states[r];
+        Barrier barrier;
+        barrier.resource = static_cast<uint32_t>(r);
+        barrier.oldLayout = state.layout;
+        barrier.newLayout = resources[r].finalLayout;
+        barrier.srcStages = state.writeStages | state.readStages | skippableStages[r];
+        barrier.srcAccess = state.writeAccess | skippableAccess[r];
+        if (barrier.newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)
+        {
+            barrier.dstStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            barrier.dstAccess = VK_ACCESS_TRANSFER_READ_BIT;
+        }
+        else
+        {
+            barrier.dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            barrier.dstAccess = 0;
+        }
+        barriers.push_back(barrier);
+    }
+    finalBarrierCount = static_cast<uint32_t>(barriers.size()) - finalBarrierBegin;
+
+    stats.barriers = static_cast<uint32_t>(barriers.size());
+    stats.barrierBatches = finalBarrierCount > 0 ? 1 : 0;
+    for (const RenderGraphPass* pass : order)
+    {
+        stats.barrierBatches += pass->barrierCount > 0 ? 1 : 0;
+    }
+}
+
+/**
+ * @brief One subpass over the pass's attachments. Layouts are changed by the
+ * graph's barriers, so every attachment stays in one layout, and load and store
+ * ops only keep contents an earlier or later pass uses.
+ *
+ * @param pass Live raster pass.
+ */
+void RenderGraph::CreateRenderPass(RenderGraphPass& pass)
+{
+    uint32_t position = static_cast<uint32_t>(std::find(order.begin(), order.end(), &pass) - order.begin());
+
+    std::vector<VkAttachmentDescription> descriptions;
+    std::vector<VkAttachmentReference> colorReferences;
+    VkAttachmentReference depthReference{};
+    bool hasDepth = false;
+
+    pass.attachments.clear();
+    pass.clearValues.clear();
+    pass.usesBackbuffer = false;
+    for (const RenderGraphPass::Use& use : pass.uses)
+    {
+        if (use.access != RenderGraphAccess::ColorAttachment && use.access != RenderGraphAccess::DepthAttachment &&
+            use.access != RenderGraphAccess::DepthRead)
+        {
+            continue;
+        }
+        const Resource& resource = resources[use.resource];
+        AccessInfo info = GetAccessInfo(use.access, pass.kind);
+
+        VkAttachmentDescription description{};
+        description.format = resource.desc.format;
+        description.samples = VK_SAMPLE_COUNT_1_BIT;
+        if (use.clear)
+        {
+            description.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        }
+        else
+        {
+            description.loadOp = resource.firstPass < position ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        }
+        bool keep = resource.type == ResourceType::Backbuffer || resource.lastPass > position;
+        description.storeOp = keep ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        description.initialLayout = info.layout;
+        description.finalLayout = info.layout;
+
+        VkAttachmentReference reference{};
+        reference.attachment = static_cast<uint32_t>(descriptions.size());
+        reference.layout = info.layout;
+        if (use.access == RenderGraphAccess::ColorAttachment)
+        {
+            colorReferences.push_back(reference);
+        }
+        else if (hasDepth)
+        {
+            throw std::runtime_error("Render graph pass '" + pass.name + "' has two depth attachments!");
+        }
+        else
+        {
+            depthReference = reference;
+            hasDepth = true;
+        }
+
+        descriptions.push_back(description);
+        pass.attachments.push_back(use.resource);
+        pass.clearValues.push_back(use.clearValue);
+        pass.usesBackbuffer |= resource.type == ResourceType::Backbuffer;
+    }
+    if (descriptions.empty())
+    {
+        throw std::runtime_error("Render graph pass '" + pass.name + "' has no attachments!");
+    }
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+    subpass.pColorAttachments = colorReferences.data();
+    subpass.pDepthStencilAttachment = hasDepth ? &depthReference : nullptr;
+
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
+    renderPassInfo.pAttachments = descriptions.data();
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+
+    if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create render pass!");
+    }
+}
+
+/**
+ * @brief Creates every live transient image, then packs them into memory slots,
+ * largest first: an image joins the first slot with a compatible memory type whose
+ * images are all dead before it is first used or born after it is last used.
+ *
+ * @param extent Backbuffer size.
+ */
+void RenderGraph::CreateTransientImages(VkExtent2D extent)
+{
+    std::vector<uint32_t> transients;
+    std::vector<VkMemoryRequirements> requirements(resources.size());
+    stats.transientImages = 0;
+    stats.transientBytes = 0;
+    stats.allocatedBytes = 0;
+
+    for (uint32_t r = 0; r < resources.size(); r++)
+    {
+        Resource& resource = resources[r];
+        if (resource.type != ResourceType::Image || resource.firstPass == UINT32_MAX)
+        {
+            continue;
+        }
+
+        VkExtent2D imageExtent = GetImageExtent(resource, extent);
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = resource.desc.format;
+        imageInfo.extent = { imageExtent.width, imageExtent.height, 1 };
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = resource.usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        if (vkCreateImage(device, &imageInfo, nullptr, &resource.image) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create render graph image!");
+        }
+        vkGetImageMemoryRequirements(device, resource.image, &requirements[r]);
+        transients.push_back(r);
+        stats.transientImages++;
+        stats.transientBytes += requirements[r].size;
+    }
+
+    std::stable_sort(transients.begin(), transients.end(), [&requirements](uint32_t a, uint32_t b)
+    {
+        return requirements[a].size > requirements[b].size;
+    });
+
+    slots.clear();
+    for (uint32_t r : transients)
+    {
+        Resource& resource = resources[r];
+        for (uint32_t s = 0; s < slots.size() && resource.slot == UINT32_MAX; s++)
+        {
+            MemorySlot& slot = slots[s];
+            if ((slot.requirements.memoryTypeBits & requirements[r].memoryTypeBits) == 0)
+            {
+                continue;
+            }
+            bool overlaps = false;
+            for (uint32_t other : slot.images)
+            {
+                overlaps |= resource.firstPass <= resources[other].lastPass && resources[other].firstPass <= resource.lastPass;
+            }
+            if (!overlaps)
+            {
+                resource.slot = s;
+            }
+        }
+        if (resource.slot == UINT32_MAX)
+        {
+            resource.slot = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+            slots.back().requirements.memoryTypeBits = requirements[r].memoryTypeBits;
+        }
+
+        MemorySlot& slot = slots[resource.slot];
+        slot.requirements.size = std::max(slot.requirements.size, requirements[r].size);
+        slot.requirements.alignment = std::max(slot.requirements.alignment, requirements[r].alignment);
+        slot.requirements.memoryTypeBits &= requirements[r].memoryTypeBits;
+        slot.stages |= resource.stages;
+        slot.writeAccess |= resource.writeAccess;
+        slot.images.push_back(r);
+    }
+
+    for (MemorySlot& slot : slots)
+    {
+        slot.allocation = allocator->Allocate(slot.requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, GpuResourceKind::Optimal);
+        stats.allocatedBytes += slot.requirements.size;
+        for (uint32_t r : slot.images)
+        {
+            vkBindImageMemory(device, resources[r].image, slot.allocation.memory, slot.allocation.offset);
+        }
+    }
+    stats.memorySlots = static_cast<uint32_t>(slots.size());
+
+    for (uint32_t r : transients)
+    {
+        Resource& resource = resources[r];
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = resource.image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = resource.desc.format;
+        viewInfo.subresourceRange.aspectMask = IsDepthFormat(resource.desc.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device, &viewInfo, nullptr, &resource.view) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create render graph image view!");
+        }
+    }
+}
+
+/**
+ * @brief One framebuffer per live raster pass, or one per backbuffer image for
+ * passes drawing into it.
+ *
+ * @param extent Backbuffer size.
+ * @param views Backbuffer views.
+ */
+void RenderGraph::CreateFramebuffers(VkExtent2D extent, const std::vector<VkImageView>& views)
+{
+    std::vector<VkImageView> attachmentViews;
+    for (RenderGraphPass* pass : order)
+    {
+        if (pass->kind != RenderGraphPassKind::Raster)
+        {
+            continue;
+        }
+
+        pass->extent = GetImageExtent(resources[pass->attachments[0]], extent);
+        for (uint32_t r : pass->attachments)
+        {
+            VkExtent2D attachmentExtent = GetImageExtent(resources[r], extent);
+            if (attachmentExtent.width != pass->extent.width || attachmentExtent.height != pass->extent.height)
+            {
+                throw std::runtime_error("Render graph pass '" + pass->name + "' has attachments of different sizes!");
+            }
+        }
+
+        size_t count = pass->usesBackbuffer ? views.size() : 1;
+        pass->framebuffers.resize(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            attachmentViews.clear();
+            for (uint32_t r : pass->attachments)
+            {
+                attachmentViews.push_back(resources[r].type == ResourceType::Backbuffer ? views[i] : resources[r].view);
+            }
+
+            VkFramebufferCreateInfo framebufferInfo{};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = pass->renderPass;
+            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachmentViews.size());
+            framebufferInfo.pAttachments = attachmentViews.data();
+            framebufferInfo.width = pass->extent.width;
+            framebufferInfo.height = pass->extent.height;
+            framebufferInfo.layers = 1;
+
+            if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &pass->framebuffers[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create framebuffer!");
+            }
+        }
+    }
+}
+
+/**
+ * @brief Records barriers [begin, begin + count) as one vkCmdPipelineBarrier.
+ * Buffers share a single global memory barrier.
+ *
+ * @param commandBuffer Buffer outside a render pass.
+ * @param begin First barrier.
+ * @param count Barriers to record, nothing is recorded for 0.
+ * @param backbufferIndex Acquired swap chain image.
+ */
+void RenderGraph::RecordBarriers(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t count, uint32_t backbufferIndex)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    VkMemoryBarrier memoryBarrier{};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    bool bufferBarrier = false;
+
+    imageBarriers.clear();
+    for (uint32_t b = begin; b < begin + count; b++)
+    {
+        const Barrier& barrier = barriers[b];
+        const Resource& resource = resources[barrier.resource];
+
+        // The memory may still be in use by the previous frame or by an image aliasing it
+        VkPipelineStageFlags barrierSrcStages = barrier.srcStages;
+        VkAccessFlags barrierSrcAccess = barrier.srcAccess;
+        if (barrier.firstUse && resource.slot != UINT32_MAX)
+        {
+            barrierSrcStages |= slots[resource.slot].stages;
+            barrierSrcAccess |= slots[resource.slot].writeAccess;
+        }
+        srcStages |= barrierSrcStages;
+        dstStages |= barrier.dstStages;
+
+        if (resource.type == ResourceType::Buffer)
+        {
+            memoryBarrier.srcAccessMask |= barrierSrcAccess;
+            memoryBarrier.dstAccessMask |= barrier.dstAccess;
+            bufferBarrier = true;
+            continue;
+        }
+
+        VkImageMemoryBarrier imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.srcAccessMask = barrierSrcAccess;
+        imageBarrier.dstAccessMask = barrier.dstAccess;
+        imageBarrier.oldLayout = barrier.oldLayout;
+        imageBarrier.newLayout = barrier.newLayout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = resource.type == ResourceType::Backbuffer ? backbufferImages[backbufferIndex] : resource.image;
+        imageBarrier.subresourceRange.aspectMask = IsDepthFormat(resource.desc.format) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBarrier.subresourceRange.baseMipLevel = 0;
+        imageBarrier.subresourceRange.levelCount = 1;
+        imageBarrier.subresourceRange.baseArrayLayer = 0;
+        imageBarrier.subresourceRange.layerCount = 1;
+        imageBarriers.push_back(imageBarrier);
+    }
+
+    // Nothing earlier in the frame to wait for
+    if (srcStages == 0)
+    {
+        srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    }
+    vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0,
+        bufferBarrier ? 1 : 0, &memoryBarrier, 0, nullptr, static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
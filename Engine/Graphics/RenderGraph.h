@@ -0,0 +1,443 @@
+/*****************************************************************//**
+ * \file   RenderGraph.h
+ * \brief  Declarative frame graph: passes, barriers and transient memory
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "GpuAllocator.h"
+#include "GpuProfiler.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Handle to an image or buffer declared on a RenderGraph.
+ */
+struct RenderGraphResource
+{
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index = INVALID_INDEX;
+
+    bool IsValid() const { return index != INVALID_INDEX; }
+};
+
+/**
+ * @brief What a pass runs on. Decides the shader stages sampled and storage
+ * accesses are synchronized against.
+ */
+enum class RenderGraphPassKind : uint32_t
+{
+    //begins a render pass over its attachments
+    Raster,
+    //dispatches, outside any render pass
+    Compute,
+    //copies, outside any render pass
+    Transfer
+};
+
+/**
+ * @brief How a pass touches a resource.
+ */
+enum class RenderGraphAccess : uint32_t
+{
+    //writes
+    ColorAttachment,
+    DepthAttachment,
+    StorageWrite,
+    TransferWrite,
+    //reads
+    DepthRead,
+    Sampled,
+    StorageRead,
+    IndirectRead,
+    TransferRead
+};
+
+/**
+ * @brief A transient image, created and aliased by the graph.
+ */
+struct RenderGraphImageDesc
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    //0 follows the backbuffer
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+/**
+ * @brief What the last Compile and CreateResources produced.
+ */
+struct RenderGraphStats
+{
+    uint32_t passes = 0;
+    //declared passes nothing live consumes
+    uint32_t culledPasses = 0;
+    //image and buffer barriers per frame, and the vkCmdPipelineBarrier calls they are batched into
+    uint32_t barriers = 0;
+    uint32_t barrierBatches = 0;
+    uint32_t transientImages = 0;
+    //memory ranges the transient images were packed into
+    uint32_t memorySlots = 0;
+    //bytes the transient images would take unaliased, and what was allocated
+    VkDeviceSize transientBytes = 0;
+    VkDeviceSize allocatedBytes = 0;
+};
+
+class DeletionQueue;
+class RenderGraph;
+class RenderGraphPass;
+
+/**
+ * @brief Handed to a pass's execute callback.
+ */
+class RenderGraphContext
+{
+public:
+    VkCommandBuffer GetCommandBuffer() const { return commandBuffer; }
+
+    //size of the pass's attachments, raster passes only
+    VkExtent2D GetExtent() const { return extent; }
+
+    /**
+     * @brief Begins the pass's render pass with its clears. Raster passes call it
+     * once, before recording draws.
+     *
+     * @param contents Inline draws, or secondary buffers made with GetInheritanceInfo.
+     */
+    void BeginRenderPass(VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+
+    void EndRenderPass();
+
+    //for secondary buffers executed inside the render pass
+    VkCommandBufferInheritanceInfo GetInheritanceInfo() const;
+
+private:
+    friend class RenderGraph;
+
+    const RenderGraphPass* pass = nullptr;
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VkExtent2D extent{};
+    bool inRenderPass = false;
+    //statistics a profiler scope around the pass may count
+    VkQueryPipelineStatisticFlags pipelineStatistics = 0;
+};
+
+/**
+ * @brief One node of the graph, made by RenderGraph::AddPass. Declares what it
+ * reads and writes, the graph works out the barriers and load and store ops.
+ */
+class RenderGraphPass
+{
+public:
+    using ExecuteFunction = std::function<void(RenderGraphContext&)>;
+
+    RenderGraphPass(const RenderGraphPass&) = delete;
+    RenderGraphPass& operator=(const RenderGraphPass&) = delete;
+
+    /**
+     * @brief Reads the resource as written by earlier passes.
+     *
+     * @param access One of the read accesses.
+     */
+    void Read(RenderGraphResource resource, RenderGraphAccess access);
+
+    /**
+     * @brief Writes the resource, keeping what earlier passes wrote where this
+     * pass doesn't.
+     *
+     * @param access One of the write accesses.
+     */
+    void Write(RenderGraphResource resource, RenderGraphAccess access);
+
+    /**
+     * @brief Writes a color or depth attachment cleared to value first, so nothing
+     * earlier passes wrote is needed.
+     */
+    void Clear(RenderGraphResource resource, const VkClearValue& value);
+
+    //called every frame in graph order with the barriers already recorded
+    void SetExecute(ExecuteFunction function) { execute = std::move(function); }
+
+    const std::string& GetName() const { return name; }
+
+    //pipelines drawing in this pass are created against it, valid after Compile
+    VkRenderPass GetRenderPass() const { return renderPass; }
+
+    //false if Compile culled the pass
+    bool IsLive() const { return live; }
+
+    /**
+     * @brief Lets SetEnabled switch the pass off between frames. Compile then
+     * requires it to be the last pass using each of its resources and to change
+     * no layouts, so skipping it leaves every other barrier valid.
+     */
+    void SetOptional(bool value) { optional = value; }
+
+    /**
+     * @brief Skips an optional pass, and its barriers, in Execute until enabled again.
+     */
+    void SetEnabled(bool value);
+
+    bool IsEnabled() const { return enabled; }
+
+    //CPU time of the pass in the last Execute, barriers included
+    double GetCpuMilliseconds() const { return cpuMilliseconds; }
+
+private:
+    friend class RenderGraph;
+    friend class RenderGraphContext;
+
+    struct Use
+    {
+        uint32_t resource = RenderGraphResource::INVALID_INDEX;
+        RenderGraphAccess access = RenderGraphAccess::Sampled;
+        bool clear = false;
+        VkClearValue clearValue{};
+    };
+
+    RenderGraphPass(RenderGraph& graph, const char* name, RenderGraphPassKind kind);
+    void AddUse(RenderGraphResource resource, RenderGraphAccess access, bool clear, const VkClearValue& value);
+
+    RenderGraph& graph;
+    std::string name;
+    RenderGraphPassKind kind;
+    std::vector<Use> uses;
+    ExecuteFunction execute;
+    bool optional = false;
+    bool enabled = true;
+    double cpuMilliseconds = 0.0;
+
+    //set by Compile
+    bool live = false;
+    uint32_t barrierBegin = 0;
+    uint32_t barrierCount = 0;
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    //resource of each attachment, in render pass order, and its clear value
+    std::vector<uint32_t> attachments;
+    std::vector<VkClearValue> clearValues;
+    bool usesBackbuffer = false;
+
+    //set by CreateResources, one per backbuffer image if the pass draws into it
+    std::vector<VkFramebuffer> framebuffers;
+    VkExtent2D extent{};
+};
+
+/**
+ * @brief Frame graph. Passes are declared once with the resources they read and
+ * write, then Compile drops passes whose results nothing reaches the backbuffer
+ * with, keeps the rest in declaration order and works out every layout transition
+ * and memory dependency between them, batched into one pipeline barrier per pass.
+ * CreateResources allocates the transient images, letting images whose lifetimes
+ * don't overlap share memory, and the framebuffers. Execute records a frame.
+ *
+ * Buffers are only tracked for synchronization, the graph doesn't own them.
+ * Render thread only.
+ */
+class RenderGraph
+{
+public:
+    RenderGraph() = default;
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    /**
+     * @brief The image the frame ends in, a swap chain image or an offscreen
+     * target. A swap chain image's acquire semaphore must be waited on at
+     * VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT.
+     *
+     * @param finalLayout VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, or
+     * VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL to copy the frame out after Execute.
+     */
+    RenderGraphResource ImportBackbuffer(const char* name, VkFormat format, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+    /**
+     * @brief A buffer owned elsewhere, tracked so passes are ordered on it.
+     */
+    RenderGraphResource ImportBuffer(const char* name);
+
+    /**
+     * @brief An image that only lives within the frame. Its contents don't survive
+     * to the next frame, and its memory may be shared with other transients.
+     */
+    RenderGraphResource CreateImage(const char* name, const RenderGraphImageDesc& desc);
+
+    /**
+     * @brief Adds a pass after every pass added so far. It may only read what
+     * those passes wrote, so declaration order is a valid execution order.
+     */
+    RenderGraphPass& AddPass(const char* name, RenderGraphPassKind kind);
+
+    /**
+     * @brief Culls, orders and computes barriers, then creates a render pass per
+     * live raster pass. Call once all passes are declared.
+     */
+    void Compile(VkDevice device);
+
+    /**
+     * @brief Creates the transient images and the framebuffers. Call after Compile
+     * and again, after DestroyResources or RetireResources, when the swap chain is
+     * recreated.
+     *
+     * @param allocator Where transient memory comes from.
+     * @param extent Backbuffer size.
+     * @param backbufferImages Swap chain images.
+     * @param backbufferViews Their views, one framebuffer is made per view.
+     */
+    void CreateResources(GpuAllocator& allocator, VkExtent2D extent, const std::vector<VkImage>& backbufferImages,
+        const std::vector<VkImageView>& backbufferViews);
+
+    /**
+     * @brief Frees the transient images and the framebuffers. The device must be idle.
+     */
+    void DestroyResources();
+
+    /**
+     * @brief Hands the transient images and the framebuffers to the deletion queue,
+     * so new ones can be created while frames in flight still use the old.
+     *
+     * @param value Frame timeline value after which nothing uses them.
+     */
+    void RetireResources(DeletionQueue& deletions, uint64_t value);
+
+    /**
+     * @brief Destroys everything, including the render passes and declarations.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Records every live, enabled pass with its barriers, then moves the backbuffer
+     * to its final layout.
+     *
+     * @param commandBuffer Primary buffer, outside a render pass.
+     * @param backbufferIndex Acquired swap chain image.
+     */
+    void Execute(VkCommandBuffer commandBuffer, uint32_t backbufferIndex);
+
+    /**
+     * @brief Context to record one pass by hand, without its barriers, for
+     * benchmarks that time a pass on its own.
+     */
+    RenderGraphContext GetContext(const RenderGraphPass& pass, VkCommandBuffer commandBuffer, uint32_t backbufferIndex) const;
+
+    /**
+     * @brief Times every pass Execute records, barriers included, as a scope named
+     * after the pass. nullptr stops profiling.
+     */
+    void SetProfiler(GpuProfiler* gpuProfiler) { profiler = gpuProfiler; }
+
+    //live passes in execution order, valid after Compile
+    const std::vector<RenderGraphPass*>& GetPasses() const { return order; }
+
+    const RenderGraphStats& GetStats() const { return stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    friend class RenderGraphPass;
+
+    enum class ResourceType : uint32_t
+    {
+        Backbuffer,
+        Image,
+        Buffer
+    };
+
+    struct Resource
+    {
+        std::string name;
+        ResourceType type = ResourceType::Image;
+        RenderGraphImageDesc desc;
+        //backbuffer only, the layout Execute leaves it in
+        VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        //set by Compile: positions in the execution order of the first and last
+        //live pass touching it, every stage it's used in and every write to it
+        uint32_t firstPass = UINT32_MAX;
+        uint32_t lastPass = 0;
+        VkImageUsageFlags usage = 0;
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags writeAccess = 0;
+
+        //set by CreateResources
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+        uint32_t slot = UINT32_MAX;
+    };
+
+    /**
+     * @brief Images sharing one memory range, with every stage and write they are
+     * used with, which the first use of each image in a frame waits for.
+     */
+    struct MemorySlot
+    {
+        VkMemoryRequirements requirements{};
+        std::vector<uint32_t> images;
+        GpuAllocation allocation;
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags writeAccess = 0;
+    };
+
+    struct Barrier
+    {
+        uint32_t resource = RenderGraphResource::INVALID_INDEX;
+        VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags srcStages = 0;
+        VkAccessFlags srcAccess = 0;
+        VkPipelineStageFlags dstStages = 0;
+        VkAccessFlags dstAccess = 0;
+        //first use of a transient this frame, also waits for the other users of its memory
+        bool firstUse = false;
+    };
+
+    struct AccessInfo
+    {
+        VkPipelineStageFlags stages;
+        VkAccessFlags access;
+        VkImageLayout layout;
+        VkImageUsageFlags usage;
+        bool write;
+    };
+
+    static AccessInfo GetAccessInfo(RenderGraphAccess access, RenderGraphPassKind kind);
+    static bool IsDepthFormat(VkFormat format);
+    static VkExtent2D GetImageExtent(const Resource& resource, VkExtent2D backbuffer);
+
+    void CullPasses();
+    void ComputeBarriers();
+    void CreateRenderPass(RenderGraphPass& pass);
+    void CreateTransientImages(VkExtent2D extent);
+    void CreateFramebuffers(VkExtent2D extent, const std::vector<VkImageView>& backbufferViews);
+    void RecordBarriers(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t count, uint32_t backbufferIndex);
+
+    VkDevice device = VK_NULL_HANDLE;
+    GpuAllocator* allocator = nullptr;
+    GpuProfiler* profiler = nullptr;
+
+    std::vector<Resource> resources;
+    std::vector<std::unique_ptr<RenderGraphPass>> passes;
+    //live passes in execution order
+    std::vector<RenderGraphPass*> order;
+    std::vector<Barrier> barriers;
+    //backbuffer to its final layout after the last pass
+    uint32_t finalBarrierBegin = 0;
+    uint32_t finalBarrierCount = 0;
+    bool compiled = false;
+
+    std::vector<MemorySlot> slots;
+    std::vector<VkImage> backbufferImages;
+
+    //scratch reused by every barrier batch
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+
+    RenderGraphStats stats;
+};
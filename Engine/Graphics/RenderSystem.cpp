@@ -1,4 +1,61 @@
 #include "RenderSystem.h"
+#include <algorithm>
+#include <iostream>
+#include "Profiler.h"
+
+/**
+ * @brief RenderSystem Constructor. Window and API setup happen on the calling
+ * (main) thread, everything after that on the render thread. Headless settings
+ * skip GLFW entirely.
+ *
+ * @param jobs Job system the render thread joins to split command recording.
+ * @param settings Renderer options, see RenderSettings.
+ */
+RenderSystem::RenderSystem(JobSystem& jobs, const RenderSettings& settings)
+    : jobSystem(jobs),
+    renderThreadRunning(true),
+    framesAcquired(0),
+    framesRendered(0),
+    statFrames(0),
+    statSimNs(0),
+    statRenderNs(0),
+    statOverlapNs(0)
+{
+    data.jobSystem = &jobSystem;
+    data.settings = settings;
+    overlayVisible = settings.overlay;
+    swapchainPolicy = settings.swapchain;
+    if (!data.settings.headless)
+    {
+        GLFWSetup();
+    }
+    SetupFunction(data);
+    renderThread = std::thread(&RenderSystem::RenderThreadMain, this);
+}
+
+/**
+ * @brief RenderSystem Destructor.
+ *
+ */
+RenderSystem::~RenderSystem()
+{
+    StopRenderThread();
+
+    FrameOverlapStats stats = GetOverlapStats();
+    if (stats.frames > 0)
+    {
+        std::cout << "Frame overlap: " << stats.frames << " frames, sim " << stats.simSeconds
+            << "s, render " << stats.renderSeconds << "s, " << stats.OverlapRatio() * 100.0
+            << "% of simulation overlapped with recording" << std::endl;
+    }
+
+    CleanupFunction(data);
+    if (!data.settings.headless)
+    {
+        GLFWCleanup();
+    }
+}
+
 /**
  * @brief GLFW setup commands.
  *
@@ -7,8 +64,8 @@ void RenderSystem::GLFWSetup()
 {
     glfwInit();
 
+    // Resizes reach the render thread through the frame packet's framebuffer size
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
 
     data.window = glfwCreateWindow(WIDTH, HEIGHT, "FridayEngine", nullptr, nullptr);
 }
@@ -21,3 +78,268 @@ void RenderSystem::GLFWCleanup()
     glfwDestroyWindow(data.window);
     glfwTerminate();
 }
+
+/**
+ * @brief Applies the frame rate cap, and in low latency mode moves the wait for a free
+ * frame slot from the render thread to before input sampling.
+ *
+ */
+void RenderSystem::PaceFrame()
+{
+    using Clock = std::chrono::steady_clock;
+    if (swapchainPolicy.frameRateCap > 0.0)
+    {
+        PROFILE_ZONE("FrameRateCap");
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / swapchainPolicy.frameRateCap));
+        Clock::time_point now = Clock::now();
+        // Sleep most of the way, the scheduler can overshoot by a millisecond, then spin
+        if (nextFrameStart - now > std::chrono::milliseconds(2))
+        {
+            std::this_thread::sleep_until(nextFrameStart - std::chrono::milliseconds(1));
+        }
+        while (Clock::now() < nextFrameStart)
+        {
+            std::this_thread::yield();
+        }
+        // A frame that ran long moves the schedule instead of bursting to catch up
+        now = Clock::now();
+        nextFrameStart = now - nextFrameStart > period ? now + period : nextFrameStart + period;
+    }
+
+    if (!data.settings.lowLatency)
+    {
+        return;
+    }
+
+    // The render thread is between frames once it has finished every packet
+    uint64_t rendered = framesRendered.load(std::memory_order_acquire);
+    while (rendered < framesSubmitted)
+    {
+        framesRendered.wait(rendered, std::memory_order_acquire);
+        rendered = framesRendered.load(std::memory_order_acquire);
+    }
+
+    // It failed, SubmitFrame rethrows
+    if (rendered == UINT64_MAX)
+    {
+        return;
+    }
+    PROFILE_ZONE("PaceFrame");
+    data.pacer.WaitForFrameSlot();
+}
+
+/**
+ * @brief Switches the swap chain policy, the render thread picks it up with the next packet.
+ *
+ * @param policy New present mode, image count and frame rate cap.
+ */
+void RenderSystem::SetSwapchainPolicy(const SwapchainPolicy& policy)
+{
+    // Restart the cap's schedule
+    if (policy.frameRateCap != swapchainPolicy.frameRateCap)
+    {
+        nextFrameStart = {};
+    }
+    swapchainPolicy = policy;
+}
+
+/**
+ * @brief Starts building the next frame packet.
+ *
+ * @return FramePacket& The packet to fill.
+ */
+FramePacket& RenderSystem::BeginFrame()
+{
+    FramePacket& packet = framePackets.WriteBuffer();
+    packet.frameIndex = nextFrameIndex++;
+    packet.simBegin = std::chrono::steady_clock::now();
+    if (data.window)
+    {
+        glfwGetFramebufferSize(data.window, &packet.framebufferWidth, &packet.framebufferHeight);
+
+        // F1 toggles the overlay on the press, not while held
+        bool keyDown = glfwGetKey(data.window, GLFW_KEY_F1) == GLFW_PRESS;
+        if (keyDown && !overlayKeyDown)
+        {
+            overlayVisible = !overlayVisible;
+        }
+        overlayKeyDown = keyDown;
+
+        // F2 cycles the present mode, to compare them on one machine
+        keyDown = glfwGetKey(data.window, GLFW_KEY_F2) == GLFW_PRESS;
+        if (keyDown && !presentModeKeyDown)
+        {
+            SwapchainPolicy policy = swapchainPolicy;
+            policy.presentMode = static_cast<PresentMode>((static_cast<uint32_t>(policy.presentMode) + 1) % static_cast<uint32_t>(PresentMode::Count));
+            SetSwapchainPolicy(policy);
+        }
+        presentModeKeyDown = keyDown;
+
+        // F3 toggles wireframe, its pipeline compiles in the background on first use
+        keyDown = glfwGetKey(data.window, GLFW_KEY_F3) == GLFW_PRESS;
+        if (keyDown && !wireframeKeyDown)
+        {
+            wireframe = !wireframe;
+        }
+        wireframeKeyDown = keyDown;
+    }
+    else
+    {
+        packet.framebufferWidth = static_cast<int>(data.settings.headlessWidth);
+        packet.framebufferHeight = static_cast<int>(data.settings.headlessHeight);
+    }
+    packet.showOverlay = data.settings.overlay && overlayVisible;
+    packet.swapchainPolicy = swapchainPolicy;
+    packet.wireframe = wireframe;
+    return packet;
+}
+
+/**
+ * @brief Publishes the packet started by BeginFrame to the render thread.
+ *
+ */
+void RenderSystem::SubmitFrame()
+{
+    FramePacket& packet = framePackets.WriteBuffer();
+
+    // Don't overwrite a packet the render thread hasn't seen yet
+    uint64_t acquired = framesAcquired.load(std::memory_order_acquire);
+    while (acquired < packet.frameIndex)
+    {
+        framesAcquired.wait(acquired, std::memory_order_acquire);
+        acquired = framesAcquired.load(std::memory_order_acquire);
+    }
+
+    if (acquired == UINT64_MAX && renderError)
+    {
+        std::rethrow_exception(renderError);
+    }
+
+    packet.simEnd = std::chrono::steady_clock::now();
+    framePackets.Publish();
+    framesSubmitted++;
+}
+
+/**
+ * @brief Snapshot of the simulation/render overlap counters.
+ *
+ * @return FrameOverlapStats Totals since startup.
+ */
+FrameOverlapStats RenderSystem::GetOverlapStats() const
+{
+    FrameOverlapStats stats;
+    stats.frames = statFrames.load(std::memory_order_relaxed);
+    stats.simSeconds = statSimNs.load(std::memory_order_relaxed) * 1e-9;
+    stats.renderSeconds = statRenderNs.load(std::memory_order_relaxed) * 1e-9;
+    stats.overlapSeconds = statOverlapNs.load(std::memory_order_relaxed) * 1e-9;
+    return stats;
+}
+
+/**
+ * @brief Render thread main loop: take the newest packet, record and submit it.
+ *
+ */
+void RenderSystem::RenderThreadMain()
+{
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point lastRenderBegin;
+    Clock::time_point lastRenderEnd;
+
+    try
+    {
+        // Recording jobs use this thread's command pools too
+        jobSystem.RegisterThread();
+        CpuProfiler::SetThreadName("Render");
+        while (true)
+        {
+            framePackets.WaitForPublish();
+            if (!renderThreadRunning.load(std::memory_order_acquire))
+            {
+                break;
+            }
+            framePackets.Acquire();
+
+            const FramePacket& packet = framePackets.ReadBuffer();
+            framesAcquired.store(packet.frameIndex + 1, std::memory_order_release);
+            framesAcquired.notify_one();
+
+            // Simulation of this packet vs. recording of the previous one
+            Clock::time_point overlapBegin = std::max(packet.simBegin, lastRenderBegin);
+            Clock::time_point overlapEnd = std::min(packet.simEnd, lastRenderEnd);
+            if (overlapEnd > overlapBegin)
+            {
+                statOverlapNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(overlapEnd - overlapBegin).count(), std::memory_order_relaxed);
+            }
+            statSimNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(packet.simEnd - packet.simBegin).count(), std::memory_order_relaxed);
+
+            Clock::time_point renderBegin = Clock::now();
+            {
+                PROFILE_ZONE("RenderFrame");
+                InterpolateTransforms(packet);
+                data.framePacket = &packet;
+                RenderFunction(data);
+                data.framePacket = nullptr;
+            }
+            Clock::time_point renderEnd = Clock::now();
+
+            statRenderNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(renderEnd - renderBegin).count(), std::memory_order_relaxed);
+            statFrames.fetch_add(1, std::memory_order_relaxed);
+            framesRendered.store(packet.frameIndex + 1, std::memory_order_release);
+            framesRendered.notify_one();
+            lastRenderBegin = renderBegin;
+            lastRenderEnd = renderEnd;
+        }
+        jobSystem.UnregisterThread();
+    }
+    catch (...)
+    {
+        jobSystem.UnregisterThread();
+        renderError = std::current_exception();
+        // Release the simulation thread if it is waiting on us
+        framesAcquired.store(UINT64_MAX, std::memory_order_release);
+        framesAcquired.notify_one();
+        framesRendered.store(UINT64_MAX, std::memory_order_release);
+        framesRendered.notify_one();
+    }
+}
+
+/**
+ * @brief Lets the render thread pick up the last packet, so every submitted frame
+ * gets rendered, then wakes it with an exit request and joins it.
+ *
+ */
+void RenderSystem::StopRenderThread()
+{
+    if (!renderThread.joinable())
+    {
+        return;
+    }
+    uint64_t acquired = framesAcquired.load(std::memory_order_acquire);
+    while (acquired < framesSubmitted)
+    {
+        framesAcquired.wait(acquired, std::memory_order_acquire);
+        acquired = framesAcquired.load(std::memory_order_acquire);
+    }
+    renderThreadRunning.store(false, std::memory_order_release);
+    framePackets.Publish();
+    renderThread.join();
+}
+
+/**
+ * @brief Blends the packet's last two simulation states into data.objectTransforms
+ * and copies what each object is drawn with.
+ *
+ * @param packet The packet being rendered.
+ */
+void RenderSystem::InterpolateTransforms(const FramePacket& packet)
+{
+    // The simulation already paired each object's previous state with its current one
+    const size_t count = packet.currentTransforms.size();
+    data.objectTransforms.resize(count);
+    data.objectRenderables.assign(packet.renderables.begin(), packet.renderables.end());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        data.objectTransforms[i] = Transform::Interpolate(packet.previousTransforms[i], packet.currentTransforms[i], packet.interpolationAlpha).ToMatrix();
+    }
+}
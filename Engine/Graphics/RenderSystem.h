@@ -1,8 +1,12 @@
 #pragma once
 #include "VulkanRenderAPI.h"
+#include "FramePacket.h"
+#include "TripleBuffer.h"
 
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <thread>
-#include <mutex>
 #include <functional>
 
 
@@ -11,35 +15,110 @@ typedef std::function<void(RenderData&)> RenderAPIInit;
 typedef std::function<void(RenderData&)> RenderAPIRender;
 typedef std::function<void(RenderData&)> RenderAPIExit;
 
+/**
+ * @brief How much simulation of frame N+1 overlapped command recording of frame N.
+ */
+struct FrameOverlapStats
+{
+    uint64_t frames = 0;
+    //total time spent building frame packets on the simulation thread
+    double simSeconds = 0.0;
+    //total time spent in the render API on the render thread
+    double renderSeconds = 0.0;
+    //portion of simSeconds that ran while the render thread was busy
+    double overlapSeconds = 0.0;
+
+    double OverlapRatio() const { return simSeconds > 0.0 ? overlapSeconds / simSeconds : 0.0; }
+};
+
 class RenderSystem
 {
 public:
-    RenderSystem()
-    {
-        GLFWSetup();
-        SetupFunction(data);
-    }
-    ~RenderSystem()
-    {
-        CleanupFunction(data);
-        GLFWCleanup();
-    }
-    void render()
-    {
-        std::lock_guard<std::mutex> lock(dataMutex);
-        RenderFunction(data);
-    }
-    
+    /**
+     * @param jobs Job system the render thread joins to split command recording.
+     * @param settings Renderer options, see RenderSettings.
+     */
+    explicit RenderSystem(JobSystem& jobs, const RenderSettings& settings = {});
+    ~RenderSystem();
+
+    /**
+     * @brief Holds the frame to the swap chain policy's frame rate cap, then in low
+     * latency mode waits until the render thread has submitted every packet and the
+     * GPU has a frame slot free, so the next frame starts recording without waiting.
+     * Main thread only, right before input is sampled.
+     */
+    void PaceFrame();
+
+    /**
+     * @brief Switches present mode, image count or frame rate cap from the next
+     * frame on. F2 cycles the present mode. Main thread only.
+     */
+    void SetSwapchainPolicy(const SwapchainPolicy& policy);
+
+    const SwapchainPolicy& GetSwapchainPolicy() const { return swapchainPolicy; }
+
+    /**
+     * @brief Starts building the next frame packet. Simulation thread only.
+     *
+     * @return FramePacket& The packet to fill, private to the caller until SubmitFrame.
+     */
+    FramePacket& BeginFrame();
+
+    /**
+     * @brief Hands the packet to the render thread. Waits only if the render thread
+     * has not yet picked up the previous packet, so simulation stays at most one
+     * frame ahead of recording.
+     */
+    void SubmitFrame();
+
+    FrameOverlapStats GetOverlapStats() const;
+
     void GLFWSetup();
     void GLFWCleanup();
 
-    GLFWwindow& GetWindow() const { return *data.window; }
+    //nullptr when rendering headless
+    GLFWwindow* GetWindow() const { return data.window; }
 private:
+    void RenderThreadMain();
+    void StopRenderThread();
+    void InterpolateTransforms(const FramePacket& packet);
+
     RenderData data;
-    std::mutex dataMutex;
+    JobSystem& jobSystem;
     RenderAPIInit SetupFunction = VulkanSetup;
     RenderAPIRender RenderFunction = VulkanRender;
     RenderAPIExit CleanupFunction = VulkanCleanup;
     const uint32_t HEIGHT = 600;
     const uint32_t WIDTH = 800;
-};
\ No newline at end of file
+
+    //sim -> render handoff, no locks
+    TripleBuffer<FramePacket> framePackets;
+    std::thread renderThread;
+    std::atomic<bool> renderThreadRunning;
+    uint64_t nextFrameIndex = 0;
+    //number of packets the render thread has picked up so far
+    std::atomic<uint64_t> framesAcquired;
+    //number of packets the render thread has finished with, for low latency mode
+    std::atomic<uint64_t> framesRendered;
+    //number of packets published so far, simulation thread only
+    uint64_t framesSubmitted = 0;
+    //debug overlay state, main thread only
+    bool overlayVisible = false;
+    bool overlayKeyDown = false;
+    //policy handed to the render thread with each packet, main thread only
+    SwapchainPolicy swapchainPolicy;
+    bool presentModeKeyDown = false;
+    //wireframe toggle, main thread only
+    bool wireframe = false;
+    bool wireframeKeyDown = false;
+    //when the frame rate cap lets the next frame start, main thread only
+    std::chrono::steady_clock::time_point nextFrameStart;
+    //set by the render thread if the render API threw, rethrown on the sim thread
+    std::exception_ptr renderError;
+
+    //overlap bookkeeping, written by the render thread
+    std::atomic<uint64_t> statFrames;
+    std::atomic<int64_t> statSimNs;
+    std::atomic<int64_t> statRenderNs;
+    std::atomic<int64_t> statOverlapNs;
+};
@@ -0,0 +1,446 @@
+/*****************************************************************//**
+ * \file   ShaderCompiler.cpp
+ * \brief  GLSL to SPIR-V through glslc, cached by content hash and recompiled on change
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "ShaderCompiler.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // FNV-1a, continued from hash
+    uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool ReadFile(const std::string& path, std::string& contents)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream.is_open())
+        {
+            return false;
+        }
+        contents.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // Through a temporary file, so the pipelines never load half a shader
+    bool WriteFile(const std::string& path, const std::string& contents)
+    {
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            stream.write(contents.data(), contents.size());
+            if (!stream)
+            {
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        return !error;
+    }
+
+    std::string Quote(const std::string& text)
+    {
+        return "\"" + text + "\"";
+    }
+
+    // Runs a shell command, its output and errors are appended to output
+    int RunCommand(const std::string& command, std::string& output)
+    {
+#ifdef _WIN32
+        // cmd.exe drops the first and last quote of a command starting with one
+        FILE* pipe = _popen(Quote(command + " 2>&1").c_str(), "r");
+#else
+        FILE* pipe = popen((command + " 2>&1").c_str(), "r");
+#endif
+        if (!pipe)
+        {
+            return -1;
+        }
+        char buffer[512];
+        while (std::fgets(buffer, sizeof(buffer), pipe))
+        {
+            output += buffer;
+        }
+#ifdef _WIN32
+        return _pclose(pipe);
+#else
+        return pclose(pipe);
+#endif
+    }
+
+    // glslc from the Vulkan SDK if VULKAN_SDK is set, else from the PATH
+    std::string FindCompiler()
+    {
+        const char* sdk = std::getenv("VULKAN_SDK");
+        if (sdk)
+        {
+#ifdef _WIN32
+            std::filesystem::path path = std::filesystem::path(sdk) / "Bin" / "glslc.exe";
+#else
+            std::filesystem::path path = std::filesystem::path(sdk) / "bin" / "glslc";
+#endif
+            std::error_code error;
+            if (std::filesystem::exists(path, error))
+            {
+                return path.string();
+            }
+        }
+        return "glslc";
+    }
+}
+
+ShaderCompiler::~ShaderCompiler()
+{
+    Shutdown();
+}
+
+/**
+ * @param shaderSources Every shader, kept for watching.
+ */
+void ShaderCompiler::Init(const std::vector<ShaderSource>& shaderSources)
+{
+    sources = shaderSources;
+    compiledHashes.assign(sources.size(), 0);
+    compilerPath = FindCompiler();
+    stats = {};
+    changed.clear();
+}
+
+/**
+ * @brief Compiles the sources in parallel, one thread each up to the core count.
+ * Warm starts only hash the sources and compare against the cache.
+ *
+ */
+void ShaderCompiler::CompileAll()
+{
+    PROFILE_FUNCTION();
+    std::atomic<size_t> next{ 0 };
+    auto compileNext = [this, &next]()
+    {
+        for (size_t source = next++; source < sources.size(); source = next++)
+        {
+            Compile(source);
+        }
+    };
+    size_t threadCount = std::min<size_t>(sources.size(), std::max(std::thread::hardware_concurrency(), 1u));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(compileNext);
+    }
+    compileNext();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (size_t source = 0; source < sources.size(); source++)
+    {
+        if (compiledHashes[source] != 0)
+        {
+            continue;
+        }
+        std::error_code error;
+        if (!std::filesystem::exists(sources[source].spirvPath, error))
+        {
+            throw std::runtime_error("failed to compile " + sources[source].sourcePath + "!");
+        }
+        std::cerr << "Using the existing " << sources[source].spirvPath << std::endl;
+    }
+}
+
+/**
+ * @brief Starts the watch thread and waits for it to set up its watches.
+ *
+ */
+void ShaderCompiler::StartWatching()
+{
+    stopping = false;
+    std::promise<void> watching;
+    std::future<void> started = watching.get_future();
+    watchThread = std::thread(&ShaderCompiler::WatchThreadMain, this, std::move(watching));
+    started.wait();
+}
+
+/**
+ * @brief Stops the watch thread, within POLL_INTERVAL_MS.
+ *
+ */
+void ShaderCompiler::Shutdown()
+{
+    stopping = true;
+    if (watchThread.joinable())
+    {
+        watchThread.join();
+    }
+}
+
+/**
+ * @param spirvPaths Cleared, then filled with the SPIR-V files rewritten since the last call.
+ */
+void ShaderCompiler::TakeChanged(std::vector<std::string>& spirvPaths)
+{
+    spirvPaths.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    spirvPaths.swap(changed);
+}
+
+ShaderCompilerStats ShaderCompiler::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Writes the compile and cache counters.
+ *
+ * @param out Where to write it.
+ */
+void ShaderCompiler::PrintReport(std::ostream& out) const
+{
+    ShaderCompilerStats current = GetStats();
+    char line[256];
+    std::snprintf(line, sizeof(line),
+        "[Shaders] %zu shaders, %u compiled (%.2f ms avg, %.2f ms max), %u from the cache, %u failed, %u reloaded\n",
+        sources.size(), current.compiles, current.AverageCompileMs(), current.maxCompileMs,
+        current.cacheHits, current.failedCompiles, current.reloads);
+    out << line;
+}
+
+/**
+ * @brief Hashes the source and its arguments, takes the SPIR-V from the cache or
+ * runs glslc into it, and copies it over the source's SPIR-V file if it differs.
+ *
+ * @param source Index into sources.
+ * @return bool True if its SPIR-V file was rewritten.
+ */
+bool ShaderCompiler::Compile(size_t source)
+{
+    PROFILE_FUNCTION();
+    const ShaderSource& shader = sources[source];
+    std::string code;
+    if (!ReadFile(shader.sourcePath, code))
+    {
+        std::cerr << "Failed to read shader " << shader.sourcePath << std::endl;
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.failedCompiles++;
+        return false;
+    }
+
+    // The stage comes from the extension, so it is part of the key too
+    std::string extension = std::filesystem::path(shader.sourcePath).extension().string();
+    uint64_t hash = HashBytes(14695981039346656037ull, code.data(), code.size());
+    hash = HashBytes(hash, shader.arguments.data(), shader.arguments.size());
+    hash = HashBytes(hash, extension.data(), extension.size());
+    if (hash == compiledHashes[source])
+    {
+        // Saved without changes
+        return false;
+    }
+
+    char fileName[32];
+    std::snprintf(fileName, sizeof(fileName), "%016llx.spv", static_cast<unsigned long long>(hash));
+    std::string cachePath = (std::filesystem::path(CACHE_DIRECTORY) / fileName).string();
+    std::string spirv;
+    if (ReadFile(cachePath, spirv))
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.cacheHits++;
+    }
+    else
+    {
+        std::error_code error;
+        std::filesystem::create_directories(CACHE_DIRECTORY, error);
+
+        // Into a temporary file, glslc leaves a partial one behind on failure
+        std::string tempPath = cachePath + ".tmp";
+        std::string command = Quote(compilerPath) + " " + shader.arguments + " " + Quote(shader.sourcePath) + " -o " + Quote(tempPath);
+        std::string output;
+        auto compileBegin = std::chrono::steady_clock::now();
+        int status = RunCommand(command, output);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileBegin).count();
+        bool compiled = status == 0 && ReadFile(tempPath, spirv) && !spirv.empty();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.compiles++;
+            stats.totalCompileMs += ms;
+            stats.maxCompileMs = std::max(stats.maxCompileMs, ms);
+            if (!compiled)
+            {
+                stats.failedCompiles++;
+            }
+        }
+        if (!compiled)
+        {
+            std::filesystem::remove(tempPath, error);
+            std::cerr << "Failed to compile " << shader.sourcePath << ":\n" << output << std::flush;
+            return false;
+        }
+        // Only speeds up the next compile, so a failure here is not one
+        std::filesystem::rename(tempPath, cachePath, error);
+    }
+
+    // Shaders differing only in comments give the same SPIR-V, nothing to reload then
+    compiledHashes[source] = hash;
+    std::string current;
+    if (ReadFile(shader.spirvPath, current) && current == spirv)
+    {
+        return false;
+    }
+    if (!WriteFile(shader.spirvPath, spirv))
+    {
+        std::cerr << "Failed to write " << shader.spirvPath << std::endl;
+        compiledHashes[source] = 0;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Recompiles the flagged sources and queues the SPIR-V files that changed.
+ *
+ * @param dirty One flag per source, cleared on return.
+ */
+void ShaderCompiler::RecompileChanged(std::vector<bool>& dirty)
+{
+    for (size_t source = 0; source < sources.size(); source++)
+    {
+        if (!dirty[source])
+        {
+            continue;
+        }
+        dirty[source] = false;
+        if (!Compile(source))
+        {
+            continue;
+        }
+
+        std::cout << "Reloaded " << sources[source].sourcePath << std::endl;
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.reloads++;
+        const std::string& spirvPath = sources[source].spirvPath;
+        if (std::find(changed.begin(), changed.end(), spirvPath) == changed.end())
+        {
+            changed.push_back(spirvPath);
+        }
+    }
+}
+
+/**
+ * @brief Watch thread loop. On Linux, waits on inotify for files written or moved
+ * into the sources' directories, else polls their modification times.
+ *
+ * @param watching Set once changes from here on are seen.
+ */
+void ShaderCompiler::WatchThreadMain(std::promise<void> watching)
+{
+    CpuProfiler::SetThreadName("Shader watch");
+#ifdef __linux__
+    int notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notify < 0)
+    {
+        PollForChanges(std::move(watching));
+        return;
+    }
+
+    // Directories rather than files, as editors often save by renaming a new file over the old one
+    std::vector<int> watches(sources.size(), -1);
+    for (size_t source = 0; source < sources.size(); source++)
+    {
+        std::filesystem::path directory = std::filesystem::path(sources[source].sourcePath).parent_path();
+        watches[source] = inotify_add_watch(notify, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    }
+    watching.set_value();
+
+    std::vector<bool> dirty(sources.size(), false);
+    alignas(inotify_event) char buffer[4096];
+    while (!stopping)
+    {
+        pollfd pollInfo{ notify, POLLIN, 0 };
+        if (poll(&pollInfo, 1, static_cast<int>(POLL_INTERVAL_MS)) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t length;
+        while ((length = read(notify, buffer, sizeof(buffer))) > 0)
+        {
+            for (char* at = buffer; at < buffer + length;)
+            {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+                for (size_t source = 0; source < sources.size(); source++)
+                {
+                    if (event->len > 0 && watches[source] == event->wd &&
+                        std::filesystem::path(sources[source].sourcePath).filename() == event->name)
+                    {
+                        dirty[source] = true;
+                    }
+                }
+                at += sizeof(inotify_event) + event->len;
+            }
+        }
+        RecompileChanged(dirty);
+    }
+    close(notify);
+#else
+    PollForChanges(std::move(watching));
+#endif
+}
+
+/**
+ * @brief Checks every source's modification time each POLL_INTERVAL_MS.
+ *
+ * @param watching Set once the starting times are read.
+ */
+void ShaderCompiler::PollForChanges(std::promise<void> watching)
+{
+    std::vector<std::filesystem::file_time_type> writeTimes(sources.size());
+    std::error_code error;
+    for (size_t source = 0; source < sources.size(); source++)
+    {
+        writeTimes[source] = std::filesystem::last_write_time(sources[source].sourcePath, error);
+    }
+    watching.set_value();
+
+    std::vector<bool> dirty(sources.size(), false);
+    while (!stopping)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+        for (size_t source = 0; source < sources.size(); source++)
+        {
+            std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(sources[source].sourcePath, error);
+            if (!error && writeTime != writeTimes[source])
+            {
+                writeTimes[source] = writeTime;
+                dirty[source] = true;
+            }
+        }
+        RecompileChanged(dirty);
+    }
+}
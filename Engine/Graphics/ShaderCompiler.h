@@ -0,0 +1,140 @@
+/*****************************************************************//**
+ * \file   ShaderCompiler.h
+ * \brief  GLSL to SPIR-V through glslc, cached by content hash and recompiled on change
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief One GLSL file and the SPIR-V file pipelines load it from.
+ */
+struct ShaderSource
+{
+    //GLSL file, glslc picks the stage from its extension
+    std::string sourcePath;
+
+    //written on every successful compile, relative to the working directory
+    std::string spirvPath;
+
+    //extra glslc arguments, e.g. --target-env=vulkan1.2
+    std::string arguments;
+};
+
+/**
+ * @brief Counters since startup.
+ */
+struct ShaderCompilerStats
+{
+    //glslc runs and how long they took
+    uint32_t compiles = 0;
+    double totalCompileMs = 0.0;
+    double maxCompileMs = 0.0;
+    //sources whose SPIR-V was already in the cache
+    uint32_t cacheHits = 0;
+    uint32_t failedCompiles = 0;
+    //SPIR-V files rewritten after their source changed on disk
+    uint32_t reloads = 0;
+
+    double AverageCompileMs() const { return compiles > 0 ? totalCompileMs / compiles : 0.0; }
+};
+
+/**
+ * @brief Compiles the engine's GLSL shaders with glslc, from $VULKAN_SDK or the
+ * PATH. Each result is kept in CACHE_DIRECTORY under a hash of the source and its
+ * arguments, so unchanged shaders are copied instead of compiled, across runs and
+ * after edits are undone. #include'd files are not part of the hash.
+ *
+ * After CompileAll, a watch thread recompiles sources as they are saved, with
+ * inotify on Linux and by polling modification times elsewhere, and reports the
+ * SPIR-V files that changed through TakeChanged. A shader that fails to compile
+ * keeps its previous SPIR-V, the errors go to std::cerr.
+ */
+class ShaderCompiler
+{
+public:
+    //compiled SPIR-V by content hash, relative to the working directory
+    static constexpr const char* CACHE_DIRECTORY = "shaders/cache";
+
+    //how often the watch thread checks for changes or for Shutdown
+    static constexpr uint32_t POLL_INTERVAL_MS = 250;
+
+    ShaderCompiler() = default;
+    ~ShaderCompiler();
+
+    ShaderCompiler(const ShaderCompiler&) = delete;
+    ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+    /**
+     * @param shaderSources Every shader, kept for watching.
+     */
+    void Init(const std::vector<ShaderSource>& shaderSources);
+
+    /**
+     * @brief Brings every SPIR-V file up to date with its source, on the calling thread.
+     * Throws if a shader fails to compile and has no SPIR-V from an earlier run.
+     */
+    void CompileAll();
+
+    /**
+     * @brief Starts the watch thread, after CompileAll. Returns once it is watching,
+     * so no later save is missed.
+     */
+    void StartWatching();
+
+    /**
+     * @brief Stops the watch thread, if it was started.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Hands over the SPIR-V files rewritten by the watch thread since the last call.
+     *
+     * @param spirvPaths Cleared, then filled with ShaderSource::spirvPath of each.
+     */
+    void TakeChanged(std::vector<std::string>& spirvPaths);
+
+    ShaderCompilerStats GetStats() const;
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    /**
+     * @brief Brings one source's SPIR-V up to date.
+     *
+     * @return bool True if its SPIR-V file was rewritten.
+     */
+    bool Compile(size_t source);
+
+    /**
+     * @brief Recompiles the flagged sources and clears their flags.
+     */
+    void RecompileChanged(std::vector<bool>& dirty);
+
+    void WatchThreadMain(std::promise<void> watching);
+
+    //watch loop without change notifications, compares modification times
+    void PollForChanges(std::promise<void> watching);
+
+    std::vector<ShaderSource> sources;
+    //hash each source's SPIR-V was last written from, 0 before the first compile
+    std::vector<uint64_t> compiledHashes;
+    std::string compilerPath;
+
+    //guards stats and changed
+    mutable std::mutex mutex;
+    ShaderCompilerStats stats;
+    std::vector<std::string> changed;
+
+    std::atomic<bool> stopping{ false };
+    std::thread watchThread;
+};
@@ -0,0 +1,128 @@
+/*****************************************************************//**
+ * \file   SwapchainPolicy.cpp
+ * \brief  Present mode, swap chain image count and frame rate cap, with present timing per mode
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "SwapchainPolicy.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+    struct PresentModeInfo
+    {
+        const char* name;
+        VkPresentModeKHR vkMode;
+    };
+
+    //indexed by PresentMode
+    constexpr PresentModeInfo PRESENT_MODES[] =
+    {
+        { "vsync", VK_PRESENT_MODE_FIFO_KHR },
+        { "mailbox", VK_PRESENT_MODE_MAILBOX_KHR },
+        { "immediate", VK_PRESENT_MODE_IMMEDIATE_KHR },
+        { "fifo-relaxed", VK_PRESENT_MODE_FIFO_RELAXED_KHR },
+    };
+    static_assert(std::size(PRESENT_MODES) == static_cast<size_t>(PresentMode::Count));
+}
+
+VkPresentModeKHR ToVkPresentMode(PresentMode mode)
+{
+    return PRESENT_MODES[static_cast<size_t>(mode)].vkMode;
+}
+
+const char* GetPresentModeName(PresentMode mode)
+{
+    return PRESENT_MODES[static_cast<size_t>(mode)].name;
+}
+
+bool ParsePresentMode(const std::string& name, PresentMode& mode)
+{
+    for (size_t i = 0; i < std::size(PRESENT_MODES); i++)
+    {
+        if (name == PRESENT_MODES[i].name)
+        {
+            mode = static_cast<PresentMode>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+double PresentModeStats::JitterSeconds() const
+{
+    if (intervals == 0)
+    {
+        return 0.0;
+    }
+    double average = AverageIntervalSeconds();
+    return std::sqrt(std::max(totalIntervalSquares / intervals - average * average, 0.0));
+}
+
+/**
+ * @brief Starts counting towards the mode the new swap chain uses.
+ *
+ * @param presentMode Mode in use, after any fallback.
+ */
+void PresentTimer::SetMode(PresentMode presentMode)
+{
+    mode = presentMode;
+    hasLastPresent = false;
+}
+
+void PresentTimer::AddAcquireTime(double seconds)
+{
+    stats[static_cast<size_t>(mode)].acquireSeconds += seconds;
+}
+
+/**
+ * @brief Counts a presented frame and the interval since the previous one.
+ *
+ * @param seconds Time vkQueuePresentKHR blocked.
+ * @param now When it returned.
+ */
+void PresentTimer::Presented(double seconds, std::chrono::steady_clock::time_point now)
+{
+    PresentModeStats& modeStats = stats[static_cast<size_t>(mode)];
+    modeStats.frames++;
+    modeStats.presentSeconds += seconds;
+    if (hasLastPresent)
+    {
+        double interval = std::chrono::duration<double>(now - lastPresent).count();
+        modeStats.minIntervalSeconds = modeStats.intervals > 0 ? std::min(modeStats.minIntervalSeconds, interval) : interval;
+        modeStats.maxIntervalSeconds = std::max(modeStats.maxIntervalSeconds, interval);
+        modeStats.intervals++;
+        modeStats.totalIntervalSeconds += interval;
+        modeStats.totalIntervalSquares += interval * interval;
+    }
+    lastPresent = now;
+    hasLastPresent = true;
+}
+
+/**
+ * @brief Writes one line per present mode that was used.
+ *
+ * @param out Where to write it.
+ */
+void PresentTimer::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        const PresentModeStats& modeStats = stats[i];
+        if (modeStats.frames == 0)
+        {
+            continue;
+        }
+        double average = modeStats.AverageIntervalSeconds();
+        std::snprintf(line, sizeof(line),
+            "[Present] %-12s %llu frames, %.1f fps, interval avg %.2f ms, min %.2f, max %.2f, jitter %.2f; acquire %.3f ms, present %.3f ms per frame\n",
+            PRESENT_MODES[i].name, static_cast<unsigned long long>(modeStats.frames), average > 0.0 ? 1.0 / average : 0.0,
+            average * 1000.0, modeStats.minIntervalSeconds * 1000.0, modeStats.maxIntervalSeconds * 1000.0, modeStats.JitterSeconds() * 1000.0,
+            modeStats.acquireSeconds * 1000.0 / modeStats.frames, modeStats.presentSeconds * 1000.0 / modeStats.frames);
+        out << line;
+    }
+}
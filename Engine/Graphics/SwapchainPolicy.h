@@ -0,0 +1,115 @@
+/*****************************************************************//**
+ * \file   SwapchainPolicy.h
+ * \brief  Present mode, swap chain image count and frame rate cap, with present timing per mode
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief How finished frames reach the screen. Modes the surface doesn't support
+ * fall back to Vsync, which every surface has.
+ */
+enum class PresentMode : uint32_t
+{
+    //FIFO: waits for vertical blank, no tearing, throughput capped at the refresh rate
+    Vsync,
+    //newest frame replaces the queued one: no tearing, lower latency, renders uncapped
+    Mailbox,
+    //presents at once: tears, lowest latency
+    Immediate,
+    //FIFO, but a late frame is shown at once instead of waiting another blank
+    FifoRelaxed,
+    Count
+};
+
+/**
+ * @brief Swap chain choices, switchable at runtime through RenderSystem::SetSwapchainPolicy.
+ */
+struct SwapchainPolicy
+{
+    PresentMode presentMode = PresentMode::Mailbox;
+
+    //images requested, clamped to what the surface allows. 0 takes the surface minimum plus one
+    uint32_t imageCount = 0;
+
+    //frames per second the main thread is held to, 0 for no cap
+    double frameRateCap = 0.0;
+
+    bool operator==(const SwapchainPolicy&) const = default;
+};
+
+VkPresentModeKHR ToVkPresentMode(PresentMode mode);
+
+const char* GetPresentModeName(PresentMode mode);
+
+/**
+ * @brief Reads a mode from its name: vsync, mailbox, immediate or fifo-relaxed.
+ *
+ * @return bool False if the name is unknown, mode is left alone.
+ */
+bool ParsePresentMode(const std::string& name, PresentMode& mode);
+
+/**
+ * @brief Present timing of one mode, over the frames presented while it was active.
+ */
+struct PresentModeStats
+{
+    uint64_t frames = 0;
+    //intervals between consecutive presents
+    uint64_t intervals = 0;
+    double totalIntervalSeconds = 0.0;
+    double totalIntervalSquares = 0.0;
+    double minIntervalSeconds = 0.0;
+    double maxIntervalSeconds = 0.0;
+    //render thread time blocked in vkAcquireNextImageKHR and vkQueuePresentKHR
+    double acquireSeconds = 0.0;
+    double presentSeconds = 0.0;
+
+    double AverageIntervalSeconds() const { return intervals > 0 ? totalIntervalSeconds / intervals : 0.0; }
+    //standard deviation of the interval, how evenly frames are paced
+    double JitterSeconds() const;
+};
+
+/**
+ * @brief Times presented frames on the render thread, kept apart per present mode
+ * so modes can be compared on the same machine in one run. The interval between
+ * one present returning and the next is the rate frames reach the display engine.
+ */
+class PresentTimer
+{
+public:
+    /**
+     * @brief Starts counting towards the mode the new swap chain actually uses. The
+     * interval across a switch isn't counted.
+     */
+    void SetMode(PresentMode mode);
+
+    void AddAcquireTime(double seconds);
+
+    /**
+     * @param seconds Time vkQueuePresentKHR blocked.
+     * @param now When it returned.
+     */
+    void Presented(double seconds, std::chrono::steady_clock::time_point now);
+
+    const PresentModeStats& GetStats(PresentMode mode) const { return stats[static_cast<size_t>(mode)]; }
+
+    /**
+     * @brief One line per mode that presented at least one frame.
+     */
+    void PrintReport(std::ostream& out) const;
+
+private:
+    PresentMode mode = PresentMode::Vsync;
+    //set once the current mode has presented
+    bool hasLastPresent = false;
+    std::chrono::steady_clock::time_point lastPresent;
+    std::array<PresentModeStats, static_cast<size_t>(PresentMode::Count)> stats{};
+};
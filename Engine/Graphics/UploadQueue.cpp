@@ -0,0 +1,379 @@
+/*****************************************************************//**
+ * \file   UploadQueue.cpp
+ * \brief  Batched buffer uploads through a persistently mapped staging ring
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#include "UploadQueue.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+/**
+ * @brief Creates the command pool, timeline semaphore and staging ring.
+ *
+ * @param logicalDevice The logical device.
+ * @param gpuAllocator Where the ring and oversized staging buffers come from.
+ * @param uploadQueue Queue copies are submitted to.
+ * @param uploadFamily Family of uploadQueue.
+ * @param consumerFamily Family that uses the uploaded buffers.
+ * @param capacity Staging ring capacity in bytes.
+ */
+void UploadQueue::Init(VkDevice logicalDevice, GpuAllocator& gpuAllocator, VkQueue uploadQueue, uint32_t uploadFamily, uint32_t consumerFamily, VkDeviceSize capacity)
+{
+    device = logicalDevice;
+    allocator = &gpuAllocator;
+    queue = uploadQueue;
+    queueFamily = uploadFamily;
+    graphicsFamily = consumerFamily;
+    ringSize = capacity;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upload command pool!");
+    }
+
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create upload timeline semaphore!");
+    }
+
+    ring = allocator->CreateBuffer(ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, ringAllocation);
+}
+
+/**
+ * @brief Waits for every batch and releases everything.
+ *
+ */
+void UploadQueue::Shutdown()
+{
+    if (device == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    Flush();
+    Wait(submittedValue);
+    Reclaim();
+
+    allocator->DestroyBuffer(ring, ringAllocation);
+    vkDestroySemaphore(device, timeline, nullptr);
+    vkDestroyCommandPool(device, commandPool, nullptr);
+    batches.clear();
+    freeCommandBuffers.clear();
+    device = VK_NULL_HANDLE;
+}
+
+/**
+ * @brief Stages data and records a copy into dst.
+ *
+ * @param dst Destination buffer, created with TRANSFER_DST usage.
+ * @param dstOffset Byte offset into dst.
+ * @param source Data to copy.
+ * @param size Bytes to copy.
+ */
+void UploadQueue::Upload(VkBuffer dst, VkDeviceSize dstOffset, const void* source, VkDeviceSize size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    VkBufferCopy region{};
+    region.dstOffset = dstOffset;
+    region.size = size;
+
+    VkBuffer staging = ring;
+    if (size > ringSize)
+    {
+        // Would never fit, give it a staging buffer that lives as long as its batch
+        OversizedStaging entry;
+        entry.buffer = allocator->CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, entry.allocation);
+        entry.value = submittedValue + 1;
+        std::memcpy(entry.allocation.mapped, source, size);
+        staging = entry.buffer;
+        oversized.push_back(entry);
+        stats.oversized++;
+    }
+    else
+    {
+        // May flush the current batch, so reserve space before picking the command buffer
+        region.srcOffset = AllocateRing(size);
+        std::memcpy(static_cast<std::byte*>(ringAllocation.mapped) + region.srcOffset, source, size);
+    }
+
+    VkCommandBuffer commandBuffer = recording ? recording : BeginBatch();
+    vkCmdCopyBuffer(commandBuffer, staging, dst, 1, &region);
+    if (UsesTransferFamily())
+    {
+        AddOwnershipTransfer(dst, dstOffset, size);
+    }
+
+    stats.copies++;
+    stats.bytes += size;
+}
+
+/**
+ * @brief Submits everything recorded since the last Flush as one batch.
+ *
+ * @return uint64_t Timeline value that signals once all uploads so far are done.
+ */
+uint64_t UploadQueue::Flush()
+{
+    if (recording == VK_NULL_HANDLE)
+    {
+        return submittedValue;
+    }
+
+    // Hand the written ranges over to the graphics family
+    if (!releaseBarriers.empty())
+    {
+        vkCmdPipelineBarrier(recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+            0, nullptr, static_cast<uint32_t>(releaseBarriers.size()), releaseBarriers.data(), 0, nullptr);
+    }
+
+    if (vkEndCommandBuffer(recording) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to record upload command buffer!");
+    }
+
+    uint64_t value = submittedValue + 1;
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &value;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &recording;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timeline;
+    if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to submit upload batch!");
+    }
+
+    submittedValue = value;
+    batches.push_back(Batch{ recording, value });
+    ringRegions.push_back(RingRegion{ ringHead, value });
+    recording = VK_NULL_HANDLE;
+
+    acquireBarriers.insert(acquireBarriers.end(), releaseBarriers.begin(), releaseBarriers.end());
+    releaseBarriers.clear();
+    stats.batches++;
+    return submittedValue;
+}
+
+/**
+ * @brief Records the graphics side of the ownership transfers flushed so far.
+ *
+ * @param commandBuffer A graphics command buffer, outside a render pass.
+ */
+void UploadQueue::RecordAcquireBarriers(VkCommandBuffer commandBuffer)
+{
+    if (acquireBarriers.empty())
+    {
+        return;
+    }
+
+    for (VkBufferMemoryBarrier& barrier : acquireBarriers)
+    {
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+    }
+    // The submission waits on the timeline at CONSUMER_STAGES, chain onto that wait
+    vkCmdPipelineBarrier(commandBuffer, CONSUMER_STAGES, CONSUMER_STAGES, 0,
+        0, nullptr, static_cast<uint32_t>(acquireBarriers.size()), acquireBarriers.data(), 0, nullptr);
+    acquireBarriers.clear();
+}
+
+/**
+ * @brief Blocks until the batch that signals value has finished.
+ *
+ * @param value Timeline value returned by Flush.
+ */
+void UploadQueue::Wait(uint64_t value)
+{
+    if (value == 0 || GetCompletedValue() >= value)
+    {
+        return;
+    }
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline;
+    waitInfo.pValues = &value;
+    if (vkWaitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to wait for uploads!");
+    }
+}
+
+/**
+ * @brief Writes the upload counters.
+ *
+ * @param out Where to write it.
+ */
+void UploadQueue::PrintReport(std::ostream& out) const
+{
+    char line[256];
+    std::snprintf(line, sizeof(line), "[Uploads] %llu copies, %.1f MB in %llu batches on the %s queue, %llu ring stalls, %llu oversized\n",
+        static_cast<unsigned long long>(stats.copies), static_cast<double>(stats.bytes) / (1024.0 * 1024.0),
+        static_cast<unsigned long long>(stats.batches), UsesTransferFamily() ? "transfer" : "graphics",
+        static_cast<unsigned long long>(stats.ringStalls), static_cast<unsigned long long>(stats.oversized));
+    out << line;
+}
+
+/**
+ * @brief Starts recording a new batch, reusing a finished command buffer if there is one.
+ *
+ * @return VkCommandBuffer The command buffer, ready for commands.
+ */
+VkCommandBuffer UploadQueue::BeginBatch()
+{
+    Reclaim();
+
+    VkCommandBuffer commandBuffer;
+    if (!freeCommandBuffers.empty())
+    {
+        commandBuffer = freeCommandBuffers.back();
+        freeCommandBuffers.pop_back();
+    }
+    else
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = commandPool;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to allocate upload command buffer!");
+        }
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to begin upload command buffer!");
+    }
+    recording = commandBuffer;
+    return commandBuffer;
+}
+
+/**
+ * @brief Reserves contiguous ring space, waiting for old batches only when the
+ * ring is full.
+ *
+ * @param size Bytes needed, no more than the ring size.
+ * @return uint64_t Offset into the ring buffer.
+ */
+uint64_t UploadQueue::AllocateRing(VkDeviceSize size)
+{
+    while (true)
+    {
+        uint64_t head = (ringHead + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+        // A copy source has to be contiguous, skip the end of the ring if it doesn't fit
+        if (head % ringSize + size > ringSize)
+        {
+            head += ringSize - head % ringSize;
+        }
+        if (head + size - ringTail <= ringSize)
+        {
+            ringHead = head + size;
+            return head % ringSize;
+        }
+
+        // Full: submit what's recorded so it can finish, then wait for the oldest batch
+        Flush();
+        if (ringRegions.empty())
+        {
+            // Nothing in flight, only the wrap padding was in the way, restart at the front
+            ringHead = ringTail = (ringHead + ringSize - 1) / ringSize * ringSize;
+            continue;
+        }
+        stats.ringStalls++;
+        Wait(ringRegions.front().value);
+        Reclaim();
+    }
+}
+
+/**
+ * @brief Recycles ring space, command buffers and staging buffers of finished batches.
+ *
+ */
+void UploadQueue::Reclaim()
+{
+    uint64_t completed = GetCompletedValue();
+    while (!ringRegions.empty() && ringRegions.front().value <= completed)
+    {
+        ringTail = ringRegions.front().end;
+        ringRegions.pop_front();
+    }
+    while (!batches.empty() && batches.front().value <= completed)
+    {
+        freeCommandBuffers.push_back(batches.front().commandBuffer);
+        batches.pop_front();
+    }
+    for (size_t i = 0; i < oversized.size();)
+    {
+        if (oversized[i].value <= completed)
+        {
+            allocator->DestroyBuffer(oversized[i].buffer, oversized[i].allocation);
+            oversized[i] = oversized.back();
+            oversized.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+uint64_t UploadQueue::GetCompletedValue() const
+{
+    uint64_t value = 0;
+    vkGetSemaphoreCounterValue(device, timeline, &value);
+    return value;
+}
+
+/**
+ * @brief Queues the release and acquire halves of a queue family ownership transfer.
+ *
+ * @param dst Buffer written by the copy.
+ * @param offset Start of the written range.
+ * @param size Length of the written range.
+ */
+void UploadQueue::AddOwnershipTransfer(VkBuffer dst, VkDeviceSize offset, VkDeviceSize size)
+{
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = queueFamily;
+    barrier.dstQueueFamilyIndex = graphicsFamily;
+    barrier.buffer = dst;
+    barrier.offset = offset;
+    barrier.size = size;
+    releaseBarriers.push_back(barrier);
+}
@@ -0,0 +1,168 @@
+/*****************************************************************//**
+ * \file   UploadQueue.h
+ * \brief  Batched buffer uploads through a persistently mapped staging ring
+ *
+ * \author Sakura
+ * \date   October 2026
+ *********************************************************************/
+#pragma once
+#include "vulkan/vulkan.h"
+#include "GpuAllocator.h"
+#include <deque>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Counters since startup.
+ */
+struct UploadStats
+{
+    uint64_t copies = 0;
+    uint64_t bytes = 0;
+    uint64_t batches = 0;
+    //times an upload had to wait for the GPU to free ring space
+    uint64_t ringStalls = 0;
+    //uploads larger than the ring that got a staging buffer of their own
+    uint64_t oversized = 0;
+};
+
+/**
+ * @brief Copies CPU data into device local buffers without stalling. Upload writes
+ * the data into a persistently mapped staging ring and records the copy; Flush
+ * submits everything recorded since the last Flush as one command buffer, on a
+ * dedicated transfer queue if the device has one. Completion is tracked with a
+ * timeline semaphore: each batch signals the next value, and ring space is reused
+ * once the semaphore has passed the value of the batch that used it.
+ *
+ * Consumers wait on GetTimeline() at GetSubmittedValue() before touching uploaded
+ * buffers. When the transfer queue belongs to another family, the graphics queue
+ * must also record RecordAcquireBarriers once per Flush. Render thread only.
+ */
+class UploadQueue
+{
+public:
+    //stages graphics work may first touch uploaded data in
+    static constexpr VkPipelineStageFlags CONSUMER_STAGES =
+        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+    UploadQueue() = default;
+
+    UploadQueue(const UploadQueue&) = delete;
+    UploadQueue& operator=(const UploadQueue&) = delete;
+
+    /**
+     * @param device The logical device.
+     * @param allocator Where the ring and oversized staging buffers come from.
+     * @param queue Queue copies are submitted to.
+     * @param queueFamily Family of queue.
+     * @param graphicsFamily Family that uses the uploaded buffers.
+     * @param ringSize Staging ring capacity in bytes.
+     */
+    void Init(VkDevice device, GpuAllocator& allocator, VkQueue queue, uint32_t queueFamily, uint32_t graphicsFamily, VkDeviceSize ringSize);
+
+    /**
+     * @brief Waits for every batch and frees the ring. Call before the allocator shuts down.
+     */
+    void Shutdown();
+
+    /**
+     * @brief Stages data and records a copy into dst. The copy is submitted by the next Flush.
+     *
+     * @param dst Destination buffer, created with TRANSFER_DST usage.
+     * @param dstOffset Byte offset into dst.
+     * @param source Data to copy, free to reuse as soon as Upload returns.
+     * @param size Bytes to copy.
+     */
+    void Upload(VkBuffer dst, VkDeviceSize dstOffset, const void* source, VkDeviceSize size);
+
+    /**
+     * @brief Submits everything recorded since the last Flush.
+     *
+     * @return uint64_t Timeline value that signals once all uploads so far are done.
+     */
+    uint64_t Flush();
+
+    /**
+     * @brief Takes ownership of buffers released by the transfer family since the last
+     * call. Record it on the graphics queue in a submission that waits for Flush's value.
+     *
+     * @param commandBuffer A graphics command buffer, outside a render pass.
+     */
+    void RecordAcquireBarriers(VkCommandBuffer commandBuffer);
+
+    /**
+     * @brief Blocks until the batch that signals value has finished.
+     */
+    void Wait(uint64_t value);
+
+    VkSemaphore GetTimeline() const { return timeline; }
+
+    uint64_t GetSubmittedValue() const { return submittedValue; }
+
+    bool UsesTransferFamily() const { return queueFamily != graphicsFamily; }
+
+    const UploadStats& GetStats() const { return stats; }
+
+    void PrintReport(std::ostream& out) const;
+
+private:
+    //staging offsets keep this alignment, enough for any texel block and copy fast paths
+    static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+    //ring bytes used by one batch, positions keep growing and wrap with % ringSize
+    struct RingRegion
+    {
+        uint64_t end;
+        uint64_t value;
+    };
+
+    //buffer too large for the ring, destroyed once its batch finished
+    struct OversizedStaging
+    {
+        VkBuffer buffer;
+        GpuAllocation allocation;
+        uint64_t value;
+    };
+
+    struct Batch
+    {
+        VkCommandBuffer commandBuffer;
+        uint64_t value;
+    };
+
+    VkCommandBuffer BeginBatch();
+    uint64_t AllocateRing(VkDeviceSize size);
+    void Reclaim();
+    uint64_t GetCompletedValue() const;
+    void AddOwnershipTransfer(VkBuffer dst, VkDeviceSize offset, VkDeviceSize size);
+
+    VkDevice device = VK_NULL_HANDLE;
+    GpuAllocator* allocator = nullptr;
+    VkQueue queue = VK_NULL_HANDLE;
+    uint32_t queueFamily = 0;
+    uint32_t graphicsFamily = 0;
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    VkSemaphore timeline = VK_NULL_HANDLE;
+    uint64_t submittedValue = 0;
+
+    VkBuffer ring = VK_NULL_HANDLE;
+    GpuAllocation ringAllocation;
+    VkDeviceSize ringSize = 0;
+    uint64_t ringHead = 0;
+    uint64_t ringTail = 0;
+    std::deque<RingRegion> ringRegions;
+    std::vector<OversizedStaging> oversized;
+
+    //batch being recorded, null until the first Upload after a Flush
+    VkCommandBuffer recording = VK_NULL_HANDLE;
+    std::deque<Batch> batches;
+    std::vector<VkCommandBuffer> freeCommandBuffers;
+
+    //queue family ownership transfers, released by the batch being recorded
+    std::vector<VkBufferMemoryBarrier> releaseBarriers;
+    //and acquired by the next graphics submission
+    std::vector<VkBufferMemoryBarrier> acquireBarriers;
+
+    UploadStats stats;
+};
@@ -9,13 +9,39 @@
 #include <array>
 #include <cstring>
 #include <limits>
+#include <memory_resource>
+#include <chrono>
+#include <cmath>
+#include "LinearArena.h"
+#include "Profiler.h"
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
+//staging memory for buffer uploads, larger uploads get a staging buffer of their own
+const VkDeviceSize UPLOAD_RING_SIZE = 16 * 1024 * 1024;
+
+//compiled pipelines from the last run, relative to the working directory like the shaders
+const char* const PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+
+//CMake runs the engine from the build tree, so the sources are watched where they are edited
+#ifdef FRIDAY_SHADER_SOURCE_DIR
+#define SHADER_SOURCE_DIR FRIDAY_SHADER_SOURCE_DIR
+#else
+#define SHADER_SOURCE_DIR "shaders"
+#endif
+
+//every shader the renderer loads, compiled into shaders/ at setup
+const std::vector<ShaderSource> shaderSources = {
+    { SHADER_SOURCE_DIR "/shader.vert", "shaders/vert.spv", "--target-env=vulkan1.2" },
+    { SHADER_SOURCE_DIR "/shader.frag", "shaders/frag.spv", "" },
+    { SHADER_SOURCE_DIR "/indirect.vert", "shaders/indirect.spv", "" },
+    { SHADER_SOURCE_DIR "/cull.comp", "shaders/cull.spv", "" }
+};
 
 struct QueueFamilyIndices
 {
     std::optional<uint32_t> graphicsFamily;
     std::optional <uint32_t> presentFamily;
+    //family that can copy but not draw, only set if the device has one
+    std::optional<uint32_t> transferFamily;
 
     bool isComplete() const
     {
@@ -25,9 +51,14 @@ struct QueueFamilyIndices
 
 struct SwapChainSupportDetails
 {
+    explicit SwapChainSupportDetails(std::pmr::memory_resource* memory)
+        : capabilities{}, formats(memory), presentModes(memory)
+    {
+    }
+
     VkSurfaceCapabilitiesKHR capabilities;
-    std::vector<VkSurfaceFormatKHR> formats;
-    std::vector<VkPresentModeKHR> presentModes;
+    std::pmr::vector<VkSurfaceFormatKHR> formats;
+    std::pmr::vector<VkPresentModeKHR> presentModes;
 };
 
 struct Vertex
@@ -67,17 +98,46 @@ const std::vector<Vertex> vertices = {
     {{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}
 };
 
-const std::vector<uint16_t> indices = {
+const std::vector<uint32_t> indices = {
     0, 1, 2, 2, 3, 0
 };
 
+/**
+ * @brief One entry of the material table. Layout matches Material in shader.vert.
+ */
+struct MaterialData
+{
+    glm::vec4 tint;
+    //bindless image and sampler, BindlessDescriptors::INVALID_INDEX until meshes have texture coordinates
+    uint32_t texture = BindlessDescriptors::INVALID_INDEX;
+    uint32_t sampler = BindlessDescriptors::INVALID_INDEX;
+    uint32_t padding[2] = {};
+};
+
+/**
+ * @brief Vertex push constants of the CPU draw path. Layout matches shader.vert.
+ */
+struct MaterialConstants
+{
+    //bindless storage buffer holding the material table
+    uint32_t materialTable;
+    uint32_t materialCount;
+};
+
+const std::vector<MaterialData> materials = {
+    {{1.0f, 1.0f, 1.0f, 1.0f}},
+    {{1.0f, 0.6f, 0.6f, 1.0f}},
+    {{0.6f, 1.0f, 0.6f, 1.0f}},
+    {{0.6f, 0.6f, 1.0f, 1.0f}}
+};
+
 
 //Function declarations
 VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData);
 void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
 void SetupDebugMessenger(RenderData& data);
 void CreateInstance(RenderData& data);
-std::vector<const char*> GetRequiredExtensions();
+std::pmr::vector<const char*> GetRequiredExtensions(bool headless, std::pmr::memory_resource* memory);
 bool CheckValidationLayerSupport();
 bool isDeviceSuitable(RenderData& data, VkPhysicalDevice device);
 void PickPhysicalDevice(RenderData& data);
@@ -85,28 +145,39 @@ QueueFamilyIndices FindQueueFamilies(RenderData& data, VkPhysicalDevice& device)
 void CreateLogicalDevice(RenderData& data);
 void CreateSurface(RenderData& data);
 void CreateSwapChain(RenderData& data);
-VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
-VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
+VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::pmr::vector<VkSurfaceFormatKHR>& availableFormats);
+PresentMode ChooseSwapPresentMode(const std::pmr::vector<VkPresentModeKHR>& availablePresentModes, PresentMode requested);
+uint32_t ChooseSwapImageCount(const VkSurfaceCapabilitiesKHR& capabilities, uint32_t requested);
 VkExtent2D ChooseSwapExtent(RenderData& data, const VkSurfaceCapabilitiesKHR& capabilities);
-SwapChainSupportDetails QuerySwapChainSupport(RenderData& data, VkPhysicalDevice& device);
+SwapChainSupportDetails QuerySwapChainSupport(RenderData& data, VkPhysicalDevice& device, std::pmr::memory_resource* memory);
 void CreateImageViews(RenderData& data);
-void CreateRenderPass(RenderData& data);
+void CreateGpuProfiler(RenderData& data);
+void CreateRenderGraph(RenderData& data);
+void CreateDebugOverlay(RenderData& data);
+void BuildDebugOverlay(RenderData& data);
 void CreateGraphicsPipeline(RenderData& data);
-VkShaderModule CreateShaderModule(RenderData& data, const std::vector<char>& code);
-static std::vector<char> readFile(const std::string& filename);
+GraphicsPipelineDesc DescribeDrawPipeline(RenderData& data, const char* vertexShaderPath, VkPipelineLayout layout, bool instanceBinding);
+void CreateGpuDrivenPipelines(RenderData& data);
+VkPipeline CreateCullPipeline(RenderData& data);
+void ReloadShaders(RenderData& data);
+VkShaderModule CreateShaderModule(RenderData& data, const std::pmr::vector<char>& code);
+static std::pmr::vector<char> readFile(const std::string& filename, std::pmr::memory_resource* memory);
 void CreateFrameBuffers(RenderData& data);
-void CreateCommandPool(RenderData& data);
-void CreateCommandBuffers(RenderData& data);
+void CreateHeadlessTarget(RenderData& data);
+void CreateCommandRecorder(RenderData& data);
 void RecordCommandBuffer(RenderData& data, VkCommandBuffer commandBuffer, uint32_t imageIndex);
+void RecordMainPass(RenderData& data, CommandRecorder& recorder, JobSystem& jobs, RenderGraphContext& context);
+void RecordDraws(RenderData& data, VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end);
+void SetViewportAndScissor(RenderData& data, VkCommandBuffer commandBuffer);
 void CreateSyncObjects(RenderData& data);
 void RecreateSwapChain(RenderData& data);
 void CleanupSwapChain(RenderData& data);
 static void FramebufferResizeCallback(GLFWwindow* window, int width, int height);
-void CreateVertexBuffer(RenderData& data);
-void CreateBuffer(RenderData& data, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-void CopyBuffer(RenderData& data, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-uint32_t findMemoryType(RenderData& data, uint32_t typeFilter, VkMemoryPropertyFlags properties);
-void CreateIndexBuffer(RenderData& data);
+void CreateScene(RenderData& data);
+void CreateMaterials(RenderData& data);
+void CreateBuffer(RenderData& data, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, GpuAllocation& allocation);
+void CreateUploadQueue(RenderData& data);
+static std::vector<glm::mat4> BenchmarkGrid(uint32_t count);
 
 
 const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
@@ -162,23 +233,67 @@ void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT
  */
 void VulkanSetup(RenderData& data)
 {
-    glfwSetWindowUserPointer(data.window, &data);
+    if (data.settings.headless)
+    {
+        data.framebufferWidth = static_cast<int>(data.settings.headlessWidth);
+        data.framebufferHeight = static_cast<int>(data.settings.headlessHeight);
+    }
+    else
+    {
+        glfwSetWindowUserPointer(data.window, &data);
+        glfwGetFramebufferSize(data.window, &data.framebufferWidth, &data.framebufferHeight);
+    }
     CreateInstance(data);
     SetupDebugMessenger(data);
-    CreateSurface(data);
+    if (!data.settings.headless)
+    {
+        CreateSurface(data);
+    }
     PickPhysicalDevice(data);
     CreateLogicalDevice(data);
-    CreateSwapChain(data);
-    CreateImageViews(data);
-    CreateRenderPass(data);
+    data.allocator.Init(data.physicalDevice, data.device);
+    data.deletions.Init(data.device, data.allocator);
+    data.bindless.Init(data.device, data.physicalDevice);
+    data.shaderCompiler.Init(shaderSources);
+    data.shaderCompiler.CompileAll();
+    data.pipelineCache.Load(data.physicalDevice, data.device, PIPELINE_CACHE_PATH);
+    data.pipelines.Init(data.device, data.pipelineCache);
+    if (data.settings.headless)
+    {
+        CreateHeadlessTarget(data);
+    }
+    else
+    {
+        CreateSwapChain(data);
+        CreateImageViews(data);
+    }
+    CreateGpuProfiler(data);
+    CreateRenderGraph(data);
     CreateGraphicsPipeline(data);
+    if (data.settings.overlay)
+    {
+        CreateDebugOverlay(data);
+    }
     CreateFrameBuffers(data);
-    CreateCommandPool(data);
-    CreateVertexBuffer(data);
-    CreateIndexBuffer(data);
+    CreateCommandRecorder(data);
+    CreateUploadQueue(data);
+    CreateScene(data);
+    CreateMaterials(data);
+    data.batcher.Init(data.allocator, data.settings.framesInFlight);
+    if (data.settings.gpuDriven)
+    {
+        CreateGpuDrivenPipelines(data);
+    }
 
-    CreateCommandBuffers(data);
     CreateSyncObjects(data);
+
+    if (data.settings.hotReload && !data.settings.headless)
+    {
+        data.shaderCompiler.StartWatching();
+    }
+
+    // Cold vs warm startup cost, delete the cache file to measure a cold start
+    data.pipelineCache.PrintReport(std::cout);
 }
 
 /**
@@ -188,36 +303,103 @@ void VulkanSetup(RenderData& data)
  */
 void VulkanCleanup(RenderData& data)
 {
+    data.shaderCompiler.Shutdown();
+    data.shaderCompiler.PrintReport(std::cout);
     vkDeviceWaitIdle(data.device);
+
+    // Every frame has finished, so the last readback and all timestamps are in.
+    // Benchmarks set up headless without rendering any frames
+    if (data.settings.headless && data.headless.GetStats().frames > 0)
+    {
+        data.headless.Finish();
+        data.headless.PrintReport(std::cout);
+        if (!data.settings.readbackPath.empty() && !data.headless.WritePpm(data.settings.readbackPath))
+        {
+            std::cerr << "Failed to write " << data.settings.readbackPath << std::endl;
+        }
+    }
     CleanupSwapChain(data);
+    if (!data.settings.headless)
+    {
+        data.presentTimer.PrintReport(std::cout);
+    }
+
+    data.deletions.PrintReport(std::cout);
+    data.deletions.Shutdown();
+
+    data.uploads.PrintReport(std::cout);
+    data.uploads.Shutdown();
+
+    data.scene.PrintReport(std::cout);
+    data.scene.Shutdown();
 
-    vkDestroyBuffer(data.device, data.indexBuffer, nullptr);
-    vkFreeMemory(data.device, data.indexBufferMemory, nullptr);
-  
-    vkDestroyBuffer(data.device, data.vertexBuffer, nullptr);
-    vkFreeMemory(data.device, data.vertexBufferMemory, nullptr);
+    data.batcher.PrintReport(std::cout);
+    data.batcher.Shutdown();
 
-    vkDestroyPipeline(data.device, data.graphicsPipeline, nullptr);
+    data.allocator.DestroyBuffer(data.materialBuffer, data.materialAllocation);
+
+    if (data.settings.gpuDriven)
+    {
+        vkDestroyPipelineLayout(data.device, data.indirectPipelineLayout, nullptr);
+        vkDestroyPipeline(data.device, data.cullPipeline, nullptr);
+        vkDestroyPipelineLayout(data.device, data.cullPipelineLayout, nullptr);
+    }
+    data.pipelines.PrintReport(std::cout);
+    data.pipelines.Shutdown();
     vkDestroyPipelineLayout(data.device, data.pipelineLayout, nullptr);
 
-    vkDestroyRenderPass(data.device, data.renderPass, nullptr);
+    data.bindless.PrintReport(std::cout);
+    data.bindless.Shutdown();
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) 
+    if (data.overlay.IsInitialized())
+    {
+        data.overlay.PrintReport(std::cout);
+        data.overlay.Shutdown();
+    }
+
+    data.graph.PrintReport(std::cout);
+    data.graph.Shutdown();
+
+    // The device is idle, so the last frames' queries are all available
+    data.profiler.Finish();
+    data.profiler.PrintReport(std::cout);
+    const std::string& profilePath = data.settings.gpuProfilePath;
+    if (!profilePath.empty())
+    {
+        bool json = profilePath.size() >= 5 && profilePath.compare(profilePath.size() - 5, 5, ".json") == 0;
+        if (!(json ? data.profiler.WriteJson(profilePath) : data.profiler.WriteCsv(profilePath)))
+        {
+            std::cerr << "Failed to write " << profilePath << std::endl;
+        }
+    }
+    data.profiler.Shutdown();
+
+    data.pacer.PrintReport(std::cout);
+    data.pacer.Shutdown();
+    for (size_t i = 0; i < data.imageAvailableSemaphores.size(); i++) 
     {
         vkDestroySemaphore(data.device, data.renderFinishedSemaphores[i], nullptr);
         vkDestroySemaphore(data.device, data.imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(data.device, data.inFlightFences[i], nullptr);
     }
 
-    vkDestroyCommandPool(data.device, data.commandPool, nullptr);
-    
+    data.recorder.PrintReport(std::cout);
+    data.recorder.Shutdown();
+
+    data.pipelineCache.Save();
+    data.pipelineCache.Destroy();
+
+    data.allocator.PrintReport(std::cout);
+    data.allocator.Shutdown();
     vkDestroyDevice(data.device, nullptr);
 
     if (enableValidationLayers)
     {
         DestroyDebugUtilsMessengerEXT(data.instance, data.debugMessenger, nullptr);
     }
-    vkDestroySurfaceKHR(data.instance, data.surface, nullptr);
+    if (!data.settings.headless)
+    {
+        vkDestroySurfaceKHR(data.instance, data.surface, nullptr);
+    }
 
     vkDestroyInstance(data.instance, nullptr);
 }
@@ -295,7 +477,7 @@ void CreateInstance(RenderData& data)
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "SaturdayEngine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_2;
 
     // Create Vulkan instance
     VkInstanceCreateInfo createInfo{};
@@ -303,7 +485,8 @@ void CreateInstance(RenderData& data)
     createInfo.pApplicationInfo = &appInfo;
 
     // Get required instance extensions
-    auto extensions = GetRequiredExtensions();
+    ScratchScope scratch;
+    auto extensions = GetRequiredExtensions(data.settings.headless, scratch.GetResource());
     createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     createInfo.ppEnabledExtensionNames = extensions.data();
 
@@ -332,16 +515,22 @@ void CreateInstance(RenderData& data)
 /**
  * @brief Retrieves the required extensions for the Vulkan instance.
  *
+ * @param headless No window, so none of the windowing system's extensions.
+ * @param memory Where the returned vector allocates.
  * @return A vector containing the required extensions.
  */
-std::vector<const char*> GetRequiredExtensions()
+std::pmr::vector<const char*> GetRequiredExtensions(bool headless, std::pmr::memory_resource* memory)
 {
-    // Get required extensions for interfacing with the windowing system
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::pmr::vector<const char*> extensions(memory);
 
-    std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    // Get required extensions for interfacing with the windowing system
+    if (!headless)
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     // Add debug utils extension if validation layers are enabled
     if (enableValidationLayers)
@@ -364,7 +553,8 @@ bool CheckValidationLayerSupport()
     uint32_t layerCount;
     vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
 
-    std::vector<VkLayerProperties> availableLayers(layerCount);
+    ScratchScope scratch;
+    std::pmr::vector<VkLayerProperties> availableLayers(layerCount, scratch.GetResource());
     vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
 
     // Check if all required validation layers are present
@@ -404,7 +594,22 @@ bool isDeviceSuitable(RenderData& data, VkPhysicalDevice device)
 {
     // Find queue families supported by the device
     QueueFamilyIndices indices = FindQueueFamilies(data, device);
-    return indices.isComplete();
+
+    // Uploads are tracked with timeline semaphores, core since Vulkan 1.2
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2)
+    {
+        return false;
+    }
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &features12;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    return indices.isComplete() && features12.timelineSemaphore && BindlessDescriptors::IsSupported(features12);
 }
 
 /**
@@ -424,7 +629,8 @@ void PickPhysicalDevice(RenderData& data)
     }
 
     // Retrieve the list of physical devices
-    std::vector<VkPhysicalDevice> devices(deviceCount);
+    ScratchScope scratch;
+    std::pmr::vector<VkPhysicalDevice> devices(deviceCount, scratch.GetResource());
     vkEnumeratePhysicalDevices(data.instance, &deviceCount, devices.data());
 
     // Select the first suitable device
@@ -456,31 +662,49 @@ QueueFamilyIndices FindQueueFamilies(RenderData& data, VkPhysicalDevice& device)
     uint32_t queueFamilyCount = 0;
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
 
-    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    ScratchScope scratch;
+    std::pmr::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount, scratch.GetResource());
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
     int i = 0;
+    bool pureTransferFamily = false;
     for (const auto& queueFamily : queueFamilies)
     {
-        // Check if the queue family supports graphics operations
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+        // Keep the first families that complete graphics and presentation
+        if (!indices.isComplete())
         {
-            indices.graphicsFamily = i;
-        }
+            // Check if the queue family supports graphics operations
+            if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            {
+                indices.graphicsFamily = i;
+            }
 
-        // Check if the queue family supports presentation
-        VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, data.surface, &presentSupport);
+            // Check if the queue family supports presentation, without a surface
+            // nothing is presented and the graphics family stands in
+            VkBool32 presentSupport = false;
+            if (data.settings.headless)
+            {
+                presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) ? VK_TRUE : VK_FALSE;
+            }
+            else
+            {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, data.surface, &presentSupport);
+            }
 
-        if (presentSupport)
-        {
-            indices.presentFamily = i;
+            if (presentSupport)
+            {
+                indices.presentFamily = i;
+            }
         }
 
-        // Break loop if both graphics and presentation families are found
-        if (indices.isComplete())
+        // A family that copies but can't draw usually runs on its own DMA engine,
+        // one that can't compute either is the most likely to be a pure copy engine
+        bool copyOnly = (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+        bool pureCopy = copyOnly && !(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT);
+        if (copyOnly && (!indices.transferFamily || (pureCopy && !pureTransferFamily)))
         {
-            break;
+            indices.transferFamily = i;
+            pureTransferFamily = pureCopy;
         }
 
         i++;
@@ -500,8 +724,13 @@ void CreateLogicalDevice(RenderData& data)
     QueueFamilyIndices indices = FindQueueFamilies(data, data.physicalDevice);
 
     // Configure device queues
-    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+    ScratchScope scratch;
+    std::pmr::vector<VkDeviceQueueCreateInfo> queueCreateInfos(scratch.GetResource());
     std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+    if (indices.transferFamily)
+    {
+        uniqueQueueFamilies.insert(indices.transferFamily.value());
+    }
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -513,15 +742,56 @@ void CreateLogicalDevice(RenderData& data)
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // The GPU-driven path needs indirect count draws, fall back to CPU draws without them
+    VkPhysicalDeviceVulkan12Features supported12{};
+    supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 supported{};
+    supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supported.pNext = &supported12;
+    vkGetPhysicalDeviceFeatures2(data.physicalDevice, &supported);
+    if (data.settings.gpuDriven &&
+        !(supported.features.multiDrawIndirect && supported.features.drawIndirectFirstInstance && supported12.drawIndirectCount))
+    {
+        std::cerr << "GPU-driven rendering needs multiDrawIndirect, drawIndirectFirstInstance and drawIndirectCount, using CPU draws" << std::endl;
+        data.settings.gpuDriven = false;
+    }
+    VkBool32 gpuDriven = data.settings.gpuDriven ? VK_TRUE : VK_FALSE;
+
+    // Secondary buffers run inside the statistics queries, so those must be inheritable
+    if (data.settings.pipelineStatistics && !(supported.features.pipelineStatisticsQuery && supported.features.inheritedQueries))
+    {
+        std::cerr << "Pipeline statistics need pipelineStatisticsQuery and inheritedQueries, timing passes only" << std::endl;
+        data.settings.pipelineStatistics = false;
+    }
+    VkBool32 pipelineStatistics = data.settings.pipelineStatistics ? VK_TRUE : VK_FALSE;
+
+    // Optional, the wireframe toggle does nothing without it
+    data.wireframeSupported = supported.features.fillModeNonSolid == VK_TRUE;
+
     // Specify device features and extensions
     VkPhysicalDeviceFeatures deviceFeatures{};
+    deviceFeatures.multiDrawIndirect = gpuDriven;
+    deviceFeatures.drawIndirectFirstInstance = gpuDriven;
+    deviceFeatures.pipelineStatisticsQuery = pipelineStatistics;
+    deviceFeatures.inheritedQueries = pipelineStatistics;
+    deviceFeatures.fillModeNonSolid = data.wireframeSupported ? VK_TRUE : VK_FALSE;
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features12.timelineSemaphore = VK_TRUE;
+    features12.drawIndirectCount = gpuDriven;
+    BindlessDescriptors::EnableFeatures(features12);
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &features12;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    // No swap chain without a window
+    if (!data.settings.headless)
+    {
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    }
 
     // Enable validation layers if necessary
     if (enableValidationLayers)
@@ -543,6 +813,10 @@ void CreateLogicalDevice(RenderData& data)
     // Retrieve queue handles from the logical device
     vkGetDeviceQueue(data.device, indices.graphicsFamily.value(), 0, &data.graphicsQueue);
     vkGetDeviceQueue(data.device, indices.presentFamily.value(), 0, &data.presentQueue);
+    if (indices.transferFamily)
+    {
+        vkGetDeviceQueue(data.device, indices.transferFamily.value(), 0, &data.transferQueue);
+    }
 }
 
 /**
@@ -566,19 +840,16 @@ void CreateSurface(RenderData& data)
 void CreateSwapChain(RenderData& data)
 {
     // Query swap chain support details
-    SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(data, data.physicalDevice);
+    ScratchScope scratch;
+    SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(data, data.physicalDevice, scratch.GetResource());
 
     // Choose surface format, presentation mode, and extent
     VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(swapChainSupport.formats);
-    VkPresentModeKHR presentMode = ChooseSwapPresentMode(swapChainSupport.presentModes);
+    PresentMode presentMode = ChooseSwapPresentMode(swapChainSupport.presentModes, data.settings.swapchain.presentMode);
     VkExtent2D extent = ChooseSwapExtent(data, swapChainSupport.capabilities);
 
     // Determine the number of images in the swap chain
-    uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-    if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount)
-    {
-        imageCount = swapChainSupport.capabilities.maxImageCount;
-    }
+    uint32_t imageCount = ChooseSwapImageCount(swapChainSupport.capabilities, data.settings.swapchain.imageCount);
 
     // Configure swap chain creation parameters
     VkSwapchainCreateInfoKHR createInfo{};
@@ -608,10 +879,11 @@ void CreateSwapChain(RenderData& data)
 
     createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    createInfo.presentMode = presentMode;
+    createInfo.presentMode = ToVkPresentMode(presentMode);
     createInfo.clipped = VK_TRUE;
 
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    // The old swap chain, if any, hands its resources over and can still present what it has acquired
+    createInfo.oldSwapchain = data.swapChain;
 
     // Create the swap chain
     if (vkCreateSwapchainKHR(data.device, &createInfo, nullptr, &data.swapChain) != VK_SUCCESS)
@@ -619,7 +891,8 @@ void CreateSwapChain(RenderData& data)
         throw std::runtime_error("Failed to create swap chain!");
     }
 
-    // Retrieve swap chain images
+    // Retrieve swap chain images, the driver may create more than asked for
+    const size_t previousImageCount = data.swapChainImages.size();
     vkGetSwapchainImagesKHR(data.device, data.swapChain, &imageCount, nullptr);
     data.swapChainImages.resize(imageCount);
     vkGetSwapchainImagesKHR(data.device, data.swapChain, &imageCount, data.swapChainImages.data());
@@ -627,6 +900,18 @@ void CreateSwapChain(RenderData& data)
     // Store swap chain properties in RenderData struct
     data.swapChainImageFormat = surfaceFormat.format;
     data.swapChainExtent = extent;
+    // Resizes keep the mode and image count, so only policy changes are reported
+    if (presentMode != data.presentMode || imageCount != previousImageCount)
+    {
+        std::cout << "Presenting with " << GetPresentModeName(presentMode) << ", " << imageCount << " images";
+        if (presentMode != data.settings.swapchain.presentMode)
+        {
+            std::cout << " (" << GetPresentModeName(data.settings.swapchain.presentMode) << " unsupported)";
+        }
+        std::cout << std::endl;
+    }
+    data.presentMode = presentMode;
+    data.presentTimer.SetMode(presentMode);
 }
 
 /**
@@ -635,7 +920,7 @@ void CreateSwapChain(RenderData& data)
  * @param availableFormats The available surface formats.
  * @return VkSurfaceFormatKHR The chosen surface format.
  */
-VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats)
+VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::pmr::vector<VkSurfaceFormatKHR>& availableFormats)
 {
     for (const auto& availableFormat : availableFormats)
     {
@@ -655,22 +940,41 @@ VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>
  * @brief Chooses the swap chain presentation mode.
  *
  * @param availablePresentModes The available presentation modes.
- * @return VkPresentModeKHR The chosen presentation mode.
+ * @param requested The policy's present mode.
+ * @return PresentMode The chosen presentation mode.
  */
-VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
+PresentMode ChooseSwapPresentMode(const std::pmr::vector<VkPresentModeKHR>& availablePresentModes, PresentMode requested)
 {
     for (const auto& availablePresentMode : availablePresentModes)
     {
-        // Check if the present mode matches the preferred one
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+        // Check if the present mode matches the requested one
+        if (availablePresentMode == ToVkPresentMode(requested))
         {
-            // Return the preferred present mode
-            return availablePresentMode;
+            // Return the requested present mode
+            return requested;
         }
     }
 
-    // If the preferred present mode is not found, return FIFO as fallback
-    return VK_PRESENT_MODE_FIFO_KHR;
+    // If the requested present mode is not found, return FIFO as fallback, every surface has it
+    return PresentMode::Vsync;
+}
+
+/**
+ * @brief Chooses how many images the swap chain asks for.
+ *
+ * @param capabilities The surface capabilities.
+ * @param requested The policy's image count, 0 for the surface minimum plus one.
+ * @return uint32_t Image count within the surface's limits.
+ */
+uint32_t ChooseSwapImageCount(const VkSurfaceCapabilitiesKHR& capabilities, uint32_t requested)
+{
+    uint32_t imageCount = requested > 0 ? std::max(requested, capabilities.minImageCount) : capabilities.minImageCount + 1;
+    // A maximum of 0 means no limit
+    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+    {
+        imageCount = capabilities.maxImageCount;
+    }
+    return imageCount;
 }
 
 /**
@@ -689,15 +993,11 @@ VkExtent2D ChooseSwapExtent(RenderData& data, const VkSurfaceCapabilitiesKHR& ca
     }
     else
     {
-        // Retrieve window framebuffer size
-        int width, height;
-        glfwGetFramebufferSize(data.window, &width, &height);
-
-        // Clamp the framebuffer size within the supported range
+        // Use the framebuffer size sampled on the main thread
         VkExtent2D actualExtent =
         {
-            static_cast<uint32_t>(width),
-            static_cast<uint32_t>(height)
+            static_cast<uint32_t>(data.framebufferWidth),
+            static_cast<uint32_t>(data.framebufferHeight)
         };
 
         actualExtent.width = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
@@ -713,11 +1013,12 @@ VkExtent2D ChooseSwapExtent(RenderData& data, const VkSurfaceCapabilitiesKHR& ca
  *
  * @param data The RenderData struct containing rendering data.
  * @param device The physical device to query.
+ * @param memory Where the format and present mode lists allocate.
  * @return SwapChainSupportDetails Swap chain support details.
  */
-SwapChainSupportDetails QuerySwapChainSupport(RenderData& data, VkPhysicalDevice& device)
+SwapChainSupportDetails QuerySwapChainSupport(RenderData& data, VkPhysicalDevice& device, std::pmr::memory_resource* memory)
 {
-    SwapChainSupportDetails details;
+    SwapChainSupportDetails details(memory);
 
     // Query surface capabilities
     vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, data.surface, &details.capabilities);
@@ -780,109 +1081,26 @@ void CreateImageViews(RenderData& data)
 }
 
 /**
- * @brief Creates a graphics pipeline.
+ * @brief Creates the graphics pipeline of the CPU draw path.
  *
  * @param data The RenderData struct containing rendering data.
  */
 void CreateGraphicsPipeline(RenderData& data)
 {
-    // Load vertex and fragment shader code
-    auto vertShaderCode = readFile("shaders/vert.spv");
-    auto fragShaderCode = readFile("shaders/frag.spv");
-
-    // Create shader modules
-    VkShaderModule vertShaderModule = CreateShaderModule(data, vertShaderCode);
-    VkShaderModule fragShaderModule = CreateShaderModule(data, fragShaderCode);
-
-    // Configure shader stages
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
-
-    // Combine shader stages
-    VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
-
-    // Configure pipeline vertex input state
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-
-    // Configure pipeline input assembly state
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    // Configure pipeline viewport state
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.scissorCount = 1;
-
-    // Configure pipeline rasterization state
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-
-    // Configure pipeline multisample state
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-
-    // Configure pipeline color blend attachment state
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-
-    // Configure pipeline color blend state
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.logicOp = VK_LOGIC_OP_COPY;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f;
-    colorBlending.blendConstants[1] = 0.0f;
-    colorBlending.blendConstants[2] = 0.0f;
-    colorBlending.blendConstants[3] = 0.0f;
-
-    // Configure pipeline dynamic state
-    std::vector<VkDynamicState> dynamicStates = {
-        VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR
-    };
-    VkPipelineDynamicStateCreateInfo dynamicState{};
-    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
-    dynamicState.pDynamicStates = dynamicStates.data();
+    // Resources are indexed through the bindless set, the push constants say where the materials are
+    VkDescriptorSetLayout setLayout = data.bindless.GetSetLayout();
+    VkPushConstantRange materialConstants{};
+    materialConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    materialConstants.offset = 0;
+    materialConstants.size = sizeof(MaterialConstants);
 
     // Configure pipeline layout
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &materialConstants;
 
     // Create pipeline layout
     if (vkCreatePipelineLayout(data.device, &pipelineLayoutInfo, nullptr, &data.pipelineLayout) != VK_SUCCESS)
@@ -890,34 +1108,156 @@ void CreateGraphicsPipeline(RenderData& data)
         throw std::runtime_error("failed to create pipeline layout!");
     }
 
-    // Configure graphics pipeline
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = nullptr; // Optional
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = &dynamicState;
-    pipelineInfo.layout = data.pipelineLayout;
-    pipelineInfo.renderPass = data.renderPass;
-    pipelineInfo.subpass = 0;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
-    pipelineInfo.basePipelineIndex = -1; // Optional
-
-    // Create graphics pipeline
-    if (vkCreateGraphicsPipelines(data.device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &data.graphicsPipeline) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to create graphics pipeline!");
-    }
-
-    // Destroy shader modules
-    vkDestroyShaderModule(data.device, fragShaderModule, nullptr);
-    vkDestroyShaderModule(data.device, vertShaderModule, nullptr);
+    // Needed by the first frame, so compiled right away. Permutations compile in the background
+    data.graphicsPipeline = data.pipelines.Request(DescribeDrawPipeline(data, "shaders/vert.spv", data.pipelineLayout, true));
+    data.drawPipeline = data.graphicsPipeline;
+}
+
+/**
+ * @brief Describes a pipeline drawing Vertex geometry into the main pass.
+ *
+ * @param vertexShaderPath SPIR-V vertex shader, used with shaders/frag.spv.
+ * @param layout Layout matching the shaders' resources.
+ * @param instanceBinding Add InstanceData as binding 1, stepped per instance.
+ * @return GraphicsPipelineDesc Key for data.pipelines.
+ */
+GraphicsPipelineDesc DescribeDrawPipeline(RenderData& data, const char* vertexShaderPath, VkPipelineLayout layout, bool instanceBinding)
+{
+    GraphicsPipelineDesc desc;
+    desc.vertexShader = vertexShaderPath;
+    desc.fragmentShader = "shaders/frag.spv";
+
+    // Per-vertex geometry at binding 0, per-instance transform and material at binding 1
+    auto vertexAttributes = Vertex::getAttributeDescriptions();
+    desc.vertexBindings.push_back(Vertex::getBindingDescription());
+    desc.vertexAttributes.assign(vertexAttributes.begin(), vertexAttributes.end());
+    if (instanceBinding)
+    {
+        auto instanceAttributes = InstanceData::getAttributeDescriptions();
+        desc.vertexBindings.push_back(InstanceData::getBindingDescription());
+        desc.vertexAttributes.insert(desc.vertexAttributes.end(), instanceAttributes.begin(), instanceAttributes.end());
+    }
+
+    desc.layout = layout;
+    desc.renderPass = data.mainPass->GetRenderPass();
+    return desc;
+}
+
+/**
+ * @brief Creates the culling compute pipeline and the indirect draw pipeline.
+ *
+ * Both use the scene's descriptor set layout. Culling gets the frustum through
+ * CullConstants, drawing gets the view projection matrix.
+ *
+ * @param data The RenderData struct, after CreateScene.
+ */
+void CreateGpuDrivenPipelines(RenderData& data)
+{
+    VkDescriptorSetLayout setLayout = data.scene.GetDescriptorSetLayout();
+
+    VkPushConstantRange cullConstants{};
+    cullConstants.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    cullConstants.offset = 0;
+    cullConstants.size = sizeof(CullConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &setLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &cullConstants;
+    if (vkCreatePipelineLayout(data.device, &pipelineLayoutInfo, nullptr, &data.cullPipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    VkPushConstantRange drawConstants{};
+    drawConstants.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    drawConstants.offset = 0;
+    drawConstants.size = sizeof(glm::mat4);
+    pipelineLayoutInfo.pPushConstantRanges = &drawConstants;
+    if (vkCreatePipelineLayout(data.device, &pipelineLayoutInfo, nullptr, &data.indirectPipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    data.cullPipeline = CreateCullPipeline(data);
+
+    data.indirectPipeline = data.pipelines.Request(DescribeDrawPipeline(data, "shaders/indirect.spv", data.indirectPipelineLayout, false));
+}
+
+/**
+ * @brief Creates the culling compute pipeline from shaders/cull.spv, on the calling thread.
+ *
+ * @param data The RenderData struct, with data.cullPipelineLayout created.
+ * @return VkPipeline The pipeline.
+ */
+VkPipeline CreateCullPipeline(RenderData& data)
+{
+    ScratchScope scratch;
+    auto cullShaderCode = readFile("shaders/cull.spv", scratch.GetResource());
+    VkShaderModule cullShaderModule = CreateShaderModule(data, cullShaderCode);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = cullShaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = data.cullPipelineLayout;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    auto createBegin = std::chrono::steady_clock::now();
+    VkResult result = vkCreateComputePipelines(data.device, data.pipelineCache.Get(), 1, &pipelineInfo, nullptr, &pipeline);
+    data.pipelineCache.RecordCreation(std::chrono::steady_clock::now() - createBegin, 1);
+    vkDestroyShaderModule(data.device, cullShaderModule, nullptr);
+    if (result != VK_SUCCESS)
+    {
+        throw std::runtime_error("failed to create compute pipeline!");
+    }
+    return pipeline;
+}
+
+/**
+ * @brief Picks up shaders the shader compiler rewrote since the last frame.
+ *
+ * Graphics pipelines recompile in the background and are swapped in over the
+ * next frames, the culling pipeline is quick to create and is replaced right
+ * away. Replaced pipelines go to the deletion queue, frames in flight keep
+ * drawing with them. A pipeline that fails to build leaves the old one in place.
+ *
+ * @param data The RenderData struct, after the frame's slot is free.
+ */
+void ReloadShaders(RenderData& data)
+{
+    PROFILE_FUNCTION();
+    uint64_t retireValue = data.pacer.GetSignalValue();
+    data.shaderCompiler.TakeChanged(data.changedShaders);
+    for (const std::string& path : data.changedShaders)
+    {
+        if (path == "shaders/cull.spv")
+        {
+            if (data.settings.gpuDriven)
+            {
+                // A shader that compiles can still fail to link against the layout, keep the old pipeline then
+                VkPipeline cullPipeline = VK_NULL_HANDLE;
+                try
+                {
+                    cullPipeline = CreateCullPipeline(data);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "Keeping the previous culling pipeline: " << e.what() << std::endl;
+                    continue;
+                }
+                data.deletions.Destroy(data.cullPipeline, retireValue);
+                data.cullPipeline = cullPipeline;
+            }
+            continue;
+        }
+        data.pipelines.ReloadShader(path);
+    }
+    data.pipelines.SwapReloaded(data.deletions, retireValue);
 }
 
 /**
@@ -927,7 +1267,7 @@ void CreateGraphicsPipeline(RenderData& data)
  * @param code The SPIR-V shader code.
  * @return VkShaderModule The created shader module.
  */
-VkShaderModule CreateShaderModule(RenderData& data, const std::vector<char>& code)
+VkShaderModule CreateShaderModule(RenderData& data, const std::pmr::vector<char>& code)
 {
     // Configure shader module creation
     VkShaderModuleCreateInfo createInfo{};
@@ -946,134 +1286,181 @@ VkShaderModule CreateShaderModule(RenderData& data, const std::vector<char>& cod
     return shaderModule;
 }
 /**
- * @brief Creates a render pass.
- *
- * This function creates a render pass object with a single color attachment.
+ * @brief Creates the query pools that time every render graph pass.
  *
- * @param data The rendering data containing the Vulkan device and swap chain image format.
- * @throws std::runtime_error if the creation of the render pass fails.
+ * @param data The RenderData struct, after the logical device is created.
  */
-void CreateRenderPass(RenderData& data)
+void CreateGpuProfiler(RenderData& data)
 {
-    // Define color attachment
-    VkAttachmentDescription colorAttachment{};
-    colorAttachment.format = data.swapChainImageFormat;
-    colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-    // Define color attachment reference for subpass
-    VkAttachmentReference colorAttachmentRef{};
-    colorAttachmentRef.attachment = 0;
-    colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-    // Define subpass
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
-
-    // Create render pass
-    VkRenderPassCreateInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = 1;
-    renderPassInfo.pAttachments = &colorAttachment;
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
-
-    // Create render pass
-    if (vkCreateRenderPass(data.device, &renderPassInfo, nullptr, &data.renderPass) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to create render pass!");
-    }
+    QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(data, data.physicalDevice);
+    data.profiler.Init(data.physicalDevice, data.device, queueFamilyIndices.graphicsFamily.value(), data.settings.framesInFlight, data.settings.pipelineStatistics);
 }
 /**
- * @brief Creates frame buffers for rendering.
+ * @brief Declares the frame's passes and compiles the render graph.
  *
- * This function creates frame buffers for rendering using the provided render data.
- * Each frame buffer corresponds to an image view in the swap chain.
+ * The GPU-driven path culls into the draw buffers in a compute pass first, the
+ * graph orders the main pass's indirect reads after its writes. The main pass
+ * clears the backbuffer and draws every object into it, and the optional overlay
+ * pass draws the performance overlay over that.
  *
- * @param data The render data containing necessary information for creating frame buffers.
+ * @param data The rendering data containing the Vulkan device and swap chain image format.
+ * @throws std::runtime_error if the creation of a render pass fails.
  */
-void CreateFrameBuffers(RenderData& data)
+void CreateRenderGraph(RenderData& data)
 {
-    // Resize vector to hold framebuffers for each swap chain image view
-    data.swapChainFramebuffers.resize(data.swapChainImageViews.size());
+    // Every pass is timed, the graph opens a profiler scope around each
+    data.graph.SetProfiler(&data.profiler);
+
+    // Headless frames are copied out for readback instead of presented
+    VkImageLayout finalLayout = data.settings.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    RenderGraphResource backbuffer = data.graph.ImportBackbuffer("Backbuffer", data.swapChainImageFormat, finalLayout);
 
-    // Create framebuffers for each swap chain image view
-    for (size_t i = 0; i < data.swapChainImageViews.size(); i++)
+    // Draw commands and count, written by cull.comp and read by the indirect draw
+    RenderGraphResource culledDraws = data.graph.ImportBuffer("Culled draws");
+    if (data.settings.gpuDriven)
     {
-        VkImageView attachments[] =
+        RenderGraphPass& cullPass = data.graph.AddPass("Cull", RenderGraphPassKind::Compute);
+        cullPass.Write(culledDraws, RenderGraphAccess::StorageWrite);
+        cullPass.SetExecute([&data](RenderGraphContext& context)
         {
-            data.swapChainImageViews[i]
-        };
+            data.scene.RecordCull(context.GetCommandBuffer(), data.currentFrame, data.cullPipeline, data.cullPipelineLayout, data.viewProjection);
+        });
+    }
 
-        VkFramebufferCreateInfo framebufferInfo{};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = data.renderPass;
-        framebufferInfo.attachmentCount = 1;
-        framebufferInfo.pAttachments = attachments;
-        framebufferInfo.width = data.swapChainExtent.width;
-        framebufferInfo.height = data.swapChainExtent.height;
-        framebufferInfo.layers = 1;
-
-        // Create framebuffer
-        if (vkCreateFramebuffer(data.device, &framebufferInfo, nullptr, &data.swapChainFramebuffers[i]) != VK_SUCCESS)
+    RenderGraphPass& mainPass = data.graph.AddPass("Main", RenderGraphPassKind::Raster);
+    VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
+    mainPass.Clear(backbuffer, clearColor);
+    if (data.settings.gpuDriven)
+    {
+        mainPass.Read(culledDraws, RenderGraphAccess::IndirectRead);
+    }
+    mainPass.SetExecute([&data](RenderGraphContext& context)
+    {
+        RecordMainPass(data, data.recorder, *data.jobSystem, context);
+    });
+    data.mainPass = &mainPass;
+
+    // Drawn over the finished frame, skipped by the graph while hidden
+    if (data.settings.overlay)
+    {
+        RenderGraphPass& overlayPass = data.graph.AddPass("Overlay", RenderGraphPassKind::Raster);
+        overlayPass.Write(backbuffer, RenderGraphAccess::ColorAttachment);
+        overlayPass.SetOptional(true);
+        overlayPass.SetExecute([&data](RenderGraphContext& context)
         {
-            throw std::runtime_error("failed to create framebuffer!");
-        }
+            context.BeginRenderPass();
+            data.overlay.Record(context.GetCommandBuffer());
+            context.EndRenderPass();
+        });
+        data.overlayPass = &overlayPass;
     }
+
+    data.graph.Compile(data.device);
 }
 /**
- * @brief Creates a command pool for managing command buffers.
+ * @brief Creates the performance overlay against the overlay pass's render pass.
  *
- * This function creates a command pool associated with a specific queue family.
- *
- * @param data The RenderData struct containing Vulkan device and physical device info.
+ * @param data The RenderData struct, after the render graph is compiled.
  */
-void CreateCommandPool(RenderData& data)
+void CreateDebugOverlay(RenderData& data)
 {
-    // Find queue families supported by the physical device
     QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(data, data.physicalDevice);
+    data.overlay.Init(data.instance, data.physicalDevice, data.device, queueFamilyIndices.graphicsFamily.value(), data.graphicsQueue,
+        data.overlayPass->GetRenderPass(), data.settings.framesInFlight, data.pipelineCache.Get());
+}
+/**
+ * @brief Switches the overlay pass on or off to match the frame packet and, if
+ * shown, lays out the overlay with this frame's counts. Call once the frame's
+ * draws are built.
+ *
+ * @param data The RenderData struct.
+ */
+void BuildDebugOverlay(RenderData& data)
+{
+    bool visible = data.framePacket && data.framePacket->showOverlay;
+    data.overlayPass->SetEnabled(visible);
+    if (!visible)
+    {
+        data.overlayWasVisible = false;
+        return;
+    }
 
-    // Configure command pool creation
-    VkCommandPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+    DebugOverlayFrame frame;
+    auto now = std::chrono::steady_clock::now();
+    if (data.overlayWasVisible)
+    {
+        frame.frameMilliseconds = std::chrono::duration<double, std::milli>(now - data.overlayFrameBegin).count();
+    }
+    data.overlayFrameBegin = now;
+    data.overlayWasVisible = true;
 
-    // Create command pool
-    if (vkCreateCommandPool(data.device, &poolInfo, nullptr, &data.commandPool) != VK_SUCCESS)
+    frame.objects = static_cast<uint32_t>(data.objectTransforms.size());
+    if (data.settings.gpuDriven)
     {
-        throw std::runtime_error("failed to create command pool!");
+        frame.draws = 1;
+        frame.triangles = static_cast<uint64_t>(data.scene.GetStats().instances) * (data.scene.GetMesh(data.quadMesh).indexCount / 3);
     }
+    else
+    {
+        const std::vector<InstanceBatch>& batches = data.batcher.GetBatches();
+        frame.draws = static_cast<uint32_t>(batches.size());
+        for (const InstanceBatch& batch : batches)
+        {
+            frame.triangles += static_cast<uint64_t>(batch.instanceCount) * (data.scene.GetMesh(batch.mesh).indexCount / 3);
+        }
+    }
+    data.overlay.Build(frame, data.swapChainExtent, data.graph, data.profiler, *data.jobSystem, data.allocator);
 }
 /**
- * @brief Allocates a command buffer from the command pool.
+ * @brief Creates the render graph's framebuffers and transient attachments.
+ *
+ * Passes drawing into the swap chain get a framebuffer per swap chain image view.
  *
- * This function allocates a command buffer from the command pool.
+ * @param data The render data containing necessary information for creating frame buffers.
+ */
+void CreateFrameBuffers(RenderData& data)
+{
+    if (data.settings.headless)
+    {
+        data.graph.CreateResources(data.allocator, data.swapChainExtent, data.headless.GetImages(), data.headless.GetImageViews());
+        return;
+    }
+    data.graph.CreateResources(data.allocator, data.swapChainExtent, data.swapChainImages, data.swapChainImageViews);
+}
+/**
+ * @brief Creates the offscreen images headless frames render into, one per frame
+ * in flight, in place of the swap chain.
  *
- * @param data The RenderData struct containing Vulkan device and command pool info.
+ * @param data The RenderData struct, after the allocator is initialized.
  */
-void CreateCommandBuffers(RenderData& data)
+void CreateHeadlessTarget(RenderData& data)
 {
-    data.commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    // Configure command buffer allocation
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = data.commandPool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = (uint32_t)data.commandBuffers.size();
+    QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(data, data.physicalDevice);
+    VkExtent2D extent = { data.settings.headlessWidth, data.settings.headlessHeight };
+    data.headless.Init(data.physicalDevice, data.device, data.allocator, extent, queueFamilyIndices.graphicsFamily.value(), data.settings.framesInFlight);
 
-    // Allocate command buffer
-    if (vkAllocateCommandBuffers(data.device, &allocInfo, data.commandBuffers.data()) != VK_SUCCESS)
+    data.swapChainImageFormat = HeadlessTarget::FORMAT;
+    data.swapChainExtent = extent;
+}
+/**
+ * @brief Creates the command pools every recording thread uses.
+ *
+ * One pool per job system thread per frame in flight, reset wholesale once the
+ * frame's fence has signalled.
+ *
+ * @param data The RenderData struct containing Vulkan device and job system.
+ */
+void CreateCommandRecorder(RenderData& data)
+{
+    if (data.jobSystem == nullptr)
     {
-        throw std::runtime_error("failed to allocate command buffers!");
+        throw std::runtime_error("RenderData has no job system to record commands on!");
     }
+
+    // Find queue families supported by the physical device
+    QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(data, data.physicalDevice);
+
+    data.recorder.Init(data.device, queueFamilyIndices.graphicsFamily.value(), data.jobSystem->GetMaxThreads(), data.settings.framesInFlight);
 }
 /**
  * @brief Records commands into a command buffer for rendering.
@@ -1081,15 +1468,17 @@ void CreateCommandBuffers(RenderData& data)
  * This function records commands into a command buffer for rendering a frame.
  *
  * @param data The RenderData struct containing Vulkan device and rendering info.
- * @param commandBugger The command buffer to record commands into.
+ * @param commandBuffer The command buffer to record commands into.
  * @param imageIndex The index of the swap chain image.
  */
 void RecordCommandBuffer(RenderData& data, VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
-    // Begin recording command buffer
+    PROFILE_FUNCTION();
+
+    // Begin recording command buffer, it is recorded fresh every frame
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = 0; // Optional
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     beginInfo.pInheritanceInfo = nullptr; // Optional
 
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
@@ -1097,49 +1486,27 @@ void RecordCommandBuffer(RenderData& data, VkCommandBuffer commandBuffer, uint32
         throw std::runtime_error("failed to begin recording command buffer!");
     }
 
-    // Begin render pass
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = data.renderPass;
-    renderPassInfo.framebuffer = data.swapChainFramebuffers[imageIndex];
-    renderPassInfo.renderArea.offset = { 0, 0 };
-    renderPassInfo.renderArea.extent = data.swapChainExtent;
+    // Take ownership of buffers the transfer queue uploaded since the last frame
+    data.uploads.RecordAcquireBarriers(commandBuffer);
 
-    VkClearValue clearColor = { {{0.0f, 0.0f, 0.0f, 1.0f}} };
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
-
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-        // Bind graphics pipeline
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, data.graphicsPipeline);
-
-        // Set viewport
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = (float)data.swapChainExtent.width;
-        viewport.height = (float)data.swapChainExtent.height;
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-
-        // Set scissor
-        VkRect2D scissor{};
-        scissor.offset = { 0, 0 };
-        scissor.extent = data.swapChainExtent;
-        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
-
-        VkBuffer vertexBuffers[] = { data.vertexBuffer };
-        VkDeviceSize offsets[] = { 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-  
-        vkCmdBindIndexBuffer(commandBuffer, data.indexBuffer, 0, VK_INDEX_TYPE_UINT16);
-        vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-
-   
-    // End render pass
-    vkCmdEndRenderPass(commandBuffer);
+    if (data.settings.headless)
+    {
+        data.headless.BeginFrame(commandBuffer, imageIndex);
+    }
+
+    // Reads this frame in flight's previous queries, its fence has signalled
+    data.profiler.BeginFrame(commandBuffer, data.currentFrame);
+
+    // Every pass with the barriers between them, ending with the image ready to present
+    data.graph.Execute(commandBuffer, imageIndex);
+
+    data.profiler.EndFrame();
+
+    // Headless images end ready to copy from instead
+    if (data.settings.headless)
+    {
+        data.headless.EndFrame(commandBuffer, imageIndex);
+    }
 
     // End recording command buffer
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
@@ -1147,13 +1514,117 @@ void RecordCommandBuffer(RenderData& data, VkCommandBuffer commandBuffer, uint32
         throw std::runtime_error("failed to record command buffer!");
     }
 }
+/**
+ * @brief Records the main pass into a primary buffer.
+ *
+ * The GPU-driven path records one indirect draw for every object. Otherwise one
+ * instanced draw per batch built by data.batcher is recorded: small counts inline,
+ * larger ones split across the job system into secondary buffers, executed in order.
+ *
+ * @param data The RenderData struct containing Vulkan device and rendering info.
+ * @param recorder Pools the secondary buffers come from, BeginFrame already called.
+ * @param jobs Job system the batches run on.
+ * @param context The main pass's context, its barriers already recorded.
+ */
+void RecordMainPass(RenderData& data, CommandRecorder& recorder, JobSystem& jobs, RenderGraphContext& context)
+{
+    uint32_t drawCount = static_cast<uint32_t>(data.batcher.GetBatches().size());
+    bool split = !data.settings.gpuDriven && CommandRecorder::ShouldSplit(drawCount);
+    VkCommandBuffer commandBuffer = context.GetCommandBuffer();
+
+    context.BeginRenderPass(split ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+
+    if (split)
+    {
+        auto recordDraws = [&data](VkCommandBuffer secondary, uint32_t begin, uint32_t end)
+        {
+            RecordDraws(data, secondary, begin, end);
+        };
+        const std::vector<VkCommandBuffer>& secondaries = recorder.RecordSecondary(jobs, context.GetInheritanceInfo(), drawCount, recordDraws);
+        vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+    }
+    else if (data.settings.gpuDriven)
+    {
+        SetViewportAndScissor(data, commandBuffer);
+        data.scene.RecordDraw(commandBuffer, data.currentFrame, data.pipelines.Get(data.indirectPipeline), data.indirectPipelineLayout, data.viewProjection);
+    }
+    else
+    {
+        RecordDraws(data, commandBuffer, 0, drawCount);
+    }
+
+    context.EndRenderPass();
+}
+/**
+ * @brief Binds the pipeline, geometry and instances and records the batcher's
+ * draws [begin, end), one instanced draw each.
+ *
+ * Sets everything itself, so it works the same in a primary and in a secondary
+ * buffer that inherits no state.
+ *
+ * @param data The RenderData struct containing Vulkan device and rendering info.
+ * @param commandBuffer Buffer inside the render pass.
+ * @param begin First draw.
+ * @param end One past the last draw.
+ */
+void RecordDraws(RenderData& data, VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end)
+{
+    PROFILE_FUNCTION();
+
+    // Bind graphics pipeline
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, data.pipelines.Get(data.drawPipeline));
+    SetViewportAndScissor(data, commandBuffer);
+
+    // One set for every draw, each instance finds its material through the table
+    data.bindless.Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, data.pipelineLayout);
+    MaterialConstants constants{ data.materialTable, data.materialCount };
+    vkCmdPushConstants(commandBuffer, data.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(constants), &constants);
+
+    VkBuffer vertexBuffers[] = { data.scene.GetVertexBuffer(), data.batcher.GetInstanceBuffer(data.currentFrame) };
+    VkDeviceSize offsets[] = { 0, 0 };
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, vertexBuffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, data.scene.GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+
+    const std::vector<InstanceBatch>& batches = data.batcher.GetBatches();
+    for (uint32_t draw = begin; draw < end; draw++)
+    {
+        const InstanceBatch& batch = batches[draw];
+        const MeshInfo& mesh = data.scene.GetMesh(batch.mesh);
+        vkCmdDrawIndexed(commandBuffer, mesh.indexCount, batch.instanceCount, mesh.firstIndex, mesh.vertexOffset, batch.firstInstance);
+    }
+}
+/**
+ * @brief Sets the dynamic viewport and scissor to the whole swap chain image.
+ *
+ * @param data The RenderData struct containing the swap chain extent.
+ * @param commandBuffer Buffer to record into.
+ */
+void SetViewportAndScissor(RenderData& data, VkCommandBuffer commandBuffer)
+{
+    // Set viewport
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)data.swapChainExtent.width;
+    viewport.height = (float)data.swapChainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+    // Set scissor
+    VkRect2D scissor{};
+    scissor.offset = { 0, 0 };
+    scissor.extent = data.swapChainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
 /**
  * @brief Reads binary data from a file.
  *
  * @param filename The path to the file.
- * @return std::vector<char> The binary data read from the file.
+ * @param memory Where the returned buffer allocates.
+ * @return std::pmr::vector<char> The binary data read from the file.
  */
-static std::vector<char> readFile(const std::string& filename)
+static std::pmr::vector<char> readFile(const std::string& filename, std::pmr::memory_resource* memory)
 {
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
@@ -1162,7 +1633,7 @@ static std::vector<char> readFile(const std::string& filename)
     }
 
     size_t fileSize = (size_t)file.tellg();
-    std::vector<char> buffer(fileSize);
+    std::pmr::vector<char> buffer(fileSize, memory);
 
     file.seekg(0);
     file.read(buffer.data(), fileSize);
@@ -1174,29 +1645,26 @@ static std::vector<char> readFile(const std::string& filename)
 /**
  * @brief Creates synchronization objects for coordinating rendering operations.
  *
- * This function creates semaphores and fences used for synchronizing rendering operations.
- * Semaphores are used to synchronize operations between command queues, while fences are used
- * to synchronize the CPU with rendering operations on the GPU.
+ * This function creates the binary semaphores that order acquire, rendering and present
+ * on the GPU, which the swap chain can't do with a timeline, and the frame pacer whose
+ * timeline semaphore synchronizes the CPU with rendering operations on the GPU.
  *
  * @param data The RenderData struct containing Vulkan device and synchronization object info.
  */
 void CreateSyncObjects(RenderData& data)
 {
-    data.imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    data.renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    data.inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+    const uint32_t framesInFlight = data.settings.framesInFlight;
+    data.pacer.Init(data.device, framesInFlight);
+
+    data.imageAvailableSemaphores.resize(framesInFlight);
+    data.renderFinishedSemaphores.resize(framesInFlight);
 
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo{};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    for (size_t i = 0; i < framesInFlight; i++) {
         if (vkCreateSemaphore(data.device, &semaphoreInfo, nullptr, &data.imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(data.device, &semaphoreInfo, nullptr, &data.renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(data.device, &fenceInfo, nullptr, &data.inFlightFences[i]) != VK_SUCCESS) {
+            vkCreateSemaphore(data.device, &semaphoreInfo, nullptr, &data.renderFinishedSemaphores[i]) != VK_SUCCESS) {
 
             throw std::runtime_error("failed to create synchronization objects for a frame!");
         }
@@ -1206,42 +1674,57 @@ void CreateSyncObjects(RenderData& data)
  * @brief Recreates the swap chain to adapt to changes in window dimensions or configuration.
  *
  * This function is called when the current swap chain is no longer compatible with the window's dimensions
- * or configuration, typically due to a window resize event. It waits for the device to finish any pending
- * operations, recreates the swap chain with updated dimensions and configuration, creates image views for
- * the new swap chain images, and creates framebuffers for rendering using the new swap chain images.
+ * or configuration, typically due to a window resize event or a new swap chain policy. The new swap chain
+ * is created from the old one, and gets its own image views and framebuffers. Frames in flight may still
+ * use the old ones, so instead of draining the device they go to the deletion queue,
+ * destroyed once the first frame into the new swap chain has finished on the GPU.
+ * Runs on the render thread, so the window size comes from the frame packet rather than GLFW.
  *
  * @param data The render data structure containing Vulkan objects and settings.
  */
 void RecreateSwapChain(RenderData& data) 
 {
-    int width = 0, height = 0;
-    glfwGetFramebufferSize(data.window, &width, &height);
-    while (width == 0 || height == 0) 
+    // Minimized, try again once a packet reports a real size
+    if (data.framebufferWidth == 0 || data.framebufferHeight == 0)
     {
-        glfwGetFramebufferSize(data.window, &width, &height);
-        glfwWaitEvents();
+        data.frameBufferResized = true;
+        return;
     }
+    PROFILE_FUNCTION();
 
-    vkDeviceWaitIdle(data.device);
-
-    CleanupSwapChain(data);
+    // Queue order means every frame into the old swap chain is done once the next frame is
+    uint64_t value = data.pacer.GetSignalValue();
+    VkSwapchainKHR oldSwapChain = data.swapChain;
+    for (VkImageView imageView : data.swapChainImageViews)
+    {
+        data.deletions.Destroy(imageView, value);
+    }
+    data.swapChainImageViews.clear();
+    data.graph.RetireResources(data.deletions, value);
 
     CreateSwapChain(data);
+    data.deletions.Destroy(oldSwapChain, value);
     CreateImageViews(data);
     CreateFrameBuffers(data);
 }
+
 /**
  * @brief Cleans up resources associated with the swap chain.
  *
- * This function destroys framebuffers and image views associated with the swap chain,
- * as well as the swap chain itself.
+ * This function destroys the render graph's framebuffers and transient attachments,
+ * the image views associated with the swap chain, as well as the swap chain itself.
+ * The device must be idle.
  *
  * @param data The RenderData structure containing the Vulkan device and swap chain resources.
  */
 void CleanupSwapChain(RenderData& data)
 {
-    for ( auto framebuffer : data.swapChainFramebuffers) {
-        vkDestroyFramebuffer(data.device, framebuffer, nullptr);
+    data.graph.DestroyResources();
+
+    if (data.settings.headless)
+    {
+        data.headless.Shutdown();
+        return;
     }
 
     for (auto imageView : data.swapChainImageViews) {
@@ -1251,184 +1734,255 @@ void CleanupSwapChain(RenderData& data)
     vkDestroySwapchainKHR(data.device, data.swapChain, nullptr);
 }
 
-void CreateBuffer(RenderData& data, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
-{
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = size;
-    bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(data.device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to create buffer!");
-    }
-
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(data.device, buffer, &memRequirements);
-
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(data, memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(data.device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
-    {
-        throw std::runtime_error("failed to allocate buffer memory!");
-    }
-
-    vkBindBufferMemory(data.device, buffer, bufferMemory, 0);
-}
-void CreateVertexBuffer(RenderData& data)
+/**
+ * @brief Creates a buffer bound to memory from the render data's GPU allocator.
+ *
+ * @param data The RenderData struct containing the allocator.
+ * @param size Buffer size in bytes.
+ * @param usage How the buffer will be used.
+ * @param properties Flags the memory type must have.
+ * @param buffer Receives the buffer.
+ * @param allocation Receives the buffer's memory, release both with GpuAllocator::DestroyBuffer.
+ */
+void CreateBuffer(RenderData& data, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, GpuAllocation& allocation)
 {
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    CreateBuffer(data, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-    void* localdata;
-    vkMapMemory(data.device, stagingBufferMemory, 0, bufferSize, 0, &localdata);
-    memcpy(localdata, vertices.data(), (size_t)bufferSize);
-    vkUnmapMemory(data.device, stagingBufferMemory);
-
-    CreateBuffer(data, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, data.vertexBuffer, data.vertexBufferMemory);
-
-    CopyBuffer(data, stagingBuffer, data.vertexBuffer, bufferSize);
-
-    vkDestroyBuffer(data.device, stagingBuffer, nullptr);
-    vkFreeMemory(data.device, stagingBufferMemory, nullptr);
+    buffer = data.allocator.CreateBuffer(size, usage, properties, allocation);
 }
-void CreateIndexBuffer(RenderData& data)
+/**
+ * @brief Creates the scene's shared buffers and adds the quad mesh to them.
+ *
+ * @param data The RenderData struct, after CreateUploadQueue.
+ */
+void CreateScene(RenderData& data)
 {
-    VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    CreateBuffer(data, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-    void* localdata;
-    vkMapMemory(data.device, stagingBufferMemory, 0, bufferSize, 0, &localdata);
-    memcpy(localdata, indices.data(), (size_t)bufferSize);
-    vkUnmapMemory(data.device, stagingBufferMemory);
+    data.scene.Init(data.device, data.allocator, data.uploads, sizeof(Vertex), data.settings.framesInFlight);
 
-    CreateBuffer(data, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, data.indexBuffer, data.indexBufferMemory);
-
-    CopyBuffer(data, stagingBuffer, data.indexBuffer, bufferSize);
+    // Bounding sphere around the origin, vertices are in mesh space
+    float radius = 0.0f;
+    for (const Vertex& vertex : vertices)
+    {
+        radius = std::max(radius, glm::length(vertex.pos));
+    }
 
-    vkDestroyBuffer(data.device, stagingBuffer, nullptr);
-    vkFreeMemory(data.device, stagingBufferMemory, nullptr);
+    // Goes out with the first frame's upload batch
+    data.quadMesh = data.scene.AddMesh(vertices.data(), static_cast<uint32_t>(vertices.size()), indices.data(),
+        static_cast<uint32_t>(indices.size()), glm::vec4(0.0f, 0.0f, 0.0f, radius));
 }
 
-void CopyBuffer(RenderData& data, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+/**
+ * @brief Creates the material table and adds it to the bindless set.
+ *
+ * @param data The RenderData struct, after CreateUploadQueue.
+ */
+void CreateMaterials(RenderData& data)
 {
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = data.commandPool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(data.device, &allocInfo, &commandBuffer);
-
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-        VkBufferCopy copyRegion{};
-        copyRegion.srcOffset = 0; // Optional
-        copyRegion.dstOffset = 0; // Optional
-        copyRegion.size = size;
-        vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-    vkEndCommandBuffer(commandBuffer);
-
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
-
-    vkQueueSubmit(data.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(data.graphicsQueue);
-
-    vkFreeCommandBuffers(data.device, data.commandPool, 1, &commandBuffer);
+    VkDeviceSize size = materials.size() * sizeof(MaterialData);
+    data.materialBuffer = data.allocator.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, data.materialAllocation);
+    data.materialCount = static_cast<uint32_t>(materials.size());
+    data.materialTable = data.bindless.AddBuffer(data.materialBuffer, 0, size);
+
+    // Goes out with the first frame's upload batch
+    data.uploads.Upload(data.materialBuffer, 0, materials.data(), size);
 }
 
-uint32_t findMemoryType(RenderData& data, uint32_t typeFilter, VkMemoryPropertyFlags properties)
+/**
+ * @brief Sets up the upload queue, on the dedicated transfer family if there is one.
+ *
+ * @param data The RenderData struct containing the device and allocator.
+ */
+void CreateUploadQueue(RenderData& data)
 {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(data.physicalDevice, &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+    QueueFamilyIndices indices = FindQueueFamilies(data, data.physicalDevice);
+    uint32_t graphicsFamily = indices.graphicsFamily.value();
+    if (indices.transferFamily)
     {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) 
-        {
-            return i;
-        }
+        data.uploads.Init(data.device, data.allocator, data.transferQueue, indices.transferFamily.value(), graphicsFamily, UPLOAD_RING_SIZE);
+    }
+    else
+    {
+        data.uploads.Init(data.device, data.allocator, data.graphicsQueue, graphicsFamily, graphicsFamily, UPLOAD_RING_SIZE);
     }
-
-    throw std::runtime_error("failed to find suitable memory type!");
 }
+
 /**
  * @brief Performs the Vulkan rendering process for a single frame.
  *
  * This function executes the Vulkan rendering process for a single frame, including
  * acquiring swap chain images, recording command buffers, submitting command buffers
- * to the graphics queue, and presenting rendered images to the screen.
+ * to the graphics queue, and presenting rendered images to the screen. Headless
+ * frames skip acquire and present and record their CPU time instead.
  *
  * @param data The RenderData struct containing Vulkan device and rendering info.
  */
 void VulkanRender(RenderData& data)
 {
-    // Wait for the fence associated with the current frame to signal that it's safe to start rendering
-    vkWaitForFences(data.device, 1, &data.inFlightFences[data.currentFrame], VK_TRUE, UINT64_MAX);
+    PROFILE_FUNCTION();
+
+    // Pick up window size changes from the frame packet
+    if (data.framePacket &&
+        (data.framePacket->framebufferWidth != data.framebufferWidth || data.framePacket->framebufferHeight != data.framebufferHeight))
+    {
+        data.framebufferWidth = data.framePacket->framebufferWidth;
+        data.framebufferHeight = data.framePacket->framebufferHeight;
+        data.frameBufferResized = true;
+    }
 
-    // Acquire the index of the next available image from the swap chain
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(data.device, data.swapChain, UINT64_MAX, data.imageAvailableSemaphores[data.currentFrame], VK_NULL_HANDLE, &imageIndex);
+    // A new present mode or image count needs a new swap chain, the frame rate cap is the main thread's
+    if (data.framePacket && data.framePacket->swapchainPolicy != data.settings.swapchain)
+    {
+        const SwapchainPolicy& policy = data.framePacket->swapchainPolicy;
+        if (policy.presentMode != data.settings.swapchain.presentMode || policy.imageCount != data.settings.swapchain.imageCount)
+        {
+            data.frameBufferResized = !data.settings.headless;
+        }
+        data.settings.swapchain = policy;
+    }
 
-    if (result == VK_ERROR_OUT_OF_DATE_KHR) 
+    // The wireframe permutation compiles in the background, solid draws stand in until it's ready
+    data.drawPipeline = data.graphicsPipeline;
+    if (data.framePacket && data.framePacket->wireframe && data.wireframeSupported)
+    {
+        if (data.wireframePipeline == PipelineLibrary::INVALID_PIPELINE)
+        {
+            GraphicsPipelineDesc desc = DescribeDrawPipeline(data, "shaders/vert.spv", data.pipelineLayout, true);
+            desc.polygonMode = VK_POLYGON_MODE_LINE;
+            data.wireframePipeline = data.pipelines.RequestAsync(desc, data.graphicsPipeline);
+        }
+        data.drawPipeline = data.wireframePipeline;
+    }
+
+    // Everything uploaded since the last frame goes out as one batch, even while minimized
+    uint64_t uploadValue = data.uploads.Flush();
+
+    // Nothing to draw into while minimized
+    if (data.framebufferWidth == 0 || data.framebufferHeight == 0)
     {
-        RecreateSwapChain(data);
         return;
     }
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) 
+
+    // Wait for the frame that last used this slot to finish on the GPU, so it's safe to start
+    // rendering. Returns at once in low latency mode, the main thread already waited
+    {
+        PROFILE_ZONE("WaitForFrameSlot");
+        data.pacer.WaitForFrameSlot();
+    }
+    data.currentFrame = data.pacer.GetFrameIndex();
+    uint64_t completedValue = data.pacer.GetCompletedValue();
+    data.deletions.Collect(completedValue);
+    data.bindless.Collect(completedValue);
+    ReloadShaders(data);
+    std::chrono::steady_clock::time_point cpuBegin = std::chrono::steady_clock::now();
+
+    // Headless frames render into the frame in flight's own image
+    uint32_t imageIndex = data.currentFrame;
+    VkResult result = VK_SUCCESS;
+    if (!data.settings.headless)
     {
-        throw std::runtime_error("failed to acquire swap chain image!");
+        // Acquire the index of the next available image from the swap chain
+        PROFILE_ZONE("AcquireImage");
+        auto acquireBegin = std::chrono::steady_clock::now();
+        result = vkAcquireNextImageKHR(data.device, data.swapChain, UINT64_MAX, data.imageAvailableSemaphores[data.currentFrame], VK_NULL_HANDLE, &imageIndex);
+        data.presentTimer.AddAcquireTime(std::chrono::duration<double>(std::chrono::steady_clock::now() - acquireBegin).count());
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            RecreateSwapChain(data);
+            return;
+        }
+        else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+        {
+            throw std::runtime_error("failed to acquire swap chain image!");
+        }
     }
 
-    // Reset the fence to prepare it for the next frame
-    vkResetFences(data.device, 1, &data.inFlightFences[data.currentFrame]);
+    // The GPU is done with this frame's buffers, reset all of its pools at once
+    data.recorder.BeginFrame(data.currentFrame);
+    VkCommandBuffer commandBuffer = data.recorder.AllocatePrimary();
+
+    // One instance per object, culled and turned into draws by cull.comp
+    PROFILE_COUNTER("Objects", data.objectTransforms.size());
+    if (data.settings.gpuDriven)
+    {
+        PROFILE_ZONE("UpdateInstances");
+        data.scene.UpdateInstances(data.currentFrame, data.objectTransforms, data.quadMesh);
+    }
+    // Objects sharing mesh and material become one instanced draw
+    else
+    {
+        PROFILE_ZONE("BuildBatches");
+        data.batcher.Build(data.currentFrame, data.objectTransforms, data.objectRenderables, data.scene.GetMeshCount(), data.settings.instancing);
+    }
 
-    // Reset the command buffer for the current frame
-    vkResetCommandBuffer(data.commandBuffers[data.currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
+    if (data.overlayPass)
+    {
+        BuildDebugOverlay(data);
+    }
 
     // Record the commands into the command buffer for the current frame
-    RecordCommandBuffer(data, data.commandBuffers[data.currentFrame], imageIndex);
+    RecordCommandBuffer(data, commandBuffer, imageIndex);
 
     // Configure submission information for the command buffer
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
-    VkSemaphore waitSemaphores[] = { data.imageAvailableSemaphores[data.currentFrame] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submitInfo.waitSemaphoreCount = 1;
+    // Wait for the uploads on the GPU rather than the CPU, the value is ignored for the binary semaphore
+    VkSemaphore waitSemaphores[2];
+    VkPipelineStageFlags waitStages[2];
+    uint64_t waitValues[2];
+    uint32_t waitCount = 0;
+    if (!data.settings.headless)
+    {
+        waitSemaphores[waitCount] = data.imageAvailableSemaphores[data.currentFrame];
+        waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        waitValues[waitCount] = 0;
+        waitCount++;
+    }
+    if (uploadValue > 0)
+    {
+        waitSemaphores[waitCount] = data.uploads.GetTimeline();
+        waitStages[waitCount] = UploadQueue::CONSUMER_STAGES;
+        waitValues[waitCount] = uploadValue;
+        waitCount++;
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = waitCount;
+    timelineInfo.pWaitSemaphoreValues = waitValues;
+
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = waitCount;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
     submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &data.commandBuffers[data.currentFrame];
+    submitInfo.pCommandBuffers = &commandBuffer;
 
-    VkSemaphore signalSemaphores[] = { data.renderFinishedSemaphores[data.currentFrame] };
-    submitInfo.signalSemaphoreCount = 1;
+    // The frame timeline tells the CPU when the slot is free again, present waits on the
+    // binary semaphore. Nothing waits on a headless frame but the timeline
+    VkSemaphore signalSemaphores[] = { data.pacer.GetTimeline(), data.renderFinishedSemaphores[data.currentFrame] };
+    uint64_t signalValues[] = { data.pacer.GetSignalValue(), 0 };
+    timelineInfo.signalSemaphoreValueCount = data.settings.headless ? 1 : 2;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+    submitInfo.signalSemaphoreCount = timelineInfo.signalSemaphoreValueCount;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
     // Submit the command buffer to the graphics queue for execution
-    if (vkQueueSubmit(data.graphicsQueue, 1, &submitInfo, data.inFlightFences[data.currentFrame]) != VK_SUCCESS) {
-        throw std::runtime_error("failed to submit draw command buffer!");
+    {
+        PROFILE_ZONE("QueueSubmit");
+        if (vkQueueSubmit(data.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit draw command buffer!");
+        }
+    }
+    // Moves on to the next frame slot
+    data.pacer.FrameSubmitted(data.framePacket ? data.framePacket->simBegin : cpuBegin);
+
+    if (data.settings.headless)
+    {
+        std::chrono::duration<double> cpuTime = std::chrono::steady_clock::now() - cpuBegin;
+        data.headless.AddCpuTime(cpuTime.count());
+        return;
     }
 
     // Configure presentation information
@@ -1436,7 +1990,7 @@ void VulkanRender(RenderData& data)
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &data.renderFinishedSemaphores[data.currentFrame];
 
     VkSwapchainKHR swapChains[] = { data.swapChain };
     presentInfo.swapchainCount = 1;
@@ -1444,7 +1998,16 @@ void VulkanRender(RenderData& data)
 
     presentInfo.pImageIndices = &imageIndex;
 
-    result = vkQueuePresentKHR(data.presentQueue, &presentInfo);
+    {
+        PROFILE_ZONE("QueuePresent");
+        auto presentBegin = std::chrono::steady_clock::now();
+        result = vkQueuePresentKHR(data.presentQueue, &presentInfo);
+        auto presentEnd = std::chrono::steady_clock::now();
+        if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+        {
+            data.presentTimer.Presented(std::chrono::duration<double>(presentEnd - presentBegin).count(), presentEnd);
+        }
+    }
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || data.frameBufferResized) {
         data.frameBufferResized = false;
@@ -1453,6 +2016,146 @@ void VulkanRender(RenderData& data)
     else if (result != VK_SUCCESS) {
         throw std::runtime_error("failed to present swap chain image!");
     }
-    // Move to the next frame to prepare for rendering the next frame
-    data.currentFrame = (data.currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+}
+
+/**
+ * @brief Transforms of count quads spread over a grid covering the screen.
+ *
+ * @param count Number of objects.
+ * @return std::vector<glm::mat4> One model matrix per object.
+ */
+static std::vector<glm::mat4> BenchmarkGrid(uint32_t count)
+{
+    std::vector<glm::mat4> transforms(count);
+    uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    float scale = 2.0f / side;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        glm::mat4& transform = transforms[i];
+        transform = glm::mat4(1.0f);
+        transform[0][0] = scale;
+        transform[1][1] = scale;
+        transform[2][2] = scale;
+        transform[3] = glm::vec4(-1.0f + scale * (i % side + 0.5f), -1.0f + scale * (i / side + 0.5f), 0.5f, 1.0f);
+    }
+    return transforms;
+}
+
+/**
+ * @brief Batches objectCount quads and records them into the first framebuffer
+ * without submitting anything, using pools of its own sized for jobs.
+ *
+ * @param data The RenderData struct, after VulkanSetup.
+ * @param jobs Job system to split recording across, owned by the calling thread.
+ * @param objectCount Objects per frame, spread over BENCHMARK_MATERIALS materials.
+ * @param frames Frames to record.
+ * @param instancing Merge objects into instanced draws, else one draw per object.
+ * @return double Average seconds spent batching and recording one frame.
+ */
+double VulkanBenchmarkRecording(RenderData& data, JobSystem& jobs, uint32_t objectCount, uint32_t frames, bool instancing)
+{
+    constexpr uint32_t BENCHMARK_MATERIALS = 4;
+
+    QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(data, data.physicalDevice);
+    CommandRecorder recorder;
+    recorder.Init(data.device, queueFamilyIndices.graphicsFamily.value(), jobs.GetMaxThreads(), 1);
+
+    std::vector<glm::mat4> transforms = BenchmarkGrid(objectCount);
+    std::vector<Renderable> renderables(objectCount);
+    for (uint32_t i = 0; i < objectCount; i++)
+    {
+        renderables[i].mesh = data.quadMesh;
+        renderables[i].material = i % BENCHMARK_MATERIALS;
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    // First frame allocates the command buffers, keep it out of the timing
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame <= frames; frame++)
+    {
+        if (frame == 1)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+        data.batcher.Build(data.currentFrame, transforms, renderables, data.scene.GetMeshCount(), instancing);
+        recorder.BeginFrame(0);
+        VkCommandBuffer commandBuffer = recorder.AllocatePrimary();
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to begin recording command buffer!");
+        }
+        RenderGraphContext context = data.graph.GetContext(*data.mainPass, commandBuffer, 0);
+        RecordMainPass(data, recorder, jobs, context);
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / frames;
+
+    recorder.Shutdown();
+    return seconds;
+}
+
+/**
+ * @brief Writes instanceCount instances and records the render graph's cull and
+ * indirect draw passes for them, frames times, without submitting anything.
+ *
+ * @param data The RenderData struct, after VulkanSetup with settings.gpuDriven.
+ * @param instanceCount Objects per frame, spread over a grid in front of the camera.
+ * @param frames Frames to record.
+ * @return GpuDrivenTimings Average seconds per frame.
+ */
+GpuDrivenTimings VulkanBenchmarkGpuDriven(RenderData& data, uint32_t instanceCount, uint32_t frames)
+{
+    if (!data.settings.gpuDriven)
+    {
+        throw std::runtime_error("GPU-driven rendering is not enabled!");
+    }
+
+    std::vector<glm::mat4> transforms = BenchmarkGrid(instanceCount);
+
+    CommandRecorder recorder;
+    QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(data, data.physicalDevice);
+    recorder.Init(data.device, queueFamilyIndices.graphicsFamily.value(), data.jobSystem->GetMaxThreads(), 1);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    // First frame grows the instance buffers and allocates the command buffer
+    GpuDrivenTimings timings;
+    for (uint32_t frame = 0; frame <= frames; frame++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        data.scene.UpdateInstances(data.currentFrame, transforms, data.quadMesh);
+        auto written = std::chrono::steady_clock::now();
+
+        recorder.BeginFrame(0);
+        VkCommandBuffer commandBuffer = recorder.AllocatePrimary();
+        if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to begin recording command buffer!");
+        }
+        data.graph.Execute(commandBuffer, 0);
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+        auto recorded = std::chrono::steady_clock::now();
+
+        if (frame > 0)
+        {
+            timings.instanceSeconds += std::chrono::duration<double>(written - begin).count();
+            timings.recordSeconds += std::chrono::duration<double>(recorded - written).count();
+        }
+    }
+    timings.instanceSeconds /= frames;
+    timings.recordSeconds /= frames;
+
+    recorder.Shutdown();
+    return timings;
 }
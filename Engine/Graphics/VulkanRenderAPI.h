@@ -2,11 +2,82 @@
 #define GLFW_INCLUDE_VULKAN
 #include "GLFW/glfw3.h"
 #include "vulkan/vulkan.h"
+#include "FramePacket.h"
+#include "GpuAllocator.h"
+#include "UploadQueue.h"
+#include "PipelineCache.h"
+#include "CommandRecorder.h"
+#include "GpuScene.h"
+#include "InstanceBatcher.h"
+#include "RenderGraph.h"
+#include "HeadlessTarget.h"
+#include "DebugOverlay.h"
+#include "FramePacer.h"
+#include "SwapchainPolicy.h"
+#include "DeletionQueue.h"
+#include "BindlessDescriptors.h"
+#include "PipelineLibrary.h"
+#include "ShaderCompiler.h"
+#include <string>
 #include <vector>
+/**
+ * @brief Renderer options chosen before VulkanSetup, e.g. from the command line.
+ */
+struct RenderSettings
+{
+    //cull and build draws on the GPU (shaders/cull.comp), cleared at setup if the
+    //device lacks multiDrawIndirect, drawIndirectFirstInstance or drawIndirectCount
+    bool gpuDriven = false;
+
+    //merge objects sharing mesh and material into one instanced draw, off gives
+    //every object a draw of its own to compare against
+    bool instancing = true;
+
+    //no window, surface or swap chain: frames go into offscreen images that are
+    //read back, for benchmarks and tests on machines without a display
+    bool headless = false;
+
+    uint32_t headlessWidth = 800;
+
+    uint32_t headlessHeight = 600;
+
+    //headless only, the last frame is saved here as a PPM at cleanup if set
+    std::string readbackPath;
+
+    //count vertices, primitives and shader invocations per pass, cleared at setup if
+    //the device lacks pipelineStatisticsQuery or inheritedQueries
+    bool pipelineStatistics = false;
+
+    //per-pass GPU times are dumped here at cleanup if set, JSON for a .json path, else CSV
+    std::string gpuProfilePath;
+
+    //create the performance overlay, F1 shows and hides it. Without it the overlay
+    //pass doesn't exist, hidden it is skipped and nothing is built
+    bool overlay = false;
+
+    //frames the CPU may record ahead of the GPU, 1 to FramePacer::MAX_FRAMES_IN_FLIGHT.
+    //More hides CPU spikes, fewer cuts latency
+    uint32_t framesInFlight = 2;
+
+    //wait for a free frame slot before input is sampled instead of after the frame is
+    //built, so input is as fresh as possible. Simulation no longer overlaps recording
+    bool lowLatency = false;
+
+    //recompile shaders saved while running and swap in their pipelines, not when headless
+    bool hotReload = true;
+
+    //present mode, image count and frame rate cap to start with. The render thread
+    //keeps the policy in use here, changes arrive with the frame packet
+    SwapchainPolicy swapchain;
+};
+
 //if making your own API, fill out renderData with what your renderer needs
 struct RenderData
 {
-    GLFWwindow* window;
+    //nullptr when settings.headless
+    GLFWwindow* window = nullptr;
+
+    RenderSettings settings;
 
     VkInstance instance;
 
@@ -18,7 +89,16 @@ struct RenderData
 
     VkQueue presentQueue;
 
-    VkSwapchainKHR swapChain;
+    //dedicated transfer queue, VK_NULL_HANDLE if the device has none
+    VkQueue transferQueue = VK_NULL_HANDLE;
+
+    VkSwapchainKHR swapChain = VK_NULL_HANDLE;
+
+    //mode the swap chain was created with, settings.swapchain's or the fallback
+    PresentMode presentMode = PresentMode::Vsync;
+
+    //presented frame timing per present mode
+    PresentTimer presentTimer;
 
     std::vector<VkImage> swapChainImages;
 
@@ -30,40 +110,165 @@ struct RenderData
 
     std::vector<VkImageView> swapChainImageViews;
 
-    VkSurfaceKHR surface;
-    
-    VkRenderPass renderPass;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+
+    //stands in for the swap chain when settings.headless
+    HeadlessTarget headless;
+
+    //every pass of the frame, its barriers and transient attachments
+    RenderGraph graph;
+
+    //GPU time of every graph pass, read back settings.framesInFlight frames later
+    GpuProfiler profiler;
+
+    //draws the objects into the backbuffer, pipelines are created against its render pass
+    RenderGraphPass* mainPass = nullptr;
+
+    //only created when settings.overlay
+    DebugOverlay overlay;
+
+    //draws the overlay over the frame, optional so it's skipped while hidden
+    RenderGraphPass* overlayPass = nullptr;
+
+    //when the last frame that showed the overlay started, for its frame time graph
+    std::chrono::steady_clock::time_point overlayFrameBegin;
+
+    //whether the frame before this one showed it, else the frame time is unknown
+    bool overlayWasVisible = false;
+
+    //GLSL to SPIR-V at setup, then recompiles shaders as they are saved
+    ShaderCompiler shaderCompiler;
 
-    VkPipeline graphicsPipeline;
+    //SPIR-V files the shader compiler rewrote, reused every frame
+    std::vector<std::string> changedShaders;
 
+    //every graphics pipeline, compiled in place or in the background
+    PipelineLibrary pipelines;
+
+    //CPU draw path pipeline id in pipelines
+    uint32_t graphicsPipeline = PipelineLibrary::INVALID_PIPELINE;
+
+    //its wireframe permutation, requested the first time a packet asks for it
+    uint32_t wireframePipeline = PipelineLibrary::INVALID_PIPELINE;
+
+    //pipeline id the current frame draws with
+    uint32_t drawPipeline = PipelineLibrary::INVALID_PIPELINE;
+
+    //the device can rasterize lines, needed by wireframePipeline
+    bool wireframeSupported = false;
+
+    //bindless set at set 0, MaterialConstants as vertex push constants
     VkPipelineLayout pipelineLayout;
 
-    std::vector<VkFramebuffer> swapChainFramebuffers;
+    //every sampled image, sampler and storage buffer shaders can index
+    BindlessDescriptors bindless;
+
+    //MaterialData of every material, Renderable::material indexes it
+    VkBuffer materialBuffer = VK_NULL_HANDLE;
+
+    GpuAllocation materialAllocation;
+
+    //bindless index of materialBuffer
+    uint32_t materialTable = BindlessDescriptors::INVALID_INDEX;
+
+    uint32_t materialCount = 0;
+
+    //GPU-driven path, only created when settings.gpuDriven
+    VkPipeline cullPipeline = VK_NULL_HANDLE;
+
+    VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+
+    //pipeline id in pipelines
+    uint32_t indirectPipeline = PipelineLibrary::INVALID_PIPELINE;
+
+    VkPipelineLayout indirectPipelineLayout = VK_NULL_HANDLE;
+
+    //loaded from disk at setup, saved at cleanup
+    PipelineCache pipelineCache;
 
-    VkCommandPool commandPool;
+    //job system that command recording is split across, set before VulkanSetup
+    JobSystem* jobSystem = nullptr;
 
-    std::vector<VkCommandBuffer> commandBuffers;
+    //per-thread, per-frame command pools and buffers
+    CommandRecorder recorder;
+
+    //the frame's objects grouped into instanced draws, recording is split across
+    //threads once there are enough draws
+    InstanceBatcher batcher;
 
     std::vector<VkSemaphore> imageAvailableSemaphores;
 
     std::vector<VkSemaphore> renderFinishedSemaphores;
 
-    std::vector<VkFence> inFlightFences;
+    //frame timeline, frame slots and latency counters
+    FramePacer pacer;
 
+    //slot of the frame being recorded, from pacer
     uint32_t currentFrame = 0;
 
     bool frameBufferResized = false;
 
-    VkBuffer vertexBuffer;
+    //framebuffer size from the latest frame packet, 0 while minimized
+    int framebufferWidth = 0;
+
+    int framebufferHeight = 0;
+
+    //packet being rendered, only valid during VulkanRender
+    const FramePacket* framePacket = nullptr;
+
+    //packet transforms interpolated to the render time
+    std::vector<glm::mat4> objectTransforms;
+
+    //mesh and material of each object
+    std::vector<Renderable> objectRenderables;
+
+    //every buffer and image gets its memory from here
+    GpuAllocator allocator;
+
+    //objects dropped mid-run, destroyed once the frame timeline passes the last frame using them
+    DeletionQueue deletions;
 
-    VkDeviceMemory vertexBufferMemory;
+    //CPU to GPU buffer copies, flushed once per frame
+    UploadQueue uploads;
 
-    VkBuffer indexBuffer;
+    //every mesh in one vertex and index buffer, plus per-instance data for GPU culling
+    GpuScene scene;
 
-    VkDeviceMemory indexBufferMemory;
+    //mesh drawn for every object
+    uint32_t quadMesh = 0;
+
+    //no camera yet, objects are placed directly in clip space
+    glm::mat4 viewProjection{ 1.0f };
 
 };
 
 void VulkanSetup(RenderData& data);
 void VulkanRender(RenderData& data);
 void VulkanCleanup(RenderData& data);
+
+/**
+ * @brief Batches and records frames of objectCount objects without submitting
+ * them, for the recording benchmark. Must be called on the thread that owns jobs.
+ *
+ * @param instancing Merge objects into instanced draws, else one draw per object.
+ * @return double Average seconds spent batching and recording one frame.
+ */
+double VulkanBenchmarkRecording(RenderData& data, JobSystem& jobs, uint32_t objectCount, uint32_t frames, bool instancing);
+
+/**
+ * @brief CPU cost of one GPU-driven frame, split into writing the instances and
+ * recording the cull and draw commands.
+ */
+struct GpuDrivenTimings
+{
+    double instanceSeconds = 0.0;
+    double recordSeconds = 0.0;
+};
+
+/**
+ * @brief Records frames of the GPU-driven path with instanceCount objects without
+ * submitting them, for the indirect benchmark. Needs settings.gpuDriven.
+ *
+ * @return GpuDrivenTimings Average seconds per frame.
+ */
+GpuDrivenTimings VulkanBenchmarkGpuDriven(RenderData& data, uint32_t instanceCount, uint32_t frames);
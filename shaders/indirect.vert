@@ -0,0 +1,25 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 fragColor;
+
+struct Instance {
+    mat4 model;
+    uint meshIndex;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(push_constant) uniform DrawConstants {
+    mat4 viewProjection;
+};
+
+void main() {
+    mat4 model = instances[gl_InstanceIndex].model;
+    gl_Position = viewProjection * model * vec4(inPosition, 0.0, 1.0);
+    fragColor = inColor;
+}
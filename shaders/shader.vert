@@ -1,11 +1,36 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec3 inColor;
 
+// Per instance, see InstanceData
+layout(location = 2) in mat4 inModel;
+layout(location = 6) in uint inMaterial;
+
 layout(location = 0) out vec3 fragColor;
 
+// Layout matches MaterialData
+struct Material {
+    vec4 tint;
+    uint textureIndex;
+    uint samplerIndex;
+    uint padding0;
+    uint padding1;
+};
+
+// Storage buffer array of the bindless set, see BindlessDescriptors
+layout(std430, set = 0, binding = 2) readonly buffer MaterialTables {
+    Material materials[];
+} materialTables[];
+
+layout(push_constant) uniform MaterialConstants {
+    uint materialTable;
+    uint materialCount;
+};
+
 void main() {
-    gl_Position = vec4(inPosition, 0.0, 1.0);
-    fragColor = inColor;
+    gl_Position = inModel * vec4(inPosition, 0.0, 1.0);
+    Material material = materialTables[materialTable].materials[inMaterial % materialCount];
+    fragColor = inColor * material.tint.rgb;
 }